@@ -76,6 +76,7 @@ constexpr auto kForwardMessagesOnAdd = 100;
 constexpr auto kProxyPromotionInterval = TimeId(60 * 60);
 constexpr auto kProxyPromotionMinDelay = TimeId(10);
 constexpr auto kSmallDelayMs = 5;
+constexpr auto kPeersPerRequestLimit = 100;
 constexpr auto kUnreadMentionsPreloadIfLess = 5;
 constexpr auto kUnreadMentionsFirstRequestLimit = 10;
 constexpr auto kUnreadMentionsNextRequestLimit = 100;
@@ -83,9 +84,11 @@ constexpr auto kSharedMediaLimit = 100;
 constexpr auto kFeedMessagesLimit = 50;
 constexpr auto kReadFeaturedSetsTimeout = TimeMs(1000);
 constexpr auto kFileLoaderQueueStopTimeout = TimeMs(5000);
+constexpr auto kFileLoaderQueueMaxThreads = 4;
 constexpr auto kFeedReadTimeout = TimeMs(1000);
 constexpr auto kStickersByEmojiInvalidateTimeout = TimeMs(60 * 60 * 1000);
 constexpr auto kNotifySettingSaveTimeout = TimeMs(1000);
+constexpr auto kFullPeerFailRetryTimeout = TimeMs(10000);
 
 using SimpleFileLocationId = Data::SimpleFileLocationId;
 using DocumentFileLocationId = Data::DocumentFileLocationId;
@@ -181,10 +184,14 @@ MTPInputPrivacyKey ApiWrap::Privacy::Input(Key key) {
 ApiWrap::ApiWrap(not_null<AuthSession*> session)
 : _session(session)
 , _messageDataResolveDelayed([=] { resolveMessageDatas(); })
+, _peerRequestsDelayed([=] { sendPeerRequests(); })
 , _webPagesTimer([=] { resolveWebPages(); })
 , _draftsSaveTimer([=] { saveDraftsToCloud(); })
 , _featuredSetsReadTimer([=] { readFeaturedSets(); })
-, _fileLoader(std::make_unique<TaskQueue>(kFileLoaderQueueStopTimeout))
+, _fileLoader(std::make_unique<TaskQueue>(
+	kFileLoaderQueueStopTimeout,
+	QThread::InheritPriority,
+	std::clamp(QThread::idealThreadCount(), 1, kFileLoaderQueueMaxThreads)))
 , _feedReadTimer([=] { readFeeds(); })
 , _proxyPromotionTimer([=] { refreshProxyPromotion(); })
 , _updateNotifySettingsTimer([=] { sendNotifySettingsUpdates(); }) {
@@ -905,9 +912,20 @@ void ApiWrap::requestFullPeer(not_null<PeerData*> peer) {
 		return;
 	}
 
+	// Many places request the full peer each time they see some of its
+	// info missing, so after a failed request they would spam the server.
+	const auto failed = _fullPeerFailedAt.find(peer);
+	if (failed != end(_fullPeerFailedAt)) {
+		if (getms(true) < failed->second + kFullPeerFailRetryTimeout) {
+			return;
+		}
+		_fullPeerFailedAt.erase(failed);
+	}
+
 	const auto requestId = [&] {
 		const auto failHandler = [=](const RPCError &error) {
 			_fullPeerRequests.remove(peer);
+			_fullPeerFailedAt[peer] = getms(true);
 			migrateFail(peer, error);
 		};
 		if (const auto user = peer->asUser()) {
@@ -1133,41 +1151,89 @@ void ApiWrap::gotUserFull(
 }
 
 void ApiWrap::requestPeer(not_null<PeerData*> peer) {
-	if (_fullPeerRequests.contains(peer) || _peerRequests.contains(peer)) {
+	if (_fullPeerRequests.contains(peer)
+		|| _peerRequests.contains(peer)
+		|| _peersPending.contains(peer)) {
 		return;
 	}
+	_peersPending.emplace(peer);
+	if (int(_peersPending.size()) >= kPeersPerRequestLimit) {
+		sendPeerRequests();
+	} else {
+		_peerRequestsDelayed.call();
+	}
+}
 
-	const auto requestId = [&] {
-		const auto failHandler = [=](const RPCError &error) {
-			_peerRequests.remove(peer);
-		};
-		const auto chatHandler = [=](const MTPmessages_Chats &result) {
-			_peerRequests.remove(peer);
-			const auto &chats = result.match([](const auto &data) {
-				return data.vchats;
-			});
-			_session->data().applyMaximumChatVersions(chats);
-			_session->data().processChats(chats);
-		};
+void ApiWrap::sendPeerRequests() {
+	if (_peersPending.empty()) {
+		return;
+	}
+	auto users = QVector<MTPInputUser>();
+	auto chats = QVector<MTPint>();
+	auto channels = QVector<MTPInputChannel>();
+	users.reserve(_peersPending.size());
+	for (const auto peer : _peersPending) {
 		if (const auto user = peer->asUser()) {
-			return request(MTPusers_GetUsers(
-				MTP_vector<MTPInputUser>(1, user->inputUser)
-			)).done([=](const MTPVector<MTPUser> &result) {
-				_peerRequests.remove(user);
-				_session->data().processUsers(result);
-			}).fail(failHandler).send();
+			users.push_back(user->inputUser);
 		} else if (const auto chat = peer->asChat()) {
-			return request(MTPmessages_GetChats(
-				MTP_vector<MTPint>(1, chat->inputChat)
-			)).done(chatHandler).fail(failHandler).send();
+			chats.push_back(chat->inputChat);
 		} else if (const auto channel = peer->asChannel()) {
-			return request(MTPchannels_GetChannels(
-				MTP_vector<MTPInputChannel>(1, channel->inputChannel)
-			)).done(chatHandler).fail(failHandler).send();
+			channels.push_back(channel->inputChannel);
+		} else {
+			Unexpected("Peer type in sendPeerRequests.");
 		}
-		Unexpected("Peer type in requestPeer.");
-	}();
-	_peerRequests.insert(peer, requestId);
+	}
+	DEBUG_LOG(("API Info: requesting peers in a batch, "
+		"users: %1, chats: %2, channels: %3."
+		).arg(users.size()
+		).arg(chats.size()
+		).arg(channels.size()));
+
+	const auto failHandler = [=](
+			const RPCError &error,
+			mtpRequestId requestId) {
+		finishPeerRequest(requestId);
+	};
+	const auto chatHandler = [=](
+			const MTPmessages_Chats &result,
+			mtpRequestId requestId) {
+		finishPeerRequest(requestId);
+		const auto &chats = result.match([](const auto &data) {
+			return data.vchats;
+		});
+		_session->data().applyMaximumChatVersions(chats);
+		_session->data().processChats(chats);
+	};
+	const auto usersRequestId = users.isEmpty() ? 0 : request(
+		MTPusers_GetUsers(MTP_vector<MTPInputUser>(users))
+	).done([=](const MTPVector<MTPUser> &result, mtpRequestId requestId) {
+		finishPeerRequest(requestId);
+		_session->data().processUsers(result);
+	}).fail(failHandler).send();
+	const auto chatsRequestId = chats.isEmpty() ? 0 : request(
+		MTPmessages_GetChats(MTP_vector<MTPint>(chats))
+	).done(chatHandler).fail(failHandler).send();
+	const auto channelsRequestId = channels.isEmpty() ? 0 : request(
+		MTPchannels_GetChannels(MTP_vector<MTPInputChannel>(channels))
+	).done(chatHandler).fail(failHandler).send();
+
+	for (const auto peer : base::take(_peersPending)) {
+		_peerRequests.insert(peer, peer->isUser()
+			? usersRequestId
+			: peer->isChat()
+			? chatsRequestId
+			: channelsRequestId);
+	}
+}
+
+void ApiWrap::finishPeerRequest(mtpRequestId requestId) {
+	for (auto i = _peerRequests.begin(); i != _peerRequests.end();) {
+		if (i.value() == requestId) {
+			i = _peerRequests.erase(i);
+		} else {
+			++i;
+		}
+	}
 }
 
 void ApiWrap::migrateChat(
@@ -1285,13 +1351,13 @@ void ApiWrap::markMediaRead(
 			MTP_vector<MTPint>(markedIds)
 		)).done([=](const MTPmessages_AffectedMessages &result) {
 			applyAffectedMessages(result);
-		}).send();
+		}).afterDelay(kSmallDelayMs).send();
 	}
 	for (const auto &channelIds : channelMarkedIds) {
 		request(MTPchannels_ReadMessageContents(
 			channelIds.first->inputChannel,
 			MTP_vector<MTPint>(channelIds.second)
-		)).send();
+		)).afterDelay(kSmallDelayMs).send();
 	}
 }
 
@@ -1309,59 +1375,22 @@ void ApiWrap::markMediaRead(not_null<HistoryItem*> item) {
 		request(MTPchannels_ReadMessageContents(
 			channel->inputChannel,
 			ids
-		)).send();
+		)).afterDelay(kSmallDelayMs).send();
 	} else {
 		request(MTPmessages_ReadMessageContents(
 			ids
 		)).done([=](const MTPmessages_AffectedMessages &result) {
 			applyAffectedMessages(result);
-		}).send();
+		}).afterDelay(kSmallDelayMs).send();
 	}
 }
 
 void ApiWrap::requestPeers(const QList<PeerData*> &peers) {
-	QVector<MTPint> chats;
-	QVector<MTPInputChannel> channels;
-	QVector<MTPInputUser> users;
-	chats.reserve(peers.size());
-	channels.reserve(peers.size());
-	users.reserve(peers.size());
 	for (const auto peer : peers) {
-		if (!peer
-			|| _fullPeerRequests.contains(peer)
-			|| _peerRequests.contains(peer)) {
-			continue;
-		}
-		if (const auto user = peer->asUser()) {
-			users.push_back(user->inputUser);
-		} else if (const auto chat = peer->asChat()) {
-			chats.push_back(chat->inputChat);
-		} else if (const auto channel = peer->asChannel()) {
-			channels.push_back(channel->inputChannel);
+		if (peer) {
+			requestPeer(peer);
 		}
 	}
-	const auto handleChats = [=](const MTPmessages_Chats &result) {
-		_session->data().processChats(result.match([](const auto &data) {
-			return data.vchats;
-		}));
-	};
-	if (!chats.isEmpty()) {
-		request(MTPmessages_GetChats(
-			MTP_vector<MTPint>(chats)
-		)).done(handleChats).send();
-	}
-	if (!channels.isEmpty()) {
-		request(MTPchannels_GetChannels(
-			MTP_vector<MTPInputChannel>(channels)
-		)).done(handleChats).send();
-	}
-	if (!users.isEmpty()) {
-		request(MTPusers_GetUsers(
-			MTP_vector<MTPInputUser>(users)
-		)).done([=](const MTPVector<MTPUser> &result) {
-			_session->data().processUsers(result);
-		}).send();
-	}
 }
 
 void ApiWrap::requestLastParticipants(not_null<ChannelData*> channel) {
@@ -1370,8 +1399,14 @@ void ApiWrap::requestLastParticipants(not_null<ChannelData*> channel) {
 		return;
 	}
 
+	// The list we already have is sent as a hash, so that the server
+	// can answer with channelParticipantsNotModified if it is actual.
 	const auto offset = 0;
-	const auto participantsHash = 0;
+	const auto participantsHash = Api::CountHash(
+		channel->mgInfo->lastParticipants
+		| ranges::view::transform([](not_null<UserData*> user) {
+			return user->bareId();
+		}));
 	const auto requestId = request(MTPchannels_GetParticipants(
 		channel->inputChannel,
 		MTP_channelParticipantsRecent(),
@@ -1387,6 +1422,10 @@ void ApiWrap::requestLastParticipants(not_null<ChannelData*> channel) {
 				channel,
 				availableCount,
 				list);
+		}, [&] {
+			channel->mgInfo->lastParticipantsStatus
+				= MegagroupInfo::LastParticipantsUpToDate;
+			fullPeerUpdated().notify(channel);
 		});
 	}).fail([this, channel](const RPCError &error) {
 		_participantsRequests.remove(channel);
@@ -3417,6 +3456,12 @@ void ApiWrap::applyUpdatesNoPtsCheck(const MTPUpdates &updates) {
 }
 
 void ApiWrap::applyUpdateNoPtsCheck(const MTPUpdate &update) {
+	if (update.type() != mtpc_updateNewMessage
+		&& update.type() != mtpc_updateNewChannelMessage) {
+		if (const auto main = App::main()) {
+			main->flushNewUnreadMessages();
+		}
+	}
 	switch (update.type()) {
 	case mtpc_updateNewMessage: {
 		auto &d = update.c_updateNewMessage();
@@ -5664,7 +5709,7 @@ void ApiWrap::sendReadRequest(not_null<PeerData*> peer, MsgId upTo) {
 				finished();
 			}).fail([=](const RPCError &error) {
 				finished();
-			}).send();
+			}).afterDelay(kSmallDelayMs).send();
 		}
 		return request(MTPmessages_ReadHistory(
 			peer->input,
@@ -5674,7 +5719,7 @@ void ApiWrap::sendReadRequest(not_null<PeerData*> peer, MsgId upTo) {
 			finished();
 		}).fail([=](const RPCError &error) {
 			finished();
-		}).send();
+		}).afterDelay(kSmallDelayMs).send();
 	}();
 	_readRequests.emplace(peer, requestId, upTo);
 }
@@ -603,6 +603,8 @@ private:
 	void migrateFail(not_null<PeerData*> peer, const RPCError &error);
 
 	void sendDialogRequests();
+	void sendPeerRequests();
+	void finishPeerRequest(mtpRequestId requestId);
 
 	not_null<AuthSession*> _session;
 
@@ -612,7 +614,10 @@ private:
 
 	using PeerRequests = QMap<PeerData*, mtpRequestId>;
 	PeerRequests _fullPeerRequests;
+	base::flat_map<not_null<PeerData*>, TimeMs> _fullPeerFailedAt;
 	PeerRequests _peerRequests;
+	base::flat_set<not_null<PeerData*>> _peersPending;
+	SingleQueuedInvokation _peerRequestsDelayed;
 
 	PeerRequests _participantsRequests;
 	PeerRequests _botsRequests;
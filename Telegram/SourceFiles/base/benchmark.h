@@ -0,0 +1,133 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Minimal micro-benchmark harness, see base/benchmarks_main.cpp.
+//
+// BENCHMARK_CASE("flat_map") {
+//	runner.measure("insert 1000", 1000, [&] { ... });
+// }
+namespace base {
+namespace benchmark {
+
+class Runner {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// Calls "body" repeatedly until enough time is spent and records
+	// the time of a single call. "operations" is the amount of work done
+	// in one call, it is used to report the time of a single operation.
+	template <typename Body>
+	void measure(
+		const std::string &name,
+		std::int64_t operations,
+		Body &&body);
+
+private:
+	void add(
+		const std::string &name,
+		std::int64_t operations,
+		std::vector<std::int64_t> &&samples,
+		std::int64_t allocations);
+
+	friend int Run(int argc, const char *argv[]);
+
+	struct Result {
+		std::string name;
+		std::int64_t operations = 0;
+		std::int64_t calls = 0;
+		double minimal = 0.;
+		double median = 0.;
+		double allocations = 0.;
+	};
+	std::string _group;
+	std::string _filter;
+	std::vector<Result> _results;
+
+};
+
+void Register(const char *group, void (*method)(Runner &runner));
+int Run(int argc, const char *argv[]);
+
+// Count of heap allocations made through the global operator new so far.
+std::int64_t AllocationsCount();
+
+// Prevents the compiler from throwing away computations in the benchmarks.
+template <typename Value>
+inline void DoNotOptimize(const Value &value) {
+	if constexpr (std::is_arithmetic_v<Value>) {
+		static volatile Value Sink = Value();
+		Sink = value;
+	} else {
+		static const void *volatile Sink = nullptr;
+		Sink = &value;
+	}
+}
+
+template <typename Body>
+void Runner::measure(
+		const std::string &name,
+		std::int64_t operations,
+		Body &&body) {
+	constexpr auto kMinimalSamples = 5;
+	constexpr auto kMaximalSamples = 1000;
+	constexpr auto kMinimalDuration = std::chrono::milliseconds(300);
+
+	if (!_filter.empty()
+		&& (_group + ' ' + name).find(_filter) == std::string::npos) {
+		return;
+	}
+	body(); // Warm up.
+
+	auto samples = std::vector<std::int64_t>();
+	samples.reserve(kMaximalSamples);
+	const auto allocations = AllocationsCount();
+	const auto started = Clock::now();
+	while (samples.size() < kMinimalSamples
+		|| (samples.size() < kMaximalSamples
+			&& Clock::now() - started < kMinimalDuration)) {
+		const auto start = Clock::now();
+		body();
+		samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			Clock::now() - start).count());
+	}
+	add(
+		name,
+		operations,
+		std::move(samples),
+		AllocationsCount() - allocations);
+}
+
+namespace details {
+
+struct Registrator {
+	Registrator(const char *group, void (*method)(Runner &runner)) {
+		Register(group, method);
+	}
+};
+
+} // namespace details
+} // namespace benchmark
+} // namespace base
+
+#define BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_IMPL(a, b)
+#define BENCHMARK_CASE_IMPL(group, method) \
+static void method(::base::benchmark::Runner &runner); \
+static const ::base::benchmark::details::Registrator \
+	BENCHMARK_CONCAT(method, _registrator)(group, &method); \
+static void method(::base::benchmark::Runner &runner)
+
+#define BENCHMARK_CASE(group) \
+BENCHMARK_CASE_IMPL(group, BENCHMARK_CONCAT(benchmark_case_, __LINE__))
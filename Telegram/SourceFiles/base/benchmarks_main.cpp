@@ -0,0 +1,164 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "base/benchmark.h"
+
+#include <QFile>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+namespace {
+
+// Global operator new is replaced to report allocations per operation.
+std::atomic<std::int64_t> Allocations = 0;
+
+} // namespace
+
+void *operator new(std::size_t size) {
+	++Allocations;
+	if (const auto result = std::malloc(size ? size : 1)) {
+		return result;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t size) noexcept {
+	std::free(pointer);
+}
+
+namespace base {
+namespace assertion {
+
+// For Assert() / Expects() / Ensures() / Unexpected() to work.
+void log(const char *message, const char *file, int line) {
+	std::cout << message << " (" << file << ":" << line << ")" << std::endl;
+}
+
+} // namespace assertion
+
+namespace benchmark {
+namespace {
+
+struct Case {
+	const char *group = nullptr;
+	void (*method)(Runner &runner) = nullptr;
+};
+
+std::vector<Case> &Cases() {
+	static auto result = std::vector<Case>();
+	return result;
+}
+
+std::string Escape(const std::string &value) {
+	auto result = std::string();
+	result.reserve(value.size());
+	for (const auto ch : value) {
+		if (ch == '"' || ch == '\\') {
+			result.push_back('\\');
+		}
+		result.push_back(ch);
+	}
+	return result;
+}
+
+} // namespace
+
+void Register(const char *group, void (*method)(Runner &runner)) {
+	Cases().push_back({ group, method });
+}
+
+std::int64_t AllocationsCount() {
+	return Allocations.load(std::memory_order_relaxed);
+}
+
+void Runner::add(
+		const std::string &name,
+		std::int64_t operations,
+		std::vector<std::int64_t> &&samples,
+		std::int64_t allocations) {
+	std::sort(begin(samples), end(samples));
+
+	const auto perOperation = [&](std::int64_t value) {
+		return double(value) / std::max(operations, std::int64_t(1));
+	};
+	auto result = Result();
+	result.name = _group + ' ' + name;
+	result.operations = operations;
+	result.calls = std::int64_t(samples.size());
+	result.minimal = perOperation(samples.front());
+	result.median = perOperation(samples[samples.size() / 2]);
+	result.allocations = perOperation(allocations) / samples.size();
+	std::cerr
+		<< result.name << ": "
+		<< result.median << " ns per operation" << std::endl;
+	_results.push_back(std::move(result));
+}
+
+// Arguments:
+// --filter <substring> runs only benchmarks with matching names.
+// --output <path> writes the JSON results to a file instead of stdout.
+int Run(int argc, const char *argv[]) {
+	auto runner = Runner();
+	auto output = QString();
+	for (auto i = 1; i < argc; ++i) {
+		if (argv[i] == QString("--filter") && i + 1 != argc) {
+			runner._filter = argv[++i];
+		} else if (argv[i] == QString("--output") && i + 1 != argc) {
+			output = QFile::decodeName(argv[++i]);
+		}
+	}
+	for (const auto &entry : Cases()) {
+		runner._group = entry.group;
+		entry.method(runner);
+	}
+
+	auto stream = std::ostringstream();
+	stream << "{\n\t\"benchmarks\": [";
+	auto first = true;
+	for (const auto &result : runner._results) {
+		stream << (first ? "\n" : ",\n");
+		first = false;
+		stream
+			<< "\t\t{ "
+			<< "\"name\": \"" << Escape(result.name) << "\", "
+			<< "\"operations\": " << result.operations << ", "
+			<< "\"calls\": " << result.calls << ", "
+			<< "\"ns_per_operation_min\": " << result.minimal << ", "
+			<< "\"ns_per_operation_median\": " << result.median << ", "
+			<< "\"allocations_per_operation\": " << result.allocations
+			<< " }";
+	}
+	stream << "\n\t]\n}\n";
+
+	const auto serialized = stream.str();
+	if (output.isEmpty()) {
+		std::cout << serialized;
+		return 0;
+	}
+	QFile f(output);
+	if (!f.open(QIODevice::WriteOnly)
+		|| f.write(serialized.data(), serialized.size()) < 0) {
+		std::cerr << "Could not write results." << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+} // namespace benchmark
+} // namespace base
+
+int main(int argc, const char *argv[]) {
+	return base::benchmark::Run(argc, argv);
+}
@@ -0,0 +1,421 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+namespace base {
+
+using std::begin;
+using std::end;
+
+// Open addressing hash map with linear probing.
+//
+// All the elements are kept in a single array together with one control
+// byte per slot, which holds 7 bits of the element hash, so most of the
+// mismatching slots are skipped without comparing the keys. Erased slots
+// are marked as deleted until the next rehash, so erasing never moves
+// other elements and it is fine to erase while iterating.
+//
+// Unlike std::unordered_map, any insertion may move all the elements,
+// invalidating all the iterators and references.
+template <
+	typename Key,
+	typename Type,
+	typename Hash = std::hash<Key>,
+	typename Equal = std::equal_to<>>
+class flat_hash_map {
+	using control_t = std::uint8_t;
+
+	template <typename Pointer, typename Reference>
+	class iterator_impl;
+
+public:
+	using key_type = Key;
+	using mapped_type = Type;
+	using value_type = std::pair<const Key, Type>;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = value_type&;
+	using const_reference = const value_type&;
+	using pointer = value_type*;
+	using const_pointer = const value_type*;
+
+	using iterator = iterator_impl<value_type*, value_type&>;
+	using const_iterator = iterator_impl<
+		const value_type*,
+		const value_type&>;
+
+	flat_hash_map() = default;
+	flat_hash_map(const flat_hash_map &other) {
+		reserve(other.size());
+		for (const auto &value : other) {
+			emplace(value.first, value.second);
+		}
+	}
+	flat_hash_map(flat_hash_map &&other) noexcept {
+		swap(other);
+	}
+	flat_hash_map &operator=(const flat_hash_map &other) {
+		if (this != &other) {
+			auto copy = other;
+			swap(copy);
+		}
+		return *this;
+	}
+	flat_hash_map &operator=(flat_hash_map &&other) noexcept {
+		if (this != &other) {
+			auto taken = flat_hash_map();
+			taken.swap(other);
+			swap(taken);
+		}
+		return *this;
+	}
+	~flat_hash_map() {
+		destroy();
+	}
+
+	void swap(flat_hash_map &other) noexcept {
+		std::swap(_control, other._control);
+		std::swap(_slots, other._slots);
+		std::swap(_capacity, other._capacity);
+		std::swap(_size, other._size);
+		std::swap(_growthLeft, other._growthLeft);
+	}
+
+	size_type size() const {
+		return _size;
+	}
+	bool empty() const {
+		return !_size;
+	}
+	void clear() {
+		// Values destructors may look into this map, leave it empty first.
+		auto taken = flat_hash_map();
+		swap(taken);
+	}
+
+	// Makes sure that "count" elements fit without a rehash.
+	void reserve(size_type count) {
+		if (count > _size + _growthLeft) {
+			rehash(CapacityFor(count));
+		}
+	}
+
+	iterator begin() {
+		return iterator(_control, _slots).skipFree();
+	}
+	iterator end() {
+		return iterator(_control + _capacity, _slots + _capacity);
+	}
+	const_iterator begin() const {
+		return const_iterator(_control, _slots).skipFree();
+	}
+	const_iterator end() const {
+		return const_iterator(_control + _capacity, _slots + _capacity);
+	}
+	const_iterator cbegin() const {
+		return begin();
+	}
+	const_iterator cend() const {
+		return end();
+	}
+
+	iterator find(const Key &key) {
+		const auto index = lookup(key);
+		return (index < 0) ? end() : at(index);
+	}
+	const_iterator find(const Key &key) const {
+		const auto index = lookup(key);
+		return (index < 0) ? end() : at(index);
+	}
+	bool contains(const Key &key) const {
+		return (lookup(key) >= 0);
+	}
+	size_type count(const Key &key) const {
+		return contains(key) ? 1 : 0;
+	}
+
+	template <typename... Args>
+	std::pair<iterator, bool> try_emplace(const Key &key, Args&&... args) {
+		const auto [index, found] = prepareInsert(key);
+		if (!found) {
+			new (&_slots[index].value) value_type(
+				std::piecewise_construct,
+				std::forward_as_tuple(key),
+				std::forward_as_tuple(std::forward<Args>(args)...));
+		}
+		return { at(index), !found };
+	}
+	template <typename... Args>
+	std::pair<iterator, bool> emplace(const Key &key, Args&&... args) {
+		return try_emplace(key, std::forward<Args>(args)...);
+	}
+	std::pair<iterator, bool> insert(value_type &&value) {
+		return try_emplace(value.first, std::move(value.second));
+	}
+	std::pair<iterator, bool> insert(const value_type &value) {
+		return try_emplace(value.first, value.second);
+	}
+
+	Type &operator[](const Key &key) {
+		return try_emplace(key).first->second;
+	}
+
+	iterator erase(const_iterator where) {
+		const auto index = where._control - _control;
+		eraseAt(index);
+		return at(index).skipFree();
+	}
+	size_type erase(const Key &key) {
+		const auto index = lookup(key);
+		if (index < 0) {
+			return 0;
+		}
+		eraseAt(index);
+		return 1;
+	}
+
+private:
+	// Control bytes of full slots hold 7 bits of the hash.
+	static constexpr auto kEmpty = control_t(0x80);
+	static constexpr auto kDeleted = control_t(0xFE);
+	static constexpr auto kSentinel = control_t(0xFF);
+	static constexpr auto kMinimalCapacity = size_type(16);
+
+	union Slot {
+		Slot() {
+		}
+		~Slot() {
+		}
+
+		value_type value;
+	};
+
+	template <typename Pointer, typename Reference>
+	class iterator_impl {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = typename flat_hash_map::value_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = Pointer;
+		using reference = Reference;
+
+		iterator_impl() = default;
+		template <
+			typename OtherPointer,
+			typename OtherReference,
+			typename = std::enable_if_t<
+				std::is_convertible_v<OtherPointer, Pointer>>>
+		iterator_impl(const iterator_impl<
+				OtherPointer,
+				OtherReference> &other)
+		: _control(other._control)
+		, _slot(other._slot) {
+		}
+
+		reference operator*() const {
+			return _slot->value;
+		}
+		pointer operator->() const {
+			return &_slot->value;
+		}
+		iterator_impl &operator++() {
+			++_control;
+			++_slot;
+			return skipFree();
+		}
+		iterator_impl operator++(int) {
+			auto result = *this;
+			++*this;
+			return result;
+		}
+
+		template <typename OtherPointer, typename OtherReference>
+		bool operator==(const iterator_impl<
+				OtherPointer,
+				OtherReference> &other) const {
+			return (_control == other._control);
+		}
+		template <typename OtherPointer, typename OtherReference>
+		bool operator!=(const iterator_impl<
+				OtherPointer,
+				OtherReference> &other) const {
+			return !(*this == other);
+		}
+
+	private:
+		friend class flat_hash_map;
+
+		template <typename OtherPointer, typename OtherReference>
+		friend class iterator_impl;
+
+		iterator_impl(const control_t *control, Slot *slot)
+		: _control(control)
+		, _slot(slot) {
+		}
+
+		// The sentinel after the last slot stops the loop.
+		iterator_impl &skipFree() {
+			while (*_control == kEmpty || *_control == kDeleted) {
+				++_control;
+				++_slot;
+			}
+			return *this;
+		}
+
+		const control_t *_control = nullptr;
+		Slot *_slot = nullptr;
+
+	};
+
+	struct HashParts {
+		size_type index = 0;
+		control_t control = 0;
+	};
+
+	static control_t *EmptyControl() {
+		static control_t result[] = { kSentinel };
+		return result;
+	}
+	static size_type CapacityFor(size_type count) {
+		auto result = kMinimalCapacity;
+		while (result - result / 8 < count) {
+			result *= 2;
+		}
+		return result;
+	}
+	static size_type GrowthFor(size_type capacity) {
+		return capacity - capacity / 8;
+	}
+	HashParts split(const Key &key) const {
+		// Hash functions for integers are usually identity, mix the bits.
+		auto mixed = std::uint64_t(Hash()(key)) * 0x9E3779B97F4A7C15ULL;
+		mixed ^= (mixed >> 32);
+		return {
+			size_type(mixed >> 7) & (_capacity - 1),
+			control_t(mixed & 0x7F)
+		};
+	}
+
+	iterator at(std::ptrdiff_t index) {
+		return iterator(_control + index, _slots + index);
+	}
+	const_iterator at(std::ptrdiff_t index) const {
+		return const_iterator(_control + index, _slots + index);
+	}
+
+	std::ptrdiff_t lookup(const Key &key) const {
+		if (!_size) {
+			return -1;
+		}
+		const auto mask = _capacity - 1;
+		const auto [start, control] = split(key);
+		for (auto index = start; true; index = (index + 1) & mask) {
+			const auto current = _control[index];
+			if (current == control
+				&& Equal()(_slots[index].value.first, key)) {
+				return std::ptrdiff_t(index);
+			} else if (current == kEmpty) {
+				return -1;
+			}
+		}
+	}
+
+	// Returns the slot of the key and if it was already there.
+	std::pair<std::ptrdiff_t, bool> prepareInsert(const Key &key) {
+		const auto existing = lookup(key);
+		if (existing >= 0) {
+			return { existing, true };
+		}
+		auto index = _capacity ? findFree(key) : 0;
+		if (!_capacity || (!_growthLeft && _control[index] != kDeleted)) {
+			// Drop the deleted slots, grow only if they are not many.
+			rehash((_size * 2 >= GrowthFor(_capacity))
+				? CapacityFor(_size + 1)
+				: std::max(_capacity, kMinimalCapacity));
+			index = findFree(key);
+		}
+		if (_control[index] == kEmpty) {
+			--_growthLeft;
+		}
+		_control[index] = split(key).control;
+		++_size;
+		return { std::ptrdiff_t(index), false };
+	}
+	size_type findFree(const Key &key) const {
+		const auto mask = _capacity - 1;
+		auto index = split(key).index;
+		while (_control[index] != kEmpty && _control[index] != kDeleted) {
+			index = (index + 1) & mask;
+		}
+		return index;
+	}
+
+	void eraseAt(std::ptrdiff_t index) {
+		_slots[index].value.~value_type();
+		--_size;
+
+		// No probe sequence goes on past an empty slot.
+		const auto next = (size_type(index) + 1) & (_capacity - 1);
+		if (_control[next] == kEmpty) {
+			_control[index] = kEmpty;
+			++_growthLeft;
+		} else {
+			_control[index] = kDeleted;
+		}
+	}
+
+	void rehash(size_type capacity) {
+		auto control = std::make_unique<control_t[]>(capacity + 1);
+		auto slots = std::make_unique<Slot[]>(capacity);
+		std::memset(control.get(), kEmpty, capacity);
+		control[capacity] = kSentinel;
+
+		auto old = flat_hash_map();
+		swap(old);
+		_control = control.release();
+		_slots = slots.release();
+		_capacity = capacity;
+		_growthLeft = GrowthFor(capacity);
+		for (auto &value : old) {
+			const auto index = findFree(value.first);
+			new (&_slots[index].value) value_type(std::move(value));
+			_control[index] = split(value.first).control;
+			++_size;
+			--_growthLeft;
+		}
+	}
+
+	void destroy() {
+		if (!_capacity) {
+			return;
+		}
+		for (auto &value : *this) {
+			value.~value_type();
+		}
+		delete[] _control;
+		delete[] _slots;
+	}
+
+	control_t *_control = EmptyControl();
+	Slot *_slots = nullptr;
+	size_type _capacity = 0;
+	size_type _size = 0;
+	size_type _growthLeft = 0;
+
+};
+
+} // namespace base
@@ -0,0 +1,109 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "base/benchmark.h"
+
+#include "base/flat_hash_map.h"
+#include "base/slab_allocator.h"
+#include <random>
+#include <unordered_map>
+
+namespace {
+
+constexpr int kSizes[] = { 256, 4096, 32768, 262144 };
+
+// Roughly the size of a DocumentData.
+struct Entity {
+	std::uint64_t id = 0;
+	char data[248] = { 0 };
+};
+struct SlabEntity : Entity, base::slab_allocated {
+};
+
+std::vector<std::uint64_t> RandomIds(int count) {
+	auto generator = std::mt19937_64(count);
+	auto result = std::vector<std::uint64_t>(count);
+	for (auto &id : result) {
+		id = generator();
+	}
+	return result;
+}
+
+template <typename Map>
+void MeasureMap(
+		base::benchmark::Runner &runner,
+		const std::string &name,
+		int size) {
+	const auto count = std::to_string(size);
+	const auto ids = RandomIds(size);
+
+	runner.measure(name + " insert " + count, size, [&] {
+		auto map = Map();
+		for (const auto id : ids) {
+			map.emplace(id, std::make_unique<SlabEntity>());
+		}
+		base::benchmark::DoNotOptimize(map);
+	});
+
+	auto map = Map();
+	for (const auto id : ids) {
+		map.emplace(id, std::make_unique<SlabEntity>());
+	}
+	runner.measure(name + " find " + count, size, [&] {
+		auto found = std::uint64_t(0);
+		for (const auto id : ids) {
+			found += map.find(id)->second->id;
+		}
+		base::benchmark::DoNotOptimize(found);
+	});
+	runner.measure(name + " find missing " + count, size, [&] {
+		auto found = 0;
+		for (const auto id : ids) {
+			found += (map.find(id ^ 1) != map.end()) ? 1 : 0;
+		}
+		base::benchmark::DoNotOptimize(found);
+	});
+}
+
+template <typename Type>
+void MeasureAllocation(
+		base::benchmark::Runner &runner,
+		const std::string &name,
+		int size) {
+	auto objects = std::vector<std::unique_ptr<Type>>(size);
+	runner.measure(name + " " + std::to_string(size), size, [&] {
+		for (auto &object : objects) {
+			object = std::make_unique<Type>();
+		}
+		for (auto &object : objects) {
+			object = nullptr;
+		}
+	});
+}
+
+} // namespace
+
+BENCHMARK_CASE("flat_hash_map") {
+	for (const auto size : kSizes) {
+		using Value = std::unique_ptr<SlabEntity>;
+		MeasureMap<std::unordered_map<std::uint64_t, Value>>(
+			runner,
+			"std::unordered_map",
+			size);
+		MeasureMap<base::flat_hash_map<std::uint64_t, Value>>(
+			runner,
+			"base::flat_hash_map",
+			size);
+	}
+}
+
+BENCHMARK_CASE("slab_allocated") {
+	for (const auto size : kSizes) {
+		MeasureAllocation<Entity>(runner, "new and delete", size);
+		MeasureAllocation<SlabEntity>(runner, "slab new and delete", size);
+	}
+}
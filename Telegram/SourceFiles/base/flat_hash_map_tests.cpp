@@ -0,0 +1,112 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "base/flat_hash_map.h"
+#include <map>
+#include <random>
+#include <string>
+
+using namespace std;
+
+TEST_CASE("flat_hash_maps find inserted items", "[flat_hash_map]") {
+	base::flat_hash_map<int, string> v;
+	REQUIRE(v.empty());
+	REQUIRE(v.find(0) == v.end());
+	REQUIRE(v.begin() == v.end());
+
+	REQUIRE(v.emplace(0, "a").second);
+	REQUIRE(v.emplace(5, "b").second);
+	REQUIRE(v.emplace(4, "d").second);
+	REQUIRE(!v.emplace(5, "c").second);
+	REQUIRE(v.size() == 3);
+	REQUIRE(v.find(5)->second == "b");
+	REQUIRE(v.contains(4));
+	REQUIRE(!v.contains(3));
+	REQUIRE(v.count(0) == 1);
+
+	SECTION("operator[] inserts default values") {
+		REQUIRE(v[7].empty());
+		v[7] = "e";
+		REQUIRE(v.size() == 4);
+		REQUIRE(v.find(7)->second == "e");
+	}
+
+	SECTION("erase by key and by iterator") {
+		REQUIRE(v.erase(5) == 1);
+		REQUIRE(v.erase(5) == 0);
+		REQUIRE(v.find(5) == v.end());
+		v.erase(v.find(0));
+		REQUIRE(v.size() == 1);
+		REQUIRE(v.begin()->first == 4);
+	}
+
+	SECTION("copy and move") {
+		auto copy = v;
+		REQUIRE(copy.size() == 3);
+		REQUIRE(copy.find(4)->second == "d");
+		auto moved = std::move(copy);
+		REQUIRE(moved.size() == 3);
+		REQUIRE(copy.empty());
+		REQUIRE(copy.find(4) == copy.end());
+		copy = moved;
+		REQUIRE(copy.size() == 3);
+	}
+}
+
+TEST_CASE("flat_hash_maps work as std::map", "[flat_hash_map]") {
+	auto engine = std::mt19937(42);
+	auto keys = std::uniform_int_distribution<std::uint64_t>(0, 2000);
+	auto actions = std::uniform_int_distribution<int>(0, 3);
+
+	base::flat_hash_map<std::uint64_t, std::unique_ptr<int>> v;
+	std::map<std::uint64_t, int> expected;
+	for (auto i = 0; i != 20000; ++i) {
+		const auto key = keys(engine);
+		if (actions(engine)) {
+			const auto [j, inserted] = v.emplace(
+				key,
+				std::make_unique<int>(i));
+			REQUIRE(inserted == expected.emplace(key, i).second);
+			REQUIRE(*j->second == expected[key]);
+		} else {
+			REQUIRE(v.erase(key) == expected.erase(key));
+		}
+	}
+	REQUIRE(v.size() == expected.size());
+	auto count = size_t(0);
+	for (const auto &[key, value] : v) {
+		REQUIRE(expected[key] == *value);
+		++count;
+	}
+	REQUIRE(count == expected.size());
+
+	SECTION("erasing while iterating visits all the items") {
+		auto visited = size_t(0);
+		for (auto i = v.begin(); i != v.end();) {
+			++visited;
+			if (i->first % 2) {
+				i = v.erase(i);
+			} else {
+				++i;
+			}
+		}
+		REQUIRE(visited == expected.size());
+		for (const auto &[key, value] : expected) {
+			REQUIRE(v.contains(key) == !(key % 2));
+		}
+	}
+
+	SECTION("clear removes everything") {
+		v.clear();
+		REQUIRE(v.empty());
+		REQUIRE(v.begin() == v.end());
+		v.emplace(1, std::make_unique<int>(1));
+		REQUIRE(v.size() == 1);
+	}
+}
@@ -322,7 +322,7 @@ public:
 		typename = typename std::iterator_traits<Iterator>::iterator_category>
 	flat_multi_map(Iterator first, Iterator last)
 	: _data(first, last) {
-		std::sort(std::begin(impl()), std::end(impl()), compare());
+		sortFrom(std::begin(impl()));
 	}
 
 	flat_multi_map(std::initializer_list<pair_type> iter)
@@ -474,9 +474,44 @@ public:
 		return compare()(key, where->first) ? impl().end() : where;
 	}
 
+	template <
+		typename OtherKey,
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
+	iterator findFirst(const OtherKey &key) {
+		if (empty()
+			|| compare()(key, front().first)
+			|| compare()(back().first, key)) {
+			return end();
+		}
+		auto where = getLowerBound(key);
+		return compare()(key, where->first) ? impl().end() : where;
+	}
+
+	template <
+		typename OtherKey,
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
+	const_iterator findFirst(const OtherKey &key) const {
+		if (empty()
+			|| compare()(key, front().first)
+			|| compare()(back().first, key)) {
+			return end();
+		}
+		auto where = getLowerBound(key);
+		return compare()(key, where->first) ? impl().end() : where;
+	}
+
 	bool contains(const Key &key) const {
 		return findFirst(key) != end();
 	}
+	template <
+		typename OtherKey,
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
+	bool contains(const OtherKey &key) const {
+		return findFirst(key) != end();
+	}
 	int count(const Key &key) const {
 		if (empty()
 			|| compare()(key, front().first)
@@ -487,6 +522,33 @@ public:
 		return (range.second - range.first);
 	}
 
+	// Sorts only the added elements and merges them in, so that adding
+	// many elements at once costs O(n + m log m) instead of O(n * m).
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category>
+	void merge(Iterator first, Iterator last) {
+		const auto was = size();
+		for (; first != last; ++first) {
+			impl().push_back(*first);
+		}
+		const auto middle = std::begin(impl()) + was;
+		sortFrom(middle);
+		std::inplace_merge(
+			std::begin(impl()),
+			middle,
+			std::end(impl()),
+			compare());
+	}
+
+	void merge(const flat_multi_map<Key, Type, Compare> &other) {
+		merge(other.begin(), other.end());
+	}
+
+	void merge(std::initializer_list<pair_type> list) {
+		merge(list.begin(), list.end());
+	}
+
 private:
 	friend class flat_map<Key, Type, Compare>;
 
@@ -572,6 +634,29 @@ private:
 			key,
 			compare());
 	}
+	template <
+		typename OtherKey,
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
+	typename impl_t::iterator getLowerBound(const OtherKey &key) {
+		return std::lower_bound(
+			std::begin(impl()),
+			std::end(impl()),
+			key,
+			compare());
+	}
+	template <
+		typename OtherKey,
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
+	typename impl_t::const_iterator getLowerBound(
+			const OtherKey &key) const {
+		return std::lower_bound(
+			std::begin(impl()),
+			std::end(impl()),
+			key,
+			compare());
+	}
 	typename impl_t::iterator getUpperBound(const Key &key) {
 		return std::upper_bound(
 			std::begin(impl()),
@@ -607,6 +692,13 @@ private:
 			compare());
 	}
 
+	// Elements with equal keys keep their order, as with insert().
+	void sortFrom(typename impl_t::iterator from) {
+		if (!std::is_sorted(from, std::end(impl()), compare())) {
+			std::stable_sort(from, std::end(impl()), compare());
+		}
+	}
+
 };
 
 template <typename Key, typename Type, typename Compare>
@@ -733,6 +825,20 @@ public:
 	const_iterator find(const Key &key) const {
 		return this->findFirst(key);
 	}
+	template <
+		typename OtherKey,
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
+	iterator find(const OtherKey &key) {
+		return this->findFirst(key);
+	}
+	template <
+		typename OtherKey,
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
+	const_iterator find(const OtherKey &key) const {
+		return this->findFirst(key);
+	}
 
 	Type &operator[](const Key &key) {
 		if (this->empty() || this->compare()(key, this->front().first)) {
@@ -759,6 +865,23 @@ public:
 		return std::move(result);
 	}
 
+	// Keys that are already in the map keep their values.
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category>
+	void merge(Iterator first, Iterator last) {
+		parent::merge(first, last);
+		finalize();
+	}
+
+	void merge(const flat_map<Key, Type, Compare> &other) {
+		merge(other.begin(), other.end());
+	}
+
+	void merge(std::initializer_list<pair_type> list) {
+		merge(list.begin(), list.end());
+	}
+
 private:
 	void finalize() {
 		this->impl().erase(
@@ -0,0 +1,85 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "base/benchmark.h"
+
+#include "base/flat_map.h"
+#include <random>
+
+namespace {
+
+constexpr int kSizes[] = { 16, 256, 4096, 32768 };
+
+std::vector<int> RandomKeys(int count) {
+	auto generator = std::mt19937(count);
+	auto result = std::vector<int>(count);
+	for (auto &key : result) {
+		key = int(generator());
+	}
+	return result;
+}
+
+} // namespace
+
+BENCHMARK_CASE("flat_map") {
+	for (const auto size : kSizes) {
+		const auto count = std::to_string(size);
+		const auto keys = RandomKeys(size);
+
+		runner.measure("insert sorted " + count, size, [&] {
+			auto map = base::flat_map<int, int>();
+			for (auto i = 0; i != size; ++i) {
+				map.emplace(i, i);
+			}
+			base::benchmark::DoNotOptimize(map);
+		});
+		runner.measure("insert random " + count, size, [&] {
+			auto map = base::flat_map<int, int>();
+			for (const auto key : keys) {
+				map.emplace(key, key);
+			}
+			base::benchmark::DoNotOptimize(map);
+		});
+
+		using pair = base::flat_map<int, int>::value_type;
+		auto pairs = std::vector<pair>();
+		pairs.reserve(size);
+		for (const auto key : keys) {
+			pairs.emplace_back(key, key);
+		}
+		runner.measure("construct random " + count, size, [&] {
+			auto map = base::flat_map<int, int>(pairs.begin(), pairs.end());
+			base::benchmark::DoNotOptimize(map);
+		});
+		const auto half = pairs.begin() + (size / 2);
+		const auto first = base::flat_map<int, int>(pairs.begin(), half);
+		runner.measure("merge random half " + count, size / 2, [&] {
+			auto map = first;
+			map.merge(half, pairs.end());
+			base::benchmark::DoNotOptimize(map);
+		});
+
+		auto map = base::flat_map<int, int>();
+		for (const auto key : keys) {
+			map.emplace(key, key);
+		}
+		runner.measure("find " + count, size, [&] {
+			auto found = 0;
+			for (const auto key : keys) {
+				found += (map.find(key) != map.end()) ? 1 : 0;
+			}
+			base::benchmark::DoNotOptimize(found);
+		});
+		runner.measure("find missing " + count, size, [&] {
+			auto found = 0;
+			for (const auto key : keys) {
+				found += map.contains(key ^ 1) ? 1 : 0;
+			}
+			base::benchmark::DoNotOptimize(found);
+		});
+	}
+}
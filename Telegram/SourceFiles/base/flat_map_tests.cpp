@@ -119,3 +119,97 @@ TEST_CASE("flat_maps structured bindings", "[flat_map]") {
 		}
 	}
 }
+
+TEST_CASE("flat_maps bulk operations", "[flat_map]") {
+	using pair = base::flat_map<int, string>::value_type;
+
+	SECTION("range constructor keeps the first of equal keys") {
+		const auto values = std::vector<pair>{
+			{ 5, "a" },
+			{ 1, "b" },
+			{ 5, "c" },
+			{ 3, "d" },
+			{ 1, "e" },
+		};
+		base::flat_map<int, string> v(values.begin(), values.end());
+		REQUIRE(v.size() == 3);
+		REQUIRE(v.begin()->first == 1);
+		REQUIRE(v.find(1)->second == "b");
+		REQUIRE(v.find(5)->second == "a");
+		REQUIRE((v.end() - 1)->first == 5);
+	}
+
+	SECTION("merge keeps the values of existing keys") {
+		base::flat_map<int, string> v;
+		v.emplace(2, "a");
+		v.emplace(4, "b");
+		v.emplace(6, "c");
+		v.merge({ { 7, "d" }, { 4, "e" }, { 1, "f" }, { 3, "g" }, { 1, "h" } });
+		REQUIRE(v.size() == 6);
+		auto expected = 0;
+		for (const auto &[key, value] : v) {
+			REQUIRE(key > expected);
+			expected = key;
+		}
+		REQUIRE(v.find(4)->second == "b");
+		REQUIRE(v.find(1)->second == "f");
+		REQUIRE(v.find(7)->second == "d");
+
+		base::flat_map<int, string> u;
+		u.merge(v);
+		REQUIRE(u.size() == v.size());
+		u.merge(v.begin(), v.end());
+		REQUIRE(u.size() == v.size());
+	}
+
+	SECTION("multi map merge keeps the order of equal keys") {
+		base::flat_multi_map<int, string> v;
+		v.insert({ 1, "a" });
+		v.insert({ 2, "b" });
+		v.merge({ { 2, "c" }, { 1, "d" }, { 2, "e" } });
+		REQUIRE(v.size() == 5);
+		REQUIRE(v.count(2) == 3);
+		auto i = v.findFirst(2);
+		REQUIRE((i++)->second == "b");
+		REQUIRE((i++)->second == "c");
+		REQUIRE((i++)->second == "e");
+		REQUIRE(v.findFirst(1)->second == "a");
+	}
+}
+
+namespace {
+
+int KeyConversions = 0;
+
+struct counted_key {
+	counted_key(int value) : value(value) {
+		++KeyConversions;
+	}
+	int value;
+};
+inline bool operator<(const counted_key &a, const counted_key &b) {
+	return a.value < b.value;
+}
+inline bool operator<(const counted_key &a, int b) {
+	return a.value < b;
+}
+inline bool operator<(int a, const counted_key &b) {
+	return a < b.value;
+}
+
+} // namespace
+
+TEST_CASE("flat_maps heterogeneous lookup", "[flat_map]") {
+	base::flat_map<counted_key, string> v;
+	v.emplace(1, "a");
+	v.emplace(3, "b");
+	v.emplace(5, "c");
+
+	KeyConversions = 0;
+	REQUIRE(v.find(3) != v.end());
+	REQUIRE(v.find(3)->second == "b");
+	REQUIRE(v.find(4) == v.end());
+	REQUIRE(v.contains(5));
+	REQUIRE(!v.contains(6));
+	REQUIRE(KeyConversions == 0);
+}
@@ -186,7 +186,7 @@ public:
 		typename = typename std::iterator_traits<Iterator>::iterator_category>
 	flat_multi_set(Iterator first, Iterator last)
 	: _data(first, last) {
-		std::sort(std::begin(impl()), std::end(impl()), compare());
+		sortFrom(std::begin(impl()));
 	}
 
 	flat_multi_set(std::initializer_list<Type> iter)
@@ -334,7 +334,8 @@ public:
 
 	template <
 		typename OtherType,
-		typename = typename Compare::is_transparent>
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
 		iterator findFirst(const OtherType &value) {
 		if (empty()
 			|| compare()(value, front())
@@ -347,7 +348,8 @@ public:
 
 	template <
 		typename OtherType,
-		typename = typename Compare::is_transparent>
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
 		const_iterator findFirst(const OtherType &value) const {
 		if (empty()
 			|| compare()(value, front())
@@ -361,6 +363,13 @@ public:
 	bool contains(const Type &value) const {
 		return findFirst(value) != end();
 	}
+	template <
+		typename OtherType,
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
+	bool contains(const OtherType &value) const {
+		return findFirst(value) != end();
+	}
 	int count(const Type &value) const {
 		if (empty()
 			|| compare()(value, front())
@@ -396,8 +405,7 @@ public:
 		typename Iterator,
 		typename = typename std::iterator_traits<Iterator>::iterator_category>
 	void merge(Iterator first, Iterator last) {
-		impl().insert(impl().end(), first, last);
-		std::sort(std::begin(impl()), std::end(impl()), compare());
+		mergeRange(first, last);
 	}
 
 	void merge(const flat_multi_set<Type, Compare> &other) {
@@ -501,7 +509,8 @@ private:
 	}
 	template <
 		typename OtherType,
-		typename = typename Compare::is_transparent>
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
 	typename impl_t::iterator getLowerBound(const OtherType &value) {
 		return std::lower_bound(
 			std::begin(impl()),
@@ -511,7 +520,8 @@ private:
 	}
 	template <
 		typename OtherType,
-		typename = typename Compare::is_transparent>
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
 	typename impl_t::const_iterator getLowerBound(const OtherType &value) const {
 		return std::lower_bound(
 			std::begin(impl()),
@@ -554,6 +564,45 @@ private:
 			compare());
 	}
 
+	// Equal elements keep their order, as with insert().
+	// Returns the indices range where equal elements may be found now.
+	template <typename Iterator>
+	std::pair<size_type, size_type> mergeRange(
+			Iterator first,
+			Iterator last) {
+		const auto was = size();
+		impl().insert(std::end(impl()), first, last);
+		const auto added = size() - was;
+		const auto middle = std::begin(impl()) + was;
+		sortFrom(middle);
+		if (!was || !added) {
+			return { 0, size() };
+		} else if (!compare()(*middle, *(middle - 1))) {
+			// The new elements follow the old ones, like newer ids.
+			return { was - 1, size() };
+		} else if (compare()(impl().back(), impl().front())) {
+			// The new elements precede the old ones, like older ids.
+			for (auto i = size_type(0); i != added; ++i) {
+				auto value = std::move(impl().back());
+				impl().pop_back();
+				impl().push_front(std::move(value));
+			}
+			return { 0, added };
+		}
+		std::inplace_merge(
+			std::begin(impl()),
+			middle,
+			std::end(impl()),
+			compare());
+		return { 0, size() };
+	}
+
+	void sortFrom(typename impl_t::iterator from) {
+		if (!std::is_sorted(from, std::end(impl()), compare())) {
+			std::stable_sort(from, std::end(impl()), compare());
+		}
+	}
+
 };
 
 template <typename Type, typename Compare>
@@ -647,13 +696,15 @@ public:
 	}
 	template <
 		typename OtherType,
-		typename = typename Compare::is_transparent>
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
 	iterator find(const OtherType &value) {
 		return this->findFirst(value);
 	}
 	template <
 		typename OtherType,
-		typename = typename Compare::is_transparent>
+		typename OtherCompare = Compare,
+		typename = typename OtherCompare::is_transparent>
 	const_iterator find(const OtherType &value) const {
 		return this->findFirst(value);
 	}
@@ -688,8 +739,8 @@ public:
 		typename Iterator,
 		typename = typename std::iterator_traits<Iterator>::iterator_category>
 	void merge(Iterator first, Iterator last) {
-		parent::merge(first, last);
-		finalize();
+		const auto [from, till] = parent::mergeRange(first, last);
+		finalize(from, till);
 	}
 
 	void merge(const flat_multi_set<Type, Compare> &other) {
@@ -702,15 +753,20 @@ public:
 
 private:
 	void finalize() {
+		finalize(0, this->size());
+	}
+	void finalize(size_type from, size_type till) {
+		const auto first = std::begin(this->impl()) + from;
+		const auto last = std::begin(this->impl()) + till;
 		this->impl().erase(
 			std::unique(
-				std::begin(this->impl()),
-				std::end(this->impl()),
+				first,
+				last,
 				[&](auto &&a, auto &&b) {
 					return !this->compare()(a, b);
 				}
 			),
-			std::end(this->impl()));
+			last);
 	}
 
 };
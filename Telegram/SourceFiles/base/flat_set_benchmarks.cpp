@@ -0,0 +1,96 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "base/benchmark.h"
+
+#include "base/flat_set.h"
+#include <random>
+
+namespace {
+
+constexpr int kSizes[] = { 16, 256, 4096, 32768 };
+
+std::vector<int> RandomKeys(int count) {
+	auto generator = std::mt19937(count);
+	auto result = std::vector<int>(count);
+	for (auto &key : result) {
+		key = int(generator());
+	}
+	return result;
+}
+
+} // namespace
+
+BENCHMARK_CASE("flat_set") {
+	for (const auto size : kSizes) {
+		const auto count = std::to_string(size);
+		const auto keys = RandomKeys(size);
+
+		runner.measure("insert sorted " + count, size, [&] {
+			auto set = base::flat_set<int>();
+			for (auto i = 0; i != size; ++i) {
+				set.insert(i);
+			}
+			base::benchmark::DoNotOptimize(set);
+		});
+		runner.measure("insert random " + count, size, [&] {
+			auto set = base::flat_set<int>();
+			for (const auto key : keys) {
+				set.insert(key);
+			}
+			base::benchmark::DoNotOptimize(set);
+		});
+		runner.measure("construct random " + count, size, [&] {
+			auto set = base::flat_set<int>(keys.begin(), keys.end());
+			base::benchmark::DoNotOptimize(set);
+		});
+		const auto half = keys.begin() + (size / 2);
+		const auto first = base::flat_set<int>(keys.begin(), half);
+		runner.measure("merge random half " + count, size / 2, [&] {
+			auto set = first;
+			set.merge(half, keys.end());
+			base::benchmark::DoNotOptimize(set);
+		});
+		runner.measure("merge older pages " + count, size, [&] {
+			auto set = base::flat_set<int>();
+			for (auto till = size; till > 0; till -= 100) {
+				auto page = std::vector<int>();
+				for (auto i = std::max(till - 100, 0); i != till; ++i) {
+					page.push_back(i);
+				}
+				set.merge(page.begin(), page.end());
+			}
+			base::benchmark::DoNotOptimize(set);
+		});
+		runner.measure("merge newer ids " + count, size, [&] {
+			auto set = base::flat_set<int>();
+			for (auto i = 0; i != size; ++i) {
+				set.merge({ i });
+			}
+			base::benchmark::DoNotOptimize(set);
+		});
+
+		auto set = base::flat_set<int>();
+		for (const auto key : keys) {
+			set.insert(key);
+		}
+		runner.measure("contains " + count, size, [&] {
+			auto found = 0;
+			for (const auto key : keys) {
+				found += set.contains(key) ? 1 : 0;
+			}
+			base::benchmark::DoNotOptimize(found);
+		});
+		runner.measure("contains missing " + count, size, [&] {
+			auto found = 0;
+			for (const auto key : keys) {
+				found += set.contains(key ^ 1) ? 1 : 0;
+			}
+			base::benchmark::DoNotOptimize(found);
+		});
+	}
+}
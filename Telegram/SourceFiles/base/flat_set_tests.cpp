@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "catch.hpp"
 
 #include "base/flat_set.h"
+#include <vector>
 
 struct int_wrap {
 	int value;
@@ -82,3 +83,34 @@ TEST_CASE("flat_sets with custom comparators", "[flat_set]") {
 		checkSorted();
 	}
 }
+
+TEST_CASE("flat_sets merge", "[flat_set]") {
+	base::flat_set<int> v = { 2, 4, 6 };
+	v.merge({ 7, 4, 1, 3, 1 });
+	REQUIRE(v.size() == 6);
+	auto expected = std::vector<int>{ 1, 2, 3, 4, 6, 7 };
+	REQUIRE(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+
+	base::flat_set<int> u = { 0, 10 };
+	u.merge(v.begin(), v.end());
+	REQUIRE(u.size() == 8);
+	REQUIRE(u.front() == 0);
+	REQUIRE(u.back() == 10);
+	REQUIRE(u.contains(7));
+
+	SECTION("merging after the last element") {
+		v.merge({ 9, 7, 8, 8 });
+		expected = std::vector<int>{ 1, 2, 3, 4, 6, 7, 8, 9 };
+		REQUIRE(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+	}
+
+	SECTION("merging before the first element") {
+		v.merge({ -1, -3, -1 });
+		expected = std::vector<int>{ -3, -1, 1, 2, 3, 4, 6, 7 };
+		REQUIRE(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+
+		v.merge({ -5, -3 });
+		REQUIRE(v.size() == 9);
+		REQUIRE(v.front() == -5);
+	}
+}
@@ -0,0 +1,167 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "base/perf_counters.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace base {
+namespace perf {
+namespace {
+
+struct Registry {
+	std::mutex mutex;
+	std::vector<Counter*> counters;
+	std::vector<Histogram*> histograms;
+};
+
+// Counters are created during the static initialization,
+// so the registry is created on the first use.
+Registry &GetRegistry() {
+	static Registry result;
+	return result;
+}
+
+template <typename Type>
+void Register(std::vector<Type*> &list, Type *value) {
+	std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+	list.push_back(value);
+}
+
+template <typename Type>
+void Unregister(std::vector<Type*> &list, Type *value) {
+	std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+	list.erase(std::remove(begin(list), end(list), value), end(list));
+}
+
+int BucketIndex(std::int64_t value) {
+	auto result = 0;
+	while (value > 0 && result + 1 < Histogram::kBucketsCount) {
+		value >>= 1;
+		++result;
+	}
+	return result;
+}
+
+// Bucket 0 holds values up to 0, bucket i holds [2^(i-1), 2^i - 1].
+std::int64_t BucketUpperBound(int index) {
+	return (std::int64_t(1) << index) - 1;
+}
+
+} // namespace
+
+Counter::Counter(const char *name) : _name(name) {
+	Register(GetRegistry().counters, this);
+}
+
+Counter::~Counter() {
+	Unregister(GetRegistry().counters, this);
+}
+
+Histogram::Histogram(const char *name) : _name(name) {
+	Register(GetRegistry().histograms, this);
+}
+
+Histogram::~Histogram() {
+	Unregister(GetRegistry().histograms, this);
+}
+
+void Histogram::add(std::int64_t value) {
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_sum.fetch_add(value, std::memory_order_relaxed);
+	_buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+
+	auto max = _max.load(std::memory_order_relaxed);
+	while (value > max
+		&& !_max.compare_exchange_weak(
+			max,
+			value,
+			std::memory_order_relaxed)) {
+	}
+}
+
+Histogram::Summary Histogram::summary() const {
+	auto buckets = std::array<std::int64_t, kBucketsCount>();
+	auto count = std::int64_t(0);
+	for (auto i = 0; i != kBucketsCount; ++i) {
+		buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+		count += buckets[i];
+	}
+
+	auto result = Summary();
+	result.count = count;
+	result.sum = _sum.load(std::memory_order_relaxed);
+	result.max = _max.load(std::memory_order_relaxed);
+	if (!count) {
+		return result;
+	}
+	const auto percentile = [&](int percent) {
+		const auto wanted = (count * percent + 99) / 100;
+		auto accumulated = std::int64_t(0);
+		for (auto i = 0; i != kBucketsCount; ++i) {
+			accumulated += buckets[i];
+			if (accumulated >= wanted) {
+				return std::min(BucketUpperBound(i), result.max);
+			}
+		}
+		return result.max;
+	};
+	result.p50 = percentile(50);
+	result.p90 = percentile(90);
+	result.p99 = percentile(99);
+	return result;
+}
+
+Snapshot TakeSnapshot() {
+	auto result = Snapshot();
+	{
+		auto &registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		result.counters.reserve(registry.counters.size());
+		for (const auto counter : registry.counters) {
+			result.counters.push_back({ counter->name(), counter->value() });
+		}
+		result.histograms.reserve(registry.histograms.size());
+		for (const auto histogram : registry.histograms) {
+			result.histograms.push_back({
+				histogram->name(),
+				histogram->summary()
+			});
+		}
+	}
+	const auto byName = [](const auto &a, const auto &b) {
+		return a.name < b.name;
+	};
+	std::sort(begin(result.counters), end(result.counters), byName);
+	std::sort(begin(result.histograms), end(result.histograms), byName);
+	return result;
+}
+
+std::string FormatSnapshot(const Snapshot &snapshot) {
+	auto result = std::string();
+	for (const auto &counter : snapshot.counters) {
+		result += counter.name + ": " + std::to_string(counter.value) + '\n';
+	}
+	for (const auto &histogram : snapshot.histograms) {
+		const auto &summary = histogram.summary;
+		result += histogram.name
+			+ ": count " + std::to_string(summary.count);
+		if (summary.count > 0) {
+			result += ", avg " + std::to_string(summary.sum / summary.count)
+				+ ", p50 " + std::to_string(summary.p50)
+				+ ", p90 " + std::to_string(summary.p90)
+				+ ", p99 " + std::to_string(summary.p99)
+				+ ", max " + std::to_string(summary.max);
+		}
+		result += '\n';
+	}
+	return result;
+}
+
+} // namespace perf
+} // namespace base
@@ -0,0 +1,104 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Runtime performance counters that any subsystem can report to.
+//
+// Counters and histograms are meant to be defined as namespace scope
+// objects, they register themselves by name and are cheap enough to be
+// updated from any thread on every event (a relaxed atomic add).
+namespace base {
+namespace perf {
+
+// Value that only grows, like bytes sent or cache misses.
+class Counter {
+public:
+	explicit Counter(const char *name);
+	Counter(const Counter &other) = delete;
+	Counter &operator=(const Counter &other) = delete;
+	~Counter();
+
+	void add(std::int64_t value = 1) {
+		_value.fetch_add(value, std::memory_order_relaxed);
+	}
+	std::int64_t value() const {
+		return _value.load(std::memory_order_relaxed);
+	}
+	const char *name() const {
+		return _name;
+	}
+
+private:
+	const char *_name = nullptr;
+	std::atomic<std::int64_t> _value = 0;
+
+};
+
+// Distribution of measured values, like response time or queue depth.
+// Values are counted in power of two buckets, so percentiles are known
+// up to a factor of two.
+class Histogram {
+public:
+	static constexpr auto kBucketsCount = 40;
+
+	struct Summary {
+		std::int64_t count = 0;
+		std::int64_t sum = 0;
+		std::int64_t max = 0;
+		std::int64_t p50 = 0;
+		std::int64_t p90 = 0;
+		std::int64_t p99 = 0;
+	};
+
+	explicit Histogram(const char *name);
+	Histogram(const Histogram &other) = delete;
+	Histogram &operator=(const Histogram &other) = delete;
+	~Histogram();
+
+	void add(std::int64_t value);
+	Summary summary() const;
+	const char *name() const {
+		return _name;
+	}
+
+private:
+	const char *_name = nullptr;
+	std::atomic<std::int64_t> _count = 0;
+	std::atomic<std::int64_t> _sum = 0;
+	std::atomic<std::int64_t> _max = 0;
+	std::array<std::atomic<std::int64_t>, kBucketsCount> _buckets = {};
+
+};
+
+struct Snapshot {
+	struct CounterValue {
+		std::string name;
+		std::int64_t value = 0;
+	};
+	struct HistogramValue {
+		std::string name;
+		Histogram::Summary summary;
+	};
+	std::vector<CounterValue> counters;
+	std::vector<HistogramValue> histograms;
+};
+
+// Both lists are sorted by name.
+Snapshot TakeSnapshot();
+
+// One "name: value" line per counter, for the logs and the debug box.
+std::string FormatSnapshot(const Snapshot &snapshot);
+
+} // namespace perf
+} // namespace base
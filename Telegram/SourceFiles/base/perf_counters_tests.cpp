@@ -0,0 +1,106 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "base/perf_counters.h"
+#include <thread>
+
+using namespace base::perf;
+
+namespace {
+
+const Snapshot::CounterValue *FindCounter(
+		const Snapshot &snapshot,
+		const std::string &name) {
+	for (const auto &counter : snapshot.counters) {
+		if (counter.name == name) {
+			return &counter;
+		}
+	}
+	return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("perf counters are registered by name", "[perf_counters]") {
+	auto second = Counter("test.b");
+	auto first = Counter("test.a");
+	first.add();
+	first.add(4);
+	second.add(2);
+
+	auto snapshot = TakeSnapshot();
+	REQUIRE(snapshot.counters.size() >= 2);
+	REQUIRE(FindCounter(snapshot, "test.a")->value == 5);
+	REQUIRE(FindCounter(snapshot, "test.b")->value == 2);
+	for (auto i = 1; i < int(snapshot.counters.size()); ++i) {
+		REQUIRE(snapshot.counters[i - 1].name < snapshot.counters[i].name);
+	}
+
+	SECTION("destroyed counters are unregistered") {
+		{
+			auto temporary = Counter("test.temporary");
+			REQUIRE(FindCounter(TakeSnapshot(), "test.temporary") != nullptr);
+		}
+		REQUIRE(FindCounter(TakeSnapshot(), "test.temporary") == nullptr);
+	}
+
+	SECTION("counters are formatted one per line") {
+		const auto text = FormatSnapshot(TakeSnapshot());
+		REQUIRE(text.find("test.a: 5\n") != std::string::npos);
+		REQUIRE(text.find("test.b: 2\n") != std::string::npos);
+	}
+}
+
+TEST_CASE("perf histograms compute percentiles", "[perf_counters]") {
+	auto histogram = Histogram("test.histogram");
+	REQUIRE(histogram.summary().count == 0);
+	REQUIRE(histogram.summary().p99 == 0);
+
+	for (auto i = 1; i <= 100; ++i) {
+		histogram.add(i);
+	}
+	const auto summary = histogram.summary();
+	REQUIRE(summary.count == 100);
+	REQUIRE(summary.sum == 5050);
+	REQUIRE(summary.max == 100);
+
+	// Percentiles are bucket upper bounds, exact up to a factor of two.
+	REQUIRE(summary.p50 >= 50);
+	REQUIRE(summary.p50 < 100);
+	REQUIRE(summary.p90 >= 90);
+	REQUIRE(summary.p99 == 100);
+
+	SECTION("values out of range go to the edge buckets") {
+		histogram.add(-5);
+		histogram.add(std::int64_t(1) << 62);
+		const auto summary = histogram.summary();
+		REQUIRE(summary.count == 102);
+		REQUIRE(summary.max == (std::int64_t(1) << 62));
+	}
+}
+
+TEST_CASE("perf counters are updated from many threads", "[perf_counters]") {
+	auto counter = Counter("test.threads");
+	auto histogram = Histogram("test.threads.histogram");
+	auto threads = std::vector<std::thread>();
+	for (auto i = 0; i != 4; ++i) {
+		threads.emplace_back([&, i] {
+			for (auto j = 0; j != 10000; ++j) {
+				counter.add();
+				histogram.add(i * 10000 + j);
+			}
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	REQUIRE(counter.value() == 40000);
+	REQUIRE(histogram.summary().count == 40000);
+	REQUIRE(histogram.summary().max == 39999);
+}
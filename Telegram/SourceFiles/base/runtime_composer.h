@@ -7,6 +7,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include "base/slab_allocator.h"
+
 template <typename Base>
 class RuntimeComposer;
 
@@ -145,7 +147,9 @@ public:
 		if (mask) {
 			auto meta = GetRuntimeComposerMetadata(mask);
 
-			auto data = operator new(meta->size);
+			// Components of many objects are destroyed together with them,
+			// keep them in slabs that can be released in a group.
+			auto data = base::details::ReleasingSlabAllocate(meta->size);
 			Assert(data != nullptr);
 
 			_data = data;
@@ -185,7 +189,7 @@ public:
 					RuntimeComponentWraps[i].Destruct(_dataptrunsafe(offset));
 				}
 			}
-			operator delete(_data);
+			base::details::ReleasingSlabFree(_data, meta->size);
 		}
 	}
 
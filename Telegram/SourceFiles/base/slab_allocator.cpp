@@ -0,0 +1,240 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "base/slab_allocator.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif // _MSC_VER
+
+namespace base {
+namespace details {
+namespace {
+
+constexpr auto kGranularity = std::size_t(16);
+constexpr auto kMaxSize = std::size_t(2048);
+constexpr auto kSlabSize = std::size_t(64 * 1024);
+constexpr auto kClassesCount = kMaxSize / kGranularity;
+
+struct FreeChunk {
+	FreeChunk *next = nullptr;
+};
+
+struct SizeClass {
+	FreeChunk *free = nullptr;
+	char *current = nullptr;
+	char *till = nullptr;
+};
+
+struct Slabs {
+	std::mutex mutex;
+	std::array<SizeClass, kClassesCount> classes;
+};
+
+Slabs &Instance() {
+	// Never destroyed, objects may be freed from static destructors.
+	static const auto result = new Slabs();
+	return *result;
+}
+
+std::size_t ClassIndex(std::size_t size) {
+	return (std::max(size, std::size_t(1)) - 1) / kGranularity;
+}
+
+// Releasing slabs are aligned by their size, so the slab of an object is
+// found by its address, and start with a header followed by the chunks.
+struct ReleasingSlab {
+	ReleasingSlab *prev = nullptr;
+	ReleasingSlab *next = nullptr;
+	FreeChunk *free = nullptr;
+	char *current = nullptr;
+	std::size_t used = 0;
+	std::size_t chunk = 0;
+};
+
+constexpr auto kReleasingHeaderSize = kGranularity
+	* ((sizeof(ReleasingSlab) + kGranularity - 1) / kGranularity);
+
+struct ReleasingSlabs {
+	std::mutex mutex;
+
+	// Slabs that have free chunks, the one in front is used first.
+	std::array<ReleasingSlab*, kClassesCount> available = { { nullptr } };
+};
+
+ReleasingSlabs &ReleasingInstance() {
+	static const auto result = new ReleasingSlabs();
+	return *result;
+}
+
+char *SlabEnd(ReleasingSlab *slab) {
+	return reinterpret_cast<char*>(slab) + kSlabSize;
+}
+
+bool SlabFull(ReleasingSlab *slab) {
+	return !slab->free
+		&& (std::size_t(SlabEnd(slab) - slab->current) < slab->chunk);
+}
+
+ReleasingSlab *SlabByPointer(void *pointer) {
+	const auto address = reinterpret_cast<std::uintptr_t>(pointer);
+	return reinterpret_cast<ReleasingSlab*>(
+		address & ~std::uintptr_t(kSlabSize - 1));
+}
+
+ReleasingSlab *CreateReleasingSlab(std::size_t chunk) {
+#ifdef _MSC_VER
+	const auto memory = _aligned_malloc(kSlabSize, kSlabSize);
+#else // _MSC_VER
+	auto memory = (void*)nullptr;
+	if (posix_memalign(&memory, kSlabSize, kSlabSize) != 0) {
+		memory = nullptr;
+	}
+#endif // _MSC_VER
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+	const auto result = new (memory) ReleasingSlab();
+	result->current = static_cast<char*>(memory) + kReleasingHeaderSize;
+	result->chunk = chunk;
+	return result;
+}
+
+void DestroyReleasingSlab(ReleasingSlab *slab) {
+	slab->~ReleasingSlab();
+#ifdef _MSC_VER
+	_aligned_free(slab);
+#else // _MSC_VER
+	std::free(slab);
+#endif // _MSC_VER
+}
+
+void LinkSlab(ReleasingSlab *&head, ReleasingSlab *slab) {
+	slab->prev = nullptr;
+	slab->next = head;
+	if (head) {
+		head->prev = slab;
+	}
+	head = slab;
+}
+
+void UnlinkSlab(ReleasingSlab *&head, ReleasingSlab *slab) {
+	if (slab->prev) {
+		slab->prev->next = slab->next;
+	} else {
+		head = slab->next;
+	}
+	if (slab->next) {
+		slab->next->prev = slab->prev;
+	}
+	slab->prev = slab->next = nullptr;
+}
+
+} // namespace
+
+void *SlabAllocate(std::size_t size) {
+	if (size > kMaxSize) {
+		return ::operator new(size);
+	}
+	const auto index = ClassIndex(size);
+	const auto chunk = (index + 1) * kGranularity;
+
+	auto &slabs = Instance();
+	std::lock_guard<std::mutex> lock(slabs.mutex);
+	auto &sizeClass = slabs.classes[index];
+	if (const auto result = sizeClass.free) {
+		sizeClass.free = result->next;
+		return result;
+	}
+	if (std::size_t(sizeClass.till - sizeClass.current) < chunk) {
+		sizeClass.current = static_cast<char*>(::operator new(kSlabSize));
+		sizeClass.till = sizeClass.current + kSlabSize;
+	}
+	const auto result = sizeClass.current;
+	sizeClass.current += chunk;
+	return result;
+}
+
+void SlabFree(void *pointer, std::size_t size) noexcept {
+	if (!pointer) {
+		return;
+	} else if (size > kMaxSize) {
+		::operator delete(pointer);
+		return;
+	}
+	auto &slabs = Instance();
+	std::lock_guard<std::mutex> lock(slabs.mutex);
+	auto &sizeClass = slabs.classes[ClassIndex(size)];
+	const auto chunk = new (pointer) FreeChunk();
+	chunk->next = sizeClass.free;
+	sizeClass.free = chunk;
+}
+
+void *ReleasingSlabAllocate(std::size_t size) {
+	if (size > kMaxSize) {
+		return ::operator new(size);
+	}
+	const auto index = ClassIndex(size);
+
+	auto &slabs = ReleasingInstance();
+	std::lock_guard<std::mutex> lock(slabs.mutex);
+	auto &head = slabs.available[index];
+	if (!head) {
+		LinkSlab(head, CreateReleasingSlab((index + 1) * kGranularity));
+	}
+	const auto slab = head;
+	auto result = (void*)nullptr;
+	if (const auto chunk = slab->free) {
+		slab->free = chunk->next;
+		result = chunk;
+	} else {
+		result = slab->current;
+		slab->current += slab->chunk;
+	}
+	++slab->used;
+	if (SlabFull(slab)) {
+		UnlinkSlab(head, slab);
+	}
+	return result;
+}
+
+void ReleasingSlabFree(void *pointer, std::size_t size) noexcept {
+	if (!pointer) {
+		return;
+	} else if (size > kMaxSize) {
+		::operator delete(pointer);
+		return;
+	}
+	auto &slabs = ReleasingInstance();
+	std::lock_guard<std::mutex> lock(slabs.mutex);
+	auto &head = slabs.available[ClassIndex(size)];
+	const auto slab = SlabByPointer(pointer);
+	const auto wasFull = SlabFull(slab);
+	const auto chunk = new (pointer) FreeChunk();
+	chunk->next = slab->free;
+	slab->free = chunk;
+	--slab->used;
+	if (wasFull) {
+		LinkSlab(head, slab);
+	}
+
+	// Keep the last slab of the size class to allocate from it later.
+	if (!slab->used && (head != slab || slab->next)) {
+		UnlinkSlab(head, slab);
+		DestroyReleasingSlab(slab);
+	}
+}
+
+} // namespace details
+} // namespace base
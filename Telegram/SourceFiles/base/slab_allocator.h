@@ -0,0 +1,52 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <cstddef>
+
+namespace base {
+namespace details {
+
+void *SlabAllocate(std::size_t size);
+void SlabFree(void *pointer, std::size_t size) noexcept;
+
+void *ReleasingSlabAllocate(std::size_t size);
+void ReleasingSlabFree(void *pointer, std::size_t size) noexcept;
+
+} // namespace details
+
+// Objects of classes deriving from it are allocated from 64 KB slabs,
+// each slab holding objects of the same size class next to each other.
+// Freed objects are reused for the same size class, the slabs are never
+// given back to the system, so use it only for long living objects.
+class slab_allocated {
+public:
+	static void *operator new(std::size_t size) {
+		return details::SlabAllocate(size);
+	}
+	static void operator delete(void *pointer, std::size_t size) noexcept {
+		details::SlabFree(pointer, size);
+	}
+
+};
+
+// Same as slab_allocated, but a slab is given back to the system as soon
+// as all of its objects are freed, so for objects that are created and
+// destroyed in big groups the memory is released with the last of them.
+class releasing_slab_allocated {
+public:
+	static void *operator new(std::size_t size) {
+		return details::ReleasingSlabAllocate(size);
+	}
+	static void operator delete(void *pointer, std::size_t size) noexcept {
+		details::ReleasingSlabFree(pointer, size);
+	}
+
+};
+
+} // namespace base
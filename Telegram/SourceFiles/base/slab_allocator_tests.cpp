@@ -0,0 +1,101 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "base/slab_allocator.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+template <std::size_t Size>
+struct Entity : base::releasing_slab_allocated {
+	explicit Entity(int value) : value(value) {
+		std::fill(std::begin(padding), std::end(padding), char(value));
+	}
+	virtual ~Entity() = default;
+
+	bool valid() const {
+		return std::all_of(
+			std::begin(padding),
+			std::end(padding),
+			[&](char ch) { return ch == char(value); });
+	}
+
+	int value = 0;
+	char padding[Size] = { 0 };
+
+};
+
+template <std::size_t Size>
+struct Derived : Entity<Size> {
+	using Entity<Size>::Entity;
+
+	char more[64] = { 0 };
+
+};
+
+} // namespace
+
+TEST_CASE("slab allocated objects do not overlap", "[slab_allocator]") {
+	using Small = Entity<24>;
+	using Large = Entity<4000>;
+
+	auto engine = std::mt19937(42);
+	auto objects = std::vector<std::unique_ptr<Small>>();
+	auto large = std::vector<std::unique_ptr<Large>>();
+	for (auto i = 0; i != 20000; ++i) {
+		if (!objects.empty() && (engine() % 3 == 0)) {
+			const auto index = engine() % objects.size();
+			REQUIRE(objects[index]->valid());
+			objects.erase(begin(objects) + index);
+		} else if (engine() % 2) {
+			objects.push_back(std::make_unique<Small>(i));
+		} else {
+			objects.push_back(std::make_unique<Derived<24>>(i));
+		}
+		if (i % 1000 == 0) {
+			large.push_back(std::make_unique<Large>(i));
+		}
+		REQUIRE(std::uintptr_t(objects.back().get()) % 16 == 0);
+	}
+	for (const auto &object : objects) {
+		REQUIRE(object->valid());
+	}
+	for (const auto &object : large) {
+		REQUIRE(object->valid());
+	}
+}
+
+TEST_CASE("slabs survive partial releases", "[slab_allocator]") {
+	using Item = Entity<200>;
+
+	auto objects = std::vector<std::unique_ptr<Item>>();
+	for (auto round = 0; round != 4; ++round) {
+		for (auto i = 0; i != 5000; ++i) {
+			objects.push_back(std::make_unique<Item>(round * 5000 + i));
+		}
+		// Free all but every hundredth object, so most slabs are released.
+		auto kept = std::vector<std::unique_ptr<Item>>();
+		for (auto i = 0; i != int(objects.size()); ++i) {
+			if (i % 100 == round) {
+				kept.push_back(std::move(objects[i]));
+			}
+		}
+		objects = std::move(kept);
+		for (const auto &object : objects) {
+			REQUIRE(object->valid());
+		}
+	}
+	objects.clear();
+	objects.push_back(std::make_unique<Item>(1));
+	REQUIRE(objects.back()->valid());
+}
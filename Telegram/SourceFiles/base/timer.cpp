@@ -7,58 +7,162 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "base/timer.h"
 
+#include <QtCore/QThreadStorage>
 #include <QtCore/QTimerEvent>
 
 namespace base {
+namespace details {
+
+// Drives all the base::Timer instances of a thread by a single Qt timer.
+class TimersDriver final : private QObject {
+public:
+	static not_null<TimersDriver*> Current();
+
+	void schedule(not_null<Timer*> timer, TimeMs when);
+
+protected:
+	void timerEvent(QTimerEvent *e) override;
+
+private:
+	TimersDriver();
+
+	void process();
+	void reschedule();
+	void wakeAt(TimeMs when);
+
+	TimerWheel _wheel;
+	TimeMs _wakeAt = 0;
+	int _timerId = 0;
+
+};
+
+} // namespace details
 namespace {
 
+using details::TimersDriver;
+
 QObject *TimersAdjuster() {
 	static QObject adjuster;
 	return &adjuster;
 }
 
+// Coarse timers may fire up to 5% of their timeout later (as in Qt),
+// rounding their times up lets us fire a lot of them at once.
+TimeMs ComputeDeadline(TimeMs now, int timeout, Qt::TimerType type) {
+	const auto exact = now + timeout;
+	const auto granularity = [&] {
+		if (type == Qt::PreciseTimer) {
+			return TimeMs(1);
+		} else if (type == Qt::VeryCoarseTimer) {
+			return TimeMs(1000);
+		}
+		auto result = TimeMs(1);
+		while (result * 2 <= timeout / 20) {
+			result *= 2;
+		}
+		return result;
+	}();
+	return ((exact + granularity - 1) / granularity) * granularity;
+}
+
 } // namespace
 
-Timer::Timer(
-	not_null<QThread*> thread,
-	Fn<void()> callback)
-: Timer(std::move(callback)) {
-	moveToThread(thread);
-}
+namespace details {
 
-Timer::Timer(Fn<void()> callback)
-: QObject(nullptr)
-, _callback(std::move(callback))
-, _type(Qt::PreciseTimer)
-, _adjusted(false) {
-	setRepeat(Repeat::Interval);
+TimersDriver::TimersDriver() : _wheel(crl::time()) {
 	connect(
 		TimersAdjuster(),
 		&QObject::destroyed,
 		this,
-		[this] { adjust(); },
+		[=] { reschedule(); },
 		Qt::QueuedConnection);
 }
 
+not_null<TimersDriver*> TimersDriver::Current() {
+	static QThreadStorage<TimersDriver*> Drivers;
+	if (!Drivers.hasLocalData()) {
+		Drivers.setLocalData(new TimersDriver());
+	}
+	return Drivers.localData();
+}
+
+void TimersDriver::schedule(not_null<Timer*> timer, TimeMs when) {
+	_wheel.add(timer, when);
+	if (!_timerId || timer->when() < _wakeAt) {
+		wakeAt(timer->when());
+	}
+}
+
+void TimersDriver::reschedule() {
+	const auto next = _wheel.next();
+	if (next >= 0) {
+		wakeAt(next);
+	} else if (_timerId) {
+		killTimer(base::take(_timerId));
+	}
+}
+
+void TimersDriver::wakeAt(TimeMs when) {
+	const auto delay = snap(
+		when - crl::time(),
+		TimeMs(0),
+		TimeMs(std::numeric_limits<int>::max()));
+	if (_timerId) {
+		killTimer(_timerId);
+	}
+	_timerId = startTimer(int(delay), Qt::PreciseTimer);
+	_wakeAt = when;
+}
+
+void TimersDriver::timerEvent(QTimerEvent *e) {
+	process();
+}
+
+void TimersDriver::process() {
+	const auto now = crl::time();
+
+	// If some callback enters a nested event loop, the rest of the due
+	// timers will be processed from that loop.
+	wakeAt(now);
+
+	while (const auto entry = _wheel.take(now)) {
+		static_cast<Timer*>(entry)->fire();
+	}
+	reschedule();
+}
+
+} // namespace details
+
+Timer::Timer(
+	not_null<QThread*> thread,
+	Fn<void()> callback)
+: _thread(thread)
+, _callback(std::move(callback))
+, _type(Qt::PreciseTimer) {
+	setRepeat(Repeat::Interval);
+}
+
+Timer::Timer(Fn<void()> callback)
+: Timer(QThread::currentThread(), std::move(callback)) {
+}
+
 void Timer::start(TimeMs timeout, Qt::TimerType type, Repeat repeat) {
-	cancel();
+	Expects(QThread::currentThread() == _thread);
 
 	_type = type;
 	setRepeat(repeat);
-	_adjusted = false;
 	setTimeout(timeout);
-	_timerId = startTimer(_timeout, _type);
-	if (_timerId) {
-		_next = crl::time() + _timeout;
-	} else {
-		_next = 0;
-	}
+	schedule();
+}
+
+void Timer::schedule() {
+	TimersDriver::Current()->schedule(
+		this,
+		ComputeDeadline(crl::time(), _timeout, _type));
 }
 
 void Timer::cancel() {
-	if (isActive()) {
-		killTimer(base::take(_timerId));
-	}
+	unlink();
 }
 
 TimeMs Timer::remainingTime() const {
@@ -66,27 +170,18 @@ TimeMs Timer::remainingTime() const {
 		return -1;
 	}
 	auto now = crl::time();
-	return (_next > now) ? (_next - now) : TimeMs(0);
+	return (when() > now) ? (when() - now) : TimeMs(0);
 }
 
 void Timer::Adjust() {
 	QObject emitter;
-	connect(
+	QObject::connect(
 		&emitter,
 		&QObject::destroyed,
 		TimersAdjuster(),
 		&QObject::destroyed);
 }
 
-void Timer::adjust() {
-	auto remaining = remainingTime();
-	if (remaining >= 0) {
-		cancel();
-		_timerId = startTimer(remaining, _type);
-		_adjusted = true;
-	}
-}
-
 void Timer::setTimeout(TimeMs timeout) {
 	Expects(timeout >= 0 && timeout <= std::numeric_limits<int>::max());
 
@@ -97,17 +192,10 @@ int Timer::timeout() const {
 	return _timeout;
 }
 
-void Timer::timerEvent(QTimerEvent *e) {
+void Timer::fire() {
 	if (repeat() == Repeat::Interval) {
-		if (_adjusted) {
-			start(_timeout, _type, repeat());
-		} else {
-			_next = crl::time() + _timeout;
-		}
-	} else {
-		cancel();
+		schedule();
 	}
-
 	if (_callback) {
 		_callback();
 	}
@@ -11,10 +11,15 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <QtCore/QThread>
 #include "base/observer.h"
 #include "base/flat_map.h"
+#include "base/timer_wheel.h"
 
 namespace base {
+namespace details {
+class TimersDriver;
+} // namespace details
 
-class Timer final : private QObject {
+// All the timers of a thread share one Qt timer, see details::TimersDriver.
+class Timer final : private details::TimerWheelEntry {
 public:
 	explicit Timer(
 		not_null<QThread*> thread,
@@ -47,7 +52,7 @@ public:
 	}
 
 	bool isActive() const {
-		return (_timerId != 0);
+		return linked();
 	}
 
 	void cancel();
@@ -55,16 +60,16 @@ public:
 
 	static void Adjust();
 
-protected:
-	void timerEvent(QTimerEvent *e) override;
-
 private:
+	friend class details::TimersDriver;
+
 	enum class Repeat : unsigned {
 		Interval   = 0,
 		SingleShot = 1,
 	};
 	void start(TimeMs timeout, Qt::TimerType type, Repeat repeat);
-	void adjust();
+	void schedule();
+	void fire();
 
 	void setTimeout(TimeMs timeout);
 	int timeout() const;
@@ -76,13 +81,11 @@ private:
 		return static_cast<Repeat>(_repeat);
 	}
 
+	not_null<QThread*> _thread;
 	Fn<void()> _callback;
-	TimeMs _next = 0;
 	int _timeout = 0;
-	int _timerId = 0;
 
 	Qt::TimerType _type : 2;
-	bool _adjusted : 1;
 	unsigned _repeat : 1;
 
 };
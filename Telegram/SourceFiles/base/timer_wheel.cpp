@@ -0,0 +1,192 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "base/timer_wheel.h"
+
+#include "base/assertion.h"
+#include <algorithm>
+#include <vector>
+
+namespace base {
+namespace details {
+
+TimerWheel::TimerWheel(Time now) : _now(now) {
+}
+
+TimerWheel::~TimerWheel() {
+	const auto clear = [](TimerWheelEntry **head) {
+		while (*head) {
+			(*head)->unlink();
+		}
+	};
+	enumerateLists(clear);
+	clear(&_expired);
+}
+
+template <typename Method>
+void TimerWheel::enumerateLists(Method method) {
+	for (auto &head : _first) {
+		method(&head);
+	}
+	for (auto &level : _levels) {
+		for (auto &head : level) {
+			method(&head);
+		}
+	}
+	method(&_overflow);
+}
+
+void TimerWheel::Push(TimerWheelEntry **head, TimerWheelEntry *entry) {
+	entry->_next = *head;
+	if (*head) {
+		(*head)->_link = &entry->_next;
+	}
+	*head = entry;
+	entry->_link = head;
+}
+
+TimerWheel::Time TimerWheel::Earliest(const TimerWheelEntry *list) {
+	auto result = list->_when;
+	for (auto entry = list->_next; entry; entry = entry->_next) {
+		result = std::min(result, entry->_when);
+	}
+	return result;
+}
+
+void TimerWheel::add(TimerWheelEntry *entry, Time when) {
+	Expects(entry != nullptr);
+
+	entry->unlink();
+	entry->_when = std::max(when, _now + 1);
+	insert(entry);
+}
+
+void TimerWheel::insert(TimerWheelEntry *entry) {
+	const auto when = entry->_when;
+	if ((when >> kFirstBits) == (_now >> kFirstBits)) {
+		Push(&_first[when & kFirstMask], entry);
+		return;
+	}
+	for (auto level = 0; level != kLevels; ++level) {
+		const auto shift = LevelShift(level);
+		const auto block = shift + kLevelBits;
+		if ((when >> block) == (_now >> block)) {
+			Push(&_levels[level][(when >> shift) & kLevelMask], entry);
+			return;
+		}
+	}
+	Push(&_overflow, entry);
+}
+
+void TimerWheel::reinsert(TimerWheelEntry **head) {
+	auto list = *head;
+	*head = nullptr;
+	while (const auto entry = list) {
+		list = entry->_next;
+		entry->_next = nullptr;
+		entry->_link = nullptr;
+		insert(entry);
+	}
+}
+
+void TimerWheel::cascade(int level) {
+	const auto index = (_now >> LevelShift(level)) & kLevelMask;
+	if (!index) {
+		if (level + 1 != kLevels) {
+			cascade(level + 1);
+		} else {
+			reinsert(&_overflow);
+		}
+	}
+	reinsert(&_levels[level][index]);
+}
+
+void TimerWheel::expire(TimerWheelEntry **head) {
+	// Entries are pushed to the front of the slots, reverse them back.
+	while (const auto entry = *head) {
+		entry->unlink();
+		Push(&_expired, entry);
+	}
+}
+
+TimerWheelEntry *TimerWheel::take(Time now) {
+	while (!_expired) {
+		if (now <= _now) {
+			return nullptr;
+		} else if (now - _now > kRebaseGap) {
+			rebase(now);
+		} else {
+			step(now);
+		}
+	}
+	const auto result = _expired;
+	result->unlink();
+	return result;
+}
+
+void TimerWheel::step(Time now) {
+	const auto last = std::min(now, _now | kFirstMask);
+	for (auto tick = _now + 1; tick <= last; ++tick) {
+		const auto head = &_first[tick & kFirstMask];
+		if (*head) {
+			_now = tick;
+			expire(head);
+			return;
+		}
+	}
+	_now = last;
+	if (_now < now) {
+		++_now;
+		cascade(0);
+		expire(&_first[_now & kFirstMask]);
+	}
+}
+
+void TimerWheel::rebase(Time now) {
+	auto entries = std::vector<TimerWheelEntry*>();
+	enumerateLists([&](TimerWheelEntry **head) {
+		while (const auto entry = *head) {
+			entry->unlink();
+			entries.push_back(entry);
+		}
+	});
+	_now = now;
+
+	// The latest due entry is pushed first, so the earliest is taken first.
+	std::sort(begin(entries), end(entries), [](
+			const TimerWheelEntry *a,
+			const TimerWheelEntry *b) {
+		return a->_when > b->_when;
+	});
+	for (const auto entry : entries) {
+		if (entry->_when <= _now) {
+			Push(&_expired, entry);
+		} else {
+			insert(entry);
+		}
+	}
+}
+
+TimerWheel::Time TimerWheel::next() const {
+	for (auto i = (_now & kFirstMask) + 1; i != kFirstSize; ++i) {
+		if (const auto entry = _first[i]) {
+			return entry->_when;
+		}
+	}
+	for (auto level = 0; level != kLevels; ++level) {
+		const auto index = (_now >> LevelShift(level)) & kLevelMask;
+		for (auto i = index + 1; i != kLevelSize; ++i) {
+			if (const auto list = _levels[level][i]) {
+				return Earliest(list);
+			}
+		}
+	}
+	return _overflow ? Earliest(_overflow) : Time(-1);
+}
+
+} // namespace details
+} // namespace base
@@ -0,0 +1,118 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <cstdint>
+
+namespace base {
+namespace details {
+
+class TimerWheel;
+
+// Intrusive node of TimerWheel, unlinks itself on destruction.
+class TimerWheelEntry {
+public:
+	TimerWheelEntry() = default;
+	TimerWheelEntry(const TimerWheelEntry &other) = delete;
+	TimerWheelEntry &operator=(const TimerWheelEntry &other) = delete;
+	~TimerWheelEntry() {
+		unlink();
+	}
+
+	bool linked() const {
+		return (_link != nullptr);
+	}
+	std::int64_t when() const {
+		return _when;
+	}
+	void unlink() {
+		if (_link) {
+			*_link = _next;
+			if (_next) {
+				_next->_link = _link;
+			}
+			_next = nullptr;
+			_link = nullptr;
+		}
+	}
+
+private:
+	friend class TimerWheel;
+
+	TimerWheelEntry *_next = nullptr;
+	TimerWheelEntry **_link = nullptr;
+	std::int64_t _when = 0;
+
+};
+
+// Hierarchical timing wheel with millisecond ticks.
+//
+// The first level has a slot for each millisecond of the current 256 ms
+// block, each next level has 64 slots, each as long as the whole previous
+// level. Adding and removing an entry is O(1), when the time reaches the
+// start of a slot of an upper level its entries are moved one level down.
+class TimerWheel final {
+public:
+	using Time = std::int64_t;
+
+	explicit TimerWheel(Time now);
+	TimerWheel(const TimerWheel &other) = delete;
+	TimerWheel &operator=(const TimerWheel &other) = delete;
+	~TimerWheel();
+
+	// Entries that are already due are scheduled for the next tick.
+	void add(TimerWheelEntry *entry, Time when);
+
+	// Returns a due entry (in the order of their times) or nullptr.
+	// The returned entry is unlinked from the wheel.
+	TimerWheelEntry *take(Time now);
+
+	// Earliest time of the scheduled entries or -1 if there are none.
+	Time next() const;
+
+private:
+	static constexpr auto kFirstBits = 8;
+	static constexpr auto kFirstSize = (1 << kFirstBits);
+	static constexpr auto kFirstMask = Time(kFirstSize - 1);
+	static constexpr auto kLevelBits = 6;
+	static constexpr auto kLevelSize = (1 << kLevelBits);
+	static constexpr auto kLevelMask = Time(kLevelSize - 1);
+	static constexpr auto kLevels = 4;
+
+	// Skipping a longer gap tick by tick costs more than placing all
+	// the entries from scratch.
+	static constexpr auto kRebaseGap = Time(1) << (kFirstBits + kLevelBits);
+
+	static int LevelShift(int level) {
+		return kFirstBits + level * kLevelBits;
+	}
+	static void Push(TimerWheelEntry **head, TimerWheelEntry *entry);
+	static Time Earliest(const TimerWheelEntry *list);
+
+	void insert(TimerWheelEntry *entry);
+	void reinsert(TimerWheelEntry **head);
+	void cascade(int level);
+	void expire(TimerWheelEntry **head);
+	void step(Time now);
+	void rebase(Time now);
+
+	template <typename Method>
+	void enumerateLists(Method method);
+
+	// All the ticks up to this one are already processed.
+	Time _now = 0;
+
+	TimerWheelEntry *_first[kFirstSize] = { nullptr };
+	TimerWheelEntry *_levels[kLevels][kLevelSize] = { { nullptr } };
+	TimerWheelEntry *_overflow = nullptr;
+	TimerWheelEntry *_expired = nullptr;
+
+};
+
+} // namespace details
+} // namespace base
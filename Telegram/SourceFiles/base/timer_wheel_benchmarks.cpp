@@ -0,0 +1,63 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "base/benchmark.h"
+
+#include "base/timer_wheel.h"
+#include <random>
+
+using namespace base::details;
+
+namespace {
+
+constexpr int kSizes[] = { 16, 256, 4096, 32768 };
+
+// Mostly short timeouts with some long ones, as in the app.
+std::vector<std::int64_t> RandomTimeouts(int count) {
+	auto generator = std::mt19937(count);
+	auto result = std::vector<std::int64_t>(count);
+	for (auto &timeout : result) {
+		const auto value = std::int64_t(generator());
+		timeout = (value % 8) ? (value % 1000) : (value % 600000);
+	}
+	return result;
+}
+
+} // namespace
+
+BENCHMARK_CASE("TimerWheel") {
+	for (const auto size : kSizes) {
+		const auto count = std::to_string(size);
+		const auto timeouts = RandomTimeouts(size);
+		auto entries = std::vector<TimerWheelEntry>(size);
+
+		runner.measure("add and remove " + count, size, [&] {
+			auto wheel = TimerWheel(0);
+			for (auto i = 0; i != size; ++i) {
+				wheel.add(&entries[i], timeouts[i]);
+			}
+			for (auto &entry : entries) {
+				entry.unlink();
+			}
+		});
+		runner.measure("add and fire " + count, size, [&] {
+			auto wheel = TimerWheel(0);
+			for (auto i = 0; i != size; ++i) {
+				wheel.add(&entries[i], timeouts[i]);
+			}
+			// Wake up only when the next entry is due, as TimersDriver does.
+			auto fired = 0;
+			while (fired != size) {
+				const auto now = wheel.next();
+				while (wheel.take(now)) {
+					++fired;
+				}
+			}
+			base::benchmark::DoNotOptimize(fired);
+		});
+	}
+}
@@ -0,0 +1,124 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "base/timer_wheel.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace base::details;
+
+namespace {
+
+std::vector<std::int64_t> TakeAll(TimerWheel &wheel, std::int64_t now) {
+	auto result = std::vector<std::int64_t>();
+	while (const auto entry = wheel.take(now)) {
+		result.push_back(entry->when());
+	}
+	return result;
+}
+
+} // namespace
+
+TEST_CASE("timer wheel fires entries in time", "[timer_wheel]") {
+	auto wheel = TimerWheel(1000);
+	auto entries = std::vector<TimerWheelEntry>(5);
+	const std::int64_t times[] = { 1300, 1001, 1000 + 20000, 1255, 1256 };
+	for (auto i = 0; i != 5; ++i) {
+		wheel.add(&entries[i], times[i]);
+	}
+	REQUIRE(wheel.next() == 1001);
+
+	SECTION("nothing is due before the earliest time") {
+		REQUIRE(wheel.take(1000) == nullptr);
+		REQUIRE(TakeAll(wheel, 1001) == std::vector<std::int64_t>{ 1001 });
+		REQUIRE(wheel.next() == 1255);
+	}
+	SECTION("due entries are taken in order") {
+		const auto expected = std::vector<std::int64_t>{ 1001, 1255, 1256 };
+		REQUIRE(TakeAll(wheel, 1299) == expected);
+		REQUIRE(wheel.next() == 1300);
+		REQUIRE(TakeAll(wheel, 30000)
+			== std::vector<std::int64_t>{ 1300, 21000 });
+		REQUIRE(wheel.next() == -1);
+	}
+	SECTION("entries that are already due fire on the next tick") {
+		REQUIRE(TakeAll(wheel, 1301).size() == 4);
+		auto late = TimerWheelEntry();
+		wheel.add(&late, 500);
+		REQUIRE(late.when() == 1302);
+		REQUIRE(wheel.next() == 1302);
+	}
+}
+
+TEST_CASE("timer wheel entries can be removed", "[timer_wheel]") {
+	auto wheel = TimerWheel(0);
+	auto first = TimerWheelEntry();
+	auto second = TimerWheelEntry();
+	auto third = TimerWheelEntry();
+	wheel.add(&first, 10);
+	wheel.add(&second, 10);
+	wheel.add(&third, 100000);
+	REQUIRE(first.linked());
+
+	second.unlink();
+	REQUIRE(!second.linked());
+	{
+		auto temporary = TimerWheelEntry();
+		wheel.add(&temporary, 10);
+	}
+	third.unlink();
+	REQUIRE(TakeAll(wheel, 1000000) == std::vector<std::int64_t>{ 10 });
+	REQUIRE(!first.linked());
+	REQUIRE(wheel.next() == -1);
+
+	SECTION("entries are detached when the wheel is destroyed") {
+		auto entry = TimerWheelEntry();
+		{
+			auto temporary = TimerWheel(0);
+			temporary.add(&entry, 5);
+		}
+		REQUIRE(!entry.linked());
+	}
+}
+
+TEST_CASE("timer wheel matches a sorted list of times", "[timer_wheel]") {
+	constexpr auto kCount = 2000;
+	auto engine = std::mt19937(42);
+	const auto check = [&](std::int64_t start, std::int64_t range) {
+		auto wheel = TimerWheel(start);
+		auto entries = std::vector<TimerWheelEntry>(kCount);
+		auto expected = std::vector<std::int64_t>();
+		auto distribution = std::uniform_int_distribution<std::int64_t>(
+			1,
+			range);
+		for (auto &entry : entries) {
+			const auto when = start + distribution(engine);
+			wheel.add(&entry, when);
+			expected.push_back(when);
+		}
+		std::sort(begin(expected), end(expected));
+
+		auto taken = std::vector<std::int64_t>();
+		auto now = start;
+		while (taken.size() != expected.size()) {
+			REQUIRE(wheel.next() == expected[taken.size()]);
+			now += distribution(engine) / 64 + 1;
+			for (const auto when : TakeAll(wheel, now)) {
+				REQUIRE(when <= now);
+				taken.push_back(when);
+			}
+		}
+		REQUIRE(taken == expected);
+	};
+	check(0, 1000);
+	check(255, 100000);
+	check(123456789, 1LL << 31);
+	check((1LL << 32) - 1000, 1LL << 20);
+}
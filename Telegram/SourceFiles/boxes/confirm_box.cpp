@@ -622,8 +622,8 @@ void DeleteMessagesBox::deleteAndClear() {
 	}
 
 	const auto revoke = _forEveryone ? _forEveryone->checked() : false;
-	for (const auto &[peer, ids] : idsByPeer) {
-		App::main()->deleteMessages(peer, ids, revoke);
+	if (!idsByPeer.empty()) {
+		App::main()->deleteMessages(idsByPeer, revoke);
 	}
 	Ui::hideLayer();
 	Auth().data().sendHistoryChangeNotifications();
@@ -664,6 +664,7 @@ void PeerListContent::addToSearchIndex(not_null<PeerListRow*> row) {
 	for (auto ch : row->nameFirstLetters()) {
 		_searchIndex[ch].push_back(row);
 	}
+	clearLocalSearchResults();
 }
 
 void PeerListContent::removeFromSearchIndex(not_null<PeerListRow*> row) {
@@ -680,9 +681,15 @@ void PeerListContent::removeFromSearchIndex(not_null<PeerListRow*> row) {
 			}
 		}
 		row->setNameFirstLetters({});
+		clearLocalSearchResults();
 	}
 }
 
+void PeerListContent::clearLocalSearchResults() {
+	_localSearchQuery = QString();
+	_localSearchResults.clear();
+}
+
 void PeerListContent::prependRow(std::unique_ptr<PeerListRow> row) {
 	Expects(row != nullptr);
 
@@ -771,6 +778,7 @@ void PeerListContent::clearAllContent() {
 	_rowsByPeer.clear();
 	_filterResults.clear();
 	_searchIndex.clear();
+	clearLocalSearchResults();
 	_rows.clear();
 	_searchRows.clear();
 	_searchQuery
@@ -1286,7 +1294,9 @@ void PeerListContent::searchQueryChanged(QString query) {
 	auto normalizedQuery = searchWordsList.join(' ');
 	if (_normalizedSearchQuery != normalizedQuery) {
 		setSearchQuery(query, normalizedQuery);
-		if (_controller->searchInLocal() && !searchWordsList.isEmpty()) {
+		if (!_controller->searchInLocal() || searchWordsList.isEmpty()) {
+			clearLocalSearchResults();
+		} else {
 			auto minimalList = (const std::vector<not_null<PeerListRow*>>*)nullptr;
 			for_const (auto &searchWord, searchWordsList) {
 				auto searchWordStart = searchWord[0].toLower();
@@ -1299,6 +1309,14 @@ void PeerListContent::searchQueryChanged(QString query) {
 					minimalList = &it->second;
 				}
 			}
+			const auto continued = !_localSearchQuery.isEmpty()
+				&& normalizedQuery.startsWith(_localSearchQuery);
+			if (minimalList
+				&& continued
+				&& _localSearchResults.size() < minimalList->size()) {
+				// All the rows found for the new query were found before.
+				minimalList = &_localSearchResults;
+			}
 			if (minimalList) {
 				auto searchWordInNames = [](
 						not_null<PeerData*> peer,
@@ -1327,6 +1345,8 @@ void PeerListContent::searchQueryChanged(QString query) {
 					}
 				}
 			}
+			_localSearchQuery = normalizedQuery;
+			_localSearchResults = _filterResults;
 		}
 		if (_controller->hasComplexSearch()) {
 			_controller->search(_searchQuery);
@@ -567,6 +567,7 @@ private:
 	void addToSearchIndex(not_null<PeerListRow*> row);
 	bool addingToSearchIndex() const;
 	void removeFromSearchIndex(not_null<PeerListRow*> row);
+	void clearLocalSearchResults();
 	void setSearchQuery(const QString &query, const QString &normalizedQuery);
 	bool showingSearch() const {
 		return !_searchQuery.isEmpty();
@@ -614,6 +615,11 @@ private:
 	QString _mentionHighlight;
 	std::vector<not_null<PeerListRow*>> _filterResults;
 
+	// Rows found in the search index for _localSearchQuery, a continued
+	// query is looked for only among them, any index change drops them.
+	QString _localSearchQuery;
+	std::vector<not_null<PeerListRow*>> _localSearchResults;
+
 	int _aboveHeight = 0;
 	object_ptr<TWidget> _aboveWidget = { nullptr };
 	object_ptr<Ui::FlatLabel> _description = { nullptr };
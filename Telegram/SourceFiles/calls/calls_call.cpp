@@ -39,6 +39,7 @@ namespace {
 constexpr auto kMinLayer = 65;
 constexpr auto kHangupTimeoutMs = 5000;
 constexpr auto kSha256Size = 32;
+constexpr auto kLogStatsTimeoutMs = 5000;
 
 using tgvoip::Endpoint;
 
@@ -130,6 +131,7 @@ Call::Call(
 , _user(user)
 , _type(type) {
 	_discardByTimeoutTimer.setCallback([this] { hangup(); });
+	_logStatsTimer.setCallback([this] { logStats(); });
 
 	if (_type == Type::Outgoing) {
 		setState(State::Requesting);
@@ -324,10 +326,24 @@ void Call::redial() {
 }
 
 QString Call::getDebugLog() const {
+	if (!_controller) {
+		return QString();
+	}
 	const auto debug = _controller->GetDebugString();
 	return QString::fromUtf8(debug.data(), debug.size());
 }
 
+void Call::logStats() {
+	if (!Logs::DebugEnabled()) {
+		return;
+	}
+	const auto stats = getDebugLog();
+	if (!stats.isEmpty()) {
+		DEBUG_LOG(("Call Stats: %1"
+			).arg(QString(stats).replace('\n', qstr("; "))));
+	}
+}
+
 void Call::startWaitingTrack() {
 	_waitingTrack = Media::Audio::Current().createTrack();
 	auto trackFileName = Auth().settings().getSoundPath(
@@ -741,6 +757,7 @@ void Call::setState(State state) {
 		switch (_state) {
 		case State::Established:
 			_startTime = getms(true);
+			_logStatsTimer.callEach(kLogStatsTimeoutMs);
 			break;
 		case State::ExchangingKeys:
 			_delegate->playSound(Delegate::Sound::Connecting);
@@ -871,7 +888,9 @@ void Call::handleControllerError(int error) {
 }
 
 void Call::destroyController() {
+	_logStatsTimer.cancel();
 	if (_controller) {
+		logStats();
 		DEBUG_LOG(("Call Info: Destroying call controller.."));
 		_controller.reset();
 		DEBUG_LOG(("Call Info: Call controller destroyed."));
@@ -180,6 +180,7 @@ private:
 	void setFailedQueued(int error);
 	void setSignalBarCount(int count);
 	void destroyController();
+	void logStats();
 
 	not_null<Delegate*> _delegate;
 	not_null<UserData*> _user;
@@ -194,6 +195,9 @@ private:
 	base::DelayedCallTimer _finishByTimeoutTimer;
 	base::Timer _discardByTimeoutTimer;
 
+	// Jitter, packet loss and bitrate from the controller, for the log.
+	base::Timer _logStatsTimer;
+
 	bool _mute = false;
 	base::Observable<bool> _muteChanged;
 
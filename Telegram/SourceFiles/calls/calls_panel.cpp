@@ -412,6 +412,7 @@ void Panel::reinitControls() {
 		_call,
 		st::callPanelSignalBars,
 		[=] { rtlupdate(signalBarsRect()); });
+	_signalBars->setAttribute(Qt::WA_TransparentForMouseEvents);
 
 	_name->setText(App::peerName(_call->user()));
 	updateStatusText(_call->state());
@@ -791,6 +792,13 @@ void Panel::mouseMoveEvent(QMouseEvent *e) {
 			move(_dragStartMyPosition + (e->globalPos() - _dragStartMousePosition));
 		}
 	} else if (_fingerprintArea.contains(e->pos())) {
+		_statsTooltip = false;
+		Ui::Tooltip::Show(kTooltipShowTimeoutMs, this);
+	} else if (Logs::DebugEnabled()
+		&& _call
+		&& _signalBars->isDisplayed()
+		&& myrtlrect(signalBarsRect()).contains(e->pos())) {
+		_statsTooltip = true;
 		Ui::Tooltip::Show(kTooltipShowTimeoutMs, this);
 	} else {
 		Ui::Tooltip::Hide();
@@ -812,6 +820,9 @@ void Panel::leaveToChildEvent(QEvent *e, QWidget *child) {
 }
 
 QString Panel::tooltipText() const {
+	if (_statsTooltip) {
+		return _call ? _call->getDebugLog() : QString();
+	}
 	return lng_call_fingerprint_tooltip(lt_user, App::peerName(_user));
 }
 
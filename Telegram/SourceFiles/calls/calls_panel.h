@@ -133,6 +133,7 @@ private:
 	object_ptr<SignalBars> _signalBars;
 	std::vector<EmojiPtr> _fingerprint;
 	QRect _fingerprintArea;
+	bool _statsTooltip = false;
 
 	base::Timer _updateDurationTimer;
 	base::Timer _updateOuterRippleTimer;
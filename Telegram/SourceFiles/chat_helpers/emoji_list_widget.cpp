@@ -519,7 +519,14 @@ void EmojiListWidget::paintEvent(QPaintEvent *e) {
 		toColumn = _columnCount - toColumn;
 	}
 
-	enumerateSections([this, &p, r, fromColumn, toColumn](const SectionInfo &info) {
+	// Everything that doesn't depend on the cell is computed only once,
+	// the sprites are already cached per size in Ui::Emoji::Instance.
+	const auto pickerSelected = _picker->isHidden() ? -1 : _pickerSel;
+	const auto emojiSize = _esize / cIntRetinaFactor();
+	const auto emojiShift = QPoint(
+		(_singleSize.width() - emojiSize) / 2,
+		(_singleSize.height() - emojiSize) / 2);
+	enumerateSections([&](const SectionInfo &info) {
 		if (r.top() >= info.rowsBottom) {
 			return true;
 		} else if (r.top() + r.height() <= info.top) {
@@ -532,6 +539,8 @@ void EmojiListWidget::paintEvent(QPaintEvent *e) {
 		}
 		if (r.top() + r.height() > info.rowsTop) {
 			ensureLoaded(info.section);
+			const auto &emoji = _emoji[info.section];
+			const auto sectionShift = info.section * MatrixRowShift;
 			auto fromRow = floorclamp(r.y() - info.rowsTop, _singleSize.height(), 0, info.rowsCount);
 			auto toRow = ceilclamp(r.y() + r.height() - info.rowsTop, _singleSize.height(), 0, info.rowsCount);
 			for (auto i = fromRow; i < toRow; ++i) {
@@ -539,7 +548,8 @@ void EmojiListWidget::paintEvent(QPaintEvent *e) {
 					auto index = i * _columnCount + j;
 					if (index >= info.count) break;
 
-					auto selected = (!_picker->isHidden() && info.section * MatrixRowShift + index == _pickerSel) || (info.section * MatrixRowShift + index == _selected);
+					const auto selectedIndex = sectionShift + index;
+					auto selected = (selectedIndex == pickerSelected) || (selectedIndex == _selected);
 
 					auto w = QPoint(_rowsLeft + j * _singleSize.width(), info.rowsTop + i * _singleSize.height());
 					if (selected) {
@@ -547,12 +557,13 @@ void EmojiListWidget::paintEvent(QPaintEvent *e) {
 						if (rtl()) tl.setX(width() - tl.x() - _singleSize.width());
 						App::roundRect(p, QRect(tl, _singleSize), st::emojiPanHover, StickerHoverCorners);
 					}
+					const auto position = w + emojiShift;
 					Ui::Emoji::Draw(
 						p,
-						_emoji[info.section][index],
+						emoji[index],
 						_esize,
-						w.x() + (_singleSize.width() - (_esize / cIntRetinaFactor())) / 2,
-						w.y() + (_singleSize.height() - (_esize / cIntRetinaFactor())) / 2);
+						position.x(),
+						position.y());
 				}
 			}
 		}
@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_chat.h"
 #include "data/data_user.h"
 #include "data/data_peer_values.h"
+#include "data/data_session.h"
 #include "mainwindow.h"
 #include "apiwrap.h"
 #include "storage/localstorage.h"
@@ -23,8 +24,28 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "styles/style_widgets.h"
 #include "styles/style_chat_helpers.h"
 
+namespace {
+
+constexpr auto kSearchParticipantsDelay = TimeMs(300);
+constexpr auto kSearchParticipantsLimit = 50;
+
+bool UserMatchesQuery(not_null<UserData*> user, const QString &query) {
+	if (user->username.startsWith(query, Qt::CaseInsensitive)) {
+		return true;
+	}
+	for (const auto &nameWord : user->nameWords()) {
+		if (nameWord.startsWith(query, Qt::CaseInsensitive)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace
+
 FieldAutocomplete::FieldAutocomplete(QWidget *parent) : TWidget(parent)
-, _scroll(this, st::mentionScroll) {
+, _scroll(this, st::mentionScroll)
+, _searchTimer([=] { requestParticipantsSearch(); }) {
 	_scroll->setGeometry(rect());
 
 	_inner = _scroll->setOwnedWidget(object_ptr<internal::FieldAutocompleteInner>(this, &_mrows, &_hrows, &_brows, &_srows));
@@ -229,6 +250,9 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 					mrows.push_back(user);
 				}
 			}
+			if (!listAllSuggestions) {
+				appendSearchedParticipants(mrows);
+			}
 		}
 	} else if (_type == Type::Hashtags) {
 		bool listAllSuggestions = _filter.isEmpty();
@@ -330,6 +354,104 @@ void FieldAutocomplete::updateFiltered(bool resetScroll) {
 	_inner->setRecentInlineBotsInRows(recentInlineBots);
 }
 
+void FieldAutocomplete::appendSearchedParticipants(
+		internal::MentionRows &rows) {
+	Expects(_channel != nullptr);
+
+	if (_searchChannel != _channel) {
+		if (_searchRequestId) {
+			request(base::take(_searchRequestId)).cancel();
+		}
+		_searchCache.clear();
+		_searchChannel = _channel;
+	}
+	const auto found = searchedParticipants(_filter);
+	if (!found) {
+		_searchTimer.callOnce(kSearchParticipantsDelay);
+		return;
+	}
+	for (const auto user : *found) {
+		if (user->isInaccessible() || rows.contains(user)) {
+			continue;
+		}
+		rows.push_back(user);
+	}
+}
+
+auto FieldAutocomplete::searchedParticipants(const QString &query) const
+-> std::optional<std::vector<not_null<UserData*>>> {
+	const auto i = _searchCache.find(query);
+	if (i != end(_searchCache)) {
+		return i->second.users;
+	}
+
+	// A complete result for a shorter query has all the results we need.
+	for (auto length = query.size() - 1; length > 0; --length) {
+		const auto j = _searchCache.find(query.mid(0, length));
+		if (j == end(_searchCache) || !j->second.complete) {
+			continue;
+		}
+		auto result = std::vector<not_null<UserData*>>();
+		for (const auto user : j->second.users) {
+			if (UserMatchesQuery(user, query)) {
+				result.push_back(user);
+			}
+		}
+		return result;
+	}
+	return std::nullopt;
+}
+
+void FieldAutocomplete::requestParticipantsSearch() {
+	if (!_channel
+		|| _channel != _searchChannel
+		|| _type != Type::Mentions
+		|| _filter.isEmpty()
+		|| searchedParticipants(_filter)) {
+		return;
+	} else if (_searchRequestId) {
+		if (_searchQuery == _filter) {
+			return;
+		}
+		request(base::take(_searchRequestId)).cancel();
+	}
+	const auto channel = not_null<ChannelData*>(_channel);
+	const auto query = _searchQuery = _filter;
+	const auto offset = 0;
+	const auto participantsHash = 0;
+	_searchRequestId = request(MTPchannels_GetParticipants(
+		channel->inputChannel,
+		MTP_channelParticipantsSearch(MTP_string(query)),
+		MTP_int(offset),
+		MTP_int(kSearchParticipantsLimit),
+		MTP_int(participantsHash)
+	)).done([=](const MTPchannels_ChannelParticipants &result) {
+		_searchRequestId = 0;
+		auto &entry = _searchCache[query];
+		Auth().api().parseChannelParticipants(channel, result, [&](
+				int availableCount,
+				const QVector<MTPChannelParticipant> &list) {
+			for (const auto &participant : list) {
+				const auto userId = participant.match([](const auto &data) {
+					return data.vuser_id.v;
+				});
+				if (const auto user = Auth().data().userLoaded(userId)) {
+					entry.users.push_back(user);
+				}
+			}
+			entry.complete = (list.size() < kSearchParticipantsLimit);
+		});
+		if (_channel == channel
+			&& _type == Type::Mentions
+			&& _filter.startsWith(query)) {
+			updateFiltered();
+		}
+	}).fail([=](const RPCError &error) {
+		_searchRequestId = 0;
+		_searchCache.emplace(query, SearchResult()); // Don't retry it.
+	}).send();
+}
+
 void FieldAutocomplete::rowsUpdated(const internal::MentionRows &mrows, const internal::HashtagRows &hrows, const internal::BotCommandRows &brows, const internal::StickerRows &srows, bool resetScroll) {
 	if (mrows.isEmpty() && hrows.isEmpty() && brows.isEmpty() && srows.empty()) {
 		if (!isHidden()) {
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "ui/twidget.h"
 #include "base/timer.h"
+#include "mtproto/sender.h"
 #include "chat_helpers/stickers.h"
 
 namespace Ui {
@@ -26,7 +27,7 @@ class FieldAutocompleteInner;
 
 } // namespace internal
 
-class FieldAutocomplete final : public TWidget {
+class FieldAutocomplete final : public TWidget, private MTP::Sender {
 	Q_OBJECT
 
 public:
@@ -93,6 +94,11 @@ private:
 	void updateFiltered(bool resetScroll = false);
 	void recount(bool resetScroll = false);
 
+	void appendSearchedParticipants(internal::MentionRows &rows);
+	std::optional<std::vector<not_null<UserData*>>> searchedParticipants(
+		const QString &query) const;
+	void requestParticipantsSearch();
+
 	QPixmap _cache;
 	internal::MentionRows _mrows;
 	internal::HashtagRows _hrows;
@@ -120,6 +126,18 @@ private:
 	QRect _boundings;
 	bool _addInlineBots;
 
+	// Server side search of the megagroup members that are not
+	// in the lastParticipants list, merged below the local rows.
+	struct SearchResult {
+		std::vector<not_null<UserData*>> users;
+		bool complete = false;
+	};
+	ChannelData *_searchChannel = nullptr;
+	std::map<QString, SearchResult> _searchCache;
+	QString _searchQuery;
+	mtpRequestId _searchRequestId = 0;
+	base::Timer _searchTimer;
+
 	int32 _width, _height;
 	bool _hiding = false;
 
@@ -177,6 +177,7 @@ void GifsListWidget::visibleTopBottomUpdated(
 	Inner::visibleTopBottomUpdated(visibleTop, visibleBottom);
 	if (top != getVisibleTop()) {
 		_lastScrolled = getms();
+		preloadImages();
 	}
 	checkLoadMore();
 }
@@ -444,7 +445,6 @@ bool GifsListWidget::inlineRowsAddItem(DocumentData *savedGif, InlineResult *res
 	}
 	if (!layout) return false;
 
-	layout->preload();
 	if (inlineRowFinalize(row, sumWidth, layout->isFullLine())) {
 		layout->setPosition(_rows.size() * MatrixRowShift);
 	}
@@ -501,10 +501,9 @@ void GifsListWidget::refreshSavedGifs() {
 		update();
 	}
 
+	preloadImages();
 	if (isVisible()) {
 		updateSelected();
-	} else {
-		preloadImages();
 	}
 }
 
@@ -620,10 +619,24 @@ void GifsListWidget::layoutInlineRow(Row &row, int fullWidth) {
 }
 
 void GifsListWidget::preloadImages() {
+	// Don't request thumbnails for hundreds of saved gifs at once,
+	// only for the rows around the visible part of the list.
+	const auto visibleHeight = getVisibleBottom() - getVisibleTop();
+	const auto preloadHeight = std::max(visibleHeight, st::emojiPanMaxHeight);
+	const auto from = getVisibleTop() - preloadHeight;
+	const auto till = getVisibleBottom() + preloadHeight;
+	auto top = st::stickerPanPadding;
 	for (auto row = 0, rows = _rows.size(); row != rows; ++row) {
-		for (auto col = 0, cols = _rows[row].items.size(); col != cols; ++col) {
-			_rows[row].items[col]->preload();
+		if (top >= till) {
+			break;
+		}
+		const auto &inlineRow = _rows[row];
+		if (top + inlineRow.height > from) {
+			for (const auto item : inlineRow.items) {
+				item->preload();
+			}
 		}
+		top += inlineRow.height;
 	}
 }
 
@@ -664,6 +677,7 @@ int GifsListWidget::refreshInlineRows(const InlineCacheEntry *entry, bool result
 	}
 
 	resizeToWidth(width());
+	preloadImages();
 	update();
 
 	_lastMousePos = QCursor::pos();
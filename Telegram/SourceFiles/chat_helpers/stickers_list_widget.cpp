@@ -773,10 +773,16 @@ int StickersListWidget::featuredRowHeight() const {
 		+ st::stickersTrendingSkip;
 }
 
-template <typename Callback>
-bool StickersListWidget::enumerateSections(Callback callback) const {
-	auto info = SectionInfo();
+const std::vector<StickersListWidget::SectionInfo> &StickersListWidget::sections() const {
 	const auto &sets = shownSets();
+	if (_sectionsValid
+		&& _sectionsFor == _section
+		&& _sections.size() == sets.size()) {
+		return _sections;
+	}
+	_sections.clear();
+	_sections.reserve(sets.size());
+	auto info = SectionInfo();
 	for (auto i = 0; i != sets.size(); ++i) {
 		auto &set = sets[i];
 		info.section = i;
@@ -797,37 +803,48 @@ bool StickersListWidget::enumerateSections(Callback callback) const {
 			info.rowsCount = (info.count / _columnCount) + ((info.count % _columnCount) ? 1 : 0);
 			info.rowsBottom = info.rowsTop + info.rowsCount * _singleSize.height();
 		}
-		if (!callback(info)) {
+		_sections.push_back(info);
+		info.top = info.rowsBottom;
+	}
+	_sectionsFor = _section;
+	_sectionsValid = true;
+	return _sections;
+}
+
+void StickersListWidget::invalidateSections() {
+	_sectionsValid = false;
+}
+
+template <typename Callback>
+bool StickersListWidget::enumerateSections(
+		Callback callback,
+		int fromSection) const {
+	const auto &list = sections();
+	for (auto i = fromSection, count = int(list.size()); i < count; ++i) {
+		if (!callback(list[i])) {
 			return false;
 		}
-		info.top = info.rowsBottom;
 	}
 	return true;
 }
 
 StickersListWidget::SectionInfo StickersListWidget::sectionInfo(int section) const {
 	Expects(section >= 0 && section < shownSets().size());
-	auto result = SectionInfo();
-	enumerateSections([searchForSection = section, &result](const SectionInfo &info) {
-		if (info.section == searchForSection) {
-			result = info;
-			return false;
-		}
-		return true;
-	});
-	return result;
+
+	return sections()[section];
 }
 
 StickersListWidget::SectionInfo StickersListWidget::sectionInfoByOffset(int yOffset) const {
-	auto result = SectionInfo();
-	enumerateSections([this, &result, yOffset](const SectionInfo &info) {
-		if (yOffset < info.rowsBottom || info.section == shownSets().size() - 1) {
-			result = info;
-			return false;
-		}
-		return true;
-	});
-	return result;
+	const auto &list = sections();
+	if (list.empty()) {
+		return SectionInfo();
+	}
+	const auto i = ranges::upper_bound(
+		list,
+		yOffset,
+		std::less<>(),
+		&SectionInfo::rowsBottom);
+	return (i != list.end()) ? *i : list.back();
 }
 
 int StickersListWidget::countDesiredHeight(int newWidth) {
@@ -846,6 +863,7 @@ int StickersListWidget::countDesiredHeight(int newWidth) {
 		- st::buttonRadius;
 	_singleSize = QSize(singleWidth, singleWidth);
 	setColumnCount(columnCount);
+	invalidateSections();
 
 	auto visibleHeight = minimalHeight();
 	auto minimalHeight = (visibleHeight - st::stickerPanPadding);
@@ -961,6 +979,7 @@ void StickersListWidget::refreshSearchRows(
 	clearSelection();
 
 	_searchSets.clear();
+	invalidateSections();
 	fillLocalSearchRows(_searchNextQuery);
 
 	if (!cloudSets && _searchNextQuery.isEmpty()) {
@@ -1159,6 +1178,9 @@ void StickersListWidget::paintStickers(Painter &p, QRect clip) {
 	if (sets.empty() && _section == Section::Search) {
 		paintEmptySearchResults(p);
 	}
+	const auto fromSection = sets.empty()
+		? 0
+		: sectionInfoByOffset(clip.top()).section;
 	enumerateSections([&](const SectionInfo &info) {
 		if (clip.top() >= info.rowsBottom) {
 			return true;
@@ -1285,7 +1307,7 @@ void StickersListWidget::paintStickers(Painter &p, QRect clip) {
 			}
 		}
 		return true;
-	});
+	}, fromSection);
 }
 
 void StickersListWidget::paintEmptySearchResults(Painter &p) {
@@ -1698,6 +1720,7 @@ void StickersListWidget::processPanelHideFinished() {
 }
 
 void StickersListWidget::refreshStickers() {
+	invalidateSections();
 	clearSelection();
 
 	_mySets.clear();
@@ -1751,6 +1774,7 @@ void StickersListWidget::refreshSearchSets() {
 			}
 		}
 	}
+	invalidateSections();
 }
 
 void StickersListWidget::refreshSearchIndex() {
@@ -1925,6 +1949,7 @@ void StickersListWidget::refreshRecentStickers(bool performResize) {
 	} else if (recentIt != _mySets.end()) {
 		_mySets.erase(recentIt);
 	}
+	invalidateSections();
 
 	if (performResize && (_section == Section::Stickers || _section == Section::Featured)) {
 		resizeToWidth(width());
@@ -2258,6 +2283,7 @@ void StickersListWidget::refreshMegagroupSetGeometry() {
 	_megagroupSetButtonTextWidth = st::stickerGroupCategoryAdd.font->width(_megagroupSetButtonText);
 	auto buttonWidth = _megagroupSetButtonTextWidth - st::stickerGroupCategoryAdd.width;
 	_megagroupSetButtonRect = QRect(left, top, buttonWidth, st::stickerGroupCategoryAdd.height);
+	invalidateSections();
 }
 
 void StickersListWidget::showMegagroupSet(ChannelData *megagroup) {
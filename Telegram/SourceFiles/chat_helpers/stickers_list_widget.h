@@ -153,9 +153,11 @@ private:
 	};
 
 	template <typename Callback>
-	bool enumerateSections(Callback callback) const;
+	bool enumerateSections(Callback callback, int fromSection = 0) const;
 	SectionInfo sectionInfo(int section) const;
 	SectionInfo sectionInfoByOffset(int yOffset) const;
+	const std::vector<SectionInfo> &sections() const;
+	void invalidateSections();
 
 	void displaySet(uint64 setId);
 	void installSet(uint64 setId);
@@ -261,6 +263,11 @@ private:
 	int _columnCount = 1;
 	QSize _singleSize;
 
+	// Layout of shownSets(), counted lazily and kept until the next resize.
+	mutable std::vector<SectionInfo> _sections;
+	mutable Section _sectionsFor = Section::Stickers;
+	mutable bool _sectionsValid = false;
+
 	OverState _selected;
 	OverState _pressed;
 	QPoint _lastMousePosition;
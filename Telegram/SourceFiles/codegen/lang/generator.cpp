@@ -178,7 +178,7 @@ bool Generator::writeSource() {
 	source_ = std::make_unique<common::CppFile>(basePath_ + ".cpp", project_);
 
 	source_->include("lang/lang_keys.h").pushNamespace("Lang").pushNamespace().stream() << "\
-const char *KeyNames[kLangKeysCount] = {\n\
+const char *const KeyNames[kLangKeysCount] = {\n\
 \n";
 	for (auto &entry : langpack_.entries) {
 		source_->stream() << "\"" << entry.key << "\",\n";
@@ -187,7 +187,7 @@ const char *KeyNames[kLangKeysCount] = {\n\
 \n\
 };\n\
 \n\
-QChar DefaultData[] = {";
+const QChar DefaultData[] = {";
 	auto count = 0;
 	auto fulllength = 0;
 	for (auto &entry : langpack_.entries) {
@@ -207,7 +207,7 @@ QChar DefaultData[] = {";
 	}
 	source_->stream() << " };\n\
 \n\
-int Offsets[] = {";
+const int Offsets[] = {";
 	count = 0;
 	auto offset = 0;
 	auto writeOffset = [this, &count, &offset] {
@@ -995,8 +995,11 @@ QByteArray save() {\n\
 }\n\
 \n\
 bool load(const QByteArray &cache) {\n\
+	const auto was = _palette.save();\n\
 	if (_palette.load(cache)) {\n\
-		style::internal::resetIcons();\n\
+		if (_palette.save() != was) {\n\
+			style::internal::resetIcons();\n\
+		}\n\
 		return true;\n\
 	}\n\
 	return false;\n\
@@ -1011,13 +1014,19 @@ palette::SetResult setColor(QLatin1String name, QLatin1String from) {\n\
 }\n\
 \n\
 void apply(const palette &other) {\n\
+	const auto was = _palette.save();\n\
 	_palette = other;\n\
-	style::internal::resetIcons();\n\
+	if (_palette.save() != was) {\n\
+		style::internal::resetIcons();\n\
+	}\n\
 }\n\
 \n\
 void reset() {\n\
+	const auto was = _palette.save();\n\
 	_palette.reset();\n\
-	style::internal::resetIcons();\n\
+	if (_palette.save() != was) {\n\
+		style::internal::resetIcons();\n\
+	}\n\
 }\n\
 \n\
 int indexOfColor(color c) {\n\
@@ -12,11 +12,13 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 #include "data/data_user.h"
 #include "base/timer.h"
+#include "base/perf_counters.h"
 #include "core/update_checker.h"
 #include "core/shortcuts.h"
 #include "core/sandbox.h"
 #include "core/local_url_handlers.h"
 #include "core/launcher.h"
+#include "core/startup_trace.h"
 #include "storage/localstorage.h"
 #include "platform/platform_specific.h"
 #include "mainwindow.h"
@@ -59,6 +61,16 @@ namespace Core {
 namespace {
 
 constexpr auto kQuitPreventTimeoutMs = 1500;
+constexpr auto kLogPerfCountersTimeout = TimeMs(60000);
+
+void LogPerfCounters() {
+	if (!Logs::DebugEnabled()) {
+		return;
+	}
+	const auto snapshot = base::perf::TakeSnapshot();
+	DEBUG_LOG(("Perf Counters:\n%1").arg(
+		QString::fromStdString(base::perf::FormatSnapshot(snapshot))));
+}
 
 } // namespace
 
@@ -70,6 +82,7 @@ struct Application::Private {
 	MTP::Instance::Config mtpConfig;
 	MTP::AuthKeysList mtpKeysToDestroy;
 	base::Timer quitTimer;
+	base::Timer perfCountersTimer;
 };
 
 Application::Application(not_null<Launcher*> launcher)
@@ -92,7 +105,9 @@ void Application::run() {
 	Global::start();
 	refreshGlobalProxy(); // Depends on Global::started().
 
+	auto storageTrace = StartupTrace::Scope("Local::start");
 	startLocalStorage();
+	storageTrace.finish();
 
 	if (Local::oldSettingsVersion() < AppVersion) {
 		psNewVersion();
@@ -107,14 +122,24 @@ void Application::run() {
 	_translator = std::make_unique<Lang::Translator>();
 	QCoreApplication::instance()->installTranslator(_translator.get());
 
+	auto styleTrace = StartupTrace::Scope("style::startManager");
 	style::startManager();
+	styleTrace.finish();
+
 	anim::startManager();
 	Ui::InitTextOptions();
+
+	auto emojiTrace = StartupTrace::Scope("Ui::Emoji::Init");
 	Ui::Emoji::Init();
+	emojiTrace.finish();
+
 	Media::Player::start(_audio.get());
 
 	DEBUG_LOG(("Application Info: inited..."));
 
+	_private->perfCountersTimer.setCallback([] { LogPerfCounters(); });
+	_private->perfCountersTimer.callEach(kLogPerfCountersTimeout);
+
 	QCoreApplication::instance()->installNativeEventFilter(
 		psNativeEventFilter());
 
@@ -125,12 +150,16 @@ void Application::run() {
 	// Create mime database, so it won't be slow later.
 	QMimeDatabase().mimeTypeForName(qsl("text/plain"));
 
+	auto windowTrace = StartupTrace::Scope("MainWindow::init");
 	_window = std::make_unique<MainWindow>();
 	_window->init();
+	windowTrace.finish();
 
+	auto mediaViewTrace = StartupTrace::Scope("MediaView::MediaView");
 	auto currentGeometry = _window->geometry();
 	_mediaView = std::make_unique<MediaView>();
 	_window->setGeometry(currentGeometry);
+	mediaViewTrace.finish();
 
 	QCoreApplication::instance()->installEventFilter(this);
 	connect(
@@ -144,7 +173,10 @@ void Application::run() {
 	startShortcuts();
 	App::initMedia();
 
+	auto readMapTrace = StartupTrace::Scope("Local::readMap");
 	Local::ReadMapState state = Local::readMap(QByteArray());
+	readMapTrace.finish();
+
 	if (state == Local::ReadMapPassNeeded) {
 		Global::SetLocalPasscode(true);
 		Global::RefLocalPasscodeChanged().notify();
@@ -152,8 +184,11 @@ void Application::run() {
 		DEBUG_LOG(("Application Info: passcode needed..."));
 	} else {
 		DEBUG_LOG(("Application Info: local map read..."));
+		auto mtpTrace = StartupTrace::Scope("Application::startMtp");
 		startMtp();
+		mtpTrace.finish();
 		DEBUG_LOG(("Application Info: MTP started..."));
+		const auto setupTrace = StartupTrace::Scope("MainWindow::setup");
 		if (AuthSession::Exists()) {
 			_window->setupMain();
 		} else {
@@ -161,7 +196,9 @@ void Application::run() {
 		}
 	}
 	DEBUG_LOG(("Application Info: showing."));
+	auto showTrace = StartupTrace::Scope("MainWindow::firstShow");
 	_window->firstShow();
+	showTrace.finish();
 
 	if (cStartToSettings()) {
 		_window->showSettings();
@@ -732,6 +769,7 @@ void Application::authSessionDestroy() {
 	if (_authSession) {
 		unlockTerms();
 		_mtproto->clearGlobalHandlers();
+		Local::writePendingStickers();
 		_authSession = nullptr;
 		authSessionChanged().notify(true);
 		Notify::unreadCounterUpdated();
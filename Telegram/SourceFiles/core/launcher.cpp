@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/main_queue_processor.h"
 #include "core/update_checker.h"
 #include "core/sandbox.h"
+#include "core/startup_trace.h"
 #include "base/concurrent_timer.h"
 
 namespace Core {
@@ -216,7 +217,9 @@ void Launcher::init() {
 }
 
 int Launcher::exec() {
+	auto initTrace = StartupTrace::Scope("Launcher::init");
 	init();
+	initTrace.finish();
 
 	if (cLaunchMode() == LaunchModeFixPrevious) {
 		return psFixPrevious();
@@ -225,11 +228,19 @@ int Launcher::exec() {
 	}
 
 	// both are finished in Sandbox::closeApplication
+	auto logsTrace = StartupTrace::Scope("Logs::start");
 	Logs::start(this); // must be started before Platform is started
+	logsTrace.finish();
+
+	auto platformTrace = StartupTrace::Scope("Platform::start");
 	Platform::start(); // must be started before Sandbox is created
+	platformTrace.finish();
 
 	auto result = executeApplication();
 
+	// If the dialogs list was never painted write what we've collected.
+	StartupTrace::Finish();
+
 	DEBUG_LOG(("Telegram finished, result: %1").arg(result));
 
 	if (!UpdaterDisabled() && cRestartingUpdate()) {
@@ -373,6 +384,7 @@ void Launcher::processArguments() {
 	auto parseMap = std::map<QByteArray, KeyFormat> {
 		{ "-testmode"       , KeyFormat::NoValues },
 		{ "-debug"          , KeyFormat::NoValues },
+		{ "-trace"          , KeyFormat::NoValues },
 		{ "-many"           , KeyFormat::NoValues },
 		{ "-key"            , KeyFormat::OneValue },
 		{ "-autostart"      , KeyFormat::NoValues },
@@ -414,6 +426,9 @@ void Launcher::processArguments() {
 	}
 	gTestMode = parseResult.contains("-testmode");
 	Logs::SetDebugEnabled(parseResult.contains("-debug"));
+	if (parseResult.contains("-trace")) {
+		StartupTrace::Enable();
+	}
 	gManyInstance = parseResult.contains("-many");
 	gKeyFile = parseResult.value("-key", {}).join(QString()).toLower();
 	gKeyFile = gKeyFile.replace(QRegularExpression("[^a-z0-9\\-_]"), {});
@@ -437,7 +452,9 @@ void Launcher::processArguments() {
 }
 
 int Launcher::executeApplication() {
+	auto sandboxTrace = StartupTrace::Scope("Sandbox::Sandbox");
 	Sandbox sandbox(this, _argc, _argv);
+	sandboxTrace.finish();
 	MainQueueProcessor processor;
 	base::ConcurrentTimerEnvironment environment;
 	return sandbox.start();
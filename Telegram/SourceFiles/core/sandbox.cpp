@@ -16,6 +16,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/application.h"
 #include "core/launcher.h"
 #include "core/local_url_handlers.h"
+#include "core/startup_trace.h"
 #include "base/timer.h"
 #include "base/concurrent_timer.h"
 #include "base/qthelp_url.h"
@@ -145,7 +146,10 @@ void Sandbox::launchApplication() {
 		}
 		setupScreenScale();
 
+		auto constructTrace = StartupTrace::Scope(
+			"Application::Application");
 		_application = std::make_unique<Application>(_launcher);
+		constructTrace.finish();
 
 		// Ideally this should go to constructor.
 		// But we want to catch all native events and Application installs
@@ -153,6 +157,7 @@ void Sandbox::launchApplication() {
 		// our filter after the Application constructor installs his.
 		installNativeEventFilter(this);
 
+		const auto runTrace = StartupTrace::Scope("Application::run");
 		_application->run();
 	});
 }
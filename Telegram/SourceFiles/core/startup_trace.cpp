@@ -0,0 +1,142 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/startup_trace.h"
+
+#include <atomic>
+
+namespace Core {
+namespace StartupTrace {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Event {
+	const char *name = nullptr;
+	int64 start = 0;
+	int64 duration = 0;
+	int thread = 0;
+};
+
+// Initialized statically, so it is as close to the process start as we get.
+const auto ProcessStart = Clock::now();
+
+std::atomic<bool> TraceEnabled = false;
+QMutex EventsMutex;
+std::vector<Event> Events;
+std::vector<Qt::HANDLE> Threads;
+
+int64 CountMicroseconds(Clock::time_point time) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		time - ProcessStart).count();
+}
+
+// Must be called with EventsMutex locked.
+int ThreadIndex(Qt::HANDLE thread) {
+	const auto i = ranges::find(Threads, thread);
+	if (i != Threads.end()) {
+		return int(i - Threads.begin());
+	}
+	Threads.push_back(thread);
+	return int(Threads.size()) - 1;
+}
+
+void Record(const char *name, Clock::time_point start, Clock::time_point end) {
+	if (!Enabled()) {
+		return;
+	}
+	const auto thread = QThread::currentThreadId();
+
+	QMutexLocker lock(&EventsMutex);
+	Events.push_back({
+		name,
+		CountMicroseconds(start),
+		CountMicroseconds(end) - CountMicroseconds(start),
+		ThreadIndex(thread) });
+}
+
+QByteArray Serialize(const std::vector<Event> &events) {
+	auto result = QByteArray("{\"traceEvents\":[\n");
+	auto first = true;
+	for (const auto &event : events) {
+		if (!first) {
+			result.append(",\n");
+		}
+		first = false;
+		result.append("{\"name\":\"").append(event.name);
+		result.append("\",\"cat\":\"startup\",\"ph\":\"");
+		result.append(event.duration >= 0 ? "X" : "i");
+		result.append("\",\"pid\":1,\"tid\":");
+		result.append(QByteArray::number(event.thread));
+		result.append(",\"ts\":").append(QByteArray::number(event.start));
+		if (event.duration >= 0) {
+			result.append(",\"dur\":");
+			result.append(QByteArray::number(event.duration));
+		} else {
+			result.append(",\"s\":\"g\"");
+		}
+		result.append('}');
+	}
+	result.append("\n],\"displayTimeUnit\":\"ms\"}\n");
+	return result;
+}
+
+} // namespace
+
+void Enable() {
+	{
+		QMutexLocker lock(&EventsMutex);
+		ThreadIndex(QThread::currentThreadId());
+	}
+	TraceEnabled = true;
+}
+
+bool Enabled() {
+	return TraceEnabled.load(std::memory_order_relaxed);
+}
+
+void Finish() {
+	if (!TraceEnabled.exchange(false)) {
+		return;
+	}
+	const auto now = CountMicroseconds(Clock::now());
+	auto events = [&] {
+		QMutexLocker lock(&EventsMutex);
+		return base::take(Events);
+	}();
+	events.push_back({ "First frame", now, -1, 0 });
+	ranges::sort(events, std::less<>(), &Event::start);
+
+	const auto path = cWorkingDir() + qsl("tdata/startup_trace.json");
+	QFile f(path);
+	if (!f.open(QIODevice::WriteOnly) || f.write(Serialize(events)) < 0) {
+		LOG(("Startup Trace Error: could not write '%1'.").arg(path));
+		return;
+	}
+	LOG(("Startup Trace: %1 events written to '%2', first frame in %3 ms."
+		).arg(events.size()
+		).arg(path
+		).arg(now / 1000));
+}
+
+Scope::Scope(const char *name)
+: _name(name)
+, _start(Clock::now()) {
+}
+
+void Scope::finish() {
+	if (const auto name = base::take(_name)) {
+		Record(name, _start, Clock::now());
+	}
+}
+
+Scope::~Scope() {
+	finish();
+}
+
+} // namespace StartupTrace
+} // namespace Core
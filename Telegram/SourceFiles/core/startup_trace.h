@@ -0,0 +1,44 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <chrono>
+
+// Lightweight startup timing probes, enabled by the "-trace" argument.
+// The collected events are written in the Chrome trace format to
+// "<working dir>/tdata/startup_trace.json" when the dialogs list is
+// painted for the first time (or when the application quits earlier).
+namespace Core {
+namespace StartupTrace {
+
+void Enable();
+bool Enabled();
+
+// Thread: Main.
+void Finish();
+
+class Scope {
+public:
+	// Thread: Any.
+	// The start time is always taken, so a scope opened before Enable()
+	// is still recorded if the tracing is enabled by the time it finishes.
+	explicit Scope(const char *name);
+	Scope(const Scope &other) = delete;
+	Scope &operator=(const Scope &other) = delete;
+
+	void finish();
+	~Scope();
+
+private:
+	const char *_name = nullptr;
+	std::chrono::steady_clock::time_point _start;
+
+};
+
+} // namespace StartupTrace
+} // namespace Core
@@ -22,6 +22,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history_item.h"
 #include "window/window_controller.h"
 #include "storage/cache/storage_cache_database.h"
+#include "storage/file_download.h"
 #include "boxes/confirm_box.h"
 #include "ui/image/image.h"
 #include "ui/image/image_source.h"
@@ -452,13 +453,7 @@ Data::FileOrigin StickerData::setOrigin() const {
 }
 
 VoiceData::~VoiceData() {
-	if (!waveform.isEmpty()
-		&& waveform[0] == -1
-		&& waveform.size() > int32(sizeof(TaskId))) {
-		TaskId taskId = 0;
-		memcpy(&taskId, waveform.constData() + 1, sizeof(taskId));
-		Local::cancelTask(taskId);
-	}
+	Local::cancelVoiceWaveform(this);
 }
 
 DocumentData::DocumentData(not_null<Data::Session*> owner, DocumentId id)
@@ -642,6 +637,10 @@ Storage::Cache::Key DocumentData::goodThumbnailCacheKey() const {
 	return Data::DocumentThumbCacheKey(_dc, id);
 }
 
+Storage::Cache::Key DocumentData::waveformCacheKey() const {
+	return Data::DocumentWaveformCacheKey(_dc, id);
+}
+
 Image *DocumentData::goodThumbnail() const {
 	return _goodThumbnail.get();
 }
@@ -730,7 +729,8 @@ void DocumentData::automaticLoad(
 		: Data::AutoDownload::Should(
 			Auth().settings().autoDownload(),
 			this);
-	const auto loadFromCloud = shouldLoadFromCloud
+	const auto loadFromCloud = (shouldLoadFromCloud
+		&& session().downloader().fastEnoughForAutoLoad(_dc, size))
 		? LoadFromCloudOrLocal
 		: LoadFromLocalOnly;
 	save(
@@ -749,6 +749,23 @@ void DocumentData::automaticLoadSettingsChanged() {
 	_loader = nullptr;
 }
 
+void DocumentData::prefetch(
+		Data::FileOrigin origin,
+		const HistoryItem *item) {
+	if (!loaded()) {
+		session().downloader().warmUp(_dc);
+	}
+	if (_thumbnail) {
+		_thumbnail->prefetch(origin, item);
+	}
+}
+
+void DocumentData::cancelPrefetch() {
+	if (_thumbnail) {
+		_thumbnail->cancelPrefetch();
+	}
+}
+
 void DocumentData::performActionOnLoad() {
 	if (_actionOnLoad == ActionOnLoadNone) {
 		return;
@@ -1007,6 +1024,9 @@ void DocumentData::save(
 		_loader->connect(_loader, SIGNAL(progress(FileLoader*)), App::main(), SLOT(documentLoadProgress(FileLoader*)));
 		_loader->connect(_loader, SIGNAL(failed(FileLoader*,bool)), App::main(), SLOT(documentLoadFailed(FileLoader*,bool)));
 	}
+	if (action != ActionOnLoadNone || !toFile.isEmpty()) {
+		_loader->setLoadPriority(Storage::LoadPriority::Interactive);
+	}
 	if (loading()) {
 		_loader->start();
 	}
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "data/data_types.h"
+#include "base/slab_allocator.h"
 #include "ui/image/image.h"
 
 namespace Images {
@@ -78,7 +79,7 @@ namespace Serialize {
 class Document;
 } // namespace Serialize;
 
-class DocumentData {
+class DocumentData : public base::slab_allocated {
 public:
 	DocumentData(not_null<Data::Session*> owner, DocumentId id);
 
@@ -92,6 +93,8 @@ public:
 		Data::FileOrigin origin,
 		const HistoryItem *item);
 	void automaticLoadSettingsChanged();
+	void prefetch(Data::FileOrigin origin, const HistoryItem *item);
+	void cancelPrefetch();
 
 	enum FilePathResolveType {
 		FilePathResolveCached,
@@ -178,6 +181,7 @@ public:
 
 	[[nodiscard]] Image *goodThumbnail() const;
 	[[nodiscard]] Storage::Cache::Key goodThumbnailCacheKey() const;
+	[[nodiscard]] Storage::Cache::Key waveformCacheKey() const;
 	void setGoodThumbnail(QImage &&image, QByteArray &&bytes);
 	void refreshGoodThumbnail();
 	void replaceGoodThumbnail(std::unique_ptr<Images::Source> &&source);
@@ -182,6 +182,10 @@ QImage GoodThumbSource::takeLoaded() {
 	return std::move(_loaded);
 }
 
+QImage GoodThumbSource::takeProgressive() {
+	return QImage();
+}
+
 void GoodThumbSource::unload() {
 	_loaded = QImage();
 	cancel();
@@ -195,6 +199,14 @@ void GoodThumbSource::automaticLoad(
 void GoodThumbSource::automaticLoadSettingsChanged() {
 }
 
+void GoodThumbSource::prefetch(
+	Data::FileOrigin origin,
+	const HistoryItem *item) {
+}
+
+void GoodThumbSource::cancelPrefetch() {
+}
+
 bool GoodThumbSource::loading() {
 	return _loading.alive();
 }
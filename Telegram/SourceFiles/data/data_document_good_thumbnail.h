@@ -26,6 +26,7 @@ public:
 		bool loadFirst,
 		bool prior) override;
 	QImage takeLoaded() override;
+	QImage takeProgressive() override;
 	void unload() override;
 
 	void automaticLoad(
@@ -33,6 +34,11 @@ public:
 		const HistoryItem *item) override;
 	void automaticLoadSettingsChanged() override;
 
+	void prefetch(
+		Data::FileOrigin origin,
+		const HistoryItem *item) override;
+	void cancelPrefetch() override;
+
 	bool loading() override;
 	bool displayLoading() override;
 	void cancel() override;
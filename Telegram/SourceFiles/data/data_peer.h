@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "data/data_types.h"
+#include "base/slab_allocator.h"
 #include "data/data_flags.h"
 #include "data/data_notify_settings.h"
 
@@ -98,7 +99,7 @@ private:
 
 };
 
-class PeerData {
+class PeerData : public base::slab_allocated {
 protected:
 	PeerData(not_null<Data::Session*> owner, PeerId id);
 	PeerData(const PeerData &other) = delete;
@@ -13,6 +13,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/image/image_source.h"
 #include "mainwidget.h"
 #include "core/application.h"
+#include "storage/file_download.h"
+#include "auth_session.h"
 
 PhotoData::PhotoData(not_null<Data::Session*> owner, PhotoId id)
 : id(id)
@@ -37,6 +39,17 @@ void PhotoData::automaticLoadSettingsChanged() {
 	_large->automaticLoadSettingsChanged();
 }
 
+void PhotoData::prefetch(Data::FileOrigin origin, const HistoryItem *item) {
+	if (!_large->loaded()) {
+		session().downloader().warmUp(_large->location().dc());
+	}
+	_large->prefetch(origin, item);
+}
+
+void PhotoData::cancelPrefetch() {
+	_large->cancelPrefetch();
+}
+
 void PhotoData::download(Data::FileOrigin origin) {
 	_large->loadEvenCancelled(origin);
 	_owner->notifyPhotoLayoutChanged(this);
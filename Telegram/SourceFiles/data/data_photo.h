@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "data/data_types.h"
+#include "base/slab_allocator.h"
 
 class AuthSession;
 
@@ -15,7 +16,7 @@ namespace Data {
 class Session;
 } // namespace Data
 
-class PhotoData {
+class PhotoData : public base::slab_allocated {
 public:
 	PhotoData(not_null<Data::Session*> owner, PhotoId id);
 
@@ -26,6 +27,8 @@ public:
 		Data::FileOrigin origin,
 		const HistoryItem *item);
 	void automaticLoadSettingsChanged();
+	void prefetch(Data::FileOrigin origin, const HistoryItem *item);
+	void cancelPrefetch();
 
 	void download(Data::FileOrigin origin);
 	[[nodiscard]] bool loaded() const;
@@ -11,8 +11,17 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "auth_session.h"
 #include "apiwrap.h"
 
-uint64 PtsWaiter::ptsKey(PtsSkippedQueue queue, int32 pts) {
-	return _queue.insert(uint64(uint32(pts)) << 32 | (++_skippedKey), queue).key();
+void PtsWaiter::addSkipped(
+		int32 pts,
+		base::variant<MTPUpdate, MTPUpdates> &&data) {
+	const auto i = std::upper_bound(
+		_skipped.begin(),
+		_skipped.end(),
+		pts,
+		[](int32 value, const Skipped &skipped) {
+			return value < skipped.pts;
+		});
+	_skipped.insert(i, Skipped{ pts, std::move(data) });
 }
 
 void PtsWaiter::setWaitingForSkipped(ChannelData *channel, int32 ms) {
@@ -50,13 +59,18 @@ void PtsWaiter::applySkippedUpdates(ChannelData *channel) {
 
 	setWaitingForSkipped(channel, -1);
 
-	if (_queue.isEmpty()) return;
+	if (_skipped.empty()) return;
 
+	// Take the whole run at once, so that the updates applied from it
+	// can't modify the list while we iterate over it.
+	const auto skipped = base::take(_skipped);
+	auto &api = Auth().api();
 	++_applySkippedLevel;
-	for (auto i = _queue.cbegin(), e = _queue.cend(); i != e; ++i) {
-		switch (i.value()) {
-		case SkippedUpdate: Auth().api().applyUpdateNoPtsCheck(_updateQueue.value(i.key())); break;
-		case SkippedUpdates: Auth().api().applyUpdatesNoPtsCheck(_updatesQueue.value(i.key())); break;
+	for (const auto &entry : skipped) {
+		if (const auto update = base::get_if<MTPUpdate>(&entry.data)) {
+			api.applyUpdateNoPtsCheck(*update);
+		} else if (const auto updates = base::get_if<MTPUpdates>(&entry.data)) {
+			api.applyUpdatesNoPtsCheck(*updates);
 		}
 	}
 	--_applySkippedLevel;
@@ -64,9 +78,7 @@ void PtsWaiter::applySkippedUpdates(ChannelData *channel) {
 }
 
 void PtsWaiter::clearSkippedUpdates() {
-	_queue.clear();
-	_updateQueue.clear();
-	_updatesQueue.clear();
+	_skipped.clear();
 	_applySkippedLevel = 0;
 }
 
@@ -78,7 +90,7 @@ bool PtsWaiter::updated(ChannelData *channel, int32 pts, int32 count, const MTPU
 	} else if (check(channel, pts, count)) {
 		return true;
 	}
-	_updatesQueue.insert(ptsKey(SkippedUpdates, pts), updates);
+	addSkipped(pts, updates);
 	return false;
 }
 
@@ -90,7 +102,7 @@ bool PtsWaiter::updated(ChannelData *channel, int32 pts, int32 count, const MTPU
 	} else if (check(channel, pts, count)) {
 		return true;
 	}
-	_updateQueue.insert(ptsKey(SkippedUpdate, pts), update);
+	addSkipped(pts, update);
 	return false;
 }
 
@@ -107,11 +119,11 @@ bool PtsWaiter::updateAndApply(ChannelData *channel, int32 pts, int32 count, con
 	if (!updated(channel, pts, count, updates)) {
 		return false;
 	}
-	if (!_waitingForSkipped || _queue.isEmpty()) {
+	if (!_waitingForSkipped || _skipped.empty()) {
 		// Optimization - no need to put in queue and back.
 		Auth().api().applyUpdatesNoPtsCheck(updates);
 	} else {
-		_updatesQueue.insert(ptsKey(SkippedUpdates, pts), updates);
+		addSkipped(pts, updates);
 		applySkippedUpdates(channel);
 	}
 	return true;
@@ -121,11 +133,11 @@ bool PtsWaiter::updateAndApply(ChannelData *channel, int32 pts, int32 count, con
 	if (!updated(channel, pts, count, update)) {
 		return false;
 	}
-	if (!_waitingForSkipped || _queue.isEmpty()) {
+	if (!_waitingForSkipped || _skipped.empty()) {
 		// Optimization - no need to put in queue and back.
 		Auth().api().applyUpdateNoPtsCheck(update);
 	} else {
-		_updateQueue.insert(ptsKey(SkippedUpdate, pts), update);
+		addSkipped(pts, update);
 		applySkippedUpdates(channel);
 	}
 	return true;
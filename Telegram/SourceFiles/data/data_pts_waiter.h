@@ -7,10 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
-enum PtsSkippedQueue {
-	SkippedUpdate,
-	SkippedUpdates,
-};
+#include "base/variant.h"
 
 class PtsWaiter {
 public:
@@ -78,15 +75,20 @@ public:
 	void clearSkippedUpdates();
 
 private:
+	struct Skipped {
+		int32 pts = 0;
+		base::variant<MTPUpdate, MTPUpdates> data;
+	};
+
 	// Return false if need to save that update and apply later.
 	bool check(ChannelData *channel, int32 pts, int32 count);
 
-	uint64 ptsKey(PtsSkippedQueue queue, int32 pts);
+	void addSkipped(int32 pts, base::variant<MTPUpdate, MTPUpdates> &&data);
 	void checkForWaiting(ChannelData *channel);
 
-	QMap<uint64, PtsSkippedQueue> _queue;
-	QMap<uint64, MTPUpdate> _updateQueue;
-	QMap<uint64, MTPUpdates> _updatesQueue;
+	// Sorted by pts, the ones with the same pts in the order of arrival.
+	// Updates mostly come in order, so it is almost always an append.
+	std::vector<Skipped> _skipped;
 	int32 _good = 0;
 	int32 _last = 0;
 	int32 _count = 0;
@@ -94,6 +96,5 @@ private:
 	bool _requesting = false;
 	bool _waitingForSkipped = false;
 	bool _waitingForShortPoll = false;
-	uint32 _skippedKey = 0;
 
 };
@@ -46,6 +46,10 @@ namespace {
 
 constexpr auto kMaxNotifyCheckDelay = 24 * 3600 * TimeMs(1000);
 constexpr auto kMaxWallpaperSize = 10 * 1024 * 1024;
+constexpr auto kLoadedViewsLimit = 10000;
+constexpr auto kCheckLoadedHistoriesDelay = 5 * TimeMs(1000);
+constexpr auto kWebPagePreviewsLimit = 256;
+constexpr auto kWebPagePreviewLifetime = 3600 * TimeMs(1000);
 
 using ViewElement = HistoryView::Element;
 
@@ -63,6 +67,14 @@ const auto SmallLevels = QByteArray::fromRawData("sambcxydwi", 10);
 const auto ThumbnailLevels = QByteArray::fromRawData("mbcxasydwi", 10);
 const auto LargeLevels = QByteArray::fromRawData("yxwmsdcbai", 10);
 
+int CountLoadedViews(not_null<History*> history) {
+	auto result = 0;
+	for (const auto &block : history->blocks) {
+		result += int(block->messages.size());
+	}
+	return result;
+}
+
 void CheckForSwitchInlineButton(not_null<HistoryItem*> item) {
 	if (item->out() || !item->hasSwitchInlineButton()) {
 		return;
@@ -146,6 +158,7 @@ Session::Session(not_null<AuthSession*> session)
 	Local::cachePath(),
 	Local::cacheSettings()))
 , _selfDestructTimer([=] { checkSelfDestructItems(); })
+, _loadedHistoriesTimer([=] { checkLoadedHistories(); })
 , _a_sendActions(animation(this, &Session::step_typings))
 , _groups(this)
 , _unmuteByFinishedTimer([=] { unmuteByFinished(); }) {
@@ -157,6 +170,9 @@ Session::Session(not_null<AuthSession*> session)
 
 void Session::clear() {
 	_sendActions.clear();
+	_shownHistory = nullptr;
+	_historiesShownAt.clear();
+	_loadedHistoriesTimer.cancel();
 
 	for (const auto &[peerId, history] : _histories) {
 		history->unloadBlocks();
@@ -1571,6 +1587,63 @@ void Session::unreadEntriesChanged(
 	}
 }
 
+void Session::setShownHistory(History *history) {
+	const auto now = getms(true);
+	if (_shownHistory) {
+		_historiesShownAt[_shownHistory] = now;
+	}
+	_shownHistory = history;
+	if (history) {
+		_historiesShownAt[history] = now;
+	}
+	_loadedHistoriesTimer.callOnce(kCheckLoadedHistoriesDelay);
+}
+
+void Session::checkLoadedHistories() {
+	const auto shown = [&](not_null<History*> history) {
+		if (!_shownHistory) {
+			return false;
+		}
+		return (history == _shownHistory)
+			|| (history == _shownHistory->migrateFrom())
+			|| (history->migrateFrom() == _shownHistory);
+	};
+	auto loaded = std::vector<std::pair<TimeMs, not_null<History*>>>();
+	auto total = 0;
+	for (const auto &[history, shownAt] : _historiesShownAt) {
+		if (shown(history)) {
+			continue;
+		} else if (const auto count = CountLoadedViews(history)) {
+			loaded.emplace_back(shownAt, history);
+			total += count;
+		}
+	}
+	if (total <= kLoadedViewsLimit) {
+		return;
+	}
+	ranges::sort(loaded, std::less<>(), [](const auto &pair) {
+		return pair.first;
+	});
+	auto unloadedHistories = 0;
+	auto unloadedViews = 0;
+	for (const auto &[shownAt, history] : loaded) {
+		if (total <= kLoadedViewsLimit) {
+			break;
+		}
+		const auto count = CountLoadedViews(history);
+		history->unloadBlocks();
+		_historiesShownAt.remove(history);
+		total -= count;
+		unloadedViews += count;
+		++unloadedHistories;
+	}
+	LOG(("Data Info: unloaded %1 histories with %2 message views, "
+		"%3 views are still loaded."
+		).arg(unloadedHistories
+		).arg(unloadedViews
+		).arg(total));
+}
+
 void Session::selfDestructIn(not_null<HistoryItem*> item, TimeMs delay) {
 	_selfDestructItems.push_back(item->fullId());
 	if (!_selfDestructTimer.isActive()
@@ -2359,7 +2432,7 @@ not_null<PollData*> Session::processPoll(const MTPDmessageMediaPoll &data) {
 	const auto result = processPoll(data.vpoll);
 	const auto changed = result->applyResults(data.vresults);
 	if (changed) {
-		notifyPollUpdateDelayed(result);
+		notifyPollResultsUpdateDelayed(result);
 	}
 	return result;
 }
@@ -2374,7 +2447,7 @@ void Session::applyUpdate(const MTPDupdateMessagePoll &update) {
 			: i->second.get();
 	}();
 	if (updated && updated->applyResults(update.vresults)) {
-		notifyPollUpdateDelayed(updated);
+		notifyPollResultsUpdateDelayed(updated);
 	}
 }
 
@@ -2646,6 +2719,34 @@ HistoryItem *Session::findWebPageItem(not_null<WebPageData*> page) const {
 	return nullptr;
 }
 
+std::optional<WebPageId> Session::cachedWebPagePreview(
+		const QString &links) {
+	const auto i = _webpagePreviews.find(links);
+	if (i == end(_webpagePreviews)) {
+		return std::nullopt;
+	}
+	const auto now = getms(true);
+	if (i->second.received + kWebPagePreviewLifetime <= now) {
+		// Let the server update the preview from time to time.
+		_webpagePreviews.erase(i);
+		return std::nullopt;
+	}
+	i->second.lastUsed = now;
+	return i->second.id;
+}
+
+void Session::cacheWebPagePreview(const QString &links, WebPageId id) {
+	const auto now = getms(true);
+	_webpagePreviews[links] = WebPagePreview{ id, now, now };
+	if (int(_webpagePreviews.size()) > kWebPagePreviewsLimit) {
+		const auto oldest = ranges::min_element(
+			_webpagePreviews,
+			std::less<>(),
+			[](const auto &pair) { return pair.second.lastUsed; });
+		_webpagePreviews.erase(oldest);
+	}
+}
+
 QString Session::findContactPhone(not_null<UserData*> contact) const {
 	const auto result = contact->phone();
 	return result.isEmpty()
@@ -2668,7 +2769,8 @@ QString Session::findContactPhone(UserId contactId) const {
 bool Session::hasPendingWebPageGamePollNotification() const {
 	return !_webpagesUpdated.empty()
 		|| !_gamesUpdated.empty()
-		|| !_pollsUpdated.empty();
+		|| !_pollsUpdated.empty()
+		|| !_pollResultsUpdated.empty();
 }
 
 void Session::notifyWebPageUpdateDelayed(not_null<WebPageData*> page) {
@@ -2695,6 +2797,14 @@ void Session::notifyPollUpdateDelayed(not_null<PollData*> poll) {
 	}
 }
 
+void Session::notifyPollResultsUpdateDelayed(not_null<PollData*> poll) {
+	const auto invoke = !hasPendingWebPageGamePollNotification();
+	_pollResultsUpdated.insert(poll);
+	if (invoke) {
+		crl::on_main(_session, [=] { sendWebPageGamePollNotifications(); });
+	}
+}
+
 void Session::sendWebPageGamePollNotifications() {
 	for (const auto page : base::take(_webpagesUpdated)) {
 		const auto i = _webpageViews.find(page);
@@ -2711,6 +2821,16 @@ void Session::sendWebPageGamePollNotifications() {
 			}
 		}
 	}
+	for (const auto poll : base::take(_pollResultsUpdated)) {
+		if (_pollsUpdated.contains(poll)) {
+			continue; // Will be resized below.
+		}
+		if (const auto i = _pollViews.find(poll); i != _pollViews.end()) {
+			for (const auto view : i->second) {
+				requestViewRepaint(view);
+			}
+		}
+	}
 	for (const auto poll : base::take(_pollsUpdated)) {
 		if (const auto i = _pollViews.find(poll); i != _pollViews.end()) {
 			for (const auto view : i->second) {
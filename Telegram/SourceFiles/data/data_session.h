@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_notify_settings.h"
 #include "history/history_location_manager.h"
 #include "base/timer.h"
+#include "base/flat_hash_map.h"
 
 class Image;
 class HistoryItem;
@@ -331,6 +332,10 @@ public:
 
 	void selfDestructIn(not_null<HistoryItem*> item, TimeMs delay);
 
+	// Remembers when histories were shown, to unload blocks of the
+	// least recently shown ones when too many views are kept loaded.
+	void setShownHistory(History *history);
+
 	[[nodiscard]] not_null<PhotoData*> photo(PhotoId id);
 	not_null<PhotoData*> processPhoto(const MTPPhoto &data);
 	not_null<PhotoData*> processPhoto(const MTPDphoto &data);
@@ -478,12 +483,21 @@ public:
 		not_null<::Media::Clip::Reader*> reader);
 
 	HistoryItem *findWebPageItem(not_null<WebPageData*> page) const;
+
+	// Link previews for the message field text, shared between all chats.
+	// A zero id means that there is no preview for those links.
+	[[nodiscard]] std::optional<WebPageId> cachedWebPagePreview(
+		const QString &links);
+	void cacheWebPagePreview(const QString &links, WebPageId id);
 	QString findContactPhone(not_null<UserData*> contact) const;
 	QString findContactPhone(UserId contactId) const;
 
 	void notifyWebPageUpdateDelayed(not_null<WebPageData*> page);
 	void notifyGameUpdateDelayed(not_null<GameData*> game);
 	void notifyPollUpdateDelayed(not_null<PollData*> poll);
+
+	// Votes don't change the poll size, so only a repaint is requested.
+	void notifyPollResultsUpdateDelayed(not_null<PollData*> poll);
 	bool hasPendingWebPageGamePollNotification() const;
 	void sendWebPageGamePollNotifications();
 
@@ -552,6 +566,7 @@ private:
 	void setupChannelLeavingViewer();
 
 	void checkSelfDestructItems();
+	void checkLoadedHistories();
 	int computeUnreadBadge(
 		int full,
 		int muted,
@@ -721,23 +736,27 @@ private:
 	base::Timer _selfDestructTimer;
 	std::vector<FullMsgId> _selfDestructItems;
 
+	History *_shownHistory = nullptr;
+	base::flat_map<not_null<History*>, TimeMs> _historiesShownAt;
+	base::Timer _loadedHistoriesTimer;
+
 	// When typing in this history started.
 	base::flat_map<not_null<History*>, TimeMs> _sendActions;
 	BasicAnimation _a_sendActions;
 
-	std::unordered_map<
+	base::flat_hash_map<
 		PhotoId,
 		std::unique_ptr<PhotoData>> _photos;
 	std::unordered_map<
 		not_null<const PhotoData*>,
 		base::flat_set<not_null<HistoryItem*>>> _photoItems;
-	std::unordered_map<
+	base::flat_hash_map<
 		DocumentId,
 		std::unique_ptr<DocumentData>> _documents;
 	std::unordered_map<
 		not_null<const DocumentData*>,
 		base::flat_set<not_null<HistoryItem*>>> _documentItems;
-	std::unordered_map<
+	base::flat_hash_map<
 		WebPageId,
 		std::unique_ptr<WebPageData>> _webpages;
 	std::unordered_map<
@@ -749,10 +768,10 @@ private:
 	std::unordered_map<
 		LocationCoords,
 		std::unique_ptr<LocationData>> _locations;
-	std::unordered_map<
+	base::flat_hash_map<
 		PollId,
 		std::unique_ptr<PollData>> _polls;
-	std::unordered_map<
+	base::flat_hash_map<
 		GameId,
 		std::unique_ptr<GameData>> _games;
 	std::unordered_map<
@@ -771,9 +790,17 @@ private:
 		not_null<::Media::Clip::Reader*>,
 		not_null<ViewElement*>> _autoplayAnimations;
 
+	struct WebPagePreview {
+		WebPageId id = 0;
+		TimeMs received = 0;
+		TimeMs lastUsed = 0;
+	};
+	base::flat_map<QString, WebPagePreview> _webpagePreviews;
+
 	base::flat_set<not_null<WebPageData*>> _webpagesUpdated;
 	base::flat_set<not_null<GameData*>> _gamesUpdated;
 	base::flat_set<not_null<PollData*>> _pollsUpdated;
+	base::flat_set<not_null<PollData*>> _pollResultsUpdated;
 
 	std::deque<Dialogs::Key> _pinnedDialogs;
 	base::flat_map<FeedId, std::unique_ptr<Feed>> _feeds;
@@ -794,8 +821,8 @@ private:
 	std::unordered_set<not_null<const PeerData*>> _mutedPeers;
 	base::Timer _unmuteByFinishedTimer;
 
-	std::unordered_map<PeerId, std::unique_ptr<PeerData>> _peers;
-	std::unordered_map<PeerId, std::unique_ptr<History>> _histories;
+	base::flat_hash_map<PeerId, std::unique_ptr<PeerData>> _peers;
+	base::flat_hash_map<PeerId, std::unique_ptr<History>> _histories;
 
 	MessageIdsList _mimeForwardIds;
 
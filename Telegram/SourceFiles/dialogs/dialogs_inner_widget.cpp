@@ -13,7 +13,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/feed/history_feed_section.h"
 #include "history/history.h"
 #include "history/history_item.h"
+#include "history/view/history_view_element.h"
 #include "core/shortcuts.h"
+#include "core/startup_trace.h"
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/popup_menu.h"
 #include "ui/text_options.h"
@@ -247,6 +249,11 @@ void DialogsInner::paintRegion(Painter &p, const QRegion &region, bool paintingO
 
 	if (!App::main()) return;
 
+	// Write the startup trace (if enabled) after the first painted frame.
+	const auto traceGuard = gsl::finally([] {
+		Core::StartupTrace::Finish();
+	});
+
 	auto r = region.boundingRect();
 	if (!paintingOther) {
 		p.setClipRect(r);
@@ -1651,6 +1658,7 @@ void DialogsInner::handlePeerNameChange(
 	}
 	_contactsNoDialogs->peerNameChanged(peer, oldLetters);
 	_contacts->peerNameChanged(peer, oldLetters);
+	_filterNamesChanged = true;
 	update();
 }
 
@@ -1665,81 +1673,82 @@ void DialogsInner::applyFilterUpdate(QString newFilter, bool force) {
 		if (_filter.isEmpty() && !_searchFromUser) {
 			clearFilter();
 		} else {
-			QStringList::const_iterator fb = words.cbegin(), fe = words.cend(), fi;
+			const auto refine = !force && canRefineFilterResults(words);
+			auto previous = refine
+				? collectLocalFilterResults()
+				: std::vector<Dialogs::Row*>();
 
 			_state = State::Filtered;
 			_waitingForSearch = true;
 			_filterResults.clear();
 			_filterResultsGlobal.clear();
+			_filterWords = QStringList();
 			if (!_searchInChat && !words.isEmpty()) {
-				const Dialogs::List *toFilter = nullptr;
-				if (!_dialogs->isEmpty()) {
-					for (fi = fb; fi != fe; ++fi) {
-						auto found = _dialogs->filtered(fi->at(0));
-						if (found->isEmpty()) {
-							toFilter = nullptr;
-							break;
-						}
-						if (!toFilter || toFilter->size() > found->size()) {
-							toFilter = found;
+				const auto matches = [&](not_null<Dialogs::Row*> row) {
+					const auto &nameWords = row->entry()->chatListNameWords();
+					for (const auto &word : words) {
+						const auto found = ranges::find_if(
+							nameWords,
+							[&](const QString &name) {
+								return name.startsWith(word);
+							});
+						if (found == nameWords.end()) {
+							return false;
 						}
 					}
-				}
-				const Dialogs::List *toFilterContacts = nullptr;
-				if (!_contactsNoDialogs->isEmpty()) {
-					for (fi = fb; fi != fe; ++fi) {
-						auto found = _contactsNoDialogs->filtered(fi->at(0));
+					return true;
+				};
+				const auto smallestFiltered = [&](
+						not_null<const Dialogs::IndexedList*> list)
+				-> const Dialogs::List* {
+					if (list->isEmpty()) {
+						return nullptr;
+					}
+					const Dialogs::List *result = nullptr;
+					for (const auto &word : words) {
+						const auto found = list->filtered(word.at(0));
 						if (found->isEmpty()) {
-							toFilterContacts = nullptr;
-							break;
-						}
-						if (!toFilterContacts || toFilterContacts->size() > found->size()) {
-							toFilterContacts = found;
+							return nullptr;
+						} else if (!result || result->size() > found->size()) {
+							result = found;
 						}
 					}
-				}
-				_filterResults.reserve((toFilter ? toFilter->size() : 0)
-					+ (toFilterContacts ? toFilterContacts->size() : 0));
-				if (toFilter) {
-					for (const auto row : *toFilter) {
-						const auto &nameWords = row->entry()->chatListNameWords();
-						auto nb = nameWords.cbegin(), ne = nameWords.cend(), ni = nb;
-						for (fi = fb; fi != fe; ++fi) {
-							auto filterWord = *fi;
-							for (ni = nb; ni != ne; ++ni) {
-								if (ni->startsWith(filterWord)) {
-									break;
-								}
-							}
-							if (ni == ne) {
-								break;
-							}
-						}
-						if (fi == fe) {
+					return result;
+				};
+				if (refine) {
+					// Each new word continues an old one, so the new results
+					// are always a part of the previous ones.
+					_filterResults.reserve(previous.size());
+					for (const auto row : previous) {
+						if (matches(row)) {
 							_filterResults.push_back(row);
 						}
 					}
-				}
-				if (toFilterContacts) {
-					for (const auto row : *toFilterContacts) {
-						const auto &nameWords = row->entry()->chatListNameWords();
-						auto nb = nameWords.cbegin(), ne = nameWords.cend(), ni = nb;
-						for (fi = fb; fi != fe; ++fi) {
-							auto filterWord = *fi;
-							for (ni = nb; ni != ne; ++ni) {
-								if (ni->startsWith(filterWord)) {
-									break;
-								}
-							}
-							if (ni == ne) {
-								break;
+				} else {
+					const auto toFilter = smallestFiltered(_dialogs.get());
+					const auto toFilterContacts = smallestFiltered(
+						_contactsNoDialogs.get());
+					_filterResults.reserve((toFilter ? toFilter->size() : 0)
+						+ (toFilterContacts ? toFilterContacts->size() : 0));
+					if (toFilter) {
+						for (const auto row : *toFilter) {
+							if (matches(row)) {
+								_filterResults.push_back(row);
 							}
 						}
-						if (fi == fe) {
-							_filterResults.push_back(row);
+					}
+					if (toFilterContacts) {
+						for (const auto row : *toFilterContacts) {
+							if (matches(row)) {
+								_filterResults.push_back(row);
+							}
 						}
 					}
 				}
+				_filterWords = words;
+				_filterDialogsCount = _dialogs->size();
+				_filterContactsCount = _contactsNoDialogs->size();
+				_filterNamesChanged = false;
 			}
 			refresh(true);
 		}
@@ -1750,6 +1759,40 @@ void DialogsInner::applyFilterUpdate(QString newFilter, bool force) {
 	}
 }
 
+bool DialogsInner::canRefineFilterResults(const QStringList &words) const {
+	if (_state != State::Filtered
+		|| _searchInChat
+		|| _filterWords.isEmpty()
+		|| _filterNamesChanged
+		|| _filterDialogsCount != _dialogs->size()
+		|| _filterContactsCount != _contactsNoDialogs->size()
+		|| words.size() < _filterWords.size()) {
+		return false;
+	}
+	for (auto i = 0, count = int(_filterWords.size()); i != count; ++i) {
+		if (!words[i].startsWith(_filterWords[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::vector<Dialogs::Row*> DialogsInner::collectLocalFilterResults() const {
+	auto result = std::vector<Dialogs::Row*>();
+	result.reserve(_filterResults.size());
+	for (const auto row : _filterResults) {
+		const auto history = row->history();
+		const auto global = history
+			? _filterResultsGlobal.find(history->peer)
+			: _filterResultsGlobal.end();
+		if (global == _filterResultsGlobal.end()
+			|| global->second.get() != row) {
+			result.push_back(row);
+		}
+	}
+	return result;
+}
+
 void DialogsInner::onHashtagFilterUpdate(QStringRef newFilter) {
 	if (newFilter.isEmpty() || newFilter.at(0) != '#' || _searchInChat) {
 		_hashtagFilter = QString();
@@ -1783,6 +1826,73 @@ DialogsInner::~DialogsInner() {
 	clearSearchResults();
 }
 
+void DialogsInner::searchInLoaded() {
+	const auto history = _searchInChat.history();
+	const auto query = _filter.trimmed();
+	if (!history || query.isEmpty() || query.at(0) == '#') {
+		return;
+	}
+	const auto words = TextUtilities::PrepareSearchWords(query);
+	if (words.isEmpty()) {
+		return;
+	}
+	const auto matches = [&](not_null<HistoryItem*> item) {
+		if (!IsServerMsgId(item->id)
+			|| (_searchFromUser && item->from() != _searchFromUser)) {
+			return false;
+		}
+		const auto text = item->originalText().text;
+		if (text.isEmpty()) {
+			return false;
+		}
+		const auto textWords = TextUtilities::PrepareSearchWords(text);
+		for (const auto &word : words) {
+			const auto found = ranges::find_if(
+				textWords,
+				[&](const QString &textWord) {
+					return textWord.startsWith(word);
+				});
+			if (found == textWords.end()) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	// Show what we can find in the loaded messages, newest first, until
+	// the first page of the server results replaces it.
+	clearSearchResults(false);
+	const auto full = [&] {
+		return int(_searchResults.size()) >= SearchPerPage;
+	};
+	const auto collect = [&](not_null<History*> from) {
+		for (auto i = from->blocks.rbegin(); i != from->blocks.rend(); ++i) {
+			const auto &messages = (*i)->messages;
+			for (auto j = messages.rbegin(); j != messages.rend(); ++j) {
+				if (full()) {
+					return;
+				}
+				const auto item = (*j)->data();
+				if (matches(item)) {
+					_searchResults.push_back(
+						std::make_unique<Dialogs::FakeRow>(
+							_searchInChat,
+							item));
+				}
+			}
+		}
+	};
+	collect(history);
+	if (_searchInMigrated) {
+		collect(_searchInMigrated);
+	}
+	if (!_searchResults.empty()) {
+		_searchedCount = int(_searchResults.size());
+		_waitingForSearch = false;
+	}
+	refresh();
+}
+
 void DialogsInner::clearSearchResults(bool clearPeerSearchResults) {
 	if (clearPeerSearchResults) _peerSearchResults.clear();
 	_searchResults.clear();
@@ -2049,12 +2159,9 @@ void DialogsInner::peerSearchReceived(
 			if (alreadyAdded(peer)) {
 				continue;
 			}
-			const auto prev = nullptr, next = nullptr;
 			const auto position = 0;
 			auto row = std::make_unique<Dialogs::Row>(
 				peer->owner().history(peer),
-				prev,
-				next,
 				position);
 			const auto [i, ok] = _filterResultsGlobal.emplace(
 				peer,
@@ -2292,6 +2399,7 @@ void DialogsInner::clearFilter() {
 		_lastSearchPeer = 0;
 		_lastSearchId = _lastSearchMigratedId = 0;
 		_filter = QString();
+		_filterWords = QStringList();
 		refresh(true);
 	}
 }
@@ -37,6 +37,7 @@ public:
 	void dialogsReceived(const QVector<MTPDialog> &dialogs);
 	void addSavedPeersAfter(const QDateTime &date);
 	void addAllSavedPeers();
+	void searchInLoaded();
 	bool searchReceived(
 		const QVector<MTPMessage> &result,
 		DialogsSearchRequestType type,
@@ -184,6 +185,8 @@ private:
 	void handlePeerNameChange(
 		not_null<PeerData*> peer,
 		const base::flat_set<QChar> &oldLetters);
+	bool canRefineFilterResults(const QStringList &words) const;
+	std::vector<Dialogs::Row*> collectLocalFilterResults() const;
 	bool uniqueSearchResults() const;
 	bool hasHistoryInResults(not_null<History*> history) const;
 
@@ -330,6 +333,13 @@ private:
 	bool _hashtagDeletePressed = false;
 
 	std::vector<Dialogs::Row*> _filterResults;
+
+	// Words of the last local filtering, if its results can be refined.
+	QStringList _filterWords;
+	int _filterDialogsCount = 0;
+	int _filterContactsCount = 0;
+	bool _filterNamesChanged = false;
+
 	base::flat_map<
 		not_null<PeerData*>,
 		std::unique_ptr<Dialogs::Row>> _filterResultsGlobal;
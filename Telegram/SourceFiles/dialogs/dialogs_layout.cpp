@@ -29,31 +29,45 @@ namespace {
 // Show all dates that are in the last 20 hours in time format.
 constexpr int kRecentlyInSeconds = 20 * 3600;
 
-void paintRowTopRight(Painter &p, const QString &text, QRect &rectForName, bool active, bool selected) {
-	const auto width = st::dialogsDateFont->width(text);
+void paintRowTopRight(Painter &p, const QString &text, int width, QRect &rectForName, bool active, bool selected) {
 	rectForName.setWidth(rectForName.width() - width - st::dialogsDateSkip);
 	p.setFont(st::dialogsDateFont);
 	p.setPen(active ? st::dialogsDateFgActive : (selected ? st::dialogsDateFgOver : st::dialogsDateFg));
 	p.drawText(rectForName.left() + rectForName.width() + st::dialogsDateSkip, rectForName.top() + st::msgNameFont->height - st::msgDateFont->descent, text);
 }
 
-void paintRowDate(Painter &p, QDateTime date, QRect &rectForName, bool active, bool selected) {
-	auto now = QDateTime::currentDateTime();
-	auto lastTime = date;
-	auto nowDate = now.date();
-	auto lastDate = lastTime.date();
+void fillRowDate(RowDateCache &cache, TimeId date) {
+	const auto now = QDateTime::currentDateTime();
+	const auto lastTime = ParseDateTime(date);
+	const auto nowDate = now.date();
+	const auto lastDate = lastTime.date();
+	const auto dayEnd = [](const QDate &day) {
+		return ServerTimeFromParsed(QDateTime(day.addDays(1)));
+	};
 
-	QString dt;
-	bool wasSameDay = (lastDate == nowDate);
-	bool wasRecently = qAbs(lastTime.secsTo(now)) < kRecentlyInSeconds;
+	const auto wasSameDay = (lastDate == nowDate);
+	const auto wasRecently = qAbs(lastTime.secsTo(now)) < kRecentlyInSeconds;
 	if (wasSameDay || wasRecently) {
-		dt = lastTime.toString(cTimeFormat());
+		cache.text = lastTime.toString(cTimeFormat());
+		cache.validTill = std::max(
+			dayEnd(lastDate),
+			date + kRecentlyInSeconds);
 	} else if (lastDate.year() == nowDate.year() && lastDate.weekNumber() == nowDate.weekNumber()) {
-		dt = langDayOfWeek(lastDate);
+		cache.text = langDayOfWeek(lastDate);
+		cache.validTill = dayEnd(nowDate);
 	} else {
-		dt = lastDate.toString(qsl("d.MM.yy"));
+		cache.text = lastDate.toString(qsl("d.MM.yy"));
+		cache.validTill = std::numeric_limits<TimeId>::max();
+	}
+	cache.date = date;
+	cache.width = st::dialogsDateFont->width(cache.text);
+}
+
+void paintRowDate(Painter &p, TimeId date, RowDateCache &cache, QRect &rectForName, bool active, bool selected) {
+	if (cache.date != date || unixtime() >= cache.validTill) {
+		fillRowDate(cache, date);
 	}
-	paintRowTopRight(p, dt, rectForName, active, selected);
+	paintRowTopRight(p, cache.text, cache.width, rectForName, active, selected);
 }
 
 void PaintNarrowCounter(
@@ -166,12 +180,13 @@ template <typename PaintItemCallback, typename PaintCounterCallback>
 void paintRow(
 		Painter &p,
 		not_null<const RippleRow*> row,
+		RowDateCache &dateCache,
 		not_null<Entry*> entry,
 		Dialogs::Key chat,
 		PeerData *from,
 		HistoryItem *item,
 		const Data::Draft *draft,
-		QDateTime date,
+		TimeId date,
 		int fullWidth,
 		base::flags<Flag> flags,
 		TimeMs ms,
@@ -245,7 +260,8 @@ void paintRow(
 		&& !(flags & (Flag::SearchResult | Flag::FeedSearchResult));
 	if (promoted) {
 		const auto text = lang(lng_proxy_sponsor);
-		paintRowTopRight(p, text, rectForName, active, selected);
+		const auto width = st::dialogsDateFont->width(text);
+		paintRowTopRight(p, text, width, rectForName, active, selected);
 	} else if (from && !(flags & Flag::FeedSearchResult)) {
 		if (const auto chatTypeIcon = ChatTypeIcon(from, active, selected)) {
 			chatTypeIcon->paint(p, rectForName.topLeft(), fullWidth);
@@ -264,7 +280,7 @@ void paintRow(
 		|| (supportMode
 			&& Auth().supportHelper().isOccupiedBySomeone(history))) {
 		if (!promoted) {
-			paintRowDate(p, date, rectForName, active, selected);
+			paintRowDate(p, date, dateCache, rectForName, active, selected);
 		}
 
 		auto availableWidth = namewidth;
@@ -308,7 +324,7 @@ void paintRow(
 		}
 	} else if (!item->isEmpty()) {
 		if (!promoted) {
-			paintRowDate(p, date, rectForName, active, selected);
+			paintRowDate(p, date, dateCache, rectForName, active, selected);
 		}
 
 		paintItemCallback(nameleft, namewidth);
@@ -552,13 +568,11 @@ void RowPainter::paint(
 	const auto displayDate = [item, cloudDraft] {
 		if (item) {
 			if (cloudDraft) {
-				return (item->date() > cloudDraft->date)
-					? ItemDateTime(item)
-					: ParseDateTime(cloudDraft->date);
+				return std::max(item->date(), cloudDraft->date);
 			}
-			return ItemDateTime(item);
+			return item->date();
 		}
-		return cloudDraft ? ParseDateTime(cloudDraft->date) : QDateTime();
+		return cloudDraft ? cloudDraft->date : TimeId(0);
 	}();
 	const auto displayMentionBadge = history
 		? history->hasUnreadMentions()
@@ -649,6 +663,7 @@ void RowPainter::paint(
 	paintRow(
 		p,
 		row,
+		row->_dateCache,
 		entry,
 		row->key(),
 		from,
@@ -766,12 +781,13 @@ void RowPainter::paint(
 	paintRow(
 		p,
 		row,
+		row->_dateCache,
 		history,
 		history,
 		from,
 		item,
 		cloudDraft,
-		ItemDateTime(item),
+		item->date(),
 		fullWidth,
 		flags,
 		ms,
@@ -14,97 +14,45 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Dialogs {
 
-List::List(SortMode sortMode)
-: _last(std::make_unique<Row>(nullptr))
-, _begin(_last.get())
-, _end(_last.get())
-, _sortMode(sortMode)
-, _current(_last.get()) {
+List::List(SortMode sortMode) : _sortMode(sortMode) {
 }
 
-void List::adjustCurrent(int32 y, int32 h) const {
-	if (isEmpty()) return;
+List::const_iterator List::cfind(Row *value) const {
+	return value
+		? const_iterator(_rows.cbegin() + value->pos())
+		: cend();
+}
 
-	int32 pos = (y > 0) ? (y / h) : 0;
-	while (_current->_pos > pos && _current != _begin) {
-		_current = _current->_prev;
-	}
-	while (_current->_pos + 1 <= pos && _current->_next != _end) {
-		_current = _current->_next;
+List::const_iterator List::cfind(int y, int h) const {
+	if (isEmpty()) {
+		return cend();
 	}
+	const auto pos = (y > 0) ? (y / h) : 0;
+	return const_iterator(_rows.cbegin() + std::min(pos, size() - 1));
 }
 
 Row *List::addToEnd(Key key) {
-	const auto result = new Row(key, _end->_prev, _end, _end->_pos);
-	_end->_pos++;
-	if (_begin == _end) {
-		_begin = _current = result;
-	} else {
-		_end->_prev->_next = result;
-	}
+	_rows.push_back(std::make_unique<Row>(key, size()));
+	const auto result = _rows.back().get();
 	_rowByKey.emplace(key, result);
-	++_count;
-	_end->_prev = result;
 	if (_sortMode == SortMode::Date) {
 		adjustByPos(result);
 	}
 	return result;
 }
 
-bool List::insertBefore(Row *row, Row *before) {
-	if (row == before) {
-		return false;
-	}
-
-	if (_current == row) {
-		_current = row->_prev;
-	}
-
-	const auto updateTill = row->_prev;
-	remove(row);
-
-	// insert row
-	row->_next = before; // update row
-	row->_prev = before->_prev;
-	row->_next->_prev = row; // update row->next
-	if (row->_prev) { // update row->prev
-		row->_prev->_next = row;
+void List::move(int from, int to) {
+	const auto i = _rows.begin();
+	if (from < to) {
+		std::rotate(i + from, i + from + 1, i + to + 1);
+	} else if (from > to) {
+		std::rotate(i + to, i + from, i + from + 1);
 	} else {
-		_begin = row;
+		return;
 	}
-
-	// update pos
-	for (auto n = row; n != updateTill; n = n->_next) {
-		n->_next->_pos++;
-		row->_pos--;
-	}
-	return true;
-}
-
-bool List::insertAfter(Row *row, Row *after) {
-	if (row == after) {
-		return false;
-	}
-
-	if (_current == row) {
-		_current = row->_next;
-	}
-
-	const auto updateFrom = row->_next;
-	remove(row);
-
-	// insert row
-	row->_prev = after; // update row
-	row->_next = after->_next;
-	row->_prev->_next = row; // update row->prev
-	row->_next->_prev = row; // update row->next
-
-	// update pos
-	for (auto n = updateFrom; n != row; n = n->_next) {
-		n->_pos--;
-		row->_pos++;
+	for (auto pos = std::min(from, to); pos <= std::max(from, to); ++pos) {
+		_rows[pos]->_pos = pos;
 	}
-	return true;
 }
 
 Row *List::adjustByName(Key key) {
@@ -115,18 +63,22 @@ Row *List::adjustByName(Key key) {
 
 	const auto row = i->second;
 	const auto name = key.entry()->chatListName();
-	auto change = row;
-	while (change->_prev
-		&& change->_prev->entry()->chatListName().compare(name, Qt::CaseInsensitive) < 0) {
-		change = change->_prev;
-	}
-	if (!insertBefore(row, change)) {
-		while (change->_next != _end
-			&& change->_next->entry()->chatListName().compare(name, Qt::CaseInsensitive) < 0) {
-			change = change->_next;
+	const auto nameAt = [&](int pos) {
+		return _rows[pos]->entry()->chatListName();
+	};
+	const auto from = row->pos();
+	auto to = from;
+	while (to > 0
+		&& nameAt(to - 1).compare(name, Qt::CaseInsensitive) < 0) {
+		--to;
+	}
+	if (to == from) {
+		while (to + 1 < size()
+			&& nameAt(to + 1).compare(name, Qt::CaseInsensitive) < 0) {
+			++to;
 		}
-		insertAfter(row, change);
 	}
+	move(from, to);
 	return row;
 }
 
@@ -136,43 +88,44 @@ Row *List::addByName(Key key) {
 	}
 
 	const auto row = addToEnd(key);
-	auto change = row;
 	const auto name = key.entry()->chatListName();
-	while (change->_prev
-		&& change->_prev->entry()->chatListName().compare(name, Qt::CaseInsensitive) > 0) {
-		change = change->_prev;
-	}
-	if (!insertBefore(row, change)) {
-		while (change->_next != _end
-			&& change->_next->entry()->chatListName().compare(name, Qt::CaseInsensitive) < 0) {
-			change = change->_next;
-		}
-		insertAfter(row, change);
-	}
+	const auto nameAt = [&](int pos) {
+		return _rows[pos]->entry()->chatListName();
+	};
+	const auto from = row->pos();
+	auto to = from;
+	while (to > 0
+		&& nameAt(to - 1).compare(name, Qt::CaseInsensitive) > 0) {
+		--to;
+	}
+	move(from, to);
 	return row;
 }
 
 void List::adjustByPos(Row *row) {
-	if (_sortMode != SortMode::Date || !_begin) return;
-
-	Row *change = row;
-	if (change != _begin && _begin->sortKey() < row->sortKey()) {
-		change = _begin;
-	} else {
-		while (change->_prev && change->_prev->sortKey() < row->sortKey()) {
-			change = change->_prev;
-		}
-	}
-	if (!insertBefore(row, change)) {
-		if (change->_next != _end && _end->_prev->sortKey() > row->sortKey()) {
-			change = _end->_prev;
-		} else {
-			while (change->_next != _end && change->_next->sortKey() > row->sortKey()) {
-				change = change->_next;
-			}
-		}
-		insertAfter(row, change);
-	}
+	if (_sortMode != SortMode::Date || isEmpty()) return;
+
+	// All other rows are sorted by the key, find the place by bisection.
+	const auto key = row->sortKey();
+	const auto from = row->pos();
+	const auto i = _rows.begin() + from;
+	const auto above = std::partition_point(
+		_rows.begin(),
+		i,
+		[&](const std::unique_ptr<Row> &other) {
+			return (other->sortKey() >= key);
+		});
+	if (above != i) {
+		move(from, int(above - _rows.begin()));
+		return;
+	}
+	const auto below = std::partition_point(
+		i + 1,
+		_rows.end(),
+		[&](const std::unique_ptr<Row> &other) {
+			return (other->sortKey() > key);
+		});
+	move(from, int(below - _rows.begin()) - 1);
 }
 
 bool List::moveToTop(Key key) {
@@ -181,7 +134,7 @@ bool List::moveToTop(Key key) {
 		return false;
 	}
 
-	insertBefore(i->second, _begin);
+	move(i->second->pos(), 0);
 	return true;
 }
 
@@ -196,39 +149,18 @@ bool List::del(Key key, Row *replacedBy) {
 		emit App::main()->dialogRowReplaced(row, replacedBy);
 	}
 
-	if (row == _current) {
-		_current = row->_next;
-	}
-	for (auto change = row->_next; change != _end; change = change->_next) {
-		--change->_pos;
-	}
-	--_end->_pos;
-	remove(row);
-	delete row;
-	--_count;
+	const auto pos = row->pos();
 	_rowByKey.erase(i);
-
-	return true;
-}
-
-void List::remove(Row *row) {
-	row->_next->_prev = row->_prev; // update row->next
-	if (row->_prev) { // update row->prev
-		row->_prev->_next = row->_next;
-	} else {
-		_begin = row->_next;
+	_rows.erase(_rows.begin() + pos);
+	for (auto j = pos, till = size(); j != till; ++j) {
+		_rows[j]->_pos = j;
 	}
+	return true;
 }
 
 void List::clear() {
-	while (_begin != _end) {
-		_current = _begin;
-		_begin = _begin->_next;
-		delete _current;
-	}
-	_current = _begin;
 	_rowByKey.clear();
-	_count = 0;
+	_rows.clear();
 }
 
 List::~List() {
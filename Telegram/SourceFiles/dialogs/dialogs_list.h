@@ -15,13 +15,15 @@ namespace Dialogs {
 enum class SortMode;
 
 class List {
+	using Rows = std::vector<std::unique_ptr<Row>>;
+
 public:
 	List(SortMode sortMode);
 	List(const List &other) = delete;
 	List &operator=(const List &other) = delete;
 
 	int size() const {
-		return _count;
+		return _rows.size();
 	}
 	bool isEmpty() const {
 		return size() == 0;
@@ -47,7 +49,6 @@ public:
 	bool moveToTop(Key key);
 	void adjustByPos(Row *row);
 	bool del(Key key, Row *replacedBy = nullptr);
-	void remove(Row *row);
 	void clear();
 
 	class const_iterator {
@@ -56,71 +57,53 @@ public:
 		using pointer = Row**;
 		using reference = Row*&;
 
-		explicit const_iterator(Row *p) : _p(p) {
+		explicit const_iterator(Rows::const_iterator i) : _i(i) {
 		}
-		inline Row* operator*() const { return _p; }
-		inline Row* const* operator->() const { return &_p; }
-		inline bool operator==(const const_iterator &other) const { return _p == other._p; }
+		inline Row* operator*() const { return _i->get(); }
+		inline bool operator==(const const_iterator &other) const { return _i == other._i; }
 		inline bool operator!=(const const_iterator &other) const { return !(*this == other); }
-		inline const_iterator &operator++() { _p = next(_p); return *this; }
+		inline const_iterator &operator++() { ++_i; return *this; }
 		inline const_iterator operator++(int) { const_iterator result(*this); ++(*this); return result; }
-		inline const_iterator &operator--() { _p = prev(_p); return *this; }
+		inline const_iterator &operator--() { --_i; return *this; }
 		inline const_iterator operator--(int) { const_iterator result(*this); --(*this); return result; }
 		inline const_iterator operator+(int j) const { const_iterator result = *this; return result += j; }
 		inline const_iterator operator-(int j) const { const_iterator result = *this; return result -= j; }
-		inline const_iterator &operator+=(int j) { if (j < 0) return (*this -= (-j)); while (j--) ++*this; return *this; }
-		inline const_iterator &operator-=(int j) { if (j < 0) return (*this += (-j)); while (j--) --*this; return *this; }
+		inline const_iterator &operator+=(int j) { _i += j; return *this; }
+		inline const_iterator &operator-=(int j) { _i -= j; return *this; }
 
 	private:
-		Row *_p;
+		Rows::const_iterator _i;
 		friend class List;
 
 	};
 	friend class const_iterator;
 	using iterator = const_iterator;
 
-	const_iterator cbegin() const { return const_iterator(_begin); }
-	const_iterator cend() const { return const_iterator(_end); }
+	const_iterator cbegin() const { return const_iterator(_rows.cbegin()); }
+	const_iterator cend() const { return const_iterator(_rows.cend()); }
 	const_iterator begin() const { return cbegin(); }
 	const_iterator end() const { return cend(); }
-	iterator begin() { return iterator(_begin); }
-	iterator end() { return iterator(_end); }
-	const_iterator cfind(Row *value) const { return value ? const_iterator(value) : cend(); }
+	iterator begin() { return cbegin(); }
+	iterator end() { return cend(); }
+	const_iterator cfind(Row *value) const;
 	const_iterator find(Row *value) const { return cfind(value); }
-	iterator find(Row *value) { return value ? iterator(value) : end(); }
-	const_iterator cfind(int y, int h) const {
-		adjustCurrent(y, h);
-		return iterator(_current);
-	}
+	iterator find(Row *value) { return cfind(value); }
+	const_iterator cfind(int y, int h) const;
 	const_iterator find(int y, int h) const { return cfind(y, h); }
-	iterator find(int y, int h) {
-		adjustCurrent(y, h);
-		return iterator(_current);
-	}
+	iterator find(int y, int h) { return cfind(y, h); }
 
 	~List();
 
 private:
-	void adjustCurrent(int y, int h) const;
-	bool insertBefore(Row *row, Row *before);
-	bool insertAfter(Row *row, Row *after);
-	static Row *next(Row *row) {
-		return row->_next;
-	}
-	static Row *prev(Row *row) {
-		return row->_prev;
-	}
+	// Moves the row from one position to another shifting rows between.
+	void move(int from, int to);
 
-	std::unique_ptr<Row> _last;
-	Row *_begin;
-	Row *_end;
 	SortMode _sortMode;
-	int _count = 0;
 
+	// Rows in the order they are shown, each knows its index as pos().
+	Rows _rows;
 	std::map<Key, not_null<Row*>> _rowByKey;
 
-	mutable Row *_current; // cache
-
 };
 
 } // namespace Dialogs
@@ -37,16 +37,19 @@ private:
 
 };
 
+// Date text in the top right corner of a row, it is computed again only
+// when the date changes or when "now" leaves the period it was made for.
+struct RowDateCache {
+	TimeId date = 0;
+	TimeId validTill = 0;
+	QString text;
+	int width = 0;
+};
+
 class List;
 class Row : public RippleRow {
 public:
-	explicit Row(std::nullptr_t) {
-	}
-	Row(Key key, Row *prev, Row *next, int pos)
-	: _id(key)
-	, _prev(prev)
-	, _next(next)
-	, _pos(pos) {
+	Row(Key key, int pos) : _id(key), _pos(pos) {
 	}
 
 	Key key() const {
@@ -71,11 +74,11 @@ public:
 
 private:
 	friend class List;
+	friend class Layout::RowPainter;
 
 	Key _id;
-	Row *_prev = nullptr;
-	Row *_next = nullptr;
 	int _pos = 0;
+	mutable RowDateCache _dateCache;
 
 };
 
@@ -97,6 +100,7 @@ private:
 	not_null<HistoryItem*> _item;
 	mutable const HistoryItem *_cacheFor = nullptr;
 	mutable Text _cache;
+	mutable RowDateCache _dateCache;
 
 };
 
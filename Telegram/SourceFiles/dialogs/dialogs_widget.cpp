@@ -735,6 +735,7 @@ bool DialogsWidget::searchForPeersRequired(const QString &query) const {
 
 void DialogsWidget::onNeedSearchMessages() {
 	if (!onSearchMessages(true)) {
+		_inner->searchInLoaded();
 		_searchTimer.start(AutoSearchTimeout);
 	}
 }
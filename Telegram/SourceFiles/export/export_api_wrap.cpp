@@ -14,16 +14,19 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/rpc_sender.h"
 #include "base/value_ordering.h"
 #include "base/bytes.h"
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
 #include <set>
 #include <deque>
+#include <list>
 
 namespace Export {
 namespace {
 
 constexpr auto kUserpicsSliceLimit = 100;
 constexpr auto kFileChunkSize = 128 * 1024;
-constexpr auto kFileRequestsCount = 2;
-constexpr auto kFileNextRequestDelay = TimeMs(20);
+constexpr auto kFileRequestsCount = 4;
 constexpr auto kChatsSliceLimit = 100;
 constexpr auto kMessagesSliceLimit = 100;
 constexpr auto kTopPeerSliceLimit = 100;
@@ -97,12 +100,57 @@ public:
 	LoadedFileCache(int limit);
 
 	void save(const Location &location, const QString &relativePath);
-	std::optional<QString> find(const Location &location) const;
+
+	// Marks the found file as recently used.
+	std::optional<QString> find(const Location &location);
 
 private:
+	struct Entry {
+		QString relativePath;
+		std::list<LocationKey>::iterator position;
+	};
+
 	int _limit = 0;
-	std::map<LocationKey, QString> _map;
-	std::deque<LocationKey> _list;
+	std::map<LocationKey, Entry> _map;
+	std::list<LocationKey> _list;
+
+};
+
+// Append-only list of exported files and chats, one JSON object per line.
+// Files of the latest previous export in the same folder are copied
+// instead of being loaded again.
+class ApiWrap::Manifest {
+public:
+	using Location = Data::FileLocation;
+	struct PreviousFile {
+		QString path;
+		int size = 0;
+		QByteArray hash;
+	};
+
+	explicit Manifest(const QString &folder);
+
+	void loadPrevious();
+	std::optional<PreviousFile> findPrevious(const Location &location) const;
+
+	void fileSaved(
+		const Location &location,
+		const QString &relativePath,
+		int size,
+		const QByteArray &hash);
+	void chatExported(Data::PeerId peerId, int32 largestId);
+
+	static QString Filename();
+
+private:
+	QString findPreviousFolder() const;
+	void readPrevious(const QString &folder);
+	void write(const QJsonObject &object);
+
+	QString _folder;
+	Output::File _file;
+	std::map<LocationKey, PreviousFile> _previous;
+	bool _failed = false;
 
 };
 
@@ -158,6 +206,7 @@ struct ApiWrap::FileProcess {
 	Data::FileLocation location;
 	int offset = 0;
 	int size = 0;
+	QCryptographicHash hash{ QCryptographicHash::Md5 };
 
 	struct Request {
 		int offset = 0;
@@ -210,6 +259,13 @@ struct ApiWrap::ChatProcess {
 	std::optional<Data::MessagesSlice> slice;
 	bool lastSlice = false;
 	int fileIndex = 0;
+	int32 largestExportedId = 0;
+
+	// The next slice is requested while files of the current are loaded.
+	std::optional<Data::MessagesSlice> preloaded;
+	bool preloadedLast = false;
+	bool preloading = false;
+	bool waitingPreloaded = false;
 };
 
 
@@ -300,27 +356,160 @@ void ApiWrap::LoadedFileCache::save(
 		return;
 	}
 	const auto key = ComputeLocationKey(location);
-	_map[key] = relativePath;
-	_list.push_back(key);
+	if (const auto i = _map.find(key); i != end(_map)) {
+		i->second.relativePath = relativePath;
+		_list.splice(end(_list), _list, i->second.position);
+		return;
+	}
+	_map.emplace(key, Entry{
+		relativePath,
+		_list.insert(end(_list), key) });
 	if (_list.size() > _limit) {
-		const auto key = _list.front();
+		_map.erase(_list.front());
 		_list.pop_front();
-		_map.erase(key);
 	}
 }
 
 std::optional<QString> ApiWrap::LoadedFileCache::find(
-		const Location &location) const {
+		const Location &location) {
 	if (!location) {
 		return std::nullopt;
 	}
 	const auto key = ComputeLocationKey(location);
 	if (const auto i = _map.find(key); i != end(_map)) {
-		return i->second;
+		_list.splice(end(_list), _list, i->second.position);
+		return i->second.relativePath;
 	}
 	return std::nullopt;
 }
 
+ApiWrap::Manifest::Manifest(const QString &folder)
+: _folder(folder)
+, _file(folder + Filename(), nullptr) {
+}
+
+QString ApiWrap::Manifest::Filename() {
+	return "export_manifest.jsonl";
+}
+
+void ApiWrap::Manifest::loadPrevious() {
+	const auto folder = findPreviousFolder();
+	if (folder.isEmpty()) {
+		return;
+	}
+	readPrevious(folder);
+	LOG(("Export Info: %1 files of the previous export found in '%2'."
+		).arg(_previous.size()
+		).arg(folder));
+}
+
+QString ApiWrap::Manifest::findPreviousFolder() const {
+	// Previous export could be in the chosen folder itself
+	// or in one of its subfolders, like the current one.
+	auto parent = QDir(_folder);
+	if (!parent.cdUp()) {
+		return QString();
+	}
+	auto candidates = QStringList(parent.absolutePath());
+	const auto mode = QDir::Dirs | QDir::NoDotAndDotDot;
+	for (const auto &info : parent.entryInfoList(mode)) {
+		candidates.push_back(info.absoluteFilePath());
+	}
+	const auto current = QDir(_folder).absolutePath();
+	auto result = QString();
+	auto resultModified = QDateTime();
+	for (const auto &candidate : candidates) {
+		if (candidate == current) {
+			continue;
+		}
+		const auto info = QFileInfo(candidate + '/' + Filename());
+		if (info.exists()
+			&& (result.isEmpty() || info.lastModified() > resultModified)) {
+			result = candidate + '/';
+			resultModified = info.lastModified();
+		}
+	}
+	return result;
+}
+
+void ApiWrap::Manifest::readPrevious(const QString &folder) {
+	QFile f(folder + Filename());
+	if (!f.open(QIODevice::ReadOnly)) {
+		return;
+	}
+	while (!f.atEnd()) {
+		const auto document = QJsonDocument::fromJson(f.readLine());
+		const auto file = document.object().value("file").toObject();
+		const auto relativePath = file.value("path").toString();
+		if (relativePath.isEmpty()) {
+			continue;
+		}
+		auto key = LocationKey();
+		key.type = file.value("type").toString().toULongLong();
+		key.id = file.value("id").toString().toULongLong();
+		_previous[key] = PreviousFile{
+			folder + relativePath,
+			file.value("size").toInt(),
+			file.value("md5").toString().toLatin1() };
+	}
+}
+
+auto ApiWrap::Manifest::findPrevious(const Location &location) const
+-> std::optional<PreviousFile> {
+	if (!location) {
+		return std::nullopt;
+	}
+	const auto i = _previous.find(ComputeLocationKey(location));
+	if (i == end(_previous)
+		|| !i->second.size
+		|| QFileInfo(i->second.path).size() != i->second.size) {
+		return std::nullopt;
+	}
+	return i->second;
+}
+
+void ApiWrap::Manifest::fileSaved(
+		const Location &location,
+		const QString &relativePath,
+		int size,
+		const QByteArray &hash) {
+	if (!location) {
+		return;
+	}
+	const auto key = ComputeLocationKey(location);
+	auto file = QJsonObject();
+	file.insert("type", QString::number(key.type));
+	file.insert("id", QString::number(key.id));
+	file.insert("path", relativePath);
+	file.insert("size", size);
+	file.insert("md5", QString::fromLatin1(hash));
+	auto object = QJsonObject();
+	object.insert("file", file);
+	write(object);
+}
+
+void ApiWrap::Manifest::chatExported(Data::PeerId peerId, int32 largestId) {
+	auto chat = QJsonObject();
+	chat.insert("peer", QString::number(peerId));
+	chat.insert("largest_id", largestId);
+	auto object = QJsonObject();
+	object.insert("chat", chat);
+	write(object);
+}
+
+void ApiWrap::Manifest::write(const QJsonObject &object) {
+	if (_failed) {
+		return;
+	}
+	auto line = QJsonDocument(object).toJson(QJsonDocument::Compact);
+	line.append('\n');
+	const auto result = _file.writeBlock(line);
+	if (!result || !_file.flush()) {
+		LOG(("Export Error: Could not write the export manifest."));
+		_failed = true;
+	}
+}
+
 ApiWrap::FileProcess::FileProcess(const QString &path, Output::Stats *stats)
 : file(path, stats) {
 }
@@ -399,6 +588,8 @@ void ApiWrap::startExport(
 
 	_settings = std::make_unique<Settings>(settings);
 	_stats = stats;
+	_manifest = std::make_unique<Manifest>(_settings->path);
+	_manifest->loadPrevious();
 	_startProcess = std::make_unique<StartProcess>();
 	_startProcess->done = std::move(done);
 
@@ -1334,6 +1525,53 @@ void ApiWrap::requestChatMessages(
 	}
 }
 
+void ApiWrap::preloadMessagesSlice() {
+	Expects(_chatProcess != nullptr);
+	Expects(_chatProcess->slice.has_value());
+	Expects(!_chatProcess->preloading);
+	Expects(!_chatProcess->preloaded.has_value());
+
+	if (_chatProcess->lastSlice) {
+		return;
+	}
+	_chatProcess->preloading = true;
+	requestChatMessages(
+		_chatProcess->info.splits[_chatProcess->localSplitIndex],
+		_chatProcess->slice->list.back().id + 1,
+		-kMessagesSliceLimit,
+		kMessagesSliceLimit,
+		[=](const MTPmessages_Messages &result) {
+		Expects(_chatProcess != nullptr);
+
+		_chatProcess->preloading = false;
+		result.match([&](const MTPDmessages_messagesNotModified &data) {
+			error("Unexpected messagesNotModified received.");
+		}, [&](const auto &data) {
+			_chatProcess->preloadedLast
+				= MTPDmessages_messages::Is<decltype(data)>();
+			_chatProcess->preloaded = Data::ParseMessagesSlice(
+				_chatProcess->context,
+				data.vmessages,
+				data.vusers,
+				data.vchats,
+				_chatProcess->info.relativePath);
+			if (base::take(_chatProcess->waitingPreloaded)) {
+				loadPreloadedMessagesSlice();
+			}
+		});
+	});
+}
+
+void ApiWrap::loadPreloadedMessagesSlice() {
+	Expects(_chatProcess != nullptr);
+	Expects(_chatProcess->preloaded.has_value());
+
+	if (_chatProcess->preloadedLast) {
+		_chatProcess->lastSlice = true;
+	}
+	loadMessagesFiles(*base::take(_chatProcess->preloaded));
+}
+
 void ApiWrap::loadMessagesFiles(Data::MessagesSlice &&slice) {
 	Expects(_chatProcess != nullptr);
 	Expects(!_chatProcess->slice.has_value());
@@ -1344,6 +1582,7 @@ void ApiWrap::loadMessagesFiles(Data::MessagesSlice &&slice) {
 	_chatProcess->slice = std::move(slice);
 	_chatProcess->fileIndex = 0;
 
+	preloadMessagesSlice();
 	loadNextMessageFile();
 }
 
@@ -1391,6 +1630,9 @@ void ApiWrap::finishMessagesSlice() {
 	auto slice = *base::take(_chatProcess->slice);
 	if (!slice.list.empty()) {
 		_chatProcess->largestIdPlusOne = slice.list.back().id + 1;
+		_chatProcess->largestExportedId = std::max(
+			_chatProcess->largestExportedId,
+			slice.list.back().id);
 		if (!_chatProcess->handleSlice(std::move(slice))) {
 			return;
 		}
@@ -1401,10 +1643,14 @@ void ApiWrap::finishMessagesSlice() {
 		_chatProcess->lastSlice = false;
 		_chatProcess->largestIdPlusOne = 1;
 	}
-	if (!_chatProcess->lastSlice) {
-		requestMessagesSlice();
-	} else {
+	if (_chatProcess->lastSlice) {
 		finishMessages();
+	} else if (_chatProcess->preloaded) {
+		loadPreloadedMessagesSlice();
+	} else if (_chatProcess->preloading) {
+		_chatProcess->waitingPreloaded = true;
+	} else {
+		requestMessagesSlice();
 	}
 }
 
@@ -1461,6 +1707,9 @@ void ApiWrap::finishMessages() {
 	Expects(!_chatProcess->slice.has_value());
 
 	const auto process = base::take(_chatProcess);
+	_manifest->chatExported(
+		process->info.peerId,
+		process->largestExportedId);
 	process->done();
 }
 
@@ -1512,11 +1761,41 @@ bool ApiWrap::processFileLoad(
 		// Don't load thumbs for large files that we skip.
 		file.skipReason = SkipReason::FileSize;
 		return true;
+	} else if (writePreviousFile(file)) {
+		return true;
 	}
 	loadFile(file, std::move(progress), std::move(done));
 	return false;
 }
 
+bool ApiWrap::writePreviousFile(Data::File &file) {
+	Expects(_settings != nullptr);
+	Expects(_manifest != nullptr);
+
+	const auto previous = _manifest->findPrevious(file.location);
+	if (!previous) {
+		return false;
+	}
+	const auto process = prepareFileProcess(file);
+	const auto result = Output::File::Copy(
+		previous->path,
+		_settings->path + process->relativePath,
+		_stats);
+	if (!result) {
+		LOG(("Export Error: Could not copy '%1', loading it again."
+			).arg(previous->path));
+		return false;
+	}
+	file.relativePath = process->relativePath;
+	_fileCache->save(file.location, file.relativePath);
+	_manifest->fileSaved(
+		file.location,
+		file.relativePath,
+		previous->size,
+		previous->hash);
+	return true;
+}
+
 bool ApiWrap::writePreloadedFile(Data::File &file) {
 	Expects(_settings != nullptr);
 
@@ -1527,7 +1806,11 @@ bool ApiWrap::writePreloadedFile(Data::File &file) {
 		return true;
 	} else if (!file.content.isEmpty()) {
 		const auto process = prepareFileProcess(file);
-		if (const auto result = process->file.writeBlock(file.content)) {
+		const auto result = [&] {
+			const auto result = process->file.writeBlock(file.content);
+			return result ? process->file.flush() : result;
+		}();
+		if (result) {
 			file.relativePath = process->relativePath;
 			_fileCache->save(file.location, file.relativePath);
 		} else {
@@ -1580,33 +1863,26 @@ auto ApiWrap::prepareFileProcess(const Data::File &file) const
 }
 
 void ApiWrap::loadFilePart() {
-	if (!_fileProcess
-		|| _fileProcess->requests.size() >= kFileRequestsCount
-		|| (_fileProcess->size > 0
-			&& _fileProcess->offset >= _fileProcess->size)) {
-		return;
-	}
-
-	const auto offset = _fileProcess->offset;
-	_fileProcess->requests.push_back({ offset });
-	fileRequest(
-		_fileProcess->location,
-		_fileProcess->offset
-	).done([=](const MTPupload_File &result) {
-		filePartDone(offset, result);
-	}).send();
-	_fileProcess->offset += kFileChunkSize;
-
-	if (_fileProcess->size > 0
-		&& _fileProcess->requests.size() < kFileRequestsCount) {
-		//const auto runner = _runner;
-		//crl::on_main([=] {
-		//	QTimer::singleShot(kFileNextRequestDelay, [=] {
-		//		runner([=] {
-		//			loadFilePart();
-		//		});
-		//	});
-		//});
+	const auto canRequestMore = [&] {
+		if (!_fileProcess
+			|| _fileProcess->requests.size() >= kFileRequestsCount) {
+			return false;
+		}
+		// If we don't know the size we request parts one by one.
+		return (_fileProcess->size > 0)
+			? (_fileProcess->offset < _fileProcess->size)
+			: _fileProcess->requests.empty();
+	};
+	while (canRequestMore()) {
+		const auto offset = _fileProcess->offset;
+		_fileProcess->requests.push_back({ offset });
+		fileRequest(
+			_fileProcess->location,
+			_fileProcess->offset
+		).done([=](const MTPupload_File &result) {
+			filePartDone(offset, result);
+		}).send();
+		_fileProcess->offset += kFileChunkSize;
 	}
 }
 
@@ -1647,6 +1923,7 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 				ioError(result);
 				return;
 			}
+			_fileProcess->hash.addData(bytes);
 			requests.pop_front();
 		}
 
@@ -1664,9 +1941,18 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 		}
 	}
 
+	if (const auto result = _fileProcess->file.flush(); !result) {
+		ioError(result);
+		return;
+	}
 	auto process = base::take(_fileProcess);
 	const auto relativePath = process->relativePath;
 	_fileCache->save(process->location, relativePath);
+	_manifest->fileSaved(
+		process->location,
+		relativePath,
+		process->file.size(),
+		process->hash.result().toHex());
 	process->done(process->relativePath);
 }
 
@@ -88,6 +88,7 @@ public:
 
 private:
 	class LoadedFileCache;
+	class Manifest;
 	struct StartProcess;
 	struct ContactsProcess;
 	struct UserpicsProcess;
@@ -150,6 +151,8 @@ private:
 		int addOffset,
 		int limit,
 		FnMut<void(MTPmessages_Messages&&)> done);
+	void preloadMessagesSlice();
+	void loadPreloadedMessagesSlice();
 	void loadMessagesFiles(Data::MessagesSlice &&slice);
 	void loadNextMessageFile();
 	bool loadMessageFileProgress(FileProgress value);
@@ -167,6 +170,7 @@ private:
 	std::unique_ptr<FileProcess> prepareFileProcess(
 		const Data::File &file) const;
 	bool writePreloadedFile(Data::File &file);
+	bool writePreviousFile(Data::File &file);
 	void loadFile(
 		const Data::File &file,
 		Fn<bool(FileProgress)> progress,
@@ -201,6 +205,7 @@ private:
 
 	std::unique_ptr<StartProcess> _startProcess;
 	std::unique_ptr<LoadedFileCache> _fileCache;
+	std::unique_ptr<Manifest> _manifest;
 	std::unique_ptr<ContactsProcess> _contactsProcess;
 	std::unique_ptr<UserpicsProcess> _userpicsProcess;
 	std::unique_ptr<OtherDataProcess> _otherDataProcess;
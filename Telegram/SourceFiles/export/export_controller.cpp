@@ -579,6 +579,13 @@ int Controller::substepsInStep(Step step) const {
 }
 
 void Controller::setFinishedState() {
+	LOG(("Export Info: %1 files, %2 bytes written in %3 ms (%4 KB/s), "
+		"peak memory %5 KB."
+		).arg(_stats.filesCount()
+		).arg(_stats.bytesCount()
+		).arg(_stats.writeTime()
+		).arg(_stats.writeBytesPerSecond() / 1024
+		).arg(_stats.peakMemoryBytes() / 1024));
 	setState(FinishedState{
 		_writer->mainFilePath(),
 		_stats.filesCount(),
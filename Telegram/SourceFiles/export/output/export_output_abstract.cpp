@@ -54,6 +54,8 @@ std::unique_ptr<AbstractWriter> CreateWriter(Format format) {
 	case Format::Html: return std::make_unique<HtmlWriter>();
 	case Format::Text: return std::make_unique<TextWriter>();
 	case Format::Json: return std::make_unique<JsonWriter>();
+	case Format::JsonLines:
+		return std::make_unique<JsonWriter>(Format::JsonLines);
 	}
 	Unexpected("Format in Export::Output::CreateWriter.");
 }
@@ -17,22 +17,48 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Export {
 namespace Output {
+namespace {
+
+constexpr auto kBufferSize = 1024 * 1024;
+
+} // namespace
 
 File::File(const QString &path, Stats *stats) : _path(path), _stats(stats) {
 }
 
 int File::size() const {
-	return _offset;
+	return _offset + _buffer.size();
 }
 
 bool File::empty() const {
-	return !_offset;
+	return !size();
 }
 
 Result File::writeBlock(const QByteArray &block) {
-	const auto result = writeBlockAttempt(block);
+	if (block.isEmpty()) {
+		// Empty block still creates the file.
+		return flush();
+	} else if (_buffer.isEmpty() && block.size() >= kBufferSize) {
+		const auto result = writeBlockAttempt(block);
+		if (!result) {
+			_file.reset();
+		}
+		return result;
+	}
+	if (_buffer.isEmpty()) {
+		_buffer.reserve(kBufferSize);
+	}
+	_buffer.append(block);
+	return (_buffer.size() >= kBufferSize) ? flush() : Result::Success();
+}
+
+Result File::flush() {
+	// The buffer is kept if we fail, so that the next attempt writes it.
+	const auto result = writeBlockAttempt(_buffer);
 	if (!result) {
 		_file.reset();
+	} else {
+		_buffer = QByteArray();
 	}
 	return result;
 }
@@ -49,10 +75,12 @@ Result File::writeBlockAttempt(const QByteArray &block) {
 	if (!size) {
 		return Result::Success();
 	}
+	const auto started = crl::time();
 	if (_file->write(block) == size && _file->flush()) {
 		_offset += size;
 		if (_stats) {
 			_stats->incrementBytes(size);
+			_stats->incrementWriteTime(crl::time() - started);
 		}
 		return Result::Success();
 	}
@@ -132,7 +160,18 @@ Result File::Copy(
 	if (bytes.size() != f.size()) {
 		return Result(Result::Type::FatalError, source);
 	}
-	return File(path, stats).writeBlock(bytes);
+	File file(path, stats);
+	if (const auto result = file.writeBlock(bytes); !result) {
+		return result;
+	}
+	return file.flush();
+}
+
+File::~File() {
+	if (!_buffer.isEmpty()) {
+		// Writers flush their files explicitly to handle the errors.
+		(void)flush();
+	}
 }
 
 } // namespace Output
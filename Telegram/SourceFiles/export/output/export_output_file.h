@@ -26,7 +26,9 @@ public:
 	[[nodiscard]] int size() const;
 	[[nodiscard]] bool empty() const;
 
+	// Small blocks are collected in memory and written in large chunks.
 	[[nodiscard]] Result writeBlock(const QByteArray &block);
+	[[nodiscard]] Result flush();
 
 	[[nodiscard]] static QString PrepareRelativePath(
 		const QString &folder,
@@ -37,6 +39,8 @@ public:
 		const QString &path,
 		Stats *stats);
 
+	~File();
+
 private:
 	[[nodiscard]] Result reopen();
 	[[nodiscard]] Result writeBlockAttempt(const QByteArray &block);
@@ -47,6 +51,7 @@ private:
 	QString _path;
 	int _offset = 0;
 	std::optional<QFile> _file;
+	QByteArray _buffer;
 
 	Stats *_stats = nullptr;
 	bool _inStats = false;
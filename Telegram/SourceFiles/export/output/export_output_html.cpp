@@ -96,9 +96,38 @@ QByteArray SerializeString(const QByteArray &value) {
 	const auto begin = value.data();
 	const auto end = begin + size;
 
+	const auto special = [&](const char *p) {
+		const auto ch = *p;
+		return (ch >= 0 && ch < 32)
+			|| (ch == '"')
+			|| (ch == '&')
+			|| (ch == '\'')
+			|| (ch == '<')
+			|| (ch == '>')
+			|| (ch == char(0xE2)
+				&& (p + 2 < end)
+				&& *(p + 1) == char(0x80)
+				&& (*(p + 2) == char(0xA8) || *(p + 2) == char(0xA9)));
+	};
+	auto p = std::find_if(begin, end, [&](const char &ch) {
+		return special(&ch);
+	});
+	if (p == end) {
+		// Most of the strings don't need any escaping.
+		return value;
+	}
+
 	auto result = QByteArray();
-	result.reserve(size * 6);
-	for (auto p = begin; p != end; ++p) {
+	result.reserve(size * 2);
+	auto plain = begin;
+	for (; p != end; ++p) {
+		if (!special(p)) {
+			continue;
+		}
+		// Append the not escaped characters all at once.
+		result.append(plain, p - plain);
+		plain = p + 1;
+
 		const auto ch = *p;
 		if (ch == '\n') {
 			result.append("<br>", 4);
@@ -121,20 +150,13 @@ QByteArray SerializeString(const QByteArray &value) {
 				result.append('0' + left);
 			}
 			result.append(';');
-		} else if (ch == char(0xE2)
-			&& (p + 2 < end)
-			&& *(p + 1) == char(0x80)) {
-			if (*(p + 2) == char(0xA8)) { // Line separator.
-				result.append("<br>", 4);
-			} else if (*(p + 2) == char(0xA9)) { // Paragraph separator.
-				result.append("<br>", 4);
-			} else {
-				result.append(ch);
-			}
-		} else {
-			result.append(ch);
+		} else { // Line or paragraph separator.
+			result.append("<br>", 4);
+			p += 2;
+			plain = p + 1;
 		}
 	}
+	result.append(plain, end - plain);
 	return result;
 }
 
@@ -172,20 +194,18 @@ QByteArray MakeLinks(const QByteArray &value) {
 				break;
 			}
 		}
-		if (start > offset) {
-			const auto link = value.mid(start, end - start);
-			result.append(value.mid(offset, start - offset));
-			result.append("<a href=\"").append(link).append("\">");
-			result.append(link);
-			result.append("</a>");
-			offset = end;
-		}
+		const auto link = value.mid(start, end - start);
+		result.append(value.data() + offset, start - offset);
+		result.append("<a href=\"").append(link).append("\">");
+		result.append(link);
+		result.append("</a>");
+		offset = end;
 	}
 	if (result.isEmpty()) {
 		return value;
 	}
 	if (offset < value.size()) {
-		result.append(value.mid(offset));
+		result.append(value.data() + offset, value.size() - offset);
 	}
 	return result;
 }
@@ -1740,7 +1760,10 @@ Result HtmlWriter::Wrap::close() {
 		while (!_context.empty()) {
 			block.append(_context.popTag());
 		}
-		return _file.writeBlock(block);
+		if (const auto result = _file.writeBlock(block); !result) {
+			return result;
+		}
+		return _file.flush();
 	}
 	return Result::Success();
 }
@@ -202,6 +202,24 @@ QByteArray SerializeText(
 	return SerializeArray(context, text);
 }
 
+// All line breaks in the serialized value are formatting,
+// because line breaks in strings are escaped by SerializeString().
+QByteArray SerializeLine(const QByteArray &serialized) {
+	auto result = QByteArray();
+	result.reserve(serialized.size() + 1);
+	auto skipIndentation = false;
+	for (const auto ch : serialized) {
+		if (ch == '\n') {
+			skipIndentation = true;
+		} else if (!skipIndentation || ch != ' ') {
+			skipIndentation = false;
+			result.append(ch);
+		}
+	}
+	result.append('\n');
+	return result;
+}
+
 Data::Utf8String FormatUsername(const Data::Utf8String &username) {
 	return username.isEmpty() ? username : ('@' + username);
 }
@@ -608,6 +626,14 @@ QByteArray SerializeMessage(
 
 } // namespace
 
+JsonWriter::JsonWriter(Format format) : _format(format) {
+	Expects(format == Format::Json || format == Format::JsonLines);
+}
+
+bool JsonWriter::messagesInLines() const {
+	return (_format == Format::JsonLines);
+}
+
 Result JsonWriter::start(
 		const Settings &settings,
 		const Environment &environment,
@@ -1013,8 +1039,20 @@ Result JsonWriter::writeDialogStart(const Data::DialogInfo &data) {
 		+ StringAllowNull(TypeString(data.type)));
 	block.append(prepareObjectItemStart("id")
 		+ Data::NumberToString(data.peerId));
-	block.append(prepareObjectItemStart("messages"));
-	block.append(pushNesting(Context::kArray));
+	if (messagesInLines()) {
+		const auto relativePath = data.relativePath + "messages.jsonl";
+		block.append(prepareObjectItemStart("messages_file")
+			+ SerializeString(relativePath.toUtf8()));
+		_messages = fileWithRelativePath(relativePath);
+
+		// Create the file even if there won't be any messages.
+		if (const auto result = _messages->writeBlock({}); !result) {
+			return result;
+		}
+	} else {
+		block.append(prepareObjectItemStart("messages"));
+		block.append(pushNesting(Context::kArray));
+	}
 	return _output->writeBlock(block);
 }
 
@@ -1045,18 +1083,39 @@ Result JsonWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 		if (Data::SkipMessageByDate(message, _settings)) {
 			continue;
 		}
-		block.append(prepareArrayItemStart() + SerializeMessage(
+		const auto serialized = SerializeMessage(
 			_context,
 			message,
 			data.peers,
-			_environment.internalLinksDomain));
+			_environment.internalLinksDomain);
+		if (messagesInLines()) {
+			block.append(SerializeLine(serialized));
+		} else {
+			block.append(prepareArrayItemStart() + serialized);
+		}
 	}
-	return block.isEmpty() ? Result::Success() : _output->writeBlock(block);
+	if (block.isEmpty()) {
+		return Result::Success();
+	} else if (messagesInLines()) {
+		Assert(_messages != nullptr);
+
+		return _messages->writeBlock(block);
+	}
+	return _output->writeBlock(block);
 }
 
 Result JsonWriter::writeDialogEnd() {
 	Expects(_output != nullptr);
 
+	if (messagesInLines()) {
+		Assert(_messages != nullptr);
+
+		if (const auto result = _messages->flush(); !result) {
+			return result;
+		}
+		_messages = nullptr;
+		return _output->writeBlock(popNesting());
+	}
 	auto block = popNesting();
 	return _output->writeBlock(block + popNesting());
 }
@@ -1090,7 +1149,10 @@ Result JsonWriter::finish() {
 
 	auto block = popNesting();
 	Assert(_context.nesting.empty());
-	return _output->writeBlock(block);
+	if (const auto result = _output->writeBlock(block); !result) {
+		return result;
+	}
+	return _output->flush();
 }
 
 QString JsonWriter::mainFilePath() {
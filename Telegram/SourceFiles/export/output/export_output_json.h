@@ -27,10 +27,14 @@ struct JsonContext {
 
 } // namespace details
 
+// With Format::JsonLines messages of each chat are written to a separate
+// "messages.jsonl" file in the chat folder, one serialized message per line.
 class JsonWriter : public AbstractWriter {
 public:
+	explicit JsonWriter(Format format = Format::Json);
+
 	Format format() override {
-		return Format::Json;
+		return _format;
 	}
 
 	Result start(
@@ -90,6 +94,9 @@ private:
 		const QByteArray &about);
 	[[nodiscard]] Result writeChatsEnd();
 
+	[[nodiscard]] bool messagesInLines() const;
+
+	Format _format = Format::Json;
 	Settings _settings;
 	Environment _environment;
 	Stats *_stats = nullptr;
@@ -99,6 +106,7 @@ private:
 	DialogsMode _dialogsMode = DialogsMode::None;
 
 	std::unique_ptr<File> _output;
+	std::unique_ptr<File> _messages;
 
 };
 
@@ -7,12 +7,17 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "export/output/export_output_stats.h"
 
+#ifndef Q_OS_WIN
+#include <sys/resource.h>
+#endif // !Q_OS_WIN
+
 namespace Export {
 namespace Output {
 
 Stats::Stats(const Stats &other)
 : _files(other._files.load())
-, _bytes(other._bytes.load()) {
+, _bytes(other._bytes.load())
+, _writeTime(other._writeTime.load()) {
 }
 
 void Stats::incrementFiles() {
@@ -23,6 +28,10 @@ void Stats::incrementBytes(int count) {
 	_bytes += count;
 }
 
+void Stats::incrementWriteTime(crl::time_type ms) {
+	_writeTime += ms;
+}
+
 int Stats::filesCount() const {
 	return _files;
 }
@@ -31,5 +40,30 @@ int64 Stats::bytesCount() const {
 	return _bytes;
 }
 
+crl::time_type Stats::writeTime() const {
+	return _writeTime;
+}
+
+int64 Stats::writeBytesPerSecond() const {
+	const auto ms = std::max(writeTime(), crl::time_type(1));
+	return bytesCount() * 1000 / ms;
+}
+
+int64 Stats::peakMemoryBytes() const {
+#ifdef Q_OS_WIN
+	return 0;
+#else // Q_OS_WIN
+	auto usage = rusage();
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+#ifdef Q_OS_MAC
+	return int64(usage.ru_maxrss);
+#else // Q_OS_MAC
+	return int64(usage.ru_maxrss) * 1024;
+#endif // Q_OS_MAC
+#endif // Q_OS_WIN
+}
+
 } // namespace Output
 } // namespace Export
@@ -19,13 +19,20 @@ public:
 
 	void incrementFiles();
 	void incrementBytes(int count);
+	void incrementWriteTime(crl::time_type ms);
 
 	int filesCount() const;
 	int64 bytesCount() const;
+	crl::time_type writeTime() const;
+	int64 writeBytesPerSecond() const;
+
+	// Peak resident set size of the whole process, zero if unknown.
+	int64 peakMemoryBytes() const;
 
 private:
 	std::atomic<int> _files;
 	std::atomic<int64> _bytes;
+	std::atomic<crl::time_type> _writeTime = 0;
 
 };
 
@@ -552,7 +552,12 @@ Result TextWriter::writeUserpicsSlice(const Data::UserpicsSlice &data) {
 }
 
 Result TextWriter::writeUserpicsEnd() {
-	_userpics = nullptr;
+	if (_userpics) {
+		if (const auto result = _userpics->flush(); !result) {
+			return result;
+		}
+		_userpics = nullptr;
+	}
 	return Result::Success();
 }
 
@@ -600,6 +605,8 @@ Result TextWriter::writeSavedContacts(const Data::ContactsList &data) {
 		+ JoinList(kLineBreak, list);
 	if (const auto result = file->writeBlock(full); !result) {
 		return result;
+	} else if (const auto flushed = file->flush(); !flushed) {
+		return flushed;
 	}
 
 	const auto header = "Contacts "
@@ -679,6 +686,8 @@ Result TextWriter::writeFrequentContacts(const Data::ContactsList &data) {
 		+ JoinList(kLineBreak, list);
 	if (const auto result = file->writeBlock(full); !result) {
 		return result;
+	} else if (const auto flushed = file->flush(); !flushed) {
+		return flushed;
 	}
 
 	const auto header = "Frequent contacts "
@@ -735,6 +744,8 @@ Result TextWriter::writeSessions(const Data::SessionsList &data) {
 		+ JoinList(kLineBreak, list);
 	if (const auto result = file->writeBlock(full); !result) {
 		return result;
+	} else if (const auto flushed = file->flush(); !flushed) {
+		return flushed;
 	}
 
 	const auto header = "Sessions "
@@ -783,6 +794,8 @@ Result TextWriter::writeWebSessions(const Data::SessionsList &data) {
 		+ JoinList(kLineBreak, list);
 	if (const auto result = file->writeBlock(full); !result) {
 		return result;
+	} else if (const auto flushed = file->flush(); !flushed) {
+		return flushed;
 	}
 
 	const auto header = "Web sessions "
@@ -871,6 +884,9 @@ Result TextWriter::writeDialogEnd() {
 	Expects(_chats != nullptr);
 	Expects(_chat != nullptr);
 
+	if (const auto result = _chat->flush(); !result) {
+		return result;
+	}
 	_chat = nullptr;
 
 	using Type = Data::DialogInfo::Type;
@@ -960,12 +976,17 @@ Result TextWriter::writeChatsStart(
 }
 
 Result TextWriter::writeChatsEnd() {
-	_chats = nullptr;
+	if (_chats) {
+		if (const auto result = _chats->flush(); !result) {
+			return result;
+		}
+		_chats = nullptr;
+	}
 	return Result::Success();
 }
 
 Result TextWriter::finish() {
-	return Result::Success();
+	return _summary ? _summary->flush() : Result::Success();
 }
 
 QString TextWriter::mainFilePath() {
@@ -237,6 +237,7 @@ void SettingsWidget::setupPathAndFormat(
 	addLocationLabel(container);
 	addFormatOption(lng_export_option_html, Format::Html);
 	addFormatOption(lng_export_option_json, Format::Json);
+	addFormatOption(lng_export_option_json_lines, Format::JsonLines);
 }
 
 void SettingsWidget::addLocationLabel(
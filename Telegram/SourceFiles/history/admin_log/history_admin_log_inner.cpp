@@ -50,6 +50,11 @@ constexpr auto kScrollDateHideTimeout = 1000;
 constexpr auto kEventsFirstPage = 20;
 constexpr auto kEventsPerPage = 50;
 
+// Events far from the visible area are unloaded when there are too many
+// items, so that scrolling through a huge log keeps the memory bounded.
+constexpr auto kMaxLoadedItems = 1000;
+constexpr auto kUnloadHeightsCount = 8;
+
 } // namespace
 
 template <InnerWidget::EnumItemsDirection direction, typename Method>
@@ -534,6 +539,7 @@ void InnerWidget::saveState(not_null<SectionMemento*> memento) {
 		memento->setItems(
 			base::take(_items),
 			base::take(_eventIds),
+			base::take(_unloadedDownIds),
 			_upLoaded,
 			_downLoaded);
 		memento->setIdManager(base::take(_idManager));
@@ -549,6 +555,7 @@ void InnerWidget::restoreState(not_null<SectionMemento*> memento) {
 		_itemsByData.emplace(item->data(), item.get());
 	}
 	_eventIds = memento->takeEventIds();
+	_unloadedDownIds = memento->takeUnloadedDownIds();
 	if (auto manager = memento->takeIdManager()) {
 		_idManager = std::move(manager);
 	}
@@ -588,6 +595,11 @@ void InnerWidget::preloadMore(Direction direction) {
 	auto maxId = (direction == Direction::Up) ? _minId : 0;
 	auto minId = (direction == Direction::Up) ? 0 : _maxId;
 	auto perPage = _items.empty() ? kEventsFirstPage : kEventsPerPage;
+	if (direction == Direction::Down
+		&& _unloadedDownIds.size() > size_type(perPage)) {
+		// Limit the range, so that we get the events right after ours.
+		maxId = _unloadedDownIds[perPage];
+	}
 	requestId = request(MTPchannels_GetAdminLog(
 		MTP_flags(flags),
 		_channel->inputChannel,
@@ -623,6 +635,9 @@ void InnerWidget::addEvents(Direction direction, const QVector<MTPChannelAdminLo
 	auto up = (direction == Direction::Up);
 	if (events.empty()) {
 		(up ? _upLoaded : _downLoaded) = true;
+		if (!up) {
+			_unloadedDownIds.clear();
+		}
 		update();
 		return;
 	}
@@ -644,7 +659,7 @@ void InnerWidget::addEvents(Direction direction, const QVector<MTPChannelAdminLo
 
 			auto count = 0;
 			const auto addOne = [&](OwnedItem item) {
-				_eventIds.emplace(id);
+				++_eventIds[id];
 				_itemsByData.emplace(item->data(), item.get());
 				addToItems.push_back(std::move(item));
 				++count;
@@ -676,16 +691,130 @@ void InnerWidget::addEvents(Direction direction, const QVector<MTPChannelAdminLo
 		}
 		updateMinMaxIds();
 		itemsAdded(direction, newItemsCount - oldItemsCount);
+		unloadFarItems(direction);
+	}
+	if (!up && !_unloadedDownIds.empty()) {
+		_unloadedDownIds.erase(
+			_unloadedDownIds.begin(),
+			std::upper_bound(
+				_unloadedDownIds.begin(),
+				_unloadedDownIds.end(),
+				_maxId));
+		_downLoaded = _unloadedDownIds.empty();
 	}
 	update();
 }
 
+void InnerWidget::unloadFarItems(Direction loadedDirection) {
+	const auto visibleHeight = (_visibleBottom - _visibleTop);
+	const auto margin = kUnloadHeightsCount * std::max(visibleHeight, 1);
+	const auto unloadFirst = (loadedDirection == Direction::Up);
+	auto unloaded = false;
+	while (int(_items.size()) > kMaxLoadedItems && !_eventIds.empty()) {
+		if (unloadFirst) {
+			// The newest event, at the bottom.
+			const auto count = _eventIds.rbegin()->second;
+			const auto top = itemTop(_items[count - 1]);
+			if (top < _visibleBottom + margin) {
+				break;
+			}
+			unloadFirstEvent();
+		} else {
+			// The oldest event, at the top.
+			const auto count = _eventIds.begin()->second;
+			const auto last = _items[_items.size() - count].get();
+			if (itemTop(last) + last->height() > _visibleTop - margin) {
+				break;
+			}
+			unloadLastEvent();
+		}
+		unloaded = true;
+	}
+	if (!unloaded) {
+		return;
+	} else if (unloadFirst) {
+		_items.front()->setAttachToNext(false);
+		_downLoaded = false;
+	} else {
+		const auto view = _items.back().get();
+		view->setDisplayDate(true);
+		view->setAttachToPrevious(false);
+		_upLoaded = false;
+	}
+	updateMinMaxIds();
+	updateSize();
+}
+
+void InnerWidget::unloadFirstEvent() {
+	const auto i = std::prev(_eventIds.end());
+	const auto count = i->second;
+	Assert(count > 0 && count <= int(_items.size()));
+
+	for (const auto &item : ranges::view::take(_items, count)) {
+		clearItemPointers(item.get());
+	}
+	_items.erase(_items.begin(), _items.begin() + count);
+	_unloadedDownIds.insert(
+		std::lower_bound(
+			_unloadedDownIds.begin(),
+			_unloadedDownIds.end(),
+			i->first),
+		i->first);
+	_eventIds.erase(i);
+}
+
+void InnerWidget::unloadLastEvent() {
+	const auto i = _eventIds.begin();
+	const auto count = i->second;
+	Assert(count > 0 && count <= int(_items.size()));
+
+	const auto from = _items.end() - count;
+	for (auto j = from; j != _items.end(); ++j) {
+		clearItemPointers(j->get());
+	}
+	_items.erase(from, _items.end());
+	_eventIds.erase(i);
+}
+
+void InnerWidget::clearItemPointers(not_null<Element*> view) {
+	_itemsByData.erase(view->data());
+	if (_visibleTopItem == view) {
+		_visibleTopItem = nullptr;
+	}
+	if (_scrollDateLastItem == view) {
+		_scrollDateLastItem = nullptr;
+		_scrollDateLastItemTop = 0;
+	}
+	if (_mouseActionItem == view) {
+		_mouseActionItem = nullptr;
+	}
+	if (_selectedItem == view) {
+		_selectedItem = nullptr;
+		_selectedText = TextSelection();
+	}
+	if (App::hoveredItem() == view) {
+		App::hoveredItem(nullptr);
+	}
+	if (App::pressedItem() == view) {
+		App::pressedItem(nullptr);
+	}
+	if (App::hoveredLinkItem() == view) {
+		App::hoveredLinkItem(nullptr);
+	}
+	if (App::pressedLinkItem() == view) {
+		App::pressedLinkItem(nullptr);
+	}
+	if (App::mousedItem() == view) {
+		App::mousedItem(nullptr);
+	}
+}
+
 void InnerWidget::updateMinMaxIds() {
 	if (_eventIds.empty() || _filterChanged) {
 		_maxId = _minId = 0;
 	} else {
-		_maxId = *_eventIds.rbegin();
-		_minId = *_eventIds.begin();
+		_maxId = _eventIds.rbegin()->first;
+		_minId = _eventIds.begin()->first;
 		if (_minId == 1) {
 			_upLoaded = true;
 		}
@@ -856,6 +985,7 @@ void InnerWidget::clearAfterFilterChange() {
 	_filterChanged = false;
 	_items.clear();
 	_eventIds.clear();
+	_unloadedDownIds.clear();
 	_itemsByData.clear();
 	_idManager = nullptr;
 	_idManager = _history->adminLogIdManager();
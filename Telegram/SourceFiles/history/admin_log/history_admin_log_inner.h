@@ -162,6 +162,10 @@ private:
 	void updateVisibleTopItem();
 	void preloadMore(Direction direction);
 	void itemsAdded(Direction direction, int addedCount);
+	void unloadFarItems(Direction loadedDirection);
+	void unloadFirstEvent();
+	void unloadLastEvent();
+	void clearItemPointers(not_null<Element*> view);
 	void updateSize();
 	void updateMinMaxIds();
 	void updateEmptyText();
@@ -206,7 +210,14 @@ private:
 	not_null<ChannelData*> _channel;
 	not_null<History*> _history;
 	std::vector<OwnedItem> _items;
-	std::set<uint64> _eventIds;
+
+	// Event id -> count of its items, the items of one event are adjacent
+	// and _items are sorted from the newest event to the oldest one.
+	std::map<uint64, int> _eventIds;
+
+	// Ids of the newer events that were unloaded to bound the memory,
+	// sorted, they are requested again by pages when scrolling down.
+	std::vector<uint64> _unloadedDownIds;
 	std::map<not_null<const HistoryItem*>, not_null<Element*>> _itemsByData;
 	int _itemsTop = 0;
 	int _itemsWidth = 0;
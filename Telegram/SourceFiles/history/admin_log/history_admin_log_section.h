@@ -150,11 +150,13 @@ public:
 
 	void setItems(
 			std::vector<OwnedItem> &&items,
-			std::set<uint64> &&eventIds,
+			std::map<uint64, int> &&eventIds,
+			std::vector<uint64> &&unloadedDownIds,
 			bool upLoaded,
 			bool downLoaded) {
 		_items = std::move(items);
 		_eventIds = std::move(eventIds);
+		_unloadedDownIds = std::move(unloadedDownIds);
 		_upLoaded = upLoaded;
 		_downLoaded = downLoaded;
 	}
@@ -170,9 +172,12 @@ public:
 	std::vector<OwnedItem> takeItems() {
 		return std::move(_items);
 	}
-	std::set<uint64> takeEventIds() {
+	std::map<uint64, int> takeEventIds() {
 		return std::move(_eventIds);
 	}
+	std::vector<uint64> takeUnloadedDownIds() {
+		return std::move(_unloadedDownIds);
+	}
 	std::shared_ptr<LocalIdManager> takeIdManager() {
 		return std::move(_idManager);
 	}
@@ -195,7 +200,8 @@ private:
 	std::vector<not_null<UserData*>> _admins;
 	std::vector<not_null<UserData*>> _adminsCanEdit;
 	std::vector<OwnedItem> _items;
-	std::set<uint64> _eventIds;
+	std::map<uint64, int> _eventIds;
+	std::vector<uint64> _unloadedDownIds;
 	bool _upLoaded = false;
 	bool _downLoaded = true;
 	std::shared_ptr<LocalIdManager> _idManager;
@@ -1678,8 +1678,6 @@ bool History::changeMute(bool newMute) {
 			_owner->unreadEntriesChanged(
 				entriesWithUnreadDelta,
 				mutedEntriesWithUnreadDelta);
-
-			Notify::unreadCounterUpdated();
 		}
 		Notify::historyMuteUpdated(this);
 	}
@@ -2547,20 +2545,54 @@ HistoryItem *History::lastSentMessage() const {
 }
 
 void History::resizeToWidth(int newWidth) {
-	const auto resizeAllItems = (_width != newWidth);
+	if (_width == newWidth
+		&& !hasPendingResizedItems()
+		&& !hasDeferredResizedBlocks()) {
+		return;
+	}
+	_flags &= ~(Flag::f_has_pending_resized_items
+		| Flag::f_has_deferred_resized_blocks);
 
-	if (!resizeAllItems && !hasPendingResizedItems()) {
+	_width = newWidth;
+	int y = 0;
+	for (const auto &block : blocks) {
+		block->setY(y);
+		y += block->resizeGetHeight(newWidth, block->width() != newWidth);
+	}
+	_height = y;
+}
+
+void History::resizeVisibleToWidth(
+		int newWidth,
+		int visibleTop,
+		int visibleBottom) {
+	if (_width == newWidth && !hasPendingResizedItems()) {
 		return;
 	}
 	_flags &= ~(Flag::f_has_pending_resized_items);
 
 	_width = newWidth;
-	int y = 0;
+	auto deferred = false;
+	auto y = 0;
 	for (const auto &block : blocks) {
+		// Visibility is checked by the old block geometry, so that
+		// the blocks above the visible ones keep their heights.
+		const auto visible = (block->y() < visibleBottom)
+			&& (block->y() + block->height() > visibleTop);
 		block->setY(y);
-		y += block->resizeGetHeight(newWidth, resizeAllItems);
+		y += block->resizeGetHeight(newWidth, visible);
+		if (block->width() != newWidth) {
+			deferred = true;
+		}
 	}
 	_height = y;
+	if (deferred) {
+		_flags |= Flag::f_has_deferred_resized_blocks;
+	}
+}
+
+bool History::hasDeferredResizedBlocks() const {
+	return _flags & Flag::f_has_deferred_resized_blocks;
 }
 
 Data::Session &History::owner() const {
@@ -2868,6 +2900,40 @@ void History::unloadBlocks() {
 	clearBlocks(true);
 }
 
+void History::unloadBlocksAbove(int leaveViewsCount) {
+	if (isBuildingFrontBlock()
+		|| scrollTopItem
+		|| !loadedAtBottom()
+		|| unreadCount() > 0) {
+		return;
+	}
+	auto left = 0;
+	auto till = int(blocks.size());
+	while (till > 0 && left < leaveViewsCount) {
+		left += int(blocks[--till]->messages.size());
+	}
+	if (till <= 0) {
+		return;
+	}
+	const auto unloaded = [&](Element *view) {
+		return view && (view->block()->indexInHistory() < till);
+	};
+	if (unloaded(_unreadBarView) || unloaded(_firstUnreadView)) {
+		return;
+	}
+	if (_joinedMessage && unloaded(_joinedMessage->mainView())) {
+		_joinedMessage = nullptr;
+	}
+	blocks.erase(blocks.begin(), blocks.begin() + till);
+	for (auto i = 0, count = int(blocks.size()); i != count; ++i) {
+		blocks[i]->setIndexInHistory(i);
+	}
+	blocks.front()->messages.front()->previousInBlocksChanged();
+
+	_loadedAtTop = false;
+	_owner->notifyHistoryChangeDelayed(this);
+}
+
 void History::clearBlocks(bool leaveItems) {
 	_unreadBarView = nullptr;
 	_firstUnreadView = nullptr;
@@ -2995,6 +3061,9 @@ HistoryBlock::HistoryBlock(not_null<History*> history)
 }
 
 int HistoryBlock::resizeGetHeight(int newWidth, bool resizeAllItems) {
+	if (resizeAllItems) {
+		_width = newWidth;
+	}
 	auto y = 0;
 	for (const auto &message : messages) {
 		message->setY(y);
@@ -87,6 +87,10 @@ public:
 	void clear();
 	void markFullyLoaded();
 	void unloadBlocks();
+
+	// Destroys the views of the oldest blocks leaving at least
+	// leaveViewsCount newest ones, if we're going to show the bottom.
+	void unloadBlocksAbove(int leaveViewsCount);
 	void clearUpTill(MsgId availableMinId);
 
 	void applyGroupAdminChanges(
@@ -202,6 +206,11 @@ public:
 	HistoryItem *lastSentMessage() const;
 
 	void resizeToWidth(int newWidth);
+
+	// Resizes only the blocks intersecting [visibleTop, visibleBottom),
+	// others keep their heights until the next resizeToWidth() call.
+	void resizeVisibleToWidth(int newWidth, int visibleTop, int visibleBottom);
+	bool hasDeferredResizedBlocks() const;
 	int height() const;
 
 	void itemRemoved(not_null<HistoryItem*> item);
@@ -347,6 +356,7 @@ private:
 
 	enum class Flag {
 		f_has_pending_resized_items = (1 << 0),
+		f_has_deferred_resized_blocks = (1 << 1),
 	};
 	using Flags = base::flags<Flag>;
 	friend inline constexpr auto is_flag_type(Flag) {
@@ -516,6 +526,9 @@ public:
 	void refreshView(not_null<Element*> view);
 
 	int resizeGetHeight(int newWidth, bool resizeAllItems);
+	int width() const {
+		return _width;
+	}
 	int y() const {
 		return _y;
 	}
@@ -558,6 +571,7 @@ protected:
 	const not_null<History*> _history;
 
 	int _y = 0;
+	int _width = 0;
 	int _height = 0;
 	int _indexInHistory = -1;
 
@@ -543,6 +543,18 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 	auto clip = e->rect();
 	auto ms = getms();
 
+	// Several small parts far from each other (like radial progress of
+	// two downloads) give us their whole bounding rect as a clip, so we
+	// skip the messages that don't intersect the updated region itself.
+	const auto region = e->region();
+	const auto complexRegion = (region.rectCount() > 1);
+	const auto viewClip = [&](QRect clip, int top, int height) {
+		return complexRegion
+			? clip.intersected(region.intersected(
+				QRect(0, top, width(), height)).boundingRect())
+			: clip;
+	};
+
 	const auto historyDisplayedEmpty = _history->isDisplayedEmpty()
 		&& (!_migrated || _migrated->isDisplayedEmpty());
 	bool noHistoryDisplayed = _firstLoading || historyDisplayedEmpty;
@@ -594,21 +606,24 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 			p.save();
 			p.translate(0, y);
 			if (clip.y() < y + view->height()) while (y < drawToY) {
-				const auto selection = itemRenderSelection(
-					view,
-					selfromy - mtop,
-					seltoy - mtop);
-				view->draw(p, clip.translated(0, -y), selection, ms);
-
-				if (item->hasViews()) {
-					App::main()->scheduleViewIncrement(item);
-				}
-				if (item->isUnreadMention() && !item->isUnreadMedia()) {
-					readMentions.insert(item);
-					_widget->enqueueMessageHighlight(view);
+				int32 h = view->height();
+				const auto painted = viewClip(clip, y, h);
+				if (!painted.isEmpty()) {
+					const auto selection = itemRenderSelection(
+						view,
+						selfromy - mtop,
+						seltoy - mtop);
+					view->draw(p, painted.translated(0, -y), selection, ms);
+
+					if (item->hasViews()) {
+						App::main()->scheduleViewIncrement(item);
+					}
+					if (item->isUnreadMention() && !item->isUnreadMedia()) {
+						readMentions.insert(item);
+						_widget->enqueueMessageHighlight(view);
+					}
 				}
 
-				int32 h = view->height();
 				p.translate(0, h);
 				y += h;
 
@@ -639,12 +654,15 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 			p.translate(0, y);
 			while (y < drawToY) {
 				auto h = view->height();
-				if (hclip.y() < y + h && hdrawtop < y + h) {
+				const auto painted = viewClip(hclip, y, h);
+				if (hclip.y() < y + h
+					&& hdrawtop < y + h
+					&& !painted.isEmpty()) {
 					const auto selection = itemRenderSelection(
 						view,
 						selfromy - htop,
 						seltoy - htop);
-					view->draw(p, hclip.translated(0, -y), selection, ms);
+					view->draw(p, painted.translated(0, -y), selection, ms);
 
 					if (item->hasViews()) {
 						App::main()->scheduleViewIncrement(item);
@@ -1876,7 +1894,13 @@ TextWithEntities HistoryInner::getSelectedText() const {
 	const auto timeFormat = qsl(", [dd.MM.yy hh:mm]\n");
 	auto groups = base::flat_set<not_null<const Data::Group*>>();
 	auto fullSize = 0;
-	auto texts = base::flat_map<Data::MessagePosition, TextWithEntities>();
+	auto fullEntities = 0;
+
+	// Selected items come in pointer order, sort the parts only once.
+	auto texts = std::vector<std::pair<
+		Data::MessagePosition,
+		TextWithEntities>>();
+	texts.reserve(selected.size());
 
 	const auto wrapItem = [&](
 			not_null<HistoryItem*> item,
@@ -1889,8 +1913,9 @@ TextWithEntities HistoryInner::getSelectedText() const {
 		part.text.reserve(size);
 		part.text.append(item->author()->name).append(time);
 		TextUtilities::Append(part, std::move(unwrapped));
-		texts.emplace(item->position(), part);
 		fullSize += size;
+		fullEntities += part.entities.size();
+		texts.emplace_back(item->position(), std::move(part));
 	};
 	const auto addItem = [&](not_null<HistoryItem*> item) {
 		wrapItem(item, HistoryItemText(item));
@@ -1917,9 +1942,16 @@ TextWithEntities HistoryInner::getSelectedText() const {
 		}
 	}
 
+	ranges::sort(texts, [](
+			const std::pair<Data::MessagePosition, TextWithEntities> &a,
+			const std::pair<Data::MessagePosition, TextWithEntities> &b) {
+		return a.first < b.first;
+	});
+
 	auto result = TextWithEntities();
 	auto sep = qsl("\n\n");
 	result.text.reserve(fullSize + (texts.size() - 1) * sep.size());
+	result.entities.reserve(fullEntities);
 	for (auto i = texts.begin(), e = texts.end(); i != e;) {
 		TextUtilities::Append(result, std::move(i->second));
 		if (++i != e) {
@@ -1951,6 +1983,51 @@ void HistoryInner::keyPressEvent(QKeyEvent *e) {
 }
 
 void HistoryInner::recountHistoryGeometry() {
+	recountHistoryGeometry(false);
+}
+
+void HistoryInner::recountVisibleHistoryGeometry() {
+	recountHistoryGeometry(true);
+}
+
+bool HistoryInner::hasDeferredResizedBlocks() const {
+	return _history->hasDeferredResizedBlocks()
+		|| (_migrated && _migrated->hasDeferredResizedBlocks());
+}
+
+void HistoryInner::resizeHistories(bool visibleOnly) {
+	if (!visibleOnly) {
+		_history->resizeToWidth(_contentWidth);
+		if (_migrated) {
+			_migrated->resizeToWidth(_contentWidth);
+		}
+		return;
+	}
+
+	// Lay out the visible area with one more screen above and below,
+	// the rest is resized by the next full recountHistoryGeometry().
+	const auto height = _visibleAreaBottom - _visibleAreaTop;
+	const auto top = _visibleAreaTop - height;
+	const auto bottom = _visibleAreaBottom + height;
+	const auto resize = [&](not_null<History*> history, int historyTop) {
+		if (historyTop < 0) {
+			history->resizeToWidth(_contentWidth);
+		} else {
+			history->resizeVisibleToWidth(
+				_contentWidth,
+				top - historyTop,
+				bottom - historyTop);
+		}
+	};
+	const auto migratedTop = this->migratedTop();
+	const auto historyTop = this->historyTop();
+	resize(_history, historyTop);
+	if (_migrated) {
+		resize(_migrated, migratedTop);
+	}
+}
+
+void HistoryInner::recountHistoryGeometry(bool visibleOnly) {
 	_contentWidth = _scroll->width();
 
 	const auto visibleHeight = _scroll->height();
@@ -1959,10 +2036,7 @@ void HistoryInner::recountHistoryGeometry() {
 		accumulate_max(oldHistoryPaddingTop, st::msgMargin.top() + st::msgMargin.bottom() + st::msgPadding.top() + st::msgPadding.bottom() + st::msgNameFont->height + st::botDescSkip + _botAbout->height);
 	}
 
-	_history->resizeToWidth(_contentWidth);
-	if (_migrated) {
-		_migrated->resizeToWidth(_contentWidth);
-	}
+	resizeHistories(visibleOnly);
 
 	// With migrated history we perhaps do not need to display
 	// the first _history message date (just skip it by height).
@@ -2080,6 +2154,7 @@ void HistoryInner::visibleAreaUpdated(int top, int bottom) {
 	if (hasPendingResizedItems()) {
 		return;
 	}
+	prefetchMedia(top, bottom);
 
 	if (bottom >= _historyPaddingTop + historyHeight() + st::historyPaddingBottom) {
 		_history->forgetScrollState();
@@ -2110,6 +2185,38 @@ void HistoryInner::visibleAreaUpdated(int top, int bottom) {
 	}
 }
 
+void HistoryInner::prefetchMedia(int top, int bottom) {
+	const auto area = _mediaPrefetch.visibleAreaUpdated(top, bottom);
+	if (!area) {
+		return;
+	}
+	const auto enumerate = [&](History *history, int historytop) {
+		if (!history || historytop < 0) {
+			return;
+		}
+		for (const auto &block : history->blocks) {
+			const auto blocktop = historytop + block->y();
+			if (blocktop >= area->bottom) {
+				return;
+			} else if (blocktop + block->height() <= area->top) {
+				continue;
+			}
+			for (const auto &view : block->messages) {
+				const auto itemtop = blocktop + view->y();
+				if (itemtop >= area->bottom) {
+					return;
+				} else if (itemtop + view->height() > area->top) {
+					_mediaPrefetch.add(view->data());
+				}
+			}
+		}
+	};
+	_mediaPrefetch.start();
+	enumerate(_migrated, migratedTop());
+	enumerate(_history, historyTop());
+	_mediaPrefetch.finish();
+}
+
 bool HistoryInner::displayScrollDate() const {
 	return (_visibleAreaTop <= height() - 2 * (_visibleAreaBottom - _visibleAreaTop));
 }
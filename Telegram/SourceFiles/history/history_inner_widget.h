@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/widgets/tooltip.h"
 #include "ui/widgets/scroll_area.h"
 #include "history/view/history_view_top_bar_widget.h"
+#include "history/view/history_view_media_prefetch.h"
 
 namespace Data {
 struct Group;
@@ -59,6 +60,8 @@ public:
 	void touchScrollUpdated(const QPoint &screenPos);
 
 	void recountHistoryGeometry();
+	void recountVisibleHistoryGeometry();
+	bool hasDeferredResizedBlocks() const;
 	void updateSize();
 
 	void repaintItem(const HistoryItem *item);
@@ -191,6 +194,7 @@ private:
 
 	void scrollDateCheck();
 	void scrollDateHideByTimer();
+	void prefetchMedia(int top, int bottom);
 	bool canHaveFromUserpics() const;
 	void mouseActionStart(const QPoint &screenPos, Qt::MouseButton button);
 	void mouseActionUpdate();
@@ -292,6 +296,8 @@ private:
 
 	// Does any of the shown histories has this flag set.
 	bool hasPendingResizedItems() const;
+	void recountHistoryGeometry(bool visibleOnly);
+	void resizeHistories(bool visibleOnly);
 
 	not_null<Window::Controller*> _controller;
 
@@ -367,4 +373,6 @@ private:
 	int _scrollDateLastItemTop = 0;
 	ClickHandlerPtr _scrollDateLink;
 
+	HistoryView::MediaPrefetch _mediaPrefetch;
+
 };
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/runtime_composer.h"
+#include "base/slab_allocator.h"
 #include "base/flags.h"
 #include "base/value_ordering.h"
 
@@ -54,7 +55,9 @@ enum class Context : char;
 class ElementDelegate;
 } // namespace HistoryView
 
-class HistoryItem : public RuntimeComposer<HistoryItem> {
+class HistoryItem
+	: public RuntimeComposer<HistoryItem>
+	, public base::releasing_slab_allocated {
 public:
 	static not_null<HistoryItem*> Create(
 		not_null<History*> history,
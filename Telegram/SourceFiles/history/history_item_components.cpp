@@ -410,9 +410,14 @@ void ReplyKeyboard::updateMessageId() {
 }
 
 void ReplyKeyboard::resize(int width, int height) {
+	// The button texts are parsed once in the constructor, so the layout
+	// depends only on the size and it is the same on every relayout.
+	if (_width == width && _height == height) {
+		return;
+	}
 	_width = width;
+	_height = height;
 
-	auto markup = _item->Get<HistoryMessageReplyMarkup>();
 	auto y = 0.;
 	auto buttonHeight = _rows.empty()
 		? float64(_st->buttonHeight())
@@ -481,6 +486,7 @@ bool ReplyKeyboard::isEnoughSpace(int width, const style::BotKeyboardButton &st)
 
 void ReplyKeyboard::setStyle(std::unique_ptr<Style> &&st) {
 	_st = std::move(st);
+	_width = _height = 0;
 }
 
 int ReplyKeyboard::naturalWidth() const {
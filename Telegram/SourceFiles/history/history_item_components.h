@@ -312,6 +312,7 @@ private:
 
 	const not_null<const HistoryItem*> _item;
 	int _width = 0;
+	int _height = 0;
 
 	std::vector<std::vector<Button>> _rows;
 
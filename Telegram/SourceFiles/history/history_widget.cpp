@@ -64,6 +64,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/application.h"
 #include "apiwrap.h"
 #include "history/view/history_view_top_bar_widget.h"
+#include "history/view/history_view_scroll_benchmark.h"
 #include "observer_peer.h"
 #include "base/qthelp_regex.h"
 #include "ui/widgets/popup_menu.h"
@@ -94,6 +95,8 @@ namespace {
 constexpr auto kMessagesPerPageFirst = 30;
 constexpr auto kMessagesPerPage = 50;
 constexpr auto kPreloadHeightsCount = 3; // when 3 screens to scroll left make a preload request
+constexpr auto kShowHistoryViewsLimit = 4 * kMessagesPerPage;
+constexpr auto kFinishDeferredResizeDelay = TimeMs(300);
 constexpr auto kTabbedSelectorToggleTooltipTimeoutMs = 3000;
 constexpr auto kTabbedSelectorToggleTooltipCount = 3;
 constexpr auto kScrollToVoiceAfterScrolledMs = 1000;
@@ -105,6 +108,7 @@ constexpr auto kCancelTypingActionTimeout = TimeMs(5000);
 constexpr auto kSaveDraftTimeout = 1000;
 constexpr auto kSaveDraftAnywayTimeout = 5000;
 constexpr auto kSaveCloudDraftIdleTimeout = 14000;
+constexpr auto kScrollBenchmarkScreens = 25;
 
 ApiWrap::RequestMessageDataCallback replyEditMessageDataCallback() {
 	return [](ChannelData *channel, MsgId msgId) {
@@ -251,6 +255,7 @@ HistoryWidget::HistoryWidget(
 	_scrollTimer.setSingleShot(false);
 
 	_highlightTimer.setCallback([this] { updateHighlightedMessage(); });
+	_deferredResizeTimer.setCallback([=] { finishDeferredResize(); });
 
 	_membersDropdownShowTimer.setSingleShot(true);
 	connect(&_membersDropdownShowTimer, SIGNAL(timeout()), this, SLOT(onMembersDropdownShow()));
@@ -371,7 +376,8 @@ HistoryWidget::HistoryWidget(
 		lifetime());
 	Auth().data().viewResizeRequest(
 	) | rpl::start_with_next([this](auto view) {
-		if (view->data()->mainView() == view) {
+		if (view->data()->mainView() == view
+			&& !deferHistoryUpdateWhileHidden()) {
 			updateHistoryGeometry();
 		}
 	}, lifetime());
@@ -1566,6 +1572,7 @@ void HistoryWidget::showHistory(
 		_membersDropdown.destroy();
 		_scrollToAnimation.finish();
 		_history = _migrated = nullptr;
+		_scrollBenchmark = nullptr;
 		_list = nullptr;
 		_peer = nullptr;
 		_channel = NoChannel;
@@ -1583,7 +1590,6 @@ void HistoryWidget::showHistory(
 	_replyEditMsg = nullptr;
 	_editMsgId = _replyToId = 0;
 	_previewData = nullptr;
-	_previewCache.clear();
 	_fieldBarCancel->hide();
 
 	_membersDropdownShowTimer.stop();
@@ -1653,6 +1659,14 @@ void HistoryWidget::showHistory(
 			}
 		}
 
+		// Don't lay out all the messages left from the previous visit
+		// if we're going to show only the bottom of the history anyway.
+		if ((_showAtMsgId == ShowAtUnreadMsgId
+			|| _showAtMsgId == ShowAtTheEndMsgId)
+			&& (!_migrated || _migrated->isEmpty())) {
+			_history->unloadBlocksAbove(kShowHistoryViewsLimit);
+		}
+
 		_scroll->hide();
 		_list = _scroll->setOwnedWidget(object_ptr<HistoryInner>(this, controller(), _scroll, _history));
 		_list->show();
@@ -1718,6 +1732,7 @@ void HistoryWidget::showHistory(
 	updateForwarding();
 	updateOverStates(mapFromGlobal(QCursor::pos()));
 
+	Auth().data().setShownHistory(_history);
 	if (_history) {
 		controller()->setActiveChatEntry({
 			_history,
@@ -2120,9 +2135,11 @@ void HistoryWidget::destroyUnreadBar() {
 	if (_migrated) _migrated->destroyUnreadBar();
 }
 
-void HistoryWidget::newUnreadMsg(
+void HistoryWidget::newUnreadMsgs(
 		not_null<History*> history,
-		not_null<HistoryItem*> item) {
+		const std::vector<not_null<HistoryItem*>> &items) {
+	Expects(!items.empty());
+
 	if (_history == history) {
 		// If we get here in non-resized state we can't rely on results of
 		// doWeReadServerHistory() and mark chat as read.
@@ -2135,16 +2152,20 @@ void HistoryWidget::newUnreadMsg(
 			destroyUnreadBar();
 		}
 		if (App::wnd()->doWeReadServerHistory()) {
-			if (item->isUnreadMention() && !item->isUnreadMedia()) {
-				Auth().api().markMediaRead(item);
+			for (const auto item : items) {
+				if (item->isUnreadMention() && !item->isUnreadMedia()) {
+					Auth().api().markMediaRead(item);
+				}
 			}
 			Auth().api().readServerHistoryForce(history);
 			return;
 		}
 	}
-	Auth().notifications().schedule(history, item);
+	for (const auto item : items) {
+		Auth().notifications().schedule(history, item);
+	}
 	if (history->unreadCountKnown()) {
-		history->changeUnreadCount(1);
+		history->changeUnreadCount(int(items.size()));
 	} else {
 		Auth().api().requestDialogEntry(history);
 	}
@@ -2563,6 +2584,9 @@ void HistoryWidget::onScroll() {
 	visibleAreaUpdated();
 	if (!_synteticScrollEvent) {
 		_lastUserScrolled = getms();
+		if (_deferredResizeTimer.isActive()) {
+			_deferredResizeTimer.callOnce(0);
+		}
 	}
 }
 
@@ -4481,7 +4505,9 @@ void HistoryWidget::onReportSpamClear() {
 
 void HistoryWidget::handleHistoryChange(not_null<const History*> history) {
 	if (_list && (_history == history || _migrated == history)) {
-		handlePendingHistoryUpdate();
+		if (!deferHistoryUpdateWhileHidden()) {
+			handlePendingHistoryUpdate();
+		}
 		updateBotKeyboard();
 		if (!_scroll->isHidden()) {
 			const auto unblock = isBlocked();
@@ -4554,10 +4580,24 @@ void HistoryWidget::handlePendingHistoryUpdate() {
 	}
 }
 
+bool HistoryWidget::deferHistoryUpdateWhileHidden() {
+	// Nobody will see the new messages in a hidden or minimized window,
+	// lay them out when the window is painted again.
+	const auto window = this->window();
+	if (window->isVisible()
+		&& !(window->windowState() & Qt::WindowMinimized)) {
+		return false;
+	}
+	_historyUpdateDeferred = true;
+	return true;
+}
+
 void HistoryWidget::resizeEvent(QResizeEvent *e) {
 	//updateTabbedSelectorSectionShown();
 	recountChatWidth();
+	_resizingVisibleOnly = true;
 	updateControlsGeometry();
+	_resizingVisibleOnly = false;
 }
 
 void HistoryWidget::updateControlsGeometry() {
@@ -4661,6 +4701,21 @@ void HistoryWidget::updateScrollColors() {
 	_scroll->updateBars();
 }
 
+void HistoryWidget::startScrollBenchmark() {
+	if (!_list) {
+		Ui::show(Box<InformBox>(qsl("Open a chat to run the benchmark.")));
+		return;
+	}
+	_scrollBenchmark = std::make_unique<HistoryView::ScrollBenchmark>(
+		_scroll.data(),
+		_list.data(),
+		[](const QString &results) {
+			LOG(("Scroll Benchmark: %1").arg(results));
+			Ui::show(Box<InformBox>(results));
+		});
+	_scrollBenchmark->start(kScrollBenchmarkScreens);
+}
+
 MsgId HistoryWidget::replyToId() const {
 	return _replyToId ? _replyToId : (_kbReplyTo ? _kbReplyTo->id : 0);
 }
@@ -4830,7 +4885,14 @@ void HistoryWidget::updateHistoryGeometry(bool initial, bool loadedDown, const S
 }
 
 void HistoryWidget::updateListSize() {
-	_list->recountHistoryGeometry();
+	if (_resizingVisibleOnly) {
+		_list->recountVisibleHistoryGeometry();
+		if (_list->hasDeferredResizedBlocks()) {
+			_deferredResizeTimer.callOnce(kFinishDeferredResizeDelay);
+		}
+	} else {
+		_list->recountHistoryGeometry();
+	}
 	auto washidden = _scroll->isHidden();
 	if (washidden) {
 		_scroll->show();
@@ -4842,6 +4904,13 @@ void HistoryWidget::updateListSize() {
 	_updateHistoryGeometryRequired = true;
 }
 
+void HistoryWidget::finishDeferredResize() {
+	if (_list && _list->hasDeferredResizedBlocks()) {
+		updateHistoryGeometry();
+		_list->update();
+	}
+}
+
 bool HistoryWidget::hasPendingResizedItems() const {
 	return (_history && _history->hasPendingResizedItems())
 		|| (_migrated && _migrated->hasPendingResizedItems());
@@ -5858,16 +5927,17 @@ void HistoryWidget::checkPreview() {
 				previewCancel();
 			}
 		} else {
-			const auto i = _previewCache.constFind(_previewLinks);
-			if (i == _previewCache.cend()) {
+			const auto cached = Auth().data().cachedWebPagePreview(
+				_previewLinks);
+			if (!cached) {
 				_previewRequest = MTP::send(
 					MTPmessages_GetWebPagePreview(
 						MTP_flags(0),
 						MTP_string(_previewLinks),
 						MTPnullEntities),
 					rpcDone(&HistoryWidget::gotPreview, _previewLinks));
-			} else if (i.value()) {
-				_previewData = Auth().data().webpage(i.value());
+			} else if (*cached) {
+				_previewData = Auth().data().webpage(*cached);
 				updatePreview();
 			} else {
 				if (_previewData && _previewData->pendingTill >= 0) previewCancel();
@@ -5897,7 +5967,7 @@ void HistoryWidget::gotPreview(QString links, const MTPMessageMedia &result, mtp
 	if (result.type() == mtpc_messageMediaWebPage) {
 		const auto &data = result.c_messageMediaWebPage().vwebpage;
 		const auto page = Auth().data().processWebpage(data);
-		_previewCache.insert(links, page->id);
+		Auth().data().cacheWebPagePreview(links, page->id);
 		if (page->pendingTill > 0 && page->pendingTill <= unixtime()) {
 			page->pendingTill = -1;
 		}
@@ -5909,7 +5979,7 @@ void HistoryWidget::gotPreview(QString links, const MTPMessageMedia &result, mtp
 		}
 		Auth().data().sendWebPageGamePollNotifications();
 	} else if (result.type() == mtpc_messageMediaEmpty) {
-		_previewCache.insert(links, 0);
+		Auth().data().cacheWebPagePreview(links, 0);
 		if (links == _previewLinks && !_previewCancelled) {
 			_previewData = nullptr;
 			updatePreview();
@@ -6530,6 +6600,10 @@ void HistoryWidget::paintEvent(QPaintEvent *e) {
 	if (Ui::skipPaintEvent(this, e)) {
 		return;
 	}
+	if (_historyUpdateDeferred) {
+		_historyUpdateDeferred = false;
+		updateHistoryGeometry();
+	}
 	if (hasPendingResizedItems()) {
 		updateListSize();
 	}
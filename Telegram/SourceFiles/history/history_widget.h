@@ -77,6 +77,7 @@ struct UploadedThumbDocument;
 
 namespace HistoryView {
 class TopBarWidget;
+class ScrollBenchmark;
 } // namespace HistoryView
 
 class DragArea;
@@ -141,9 +142,9 @@ public:
 	void firstLoadMessages();
 	void delayedShowAt(MsgId showAtMsgId);
 
-	void newUnreadMsg(
+	void newUnreadMsgs(
 		not_null<History*> history,
-		not_null<HistoryItem*> item);
+		const std::vector<not_null<HistoryItem*>> &items);
 	void historyToDown(History *history);
 
 	QRect historyRect() const;
@@ -192,6 +193,7 @@ public:
 	void itemEdited(HistoryItem *item);
 
 	void updateScrollColors();
+	void startScrollBenchmark();
 
 	void replyToMessage(FullMsgId itemId);
 	void replyToMessage(not_null<HistoryItem*> item);
@@ -367,6 +369,7 @@ private:
 
 	void send(Qt::KeyboardModifiers modifiers = Qt::KeyboardModifiers());
 	void handlePendingHistoryUpdate();
+	bool deferHistoryUpdateWhileHidden();
 	void fullPeerUpdated(PeerData *peer);
 	void toggleTabbedSelectorMode();
 	void returnTabbedSelector(object_ptr<TabbedSelector> selector);
@@ -577,8 +580,6 @@ private:
 	QStringList _parsedLinks;
 	QString _previewLinks;
 	WebPageData *_previewData = nullptr;
-	typedef QMap<QString, WebPageId> PreviewCache;
-	PreviewCache _previewCache;
 	mtpRequestId _previewRequest = 0;
 	Text _previewTitle;
 	Text _previewDescription;
@@ -618,6 +619,7 @@ private:
 	};
 	void updateHistoryGeometry(bool initial = false, bool loadedDown = false, const ScrollChange &change = { ScrollChangeNone, 0 });
 	void updateListSize();
+	void finishDeferredResize();
 
 	// Does any of the shown histories has this flag set.
 	bool hasPendingResizedItems() const;
@@ -692,14 +694,21 @@ private:
 	object_ptr<HistoryView::TopBarWidget> _topBar;
 	object_ptr<Ui::ScrollArea> _scroll;
 	QPointer<HistoryInner> _list;
+	std::unique_ptr<HistoryView::ScrollBenchmark> _scrollBenchmark;
 	History *_migrated = nullptr;
 	History *_history = nullptr;
 	// Initial updateHistoryGeometry() was called.
 	bool _historyInited = false;
 	// If updateListSize() was called without updateHistoryGeometry().
 	bool _updateHistoryGeometryRequired = false;
+	bool _historyUpdateDeferred = false;
 	int _addToScroll = 0;
 
+	// While the window is being resized only the visible messages are
+	// laid out, others are resized by _deferredResizeTimer.
+	bool _resizingVisibleOnly = false;
+	base::Timer _deferredResizeTimer;
+
 	int _lastScrollTop = 0; // gifs optimization
 	TimeMs _lastScrolled = 0;
 	QTimer _updateHistoryItems;
@@ -51,6 +51,12 @@ HistoryDocument::HistoryDocument(
 	}
 }
 
+HistoryDocument::~HistoryDocument() {
+	if (const auto voice = _data->voice()) {
+		Local::cancelVoiceWaveform(voice);
+	}
+}
+
 float64 HistoryDocument::dataProgress() const {
 	return _data->progress();
 }
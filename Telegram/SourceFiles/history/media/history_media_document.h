@@ -19,6 +19,7 @@ public:
 	HistoryDocument(
 		not_null<Element*> parent,
 		not_null<DocumentData*> document);
+	~HistoryDocument();
 
 	void draw(Painter &p, const QRect &r, TextSelection selection, TimeMs ms) const override;
 	TextState textState(QPoint point, StateRequest request) const override;
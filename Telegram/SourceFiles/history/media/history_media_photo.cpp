@@ -201,6 +201,8 @@ void HistoryPhoto::draw(Painter &p, const QRect &r, TextSelection selection, Tim
 		const auto pix = [&] {
 			if (loaded) {
 				return _data->large()->pixSingle(_realParent->fullId(), _pixw, _pixh, paintw, painth, roundRadius, roundCorners);
+			} else if (auto progressive = _data->large()->pixProgressiveSingle(_pixw, _pixh, paintw, painth, roundRadius, roundCorners); !progressive.isNull()) {
+				return progressive;
 			} else if (_data->thumbnail()->loaded()) {
 				return _data->thumbnail()->pixBlurredSingle(_realParent->fullId(), _pixw, _pixh, paintw, painth, roundRadius, roundCorners);
 			} else if (_data->thumbnailSmall()->loaded()) {
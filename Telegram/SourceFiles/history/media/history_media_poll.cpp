@@ -487,6 +487,10 @@ void HistoryPoll::draw(Painter &p, const QRect &r, TextSelection selection, Time
 	if (width() < st::msgPadding.left() + st::msgPadding.right() + 1) return;
 	auto paintx = 0, painty = 0, paintw = width(), painth = height();
 
+	if (_pollVersion != _poll->version) {
+		// Results updates request only a repaint, not a resize.
+		const_cast<HistoryPoll*>(this)->updateTexts();
+	}
 	checkSendingAnimation();
 	_poll->checkResultsReload(_parent->data(), ms);
 
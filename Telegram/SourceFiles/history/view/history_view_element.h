@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "history/view/history_view_object.h"
 #include "base/runtime_composer.h"
+#include "base/slab_allocator.h"
 #include "base/flags.h"
 
 class HistoryBlock;
@@ -104,7 +105,8 @@ struct DateBadge : public RuntimeComponent<DateBadge, Element> {
 class Element
 	: public Object
 	, public RuntimeComposer<Element>
-	, public ClickHandlerHost {
+	, public ClickHandlerHost
+	, public base::releasing_slab_allocated {
 public:
 	Element(
 		not_null<ElementDelegate*> delegate,
@@ -42,8 +42,9 @@ namespace {
 constexpr auto kScrollDateHideTimeout = 1000;
 constexpr auto kPreloadedScreensCount = 4;
 constexpr auto kPreloadIfLessThanScreens = 2;
-constexpr auto kPreloadedScreensCountFull
-	= kPreloadedScreensCount + 1 + kPreloadedScreensCount;
+constexpr auto kPreloadedScreensCountFast = 8;
+constexpr auto kPreloadIfLessThanScreensFast = 4;
+constexpr auto kScrollSpeedPeriod = TimeMs(300);
 
 } // namespace
 
@@ -567,13 +568,16 @@ void ListWidget::visibleTopBottomUpdated(
 
 	const auto initializing = !(_visibleTop < _visibleBottom);
 	const auto scrolledUp = (visibleTop < _visibleTop);
+	const auto scrolled = initializing ? 0 : (visibleTop - _visibleTop);
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
+	updateScrollSpeed(scrolled);
 
 	if (initializing) {
 		checkUnreadBarCreation();
 	}
 	updateVisibleTopItem();
+	prefetchMedia();
 	if (scrolledUp) {
 		_scrollDateCheck.call();
 	} else {
@@ -583,11 +587,43 @@ void ListWidget::visibleTopBottomUpdated(
 	_applyUpdatedScrollState.call();
 }
 
+void ListWidget::updateScrollSpeed(int scrolled) {
+	const auto now = getms();
+	if (now - _scrollSpeedPeriodStart > kScrollSpeedPeriod) {
+		_scrollSpeedPeriodStart = now;
+		_scrolledInPeriod = 0;
+	}
+	_scrolledInPeriod += std::abs(scrolled);
+
+	// More than a screen in a short period is a fling,
+	// we need a larger slice around to keep up with it.
+	_fastScrolling = (_scrolledInPeriod > _visibleBottom - _visibleTop);
+}
+
 void ListWidget::applyUpdatedScrollState() {
 	checkMoveToOtherViewer();
 	_delegate->listVisibleItemsChanged(collectVisibleItems());
 }
 
+void ListWidget::prefetchMedia() {
+	const auto area = _mediaPrefetch.visibleAreaUpdated(
+		_visibleTop,
+		_visibleBottom);
+	if (!area) {
+		return;
+	}
+	_mediaPrefetch.start();
+	for (const auto view : _items) {
+		const auto top = itemTop(view);
+		if (top >= area->bottom) {
+			break;
+		} else if (top + view->height() > area->top) {
+			_mediaPrefetch.add(view->data());
+		}
+	}
+	_mediaPrefetch.finish();
+}
+
 void ListWidget::updateVisibleTopItem() {
 	if (_visibleBottom == height()) {
 		_visibleTopItem = nullptr;
@@ -1008,15 +1044,23 @@ void ListWidget::checkMoveToOtherViewer() {
 		return;
 	}
 
+	const auto preloadedScreens = _fastScrolling
+		? kPreloadedScreensCountFast
+		: kPreloadedScreensCount;
+	const auto preloadIfLessThanScreens = _fastScrolling
+		? kPreloadIfLessThanScreensFast
+		: kPreloadIfLessThanScreens;
+
 	auto topItem = findItemByY(_visibleTop);
 	auto bottomItem = findItemByY(_visibleBottom);
-	auto preloadedHeight = kPreloadedScreensCountFull * visibleHeight;
+	auto preloadedHeight = (preloadedScreens + 1 + preloadedScreens)
+		* visibleHeight;
 	auto preloadedCount = preloadedHeight / _itemAverageHeight;
 	auto preloadIdsLimitMin = (preloadedCount / 2) + 1;
 	auto preloadIdsLimit = preloadIdsLimitMin
 		+ (visibleHeight / _itemAverageHeight);
 
-	auto preloadBefore = kPreloadIfLessThanScreens * visibleHeight;
+	auto preloadBefore = preloadIfLessThanScreens * visibleHeight;
 	auto before = _slice.skippedBefore;
 	auto preloadTop = (_visibleTop < preloadBefore);
 	auto topLoaded = before && (*before == 0);
@@ -1024,8 +1068,7 @@ void ListWidget::checkMoveToOtherViewer() {
 	auto preloadBottom = (height() - _visibleBottom < preloadBefore);
 	auto bottomLoaded = after && (*after == 0);
 
-	auto minScreenDelta = kPreloadedScreensCount
-		- kPreloadIfLessThanScreens;
+	auto minScreenDelta = preloadedScreens - preloadIfLessThanScreens;
 	auto minUniversalIdDelta = (minScreenDelta * visibleHeight)
 		/ _itemAverageHeight;
 	auto preloadAroundMessage = [&](not_null<Element*> view) {
@@ -1398,6 +1441,7 @@ TextWithEntities ListWidget::getSelectedText() const {
 	const auto timeFormat = qsl(", [dd.MM.yy hh:mm]\n");
 	auto groups = base::flat_set<not_null<const Data::Group*>>();
 	auto fullSize = 0;
+	auto fullEntities = 0;
 	auto texts = std::vector<std::pair<
 		not_null<HistoryItem*>,
 		TextWithEntities>>();
@@ -1414,8 +1458,9 @@ TextWithEntities ListWidget::getSelectedText() const {
 		part.text.reserve(size);
 		part.text.append(item->author()->name).append(time);
 		TextUtilities::Append(part, std::move(unwrapped));
-		texts.push_back(std::make_pair(std::move(item), std::move(part)));
 		fullSize += size;
+		fullEntities += part.entities.size();
+		texts.push_back(std::make_pair(std::move(item), std::move(part)));
 	};
 	const auto addItem = [&](not_null<HistoryItem*> item) {
 		wrapItem(item, HistoryItemText(item));
@@ -1452,6 +1497,7 @@ TextWithEntities ListWidget::getSelectedText() const {
 	auto result = TextWithEntities();
 	auto sep = qsl("\n\n");
 	result.text.reserve(fullSize + (texts.size() - 1) * sep.size());
+	result.entities.reserve(fullEntities);
 	for (auto i = begin(texts), e = end(texts); i != e;) {
 		TextUtilities::Append(result, std::move(i->second));
 		if (++i != e) {
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/timer.h"
 #include "data/data_messages.h"
 #include "history/view/history_view_element.h"
+#include "history/view/history_view_media_prefetch.h"
 
 namespace Ui {
 class PopupMenu;
@@ -293,6 +294,7 @@ private:
 
 	void checkMoveToOtherViewer();
 	void updateVisibleTopItem();
+	void prefetchMedia();
 	void updateItemsGeometry();
 	void updateSize();
 	void refreshAttachmentsFromTill(int from, int till);
@@ -380,6 +382,7 @@ private:
 		not_null<const SelectedMap*> selected,
 		not_null<const Element*> view) const;
 	void checkUnreadBarCreation();
+	void updateScrollSpeed(int scrolled);
 	void applyUpdatedScrollState();
 	void scrollToAnimationCallback(FullMsgId attachToId);
 
@@ -432,8 +435,12 @@ private:
 	int _minHeight = 0;
 	int _visibleTop = 0;
 	int _visibleBottom = 0;
+	TimeMs _scrollSpeedPeriodStart = 0;
+	int _scrolledInPeriod = 0;
+	bool _fastScrolling = false;
 	Element *_visibleTopItem = nullptr;
 	int _visibleTopFromItem = 0;
+	MediaPrefetch _mediaPrefetch;
 	ScrollTopState _scrollTopState;
 	Animation _scrollToAnimation;
 
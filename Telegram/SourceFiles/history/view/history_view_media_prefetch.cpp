@@ -0,0 +1,104 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "history/view/history_view_media_prefetch.h"
+
+#include "history/history_item.h"
+#include "data/data_media_types.h"
+#include "data/data_photo.h"
+#include "data/data_document.h"
+
+namespace HistoryView {
+namespace {
+
+// Scrolling faster than a screen per second prefetches two screens.
+constexpr auto kFastScrollScreensPerSecond = 1;
+constexpr auto kSlowScrollScreens = 1;
+constexpr auto kFastScrollScreens = 2;
+
+// Scroll events further apart don't give the scroll speed.
+constexpr auto kScrollSpeedTimeout = TimeMs(1000);
+
+} // namespace
+
+std::optional<MediaPrefetch::Area> MediaPrefetch::visibleAreaUpdated(
+		int top,
+		int bottom) {
+	const auto now = getms();
+	const auto height = bottom - top;
+	const auto wasValid = std::exchange(_lastValid, (height > 0));
+	const auto delta = top - std::exchange(_lastTop, top);
+	const auto elapsed = now - std::exchange(_lastTime, now);
+	if (!wasValid || height <= 0 || !delta) {
+		return std::nullopt;
+	}
+	const auto fast = (elapsed < kScrollSpeedTimeout)
+		&& (std::abs(delta) * TimeMs(1000)
+			>= height * kFastScrollScreensPerSecond * elapsed);
+	const auto ahead = height
+		* (fast ? kFastScrollScreens : kSlowScrollScreens);
+	return (delta > 0)
+		? Area{ bottom, bottom + ahead }
+		: Area{ top - ahead, top };
+}
+
+void MediaPrefetch::start() {
+	_adding.clear();
+}
+
+void MediaPrefetch::add(not_null<HistoryItem*> item) {
+	const auto itemId = item->fullId();
+	if (_adding.contains(itemId)) {
+		return;
+	}
+	_adding.emplace(itemId);
+	if (!_items.contains(itemId)) {
+		Prefetch(item);
+	}
+}
+
+void MediaPrefetch::finish() {
+	for (const auto itemId : _items) {
+		if (!_adding.contains(itemId)) {
+			CancelPrefetch(itemId);
+		}
+	}
+	_items = base::take(_adding);
+}
+
+void MediaPrefetch::clear() {
+	for (const auto itemId : base::take(_items)) {
+		CancelPrefetch(itemId);
+	}
+	_adding.clear();
+	_lastValid = false;
+}
+
+void MediaPrefetch::Prefetch(not_null<HistoryItem*> item) {
+	const auto media = item->media();
+	if (!media) {
+		return;
+	} else if (const auto photo = media->photo()) {
+		photo->prefetch(item->fullId(), item);
+	} else if (const auto document = media->document()) {
+		document->prefetch(item->fullId(), item);
+	}
+}
+
+void MediaPrefetch::CancelPrefetch(FullMsgId itemId) {
+	const auto item = App::histItemById(itemId);
+	const auto media = item ? item->media() : nullptr;
+	if (!media) {
+		return;
+	} else if (const auto photo = media->photo()) {
+		photo->cancelPrefetch();
+	} else if (const auto document = media->document()) {
+		document->cancelPrefetch();
+	}
+}
+
+} // namespace HistoryView
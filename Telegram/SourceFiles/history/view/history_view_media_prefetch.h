@@ -0,0 +1,47 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class HistoryItem;
+
+namespace HistoryView {
+
+// Loads media of the messages the user is expected to scroll to soon
+// with the Prefetch load priority and cancels those loads when the
+// messages leave the prefetched area.
+class MediaPrefetch final {
+public:
+	struct Area {
+		int top = 0;
+		int bottom = 0;
+	};
+
+	// Returns the area one or two screens ahead in the scroll direction,
+	// depending on the scroll speed, or nothing if the scroll didn't move.
+	std::optional<Area> visibleAreaUpdated(int top, int bottom);
+
+	// Call add() for each message in the returned area between those.
+	void start();
+	void add(not_null<HistoryItem*> item);
+	void finish();
+
+	void clear();
+
+private:
+	static void Prefetch(not_null<HistoryItem*> item);
+	static void CancelPrefetch(FullMsgId itemId);
+
+	bool _lastValid = false;
+	int _lastTop = 0;
+	TimeMs _lastTime = 0;
+	base::flat_set<FullMsgId> _items;
+	base::flat_set<FullMsgId> _adding;
+
+};
+
+} // namespace HistoryView
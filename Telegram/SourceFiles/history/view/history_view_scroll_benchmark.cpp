@@ -0,0 +1,109 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "history/view/history_view_scroll_benchmark.h"
+
+#include "ui/widgets/scroll_area.h"
+
+#include <chrono>
+
+namespace HistoryView {
+namespace {
+
+constexpr auto kStepsPerScreen = 4;
+constexpr auto kFrameDuration = TimeMs(16);
+
+// While scrolling up older messages may be loading, we wait for them.
+constexpr auto kMaxStuckSteps = 120;
+
+// Frames longer than that are counted as dropped.
+constexpr auto kSlowFrame = int64(1000000 / 60);
+
+QString FormatMs(int64 microseconds) {
+	return QString::number(microseconds / 1000., 'f', 2) + " ms";
+}
+
+} // namespace
+
+ScrollBenchmark::ScrollBenchmark(
+	not_null<Ui::ScrollArea*> scroll,
+	not_null<QWidget*> content,
+	Fn<void(QString)> done)
+: _scroll(scroll)
+, _content(content)
+, _done(std::move(done))
+, _timer([=] { step(); }) {
+}
+
+void ScrollBenchmark::start(int screens) {
+	Expects(screens > 0);
+
+	_stepsLeft = screens * kStepsPerScreen;
+	_direction = -1;
+	_stuckSteps = 0;
+	_frames.clear();
+	_frames.reserve(2 * _stepsLeft);
+	_timer.callEach(kFrameDuration);
+}
+
+void ScrollBenchmark::step() {
+	const auto delta = std::max(_scroll->height() / kStepsPerScreen, 1);
+	const auto was = _scroll->scrollTop();
+	const auto now = snap(
+		was + _direction * delta,
+		0,
+		_scroll->scrollTopMax());
+	if (!_stepsLeft || now == was) {
+		if (_stepsLeft && _direction < 0 && ++_stuckSteps < kMaxStuckSteps) {
+			return;
+		} else if (_direction > 0) {
+			finish();
+			return;
+		}
+		// Scroll back down the same amount of steps we've made up.
+		_direction = 1;
+		_stepsLeft = int(_frames.size());
+		return;
+	}
+	_stuckSteps = 0;
+	--_stepsLeft;
+
+	using Clock = std::chrono::steady_clock;
+	const auto started = Clock::now();
+	_scroll->scrollToY(now);
+	_content->repaint();
+	_frames.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+		Clock::now() - started).count());
+}
+
+void ScrollBenchmark::finish() {
+	_timer.cancel();
+	_done(countResults());
+}
+
+QString ScrollBenchmark::countResults() const {
+	if (_frames.empty()) {
+		return qsl("Nothing to scroll.");
+	}
+	auto sorted = _frames;
+	ranges::sort(sorted);
+	const auto count = int(sorted.size());
+	const auto total = ranges::accumulate(sorted, int64(0));
+	const auto slow = ranges::count_if(sorted, [](int64 frame) {
+		return frame > kSlowFrame;
+	});
+	return qsl("Scrolled %1 steps, frame average %2, median %3, "
+		"95% %4, max %5, slower than 60 fps: %6."
+		).arg(count
+		).arg(FormatMs(total / count)
+		).arg(FormatMs(sorted[count / 2])
+		).arg(FormatMs(sorted[(count * 95) / 100])
+		).arg(FormatMs(sorted.back())
+		).arg(slow);
+}
+
+} // namespace HistoryView
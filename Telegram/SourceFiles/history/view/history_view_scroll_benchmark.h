@@ -0,0 +1,46 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/timer.h"
+
+namespace Ui {
+class ScrollArea;
+} // namespace Ui
+
+namespace HistoryView {
+
+// Scrolls a list a number of screens up and back down, one step per frame,
+// repainting it synchronously and measuring the time of each step.
+class ScrollBenchmark final {
+public:
+	ScrollBenchmark(
+		not_null<Ui::ScrollArea*> scroll,
+		not_null<QWidget*> content,
+		Fn<void(QString)> done);
+
+	void start(int screens);
+
+private:
+	void step();
+	void finish();
+	QString countResults() const;
+
+	const not_null<Ui::ScrollArea*> _scroll;
+	const not_null<QWidget*> _content;
+	const Fn<void(QString)> _done;
+	base::Timer _timer;
+
+	int _stepsLeft = 0;
+	int _direction = -1;
+	int _stuckSteps = 0;
+	std::vector<int64> _frames;
+
+};
+
+} // namespace HistoryView
@@ -141,10 +141,13 @@ void Gif::paint(Painter &p, const QRect &clip, const PaintContext *context) cons
 	const auto document = getShownDocument();
 	document->automaticLoad(fileOrigin(), nullptr);
 
+	int32 height = st::inlineMediaHeight;
+	QSize frame = countFrameSize();
+
 	bool loaded = document->loaded(), loading = document->loading(), displayLoading = document->displayLoading();
 	if (loaded && !_gif && !_gif.isBad()) {
 		auto that = const_cast<Gif*>(this);
-		that->_gif = Media::Clip::MakeReader(document, FullMsgId(), [that](Media::Clip::Notification notification) {
+		that->_gif = Media::Clip::MakeSharedReader(document, frame, QSize(_width, height), [that](Media::Clip::Notification notification) {
 			that->clipCallback(notification);
 		});
 		if (_gif) _gif->setAutoplay();
@@ -159,9 +162,6 @@ void Gif::paint(Painter &p, const QRect &clip, const PaintContext *context) cons
 	}
 	bool radial = isRadialAnimation(context->ms);
 
-	int32 height = st::inlineMediaHeight;
-	QSize frame = countFrameSize();
-
 	QRect r(0, 0, _width, height);
 	if (animating) {
 		if (!_thumb.isNull()) _thumb = QPixmap();
@@ -39,6 +39,7 @@ namespace internal {
 namespace {
 
 constexpr auto kInlineBotRequestDelay = 400;
+constexpr auto kInlineCacheLimit = 32;
 
 } // namespace
 
@@ -1008,6 +1009,7 @@ void Widget::inlineBotChanged() {
 	if (_inlineRequestId) MTP::cancel(_inlineRequestId);
 	_inlineRequestId = 0;
 	_inlineQuery = _inlineNextQuery = _inlineNextOffset = QString();
+	_inlineShownQuery = QString();
 	_inlineBot = nullptr;
 	_inlineCache.clear();
 	_inner->inlineBotChanged();
@@ -1033,6 +1035,9 @@ void Widget::inlineResultsDone(const MTPmessages_BotResults &result) {
 			it = _inlineCache.emplace(_inlineQuery, std::make_unique<internal::CacheEntry>()).first;
 		}
 		auto entry = it->second.get();
+		if (!adding) {
+			entry->expires = getms(true) + d.vcache_time.v * TimeMs(1000);
+		}
 		entry->nextOffset = qs(d.vnext_offset);
 		if (d.has_switch_pm() && d.vswitch_pm.type() == mtpc_inlineBotSwitchPM) {
 			auto &switchPm = d.vswitch_pm.c_inlineBotSwitchPM();
@@ -1061,9 +1066,46 @@ void Widget::inlineResultsDone(const MTPmessages_BotResults &result) {
 	if (!showInlineRows(!adding)) {
 		it->second->nextOffset = QString();
 	}
+	checkInlineCacheLimit();
 	onScroll();
 }
 
+bool Widget::inlineCacheInUse(const QString &query) const {
+	// The displayed rows hold pointers to the results.
+	return (query == _inlineQuery) || (query == _inlineShownQuery);
+}
+
+void Widget::removeExpiredInlineCache(const QString &query) {
+	if (inlineCacheInUse(query)) {
+		return;
+	}
+	const auto i = _inlineCache.find(query);
+	if (i != _inlineCache.cend() && i->second->expires <= getms(true)) {
+		_inlineCache.erase(i);
+		_inner->deleteUnusedInlineLayouts();
+	}
+}
+
+void Widget::checkInlineCacheLimit() {
+	if (int(_inlineCache.size()) <= internal::kInlineCacheLimit) {
+		return;
+	}
+
+	auto oldest = _inlineCache.end();
+	for (auto i = _inlineCache.begin(); i != _inlineCache.cend(); ++i) {
+		if (inlineCacheInUse(i->first)) {
+			continue;
+		} else if (oldest == _inlineCache.cend()
+			|| i->second->lastUsed < oldest->second->lastUsed) {
+			oldest = i;
+		}
+	}
+	if (oldest != _inlineCache.cend()) {
+		_inlineCache.erase(oldest);
+		_inner->deleteUnusedInlineLayouts();
+	}
+}
+
 void Widget::queryInlineBot(UserData *bot, PeerData *peer, QString query) {
 	bool force = false;
 	_inlineQueryPeer = peer;
@@ -1079,6 +1121,7 @@ void Widget::queryInlineBot(UserData *bot, PeerData *peer, QString query) {
 			_inlineRequestId = 0;
 			Notify::inlineBotRequesting(false);
 		}
+		removeExpiredInlineCache(query);
 		if (_inlineCache.find(query) != _inlineCache.cend()) {
 			_inlineRequestTimer.stop();
 			_inlineQuery = _inlineNextQuery = query;
@@ -1124,9 +1167,11 @@ bool Widget::refreshInlineRows(int *added) {
 		if (!it->second->results.empty() || !it->second->switchPmText.isEmpty()) {
 			entry = it->second.get();
 		}
+		it->second->lastUsed = getms(true);
 		_inlineNextOffset = it->second->nextOffset;
 	}
 	if (!entry) prepareCache();
+	_inlineShownQuery = entry ? _inlineQuery : QString();
 	auto result = _inner->refreshInlineRows(_inlineQueryPeer, _inlineBot, entry, false);
 	if (added) *added = result;
 	return (entry != nullptr);
@@ -45,6 +45,8 @@ struct CacheEntry {
 	QString nextOffset;
 	QString switchPmText, switchPmStartToken;
 	Results results;
+	TimeMs expires = 0; // From the cache_time of the first page.
+	TimeMs lastUsed = 0;
 };
 
 class Inner : public TWidget, public Context, private base::Subscriber {
@@ -62,6 +64,9 @@ public:
 	void hideInlineRowsPanel();
 	void clearInlineRowsPanel();
 
+	// Call after removing results that are not displayed right now.
+	void deleteUnusedInlineLayouts();
+
 	void preloadImages();
 
 	void inlineItemLayoutChanged(const ItemBase *layout) override;
@@ -122,7 +127,6 @@ private:
 	bool inlineRowFinalize(Row &row, int32 &sumWidth, bool force = false);
 
 	Row &layoutInlineRow(Row &row, int32 sumWidth = 0);
-	void deleteUnusedInlineLayouts();
 
 	int validateExistingInlineRows(const Results &results);
 	void selectInlineResult(int row, int column);
@@ -233,6 +237,9 @@ private:
 	void recountContentMaxHeight();
 	bool refreshInlineRows(int *added = nullptr);
 	void inlineResultsDone(const MTPmessages_BotResults &result);
+	bool inlineCacheInUse(const QString &query) const;
+	void removeExpiredInlineCache(const QString &query);
+	void checkInlineCacheLimit();
 
 	not_null<Window::Controller*> _controller;
 
@@ -261,6 +268,7 @@ private:
 	UserData *_inlineBot = nullptr;
 	PeerData *_inlineQueryPeer = nullptr;
 	QString _inlineQuery, _inlineNextQuery, _inlineNextOffset;
+	QString _inlineShownQuery;
 	mtpRequestId _inlineRequestId = 0;
 
 };
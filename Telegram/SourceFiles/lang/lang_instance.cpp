@@ -82,7 +82,15 @@ ValueParser::ValueParser(const QByteArray &key, LangKey keyIndex, const QByteArr
 }
 
 void ValueParser::appendToResult(const char *nextBegin) {
-	if (_ch > _begin) _result.append(QString::fromUtf8(_begin, _ch - _begin));
+	if (_ch > _begin) {
+		const auto part = QString::fromUtf8(_begin, _ch - _begin);
+		if (_result.isEmpty()) {
+			// Most of the values don't have tags, use the decoded as is.
+			_result = part;
+		} else {
+			_result.append(part);
+		}
+	}
 	_begin = nextBegin;
 }
 
@@ -140,7 +148,6 @@ bool ValueParser::readTag() {
 
 bool ValueParser::parse() {
 	_failed = false;
-	_result.reserve(_end - _begin);
 	for (; _ch != _end; ++_ch) {
 		if (*_ch == '{') {
 			appendToResult(_ch);
@@ -693,13 +700,28 @@ void Instance::applyDifferenceToMe(
 	Expects(difference.vfrom_version.v <= _version);
 
 	_version = difference.vversion.v;
+
+	// Skip the app-wide retranslation if nothing has really changed.
+	auto changed = 0;
 	for (const auto &string : difference.vstrings.v) {
 		HandleString(string, [&](auto &&key, auto &&value) {
-			applyValue(key, value);
+			const auto i = _nonDefaultValues.find(key);
+			if (i == end(_nonDefaultValues) || i->second != value) {
+				applyValue(key, value);
+				++changed;
+			}
 		}, [&](auto &&key) {
-			resetValue(key);
+			if (_nonDefaultValues.find(key) != end(_nonDefaultValues)) {
+				resetValue(key);
+				++changed;
+			}
 		});
 	}
+	if (!changed) {
+		LOG(("Lang Info: Difference to version %1 has no changes."
+			).arg(_version));
+		return;
+	}
 	if (!_derived) {
 		_updated.notify();
 	} else {
@@ -787,7 +809,7 @@ rpl::producer<QString> Viewer(LangKey key) {
 		Current().updated()
 	) | rpl::map([=] {
 		return Current().getValue(key);
-	}));
+	})) | rpl::distinct_until_changed();
 }
 
 } // namespace Lang
@@ -54,6 +54,27 @@ QString _logsEntryStart() {
 	return QString("[%1 %2-%3]").arg(tm.toString("hh:mm:ss.zzz")).arg(QString("%1").arg(threadId, 2, 10, QChar('0'))).arg(++index, 7, 10, QChar('0'));
 }
 
+// Debug logs that wait for the writer thread are dropped above that size.
+constexpr auto kMaxQueuedDebugLogSize = 16 * 1024 * 1024;
+
+// Debug logs are switched each 15 minutes, this caps a single file.
+constexpr auto kMaxDebugLogPartSize = qint64(256 * 1024 * 1024);
+
+class LogsWriterThread : public QThread {
+public:
+	LogsWriterThread(Fn<void()> body) : _body(std::move(body)) {
+	}
+
+protected:
+	void run() override {
+		_body();
+	}
+
+private:
+	Fn<void()> _body;
+
+};
+
 class LogsDataFields {
 public:
 
@@ -63,6 +84,17 @@ public:
 		}
 	}
 
+	~LogsDataFields() {
+		if (_writer) {
+			{
+				QMutexLocker lock(&_queueMutex);
+				_finishing = true;
+				_queueCondition.wakeOne();
+			}
+			_writer->wait();
+		}
+	}
+
 	bool openMain() {
 		return reopen(LogDataMain, 0, qsl("start"));
 	}
@@ -93,10 +125,11 @@ public:
 	}
 
 	void write(LogDataType type, const QString &msg) {
-		QMutexLocker lock(_logsMutex(type));
 		if (type != LogDataMain) {
-			reopenDebug();
+			queue(type, msg.toUtf8());
+			return;
 		}
+		QMutexLocker lock(_logsMutex(type));
 		const auto file = files[type].get();
 		if (!file || !file->isOpen()) {
 			return;
@@ -110,6 +143,98 @@ private:
 
 	int32 part = -1;
 
+	// The main log is written right away, so that nothing is lost
+	// in a crash. The debug logs are much larger and they are written
+	// from the connection threads, so they are passed to a writer thread.
+	QMutex _queueMutex;
+	QWaitCondition _queueCondition;
+	QByteArray _queued[LogDataCount];
+	qint64 _dropped[LogDataCount] = { 0 };
+	bool _finishing = false;
+	std::unique_ptr<LogsWriterThread> _writer;
+
+	qint64 _partSize[LogDataCount] = { 0 };
+	bool _partFull[LogDataCount] = { false };
+
+	void queue(LogDataType type, QByteArray &&utf8) {
+		QMutexLocker lock(&_queueMutex);
+		auto &queued = _queued[type];
+		if (queued.size() + utf8.size() > kMaxQueuedDebugLogSize) {
+			_dropped[type] += utf8.size();
+			return;
+		}
+		if (queued.isEmpty()) {
+			queued = std::move(utf8);
+		} else {
+			queued.append(utf8);
+		}
+		if (!_writer) {
+			_writer = std::make_unique<LogsWriterThread>([=] {
+				writerLoop();
+			});
+			_writer->start();
+		}
+		_queueCondition.wakeOne();
+	}
+
+	bool hasQueued() const {
+		for (const auto &queued : _queued) {
+			if (!queued.isEmpty()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void writerLoop() {
+		QByteArray taken[LogDataCount];
+		qint64 dropped[LogDataCount] = { 0 };
+
+		QMutexLocker lock(&_queueMutex);
+		while (true) {
+			while (!_finishing && !hasQueued()) {
+				_queueCondition.wait(&_queueMutex);
+			}
+			if (!hasQueued()) {
+				break;
+			}
+			for (auto type = 0; type != LogDataCount; ++type) {
+				std::swap(taken[type], _queued[type]);
+				dropped[type] = base::take(_dropped[type]);
+			}
+			lock.unlock();
+
+			reopenDebug();
+			for (auto type = 0; type != LogDataCount; ++type) {
+				writeQueued(LogDataType(type), taken[type], dropped[type]);
+				taken[type].clear();
+			}
+
+			lock.relock();
+		}
+	}
+
+	void writeQueued(
+			LogDataType type,
+			const QByteArray &utf8,
+			qint64 dropped) {
+		const auto file = files[type].get();
+		if (utf8.isEmpty() || !file || !file->isOpen() || _partFull[type]) {
+			return;
+		}
+		if (dropped > 0) {
+			file->write(QString("[%1 bytes of log were dropped]\n"
+				).arg(dropped).toUtf8());
+		}
+		if (_partSize[type] + utf8.size() > kMaxDebugLogPartSize) {
+			_partFull[type] = true;
+			file->write("[log size limit reached]\n");
+		} else {
+			_partSize[type] += file->write(utf8);
+		}
+		file->flush();
+	}
+
 	bool reopen(LogDataType type, int32 dayIndex, const QString &postfix) {
 		if (files[type] && files[type]->isOpen()) {
 			if (type == LogDataMain) {
@@ -194,6 +319,8 @@ private:
 		}
 		if (files[type]->open(mode)) {
 			if (type != LogDataMain) {
+				_partSize[type] = files[type]->size();
+				_partFull[type] = false;
 				files[type]->write(((mode & QIODevice::Append)
 					? qsl("\
 ----------------------------------------------------------------\n\
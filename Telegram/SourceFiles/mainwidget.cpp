@@ -104,6 +104,9 @@ constexpr auto kChannelGetDifferenceLimit = 100;
 // 1s wait after show channel history before sending getChannelDifference.
 constexpr auto kWaitForChannelGetDifference = TimeMs(1000);
 
+// How many getChannelDifference requests can be sent at the same time.
+constexpr auto kChannelDifferenceRequestsLimit = 4;
+
 // If nothing is received in 1 min we ping.
 constexpr auto kNoUpdatesTimeout = 60 * 1000;
 
@@ -255,6 +258,40 @@ DataIsLoadedResult AllDataLoadedForMessage(
 	});
 }
 
+// Differences after a long offline period take seconds to read, so
+// they're read on a background thread and only applied on the main one.
+template <typename Response, typename Callback>
+void ReadInBackground(
+		not_null<QObject*> guard,
+		const mtpPrime *from,
+		const mtpPrime *end,
+		Callback &&callback) {
+	auto buffer = mtpBuffer(end - from);
+	memcpy(buffer.data(), from, (end - from) * sizeof(mtpPrime));
+	crl::async([
+		guard = guard.get(),
+		buffer = std::move(buffer),
+		callback = std::forward<Callback>(callback)
+	]() mutable {
+		auto result = std::optional<Response>();
+		auto from = buffer.constData();
+		const auto end = from + buffer.size();
+		try {
+			auto parsed = Response();
+			MTP::internal::ReadReceived(parsed, from, end);
+			result = std::move(parsed);
+		} catch (Exception &e) {
+			LOG(("API Error: could not read response: %1").arg(e.what()));
+		}
+		crl::on_main(guard, [
+			result = std::move(result),
+			callback = std::move(callback)
+		]() mutable {
+			callback(std::move(result));
+		});
+	});
+}
+
 } // namespace
 
 enum StackItemType {
@@ -378,6 +415,7 @@ MainWidget::MainWidget(
 , _onlineTimer([=] { updateOnline(); })
 , _idleFinishTimer([=] { checkIdleFinish(); })
 , _failDifferenceTimer([=] { getDifferenceAfterFail(); })
+, _channelDifferencePauseTimer([=] { sendChannelDifferenceRequests(); })
 , _cacheBackgroundTimer([=] { cacheBackground(); })
 , _viewsIncrementTimer([=] { viewsIncrement(); }) {
 	_controller->setDefaultFloatPlayerDelegate(floatPlayerDelegate());
@@ -964,23 +1002,33 @@ void MainWidget::deleteHistoryPart(DeleteHistoryRequest request, const MTPmessag
 }
 
 void MainWidget::deleteMessages(
-		not_null<PeerData*> peer,
-		const QVector<MTPint> &ids,
+		const base::flat_map<not_null<PeerData*>, QVector<MTPint>> &idsByPeer,
 		bool revoke) {
-	if (const auto channel = peer->asChannel()) {
-		MTP::send(
-			MTPchannels_DeleteMessages(
-				channel->inputChannel,
-				MTP_vector<MTPint>(ids)),
-			rpcDone(&MainWidget::messagesAffected, peer));
-	} else {
-		using Flag = MTPmessages_DeleteMessages::Flag;
-		MTP::send(
-			MTPmessages_DeleteMessages(
-				MTP_flags(revoke ? Flag::f_revoke : Flag(0)),
-				MTP_vector<MTPint>(ids)),
-			rpcDone(&MainWidget::messagesAffected, peer));
+	// Ids outside of channels are global, so messages from all
+	// the regular chats are deleted by a single request.
+	auto regularIds = QVector<MTPint>();
+	auto regularPeers = std::vector<not_null<PeerData*>>();
+	for (const auto &[peer, ids] : idsByPeer) {
+		if (const auto channel = peer->asChannel()) {
+			MTP::send(
+				MTPchannels_DeleteMessages(
+					channel->inputChannel,
+					MTP_vector<MTPint>(ids)),
+				rpcDone(&MainWidget::messagesAffected, peer));
+		} else {
+			regularIds.append(ids);
+			regularPeers.push_back(peer);
+		}
+	}
+	if (regularIds.isEmpty()) {
+		return;
 	}
+	using Flag = MTPmessages_DeleteMessages::Flag;
+	MTP::send(
+		MTPmessages_DeleteMessages(
+			MTP_flags(revoke ? Flag::f_revoke : Flag(0)),
+			MTP_vector<MTPint>(regularIds)),
+		rpcDone(&MainWidget::regularMessagesAffected, regularPeers));
 }
 
 void MainWidget::deletedContact(UserData *user, const MTPcontacts_Link &result) {
@@ -1057,45 +1105,72 @@ bool MainWidget::sendMessageFail(const RPCError &error) {
 }
 
 void MainWidget::cacheBackground() {
-	if (Window::Theme::Background()->colorForFill()) {
+	const auto background = Window::Theme::Background();
+	if (background->colorForFill()) {
 		return;
-	} else if (Window::Theme::Background()->tile()) {
-		auto &bg = Window::Theme::Background()->pixmapForTiled();
+	}
 
-		auto result = QImage(_willCacheFor.width() * cIntRetinaFactor(), _willCacheFor.height() * cIntRetinaFactor(), QImage::Format_RGB32);
-        result.setDevicePixelRatio(cRetinaFactor());
-		{
+	// Scaling a large wallpaper takes a while, so we do it in background.
+	// The previous cached pixmap stays on screen until the new one is ready.
+	const auto tiled = background->tile();
+	const auto image = tiled
+		? background->pixmapForTiled().toImage()
+		: background->pixmap().toImage();
+	const auto rect = _willCacheFor;
+	const auto factor = cIntRetinaFactor();
+	const auto ratio = cRetinaFactor();
+	auto [left, right] = base::make_binary_guard();
+	_cachingBackground = std::move(left);
+	crl::async([=, guard = std::move(right)]() mutable {
+		auto position = QPoint();
+		auto result = QImage();
+		if (tiled) {
+			result = QImage(
+				rect.width() * factor,
+				rect.height() * factor,
+				QImage::Format_RGB32);
+			result.setDevicePixelRatio(ratio);
 			QPainter p(&result);
-			auto left = 0;
-			auto top = 0;
-			auto right = _willCacheFor.width();
-			auto bottom = _willCacheFor.height();
-			auto w = bg.width() / cRetinaFactor();
-			auto h = bg.height() / cRetinaFactor();
-			auto sx = 0;
-			auto sy = 0;
-			auto cx = qCeil(_willCacheFor.width() / w);
-			auto cy = qCeil(_willCacheFor.height() / h);
-			for (int i = sx; i < cx; ++i) {
-				for (int j = sy; j < cy; ++j) {
-					p.drawPixmap(QPointF(i * w, j * h), bg);
+			const auto w = image.width() / ratio;
+			const auto h = image.height() / ratio;
+			const auto cx = qCeil(rect.width() / w);
+			const auto cy = qCeil(rect.height() / h);
+			for (auto i = 0; i < cx; ++i) {
+				for (auto j = 0; j < cy; ++j) {
+					p.drawImage(QPointF(i * w, j * h), image);
 				}
 			}
-		}
-		_cachedX = 0;
-		_cachedY = 0;
-		_cachedBackground = App::pixmapFromImageInPlace(std::move(result));
-	} else {
-		auto &bg = Window::Theme::Background()->pixmap();
-
-		QRect to, from;
-		Window::Theme::ComputeBackgroundRects(_willCacheFor, bg.size(), to, from);
-		_cachedX = to.x();
-		_cachedY = to.y();
-		_cachedBackground = App::pixmapFromImageInPlace(bg.toImage().copy(from).scaled(to.width() * cIntRetinaFactor(), to.height() * cIntRetinaFactor(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
-		_cachedBackground.setDevicePixelRatio(cRetinaFactor());
-	}
-	_cachedFor = _willCacheFor;
+		} else {
+			QRect to, from;
+			Window::Theme::ComputeBackgroundRects(
+				rect,
+				image.size(),
+				to,
+				from);
+			position = to.topLeft();
+			result = image.copy(from).scaled(
+				to.width() * factor,
+				to.height() * factor,
+				Qt::IgnoreAspectRatio,
+				Qt::SmoothTransformation);
+		}
+		crl::on_main([
+			=,
+			result = std::move(result),
+			guard = std::move(guard)
+		]() mutable {
+			if (!guard) {
+				return;
+			}
+			_cachingBackground = nullptr;
+			_cachedX = position.x();
+			_cachedY = position.y();
+			_cachedBackground = App::pixmapFromImageInPlace(
+				std::move(result));
+			_cachedBackground.setDevicePixelRatio(ratio);
+			_cachedFor = rect;
+		});
+	});
 }
 
 Dialogs::IndexedList *MainWidget::contactsList() {
@@ -1177,6 +1252,19 @@ void MainWidget::messagesAffected(
 	}
 }
 
+void MainWidget::regularMessagesAffected(
+		std::vector<not_null<PeerData*>> peers,
+		const MTPmessages_AffectedMessages &result) {
+	const auto &data = result.c_messages_affectedMessages();
+	ptsUpdateAndApply(data.vpts.v, data.vpts_count.v);
+
+	for (const auto peer : peers) {
+		if (const auto history = session().data().historyLoaded(peer)) {
+			history->requestChatListMessage();
+		}
+	}
+}
+
 void MainWidget::handleAudioUpdate(const AudioMsgId &audioId) {
 	using State = Media::Player::State;
 	const auto document = audioId.audio();
@@ -1530,12 +1618,22 @@ bool MainWidget::isIdle() const {
 
 void MainWidget::clearCachedBackground() {
 	_cachedBackground = QPixmap();
+	_cachingBackground = nullptr;
 	_cacheBackgroundTimer.cancel();
 	update();
 }
 
 QPixmap MainWidget::cachedBackground(const QRect &forRect, int &x, int &y) {
-	if (!_cachedBackground.isNull() && forRect == _cachedFor) {
+	const auto tiledCovers = [&] {
+		// A tiled background always starts at (0, 0),
+		// so a larger cached one is good for a smaller rect as well.
+		return Window::Theme::Background()->tile()
+			&& forRect.topLeft() == _cachedFor.topLeft()
+			&& forRect.width() <= _cachedFor.width()
+			&& forRect.height() <= _cachedFor.height();
+	};
+	if (!_cachedBackground.isNull()
+		&& (forRect == _cachedFor || tiledCovers())) {
 		x = _cachedX;
 		y = _cachedY;
 		return _cachedBackground;
@@ -1551,6 +1649,10 @@ void MainWidget::updateScrollColors() {
 	_history->updateScrollColors();
 }
 
+void MainWidget::startScrollBenchmark() {
+	_history->startScrollBenchmark();
+}
+
 void MainWidget::setChatBackground(
 		const Data::WallPaper &background,
 		QImage &&image) {
@@ -1837,7 +1939,8 @@ void MainWidget::ui_showPeerHistory(
 	auto animatedShow = [&] {
 		if (_a_show.animating()
 			|| Core::App().locked()
-			|| (params.animated == anim::type::instant)) {
+			|| (params.animated == anim::type::instant)
+			|| !canAnimateSectionShow()) {
 			return false;
 		}
 		if (!peerId) {
@@ -2011,6 +2114,15 @@ Window::SectionSlideParams MainWidget::prepareThirdSectionAnimation(Window::Sect
 	return result;
 }
 
+bool MainWidget::canAnimateSectionShow() const {
+	// Each slide grabs both the old and the new section into full size
+	// pixmaps, don't pay for that when nobody is going to see it.
+	const auto window = this->window();
+	return isVisible()
+		&& window->isVisible()
+		&& !(window->windowState() & Qt::WindowMinimized);
+}
+
 Window::SectionSlideParams MainWidget::prepareShowAnimation(
 		bool willHaveTopBarShadow) {
 	Window::SectionSlideParams result;
@@ -2147,7 +2259,8 @@ void MainWidget::showNewSection(
 		if (_a_show.animating()
 			|| Core::App().locked()
 			|| (params.animated == anim::type::instant)
-			|| memento.instant()) {
+			|| memento.instant()
+			|| !canAnimateSectionShow()) {
 			return false;
 		}
 		if (!Adaptive::OneColumn() && params.way == SectionShow::Way::ClearStack) {
@@ -2429,7 +2542,48 @@ void MainWidget::dialogsToUp() {
 void MainWidget::newUnreadMsg(
 		not_null<History*> history,
 		not_null<HistoryItem*> item) {
-	_history->newUnreadMsg(history, item);
+	if (_newUnreadBatchLevel > 0) {
+		const auto i = ranges::find(
+			_newUnreadBatch,
+			history,
+			[](const auto &pair) { return pair.first; });
+		if (i != _newUnreadBatch.end()) {
+			i->second.push_back(item->fullId());
+		} else {
+			_newUnreadBatch.emplace_back(
+				history,
+				std::vector<FullMsgId>(1, item->fullId()));
+		}
+		return;
+	}
+	_history->newUnreadMsgs(history, { item });
+}
+
+void MainWidget::flushNewUnreadMessages() {
+	for (const auto &[history, ids] : base::take(_newUnreadBatch)) {
+		auto items = std::vector<not_null<HistoryItem*>>();
+		items.reserve(ids.size());
+		for (const auto &id : ids) {
+			if (const auto item = App::histItemById(id)) {
+				items.push_back(item);
+			}
+		}
+		if (!items.empty()) {
+			_history->newUnreadMsgs(history, items);
+		}
+	}
+}
+
+void MainWidget::startNewUnreadMessagesBatch() {
+	++_newUnreadBatchLevel;
+}
+
+void MainWidget::finishNewUnreadMessagesBatch() {
+	Expects(_newUnreadBatchLevel > 0);
+
+	if (!--_newUnreadBatchLevel) {
+		flushNewUnreadMessages();
+	}
 }
 
 void MainWidget::markActiveHistoryAsRead() {
@@ -3020,12 +3174,14 @@ void MainWidget::searchInChat(Dialogs::Key chat) {
 void MainWidget::feedUpdateVector(
 		const MTPVector<MTPUpdate> &updates,
 		bool skipMessageIds) {
+	startNewUnreadMessagesBatch();
 	for (const auto &update : updates.v) {
 		if (skipMessageIds && update.type() == mtpc_updateMessageID) {
 			continue;
 		}
 		feedUpdate(update);
 	}
+	finishNewUnreadMessagesBatch();
 	session().data().sendHistoryChangeNotifications();
 }
 
@@ -3070,6 +3226,24 @@ void MainWidget::updSetState(int32 pts, int32 date, int32 qts, int32 seq) {
 	}
 }
 
+void MainWidget::channelDifferenceReceived(
+		ChannelData *channel,
+		const mtpPrime *from,
+		const mtpPrime *end) {
+	ReadInBackground<MTPupdates_ChannelDifference>(this, from, end, [=](
+			std::optional<MTPupdates_ChannelDifference> &&result) {
+		channelDifferenceRequestFinished(channel);
+		if (result) {
+			gotChannelDifference(channel, *result);
+		} else {
+			failChannelDifference(
+				channel,
+				RPCError::Local("RESPONSE_PARSE_FAILED", QString()));
+		}
+		sendChannelDifferenceRequests();
+	});
+}
+
 void MainWidget::gotChannelDifference(
 		ChannelData *channel,
 		const MTPupdates_ChannelDifference &diff) {
@@ -3146,15 +3320,30 @@ void MainWidget::feedChannelDifference(
 
 	_handlingChannelDifference = true;
 	feedMessageIds(data.vother_updates);
+	startNewUnreadMessagesBatch();
 	App::feedMsgs(data.vnew_messages, NewMessageUnread);
+	finishNewUnreadMessagesBatch();
 	feedUpdateVector(data.vother_updates, true);
 	_handlingChannelDifference = false;
 }
 
 bool MainWidget::failChannelDifference(ChannelData *channel, const RPCError &error) {
+	if (MTP::isFloodError(error)) {
+		// This request will be resent by MTP::Instance after the wait,
+		// but don't start the queued ones until then.
+		const auto seconds = error.type().mid(
+			qstr("FLOOD_WAIT_").size()).toInt();
+		accumulate_max(
+			_channelDifferencePausedTill,
+			getms(true) + std::max(seconds, 1) * TimeMs(1000));
+	}
 	if (MTP::isDefaultHandledError(error)) return false;
 
 	LOG(("RPC Error in getChannelDifference: %1 %2: %3").arg(error.code()).arg(error.type()).arg(error.description()));
+	if (channel && _channelDifferenceRequests.contains(channel)) {
+		channelDifferenceRequestFinished(channel);
+		sendChannelDifferenceRequests();
+	}
 	failDifferenceStartTimerFor(channel);
 	return true;
 }
@@ -3171,6 +3360,20 @@ void MainWidget::gotState(const MTPupdates_State &state) {
 	updateOnline();
 }
 
+void MainWidget::differenceReceived(
+		const mtpPrime *from,
+		const mtpPrime *end) {
+	ReadInBackground<MTPupdates_Difference>(this, from, end, [=](
+			std::optional<MTPupdates_Difference> &&result) {
+		if (result) {
+			gotDifference(*result);
+		} else {
+			failDifference(
+				RPCError::Local("RESPONSE_PARSE_FAILED", QString()));
+		}
+	});
+}
+
 void MainWidget::gotDifference(const MTPupdates_Difference &difference) {
 	_failDifferenceTimeout = 1;
 
@@ -3293,7 +3496,9 @@ void MainWidget::feedDifference(
 	session().data().processUsers(users);
 	session().data().processChats(chats);
 	feedMessageIds(other);
+	startNewUnreadMessagesBatch();
 	App::feedMsgs(msgs, NewMessageUnread);
+	finishNewUnreadMessagesBatch();
 	feedUpdateVector(other, true);
 }
 
@@ -3379,7 +3584,7 @@ void MainWidget::getDifference() {
 			MTPint(),
 			MTP_int(updDate),
 			MTP_int(updQts)),
-		rpcDone(&MainWidget::gotDifference),
+		rpcDone(&MainWidget::differenceReceived),
 		rpcFail(&MainWidget::failDifference));
 }
 
@@ -3398,12 +3603,61 @@ void MainWidget::getChannelDifference(ChannelData *channel, ChannelDifferenceReq
 
 	channel->ptsSetRequesting(true);
 
-	auto filter = MTP_channelMessagesFilterEmpty();
-	auto flags = MTPupdates_GetChannelDifference::Flag::f_force | 0;
+	auto force = true;
 	if (from != ChannelDifferenceRequest::PtsGapOrShortPoll) {
 		if (!channel->ptsWaitingForSkipped()) {
-			flags = 0; // No force flag when requesting for short poll.
+			force = false; // No force flag when requesting for short poll.
+		}
+	}
+	_channelDifferenceQueue.emplace(channel, force);
+	sendChannelDifferenceRequests();
+}
+
+void MainWidget::sendChannelDifferenceRequests() {
+	const auto now = getms(true);
+	if (_channelDifferencePausedTill > now) {
+		if (!_channelDifferenceQueue.empty()) {
+			_channelDifferencePauseTimer.callOnce(
+				_channelDifferencePausedTill - now);
 		}
+		return;
+	}
+	while (!_channelDifferenceQueue.empty()
+		&& (int(_channelDifferenceRequests.size())
+			< kChannelDifferenceRequestsLimit)) {
+		const auto i = ranges::max_element(
+			_channelDifferenceQueue,
+			std::less<>(),
+			[&](const auto &pair) {
+				return channelDifferencePriority(pair.first);
+			});
+		const auto [channel, force] = *i;
+		_channelDifferenceQueue.erase(i);
+		sendChannelDifference(channel, force);
+	}
+}
+
+uint64 MainWidget::channelDifferencePriority(
+		not_null<ChannelData*> channel) const {
+	// The opened channel goes first, then the chat list order, so that
+	// the visible rows are updated before the long inactive channels.
+	if (_controller->activeChatCurrent().peer() == channel) {
+		return std::numeric_limits<uint64>::max();
+	} else if (const auto history = session().data().historyLoaded(channel)) {
+		return history->sortKeyInChatList();
+	}
+	return 0;
+}
+
+void MainWidget::sendChannelDifference(
+		not_null<ChannelData*> channel,
+		bool force) {
+	_channelDifferenceRequests.emplace(channel);
+
+	auto filter = MTP_channelMessagesFilterEmpty();
+	auto flags = MTPupdates_GetChannelDifference::Flag::f_force | 0;
+	if (!force) {
+		flags = 0;
 	}
 	MTP::send(
 		MTPupdates_GetChannelDifference(
@@ -3412,8 +3666,13 @@ void MainWidget::getChannelDifference(ChannelData *channel, ChannelDifferenceReq
 			filter,
 			MTP_int(channel->pts()),
 			MTP_int(kChannelGetDifferenceLimit)),
-		rpcDone(&MainWidget::gotChannelDifference, channel),
-		rpcFail(&MainWidget::failChannelDifference, channel));
+		rpcDone(&MainWidget::channelDifferenceReceived, channel.get()),
+		rpcFail(&MainWidget::failChannelDifference, channel.get()));
+}
+
+void MainWidget::channelDifferenceRequestFinished(
+		not_null<ChannelData*> channel) {
+	_channelDifferenceRequests.remove(channel);
 }
 
 void MainWidget::sendPing() {
@@ -3901,7 +4160,7 @@ void MainWidget::updateReceived(const mtpPrime *from, const mtpPrime *end) {
 	} else {
 		try {
 			MTPUpdates updates;
-			updates.read(from, end);
+			MTP::internal::ReadReceived(updates, from, end);
 
 			_lastUpdateTime = getms(true);
 			_noUpdatesTimer.callOnce(kNoUpdatesTimeout);
@@ -4048,6 +4307,11 @@ void MainWidget::feedUpdates(const MTPUpdates &updates, uint64 randomId) {
 }
 
 void MainWidget::feedUpdate(const MTPUpdate &update) {
+	if (update.type() != mtpc_updateNewMessage
+		&& update.type() != mtpc_updateNewChannelMessage) {
+		// Other updates may read or delete the collected messages.
+		flushNewUnreadMessages();
+	}
 	switch (update.type()) {
 
 	// New messages.
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/timer.h"
+#include "base/binary_guard.h"
 #include "base/weak_ptr.h"
 #include "ui/rp_widget.h"
 #include "media/player/media_player_float.h"
@@ -139,6 +140,8 @@ public:
 	void newUnreadMsg(
 		not_null<History*> history,
 		not_null<HistoryItem*> item);
+	// Applies new unread messages collected while feeding updates.
+	void flushNewUnreadMessages();
 	void markActiveHistoryAsRead();
 
 	PeerData *peer();
@@ -198,8 +201,7 @@ public:
 	bool leaveChatFailed(PeerData *peer, const RPCError &e);
 	void deleteHistoryAfterLeave(PeerData *peer, const MTPUpdates &updates);
 	void deleteMessages(
-		not_null<PeerData*> peer,
-		const QVector<MTPint> &ids,
+		const base::flat_map<not_null<PeerData*>, QVector<MTPint>> &idsByPeer,
 		bool revoke);
 	void deletedContact(UserData *user, const MTPcontacts_Link &result);
 	void deleteConversation(
@@ -230,6 +232,7 @@ public:
 
 	QPixmap cachedBackground(const QRect &forRect, int &x, int &y);
 	void updateScrollColors();
+	void startScrollBenchmark();
 
 	void setChatBackground(
 		const Data::WallPaper &background,
@@ -381,7 +384,11 @@ private:
 	void messagesAffected(
 		not_null<PeerData*> peer,
 		const MTPmessages_AffectedMessages &result);
+	void regularMessagesAffected(
+		std::vector<not_null<PeerData*>> peers,
+		const MTPmessages_AffectedMessages &result);
 
+	bool canAnimateSectionShow() const;
 	Window::SectionSlideParams prepareShowAnimation(
 		bool willHaveTopBarShadow);
 	void showNewSection(
@@ -399,11 +406,20 @@ private:
 	void saveSectionInStack();
 
 	void getChannelDifference(ChannelData *channel, ChannelDifferenceRequest from = ChannelDifferenceRequest::Unknown);
+	void sendChannelDifferenceRequests();
+	void sendChannelDifference(not_null<ChannelData*> channel, bool force);
+	uint64 channelDifferencePriority(not_null<ChannelData*> channel) const;
+	void channelDifferenceRequestFinished(not_null<ChannelData*> channel);
+	void differenceReceived(const mtpPrime *from, const mtpPrime *end);
 	void gotDifference(const MTPupdates_Difference &diff);
 	bool failDifference(const RPCError &e);
 	void feedDifference(const MTPVector<MTPUser> &users, const MTPVector<MTPChat> &chats, const MTPVector<MTPMessage> &msgs, const MTPVector<MTPUpdate> &other);
 	void gotState(const MTPupdates_State &state);
 	void updSetState(int32 pts, int32 date, int32 qts, int32 seq);
+	void channelDifferenceReceived(
+		ChannelData *channel,
+		const mtpPrime *from,
+		const mtpPrime *end);
 	void gotChannelDifference(ChannelData *channel, const MTPupdates_ChannelDifference &diff);
 	bool failChannelDifference(ChannelData *channel, const RPCError &err);
 	void failDifferenceStartTimerFor(ChannelData *channel);
@@ -416,6 +432,9 @@ private:
 	// Doesn't call sendHistoryChangeNotifications itself.
 	void feedUpdate(const MTPUpdate &update);
 
+	void startNewUnreadMessagesBatch();
+	void finishNewUnreadMessagesBatch();
+
 	void deleteHistoryPart(DeleteHistoryRequest request, const MTPmessages_AffectedHistory &result);
 
 	void usernameResolveDone(QPair<MsgId, QString> msgIdAndStartToken, const MTPcontacts_ResolvedPeer &result);
@@ -539,14 +558,26 @@ private:
 	QMap<ChannelData*, int32> _channelFailDifferenceTimeout; // growing timeout for getChannelDifference calls, if it fails
 	base::Timer _failDifferenceTimer;
 
+	// getChannelDifference requests waiting for a free slot, with 'force'.
+	base::flat_map<not_null<ChannelData*>, bool> _channelDifferenceQueue;
+	base::flat_set<not_null<ChannelData*>> _channelDifferenceRequests;
+	TimeMs _channelDifferencePausedTill = 0;
+	base::Timer _channelDifferencePauseTimer;
+
 	TimeMs _lastUpdateTime = 0;
 	bool _handlingChannelDifference = false;
 
+	int _newUnreadBatchLevel = 0;
+	std::vector<std::pair<
+		not_null<History*>,
+		std::vector<FullMsgId>>> _newUnreadBatch;
+
 	QPixmap _cachedBackground;
 	QRect _cachedFor, _willCacheFor;
 	int _cachedX = 0;
 	int _cachedY = 0;
 	base::Timer _cacheBackgroundTimer;
+	base::binary_guard _cachingBackground;
 
 	PhotoData *_deletingPhoto = nullptr;
 
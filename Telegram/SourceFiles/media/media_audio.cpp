@@ -542,6 +542,7 @@ Mixer::~Mixer() {
 }
 
 void Mixer::onUpdated(const AudioMsgId &audio) {
+	statesChanged();
 	if (audio.playId()) {
 		videoSoundProgress(audio);
 	}
@@ -674,6 +675,8 @@ void Mixer::play(
 		TimeMs positionMs) {
 	Expects(!videoData || audio.playId() != 0);
 
+	const auto guard = gsl::finally([&] { statesChanged(); });
+
 	auto type = audio.type();
 	AudioMsgId stopped;
 	auto notLoadedYet = false;
@@ -818,6 +821,7 @@ bool Mixer::checkCurrentALError(AudioMsgId::Type type) {
 }
 
 void Mixer::pause(const AudioMsgId &audio, bool fast) {
+	const auto guard = gsl::finally([&] { statesChanged(); });
 	AudioMsgId current;
 	{
 		QMutexLocker lock(&AudioMutex);
@@ -865,6 +869,7 @@ void Mixer::pause(const AudioMsgId &audio, bool fast) {
 }
 
 void Mixer::resume(const AudioMsgId &audio, bool fast) {
+	const auto guard = gsl::finally([&] { statesChanged(); });
 	AudioMsgId current;
 	{
 		QMutexLocker lock(&AudioMutex);
@@ -923,6 +928,7 @@ void Mixer::resume(const AudioMsgId &audio, bool fast) {
 }
 
 void Mixer::seek(AudioMsgId::Type type, TimeMs positionMs) {
+	const auto guard = gsl::finally([&] { statesChanged(); });
 	QMutexLocker lock(&AudioMutex);
 
 	const auto current = trackForType(type);
@@ -989,6 +995,7 @@ void Mixer::seek(AudioMsgId::Type type, TimeMs positionMs) {
 }
 
 void Mixer::stop(const AudioMsgId &audio) {
+	const auto guard = gsl::finally([&] { statesChanged(); });
 	AudioMsgId current;
 	{
 		QMutexLocker lock(&AudioMutex);
@@ -1012,6 +1019,8 @@ void Mixer::stop(const AudioMsgId &audio) {
 void Mixer::stop(const AudioMsgId &audio, State state) {
 	Expects(IsStopped(state));
 
+	const auto guard = gsl::finally([&] { statesChanged(); });
+
 	AudioMsgId current;
 	{
 		QMutexLocker lock(&AudioMutex);
@@ -1062,6 +1071,7 @@ void Mixer::updatePlaybackSpeed(Track *track, bool doubled) {
 }
 
 void Mixer::stopAndClear() {
+	const auto guard = gsl::finally([&] { statesChanged(); });
 	Track *current_audio = nullptr, *current_song = nullptr;
 	{
 		QMutexLocker lock(&AudioMutex);
@@ -1095,13 +1105,27 @@ void Mixer::stopAndClear() {
 	}
 }
 
+void Mixer::statesChanged() {
+	_statesVersion.fetchAndAddOrdered(1);
+}
+
 TrackState Mixer::currentState(AudioMsgId::Type type) {
-	QMutexLocker lock(&AudioMutex);
-	auto current = trackForType(type);
-	if (!current) {
-		return TrackState();
+	// Progress bars ask for the state on each paint. If the state didn't
+	// change and the audio threads hold the mutex we don't wait for them.
+	const auto version = _statesVersion.loadAcquire();
+	auto &published = _publishedStates[type];
+	if (published.version == version) {
+		if (!AudioMutex.tryLock()) {
+			return published.state;
+		}
+	} else {
+		AudioMutex.lock();
 	}
-	return current->state;
+	const auto current = trackForType(type);
+	published.state = current ? current->state : TrackState();
+	published.version = version;
+	AudioMutex.unlock();
+	return published.state;
 }
 
 void Mixer::setStoppedState(Track *current, State state) {
@@ -1114,6 +1138,7 @@ void Mixer::setStoppedState(Track *current, State state) {
 }
 
 void Mixer::clearStoppedAtStart(const AudioMsgId &audio) {
+	const auto guard = gsl::finally([&] { statesChanged(); });
 	QMutexLocker lock(&AudioMutex);
 	auto track = trackForType(audio.type());
 	if (track && track->state.id == audio && track->state.state == State::StoppedAtStart) {
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "storage/localimageloader.h"
 #include "base/bytes.h"
+#include "base/flat_map.h"
 
 struct VideoSoundData;
 struct VideoSoundPart;
@@ -122,6 +123,8 @@ public:
 
 	void stopAndClear();
 
+	// Thread: Main. Doesn't wait for AudioMutex if the state wasn't
+	// changed since the previous call, returns that state instead.
 	TrackState currentState(AudioMsgId::Type type);
 
 	void clearStoppedAtStart(const AudioMsgId &audio);
@@ -223,6 +226,10 @@ private:
 
 	// Thread: Any. Must be locked: AudioMutex.
 	void setStoppedState(Track *current, State state = State::Stopped);
+
+	// Thread: Any.
+	void statesChanged();
+
 	void updatePlaybackSpeed(Track *track);
 	void updatePlaybackSpeed(Track *track, bool doubled);
 
@@ -245,6 +252,15 @@ private:
 	QAtomicInt _volumeSong;
 	QAtomicInt _voicePlaybackDoubled = { 0 };
 
+	// Incremented after each change that callers of currentState() can
+	// react to, so they never get an outdated state after a change.
+	QAtomicInt _statesVersion = { 0 };
+	struct PublishedState {
+		TrackState state;
+		int version = 0;
+	};
+	base::flat_map<AudioMsgId::Type, PublishedState> _publishedStates;
+
 	friend class Fader;
 	friend class Loaders;
 
@@ -9,6 +9,87 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "base/bytes.h"
 
+#include <deque>
+
+namespace {
+
+// Voice messages played one after another usually have the same format,
+// so a resampler is kept for the next track instead of being reinited.
+constexpr auto kMaxPooledResamplers = 4;
+
+struct ResamplerFormat {
+	int srcRate = 0;
+	AVSampleFormat srcSampleFormat = AV_SAMPLE_FMT_NONE;
+	uint64_t srcChannelLayout = 0;
+	int dstRate = 0;
+	AVSampleFormat dstSampleFormat = AV_SAMPLE_FMT_NONE;
+	uint64_t dstChannelLayout = 0;
+};
+
+inline bool operator==(const ResamplerFormat &a, const ResamplerFormat &b) {
+	return (a.srcRate == b.srcRate)
+		&& (a.srcSampleFormat == b.srcSampleFormat)
+		&& (a.srcChannelLayout == b.srcChannelLayout)
+		&& (a.dstRate == b.dstRate)
+		&& (a.dstSampleFormat == b.dstSampleFormat)
+		&& (a.dstChannelLayout == b.dstChannelLayout);
+}
+
+class ResamplersPool {
+public:
+	SwrContext *take(const ResamplerFormat &format);
+	void put(const ResamplerFormat &format, SwrContext *context);
+
+	~ResamplersPool();
+
+private:
+	QMutex _mutex;
+	std::deque<std::pair<ResamplerFormat, SwrContext*>> _list;
+
+};
+
+SwrContext *ResamplersPool::take(const ResamplerFormat &format) {
+	QMutexLocker lock(&_mutex);
+	const auto i = ranges::find(
+		_list,
+		format,
+		[](const auto &pair) { return pair.first; });
+	if (i == end(_list)) {
+		return nullptr;
+	}
+	const auto result = i->second;
+	_list.erase(i);
+	return result;
+}
+
+void ResamplersPool::put(const ResamplerFormat &format, SwrContext *context) {
+	// Only the contexts that don't change the sample rate keep no state
+	// between the swr_convert() calls and can be used for another track.
+	if (format.srcRate != format.dstRate) {
+		swr_free(&context);
+		return;
+	}
+	QMutexLocker lock(&_mutex);
+	_list.emplace_back(format, context);
+	if (int(_list.size()) > kMaxPooledResamplers) {
+		swr_free(&_list.front().second);
+		_list.pop_front();
+	}
+}
+
+ResamplersPool::~ResamplersPool() {
+	for (auto &[format, context] : _list) {
+		swr_free(&context);
+	}
+}
+
+ResamplersPool &Resamplers() {
+	static auto Instance = ResamplersPool();
+	return Instance;
+}
+
+} // namespace
+
 uint64_t AbstractFFMpegLoader::ComputeChannelLayout(
 		uint64_t channel_layout,
 		int channels) {
@@ -326,6 +407,7 @@ bool AbstractAudioFFMpegLoader::initResampleForFrame() {
 			return true;
 		}
 		swr_close(_swrContext);
+		_swrReusable = false;
 	}
 
 	_swrSrcSampleFormat = static_cast<AVSampleFormat>(_frame->format);
@@ -337,6 +419,27 @@ bool AbstractAudioFFMpegLoader::initResampleForFrame() {
 bool AbstractAudioFFMpegLoader::initResampleUsingFormat() {
 	int res = 0;
 
+	const auto format = ResamplerFormat{
+		_swrSrcRate,
+		_swrSrcSampleFormat,
+		_swrSrcChannelLayout,
+		_swrDstRate,
+		_swrDstSampleFormat,
+		_swrDstChannelLayout
+	};
+	if (const auto pooled = Resamplers().take(format)) {
+		if (_swrContext) {
+			swr_free(&_swrContext);
+		}
+		_swrContext = pooled;
+		_swrReusable = true;
+		if (_swrDstData) {
+			av_freep(&_swrDstData[0]);
+			_swrDstDataCapacity = -1;
+		}
+		return true;
+	}
+
 	_swrContext = swr_alloc_set_opts(
 		_swrContext,
 		_swrDstChannelLayout,
@@ -365,6 +468,7 @@ bool AbstractAudioFFMpegLoader::initResampleUsingFormat() {
 			));
 		return false;
 	}
+	_swrReusable = true;
 	if (_swrDstData) {
 		av_freep(&_swrDstData[0]);
 		_swrDstDataCapacity = -1;
@@ -477,7 +581,16 @@ AudioPlayerLoader::ReadResult AbstractAudioFFMpegLoader::readFromReadyFrame(
 }
 
 AbstractAudioFFMpegLoader::~AbstractAudioFFMpegLoader() {
-	if (_swrContext) {
+	if (_swrContext && _swrReusable) {
+		Resamplers().put(ResamplerFormat{
+			_swrSrcRate,
+			_swrSrcSampleFormat,
+			_swrSrcChannelLayout,
+			_swrDstRate,
+			_swrDstSampleFormat,
+			_swrDstChannelLayout
+		}, base::take(_swrContext));
+	} else if (_swrContext) {
 		swr_free(&_swrContext);
 	}
 	if (_swrDstData) {
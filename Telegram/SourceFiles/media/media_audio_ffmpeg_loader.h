@@ -123,6 +123,7 @@ private:
 	int64 _outputSamplesCount = 0;
 
 	SwrContext *_swrContext = nullptr;
+	bool _swrReusable = false;
 
 	int _swrSrcRate = 0;
 	AVSampleFormat _swrSrcSampleFormat = AV_SAMPLE_FMT_NONE;
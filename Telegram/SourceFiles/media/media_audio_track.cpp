@@ -39,6 +39,16 @@ ALuint CreateBuffer() {
 	return buffer;
 }
 
+int BytesPerSample(int format) {
+	switch (format) {
+	case AL_FORMAT_MONO8: return 1;
+	case AL_FORMAT_STEREO8:
+	case AL_FORMAT_MONO16: return 2;
+	case AL_FORMAT_STEREO16: return 4;
+	}
+	return 0;
+}
+
 } // namespace
 
 Track::Track(not_null<Instance*> instance) : _instance(instance) {
@@ -66,6 +76,12 @@ void Track::fillFromData(bytes::vector &&data) {
 	auto peakEachSample = (format == AL_FORMAT_STEREO8 || format == AL_FORMAT_STEREO16) ? (_peakEachPosition * 2) : _peakEachPosition;
 	_peakValueMin = 0x7FFF;
 	_peakValueMax = 0;
+
+	// Decode straight into one buffer instead of growing it chunk by chunk.
+	const auto bytesCount = loader.samplesCount() * BytesPerSample(format);
+	if (bytesCount > 0) {
+		_samples.reserve(bytesCount);
+	}
 	auto peakCallback = [this, &peakValue, &peakSamples, peakEachSample](uint16 sample) {
 		accumulate_max(peakValue, sample);
 		if (++peakSamples >= peakEachSample) {
@@ -91,7 +91,14 @@ AudioPlayerLoader::ReadResult ChildFFMpegLoader::readMore(
 }
 
 void ChildFFMpegLoader::enqueuePackets(QQueue<FFMpeg::AVPacketDataWrap> &packets) {
-	_queue += std::move(packets);
+	// The packets are moved with their buffers, the data is not copied.
+	// When we're keeping up with the video there is nothing queued yet,
+	// so we take the whole list instead of appending it node by node.
+	if (_queue.isEmpty()) {
+		std::swap(_queue, packets);
+	} else {
+		_queue += std::move(packets);
+	}
 	packets.clear();
 }
 
@@ -11,6 +11,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/media_child_ffmpeg_loader.h"
 #include "storage/file_download.h"
 
+extern "C" {
+#include <libavutil/hwcontext.h>
+} // extern "C"
+
 namespace Media {
 namespace Clip {
 namespace internal {
@@ -42,6 +46,60 @@ bool isAlignedImage(const QImage &image) {
 	return !(reinterpret_cast<uintptr_t>(image.constBits()) % kAlignImageBy) && !(image.bytesPerLine() % kAlignImageBy);
 }
 
+struct HardwareDevice {
+	AVBufferRef *context = nullptr;
+	AVPixelFormat format = AV_PIX_FMT_NONE;
+};
+
+// The device is created once and shared by all the readers. If none of
+// the platform decoders is available we decode everything in software.
+const HardwareDevice &ResolveHardwareDevice() {
+	static const auto Instance = [] {
+		auto result = HardwareDevice();
+		const auto candidates = {
+#ifdef Q_OS_WIN
+			std::make_pair(AV_HWDEVICE_TYPE_D3D11VA, AV_PIX_FMT_D3D11),
+			std::make_pair(AV_HWDEVICE_TYPE_DXVA2, AV_PIX_FMT_DXVA2_VLD),
+#elif defined Q_OS_MAC // Q_OS_WIN
+			std::make_pair(
+				AV_HWDEVICE_TYPE_VIDEOTOOLBOX,
+				AV_PIX_FMT_VIDEOTOOLBOX),
+#else // Q_OS_WIN || Q_OS_MAC
+			std::make_pair(AV_HWDEVICE_TYPE_VAAPI, AV_PIX_FMT_VAAPI),
+			std::make_pair(AV_HWDEVICE_TYPE_VDPAU, AV_PIX_FMT_VDPAU),
+#endif // Q_OS_WIN || Q_OS_MAC
+		};
+		for (const auto &[type, format] : candidates) {
+			const auto error = av_hwdevice_ctx_create(
+				&result.context,
+				type,
+				nullptr,
+				nullptr,
+				0);
+			if (error >= 0) {
+				result.format = format;
+				DEBUG_LOG(("Gif Info: Using hardware decoding, device '%1'."
+					).arg(av_hwdevice_get_type_name(type)));
+				break;
+			}
+		}
+		return result;
+	}();
+	return Instance;
+}
+
+AVPixelFormat GetHardwareFormat(
+		AVCodecContext *context,
+		const AVPixelFormat *formats) {
+	const auto wanted = ResolveHardwareDevice().format;
+	for (auto format = formats; *format != AV_PIX_FMT_NONE; ++format) {
+		if (*format == wanted) {
+			return wanted;
+		}
+	}
+	return avcodec_default_get_format(context, formats);
+}
+
 } // namespace
 
 FFMpegReaderImplementation::FFMpegReaderImplementation(FileLocation *location, QByteArray *data, const AudioMsgId &audio) : ReaderImplementation(location, data)
@@ -61,6 +119,11 @@ ReaderImplementation::ReadResult FFMpegReaderImplementation::readNextFrame() {
 	do {
 		int res = avcodec_receive_frame(_codecContext, _frame);
 		if (res >= 0) {
+			if (_hardwareFormat != AV_PIX_FMT_NONE
+				&& _frame->format == _hardwareFormat
+				&& !transferHardwareFrame()) {
+				return ReadResult::Error;
+			}
 			processReadFrame();
 			return ReadResult::Success;
 		}
@@ -135,6 +198,27 @@ ReaderImplementation::ReadResult FFMpegReaderImplementation::readNextFrame() {
 	return ReadResult::Error;
 }
 
+bool FFMpegReaderImplementation::transferHardwareFrame() {
+	if (!_hardwareTransferFrame) {
+		_hardwareTransferFrame = av_frame_alloc();
+	}
+	const auto res = av_hwframe_transfer_data(
+		_hardwareTransferFrame,
+		_frame,
+		0);
+	if (res < 0) {
+		char err[AV_ERROR_MAX_STRING_SIZE] = { 0 };
+		LOG(("Gif Error: Unable to av_hwframe_transfer_data() %1, error %2, %3").arg(logData()).arg(res).arg(av_make_error_string(err, sizeof(err), res)));
+		av_frame_unref(_hardwareTransferFrame);
+		av_frame_unref(_frame);
+		return false;
+	}
+	av_frame_copy_props(_hardwareTransferFrame, _frame);
+	av_frame_unref(_frame);
+	av_frame_move_ref(_frame, _hardwareTransferFrame);
+	return true;
+}
+
 void FFMpegReaderImplementation::processReadFrame() {
 	int64 duration = _frame->pkt_duration;
 	int64 framePts = _frame->pts;
@@ -351,7 +435,24 @@ bool FFMpegReaderImplementation::start(Mode mode, TimeMs &positionMs) {
 		_audioStreamId = -1;
 	}
 
-	if ((res = avcodec_open2(_codecContext, _codec, 0)) < 0) {
+	if (_mode != Mode::Inspecting
+		&& _codecContext->codec_id == AV_CODEC_ID_H264) {
+		const auto &device = ResolveHardwareDevice();
+		if (device.context) {
+			_codecContext->hw_device_ctx = av_buffer_ref(device.context);
+			_codecContext->get_format = GetHardwareFormat;
+			_hardwareFormat = device.format;
+		}
+	}
+	if ((res = avcodec_open2(_codecContext, _codec, 0)) < 0
+		&& _hardwareFormat != AV_PIX_FMT_NONE) {
+		LOG(("Gif Error: Unable to avcodec_open2 with hardware decoding %1, error %2, %3").arg(logData()).arg(res).arg(av_make_error_string(err, sizeof(err), res)));
+		av_buffer_unref(&_codecContext->hw_device_ctx);
+		_codecContext->get_format = avcodec_default_get_format;
+		_hardwareFormat = AV_PIX_FMT_NONE;
+		res = avcodec_open2(_codecContext, _codec, 0);
+	}
+	if (res < 0) {
 		LOG(("Gif Error: Unable to avcodec_open2 %1, error %2, %3").arg(logData()).arg(res).arg(av_make_error_string(err, sizeof(err), res)));
 		return false;
 	}
@@ -478,6 +579,7 @@ FFMpegReaderImplementation::~FFMpegReaderImplementation() {
 	}
 	if (_fmtContext) avformat_free_context(_fmtContext);
 	av_frame_free(&_frame);
+	if (_hardwareTransferFrame) av_frame_free(&_hardwareTransferFrame);
 }
 
 FFMpegReaderImplementation::PacketResult FFMpegReaderImplementation::readPacket(AVPacket *packet) {
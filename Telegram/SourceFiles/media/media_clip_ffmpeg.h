@@ -48,6 +48,7 @@ public:
 private:
 	ReadResult readNextFrame();
 	void processReadFrame();
+	bool transferHardwareFrame();
 
 	enum class PacketResult {
 		Ok,
@@ -88,6 +89,8 @@ private:
 	AVCodecContext *_codecContext = nullptr;
 	int _streamId = 0;
 	AVFrame *_frame = nullptr;
+	AVFrame *_hardwareTransferFrame = nullptr;
+	AVPixelFormat _hardwareFormat = AV_PIX_FMT_NONE;
 	bool _opened = false;
 	bool _hadFrame = false;
 	bool _frameRead = false;
@@ -26,9 +26,19 @@ namespace Media {
 namespace Clip {
 namespace {
 
+// Short silent GIFs keep the frames of one loop and replay them
+// without decoding, while all the frames fit in the size limit.
+constexpr auto kFrameCacheMaxDuration = TimeMs(3000);
+constexpr auto kFrameCacheMaxSize = 8 * 1024 * 1024;
+
 QVector<QThread*> threads;
 QVector<Manager*> managers;
 
+// Document id, frame size and outer size of a shared GIF reader.
+using SharedReaderKey = std::tuple<DocumentId, int, int, int, int>;
+base::flat_map<SharedReaderKey, Reader*> SharedReaders;
+int SharedReaderSubscription = 0;
+
 QImage PrepareFrameImage(const FrameRequest &request, const QImage &original, bool hasAlpha, QImage &cache) {
 	auto needResize = (original.width() != request.framew) || (original.height() != request.frameh);
 	auto needOuterFill = (request.outerw != request.framew) || (request.outerh != request.frameh);
@@ -185,13 +195,76 @@ void Reader::moveToNextWrite() const {
 	}
 }
 
+ReaderPointer MakeSharedReader(
+		not_null<DocumentData*> document,
+		QSize frame,
+		QSize outer,
+		Reader::Callback &&callback) {
+	const auto key = SharedReaderKey(
+		document->id,
+		frame.width(),
+		frame.height(),
+		outer.width(),
+		outer.height());
+	auto i = SharedReaders.find(key);
+	if (i == SharedReaders.end() || i->second->state() == State::Error) {
+		const auto reader = new Reader(
+			document,
+			FullMsgId(),
+			Reader::Callback());
+		reader->_shared = true;
+		if (i == SharedReaders.end()) {
+			i = SharedReaders.emplace(key, reader).first;
+		} else {
+			i->second = reader;
+		}
+	}
+	const auto reader = i->second;
+	return ReaderPointer(reader, reader->subscribe(std::move(callback)));
+}
+
 void Reader::callback(Reader *reader, int32 threadIndex, Notification notification) {
 	// check if reader is not deleted already
-	if (managers.size() > threadIndex && managers.at(threadIndex)->carries(reader) && reader->_callback) {
+	const auto alive = [&] {
+		return (managers.size() > threadIndex)
+			&& managers.at(threadIndex)->carries(reader);
+	};
+	if (!alive()) {
+		return;
+	} else if (reader->_callback) {
 		reader->_callback(notification);
+		return;
+	}
+
+	// Any of the subscribers can unsubscribe or destroy the reader.
+	auto subscriptions = std::vector<int>();
+	subscriptions.reserve(reader->_subscriptions.size());
+	for (const auto &[subscription, callback] : reader->_subscriptions) {
+		subscriptions.push_back(subscription);
+	}
+	for (const auto subscription : subscriptions) {
+		if (!alive()) {
+			return;
+		}
+		const auto i = reader->_subscriptions.find(subscription);
+		if (i != reader->_subscriptions.end()) {
+			const auto callback = i->second;
+			callback(notification);
+		}
 	}
 }
 
+int Reader::subscribe(Callback &&callback) {
+	const auto subscription = ++SharedReaderSubscription;
+	_subscriptions.emplace(subscription, std::move(callback));
+	return subscription;
+}
+
+int Reader::unsubscribe(int subscription) {
+	_subscriptions.remove(subscription);
+	return int(_subscriptions.size());
+}
+
 void Reader::start(int32 framew, int32 frameh, int32 outerw, int32 outerh, ImageRoundRadius radius, RectParts corners) {
 	if (managers.size() <= _threadIndex) error();
 	if (_state == State::Error) return;
@@ -346,6 +419,14 @@ void Reader::finished() {
 }
 
 Reader::~Reader() {
+	if (_shared) {
+		for (auto i = SharedReaders.begin(); i != SharedReaders.end(); ++i) {
+			if (i->second == this) {
+				SharedReaders.erase(i);
+				break;
+			}
+		}
+	}
 	stop();
 }
 
@@ -437,6 +518,14 @@ public:
 	}
 
 	ProcessResult finishProcess(TimeMs ms) {
+		if (_frameCacheState == FrameCacheState::Ready) {
+			if (_frameCacheRequest == _request) {
+				return replayCachedFrame(ms);
+			}
+			clearFrameCache();
+			_frameCacheState = FrameCacheState::Disabled;
+		}
+
 		auto frameMs = _seekPositionMs + ms - _animationStarted;
 		auto readResult = _implementation->readFramesTill(frameMs, ms);
 		if (readResult == internal::ReaderImplementation::ReadResult::EndOfFile) {
@@ -457,9 +546,97 @@ public:
 		if (!renderFrame()) {
 			return error();
 		}
+		cacheRenderedFrame();
+		return ProcessResult::CopyFrame;
+	}
+
+	bool frameCacheAllowed() const {
+		return (_mode == Reader::Mode::Gif)
+			&& !_hasAudio
+			&& (_durationMs > 0)
+			&& (_durationMs <= kFrameCacheMaxDuration);
+	}
+
+	void cacheRenderedFrame() {
+		const auto wrapped = (_nextFramePositionMs < _lastFramePositionMs);
+		_lastFramePositionMs = _nextFramePositionMs;
+		if (_frameCacheState == FrameCacheState::Waiting && wrapped) {
+			_frameCacheState = frameCacheAllowed()
+				? FrameCacheState::Recording
+				: FrameCacheState::Disabled;
+			_frameCacheRequest = _request;
+		} else if (_frameCacheState == FrameCacheState::Recording) {
+			if (_frameCacheRequest != _request) {
+				clearFrameCache();
+				_frameCacheState = FrameCacheState::Disabled;
+				return;
+			} else if (wrapped) {
+				finishFrameCache();
+				return;
+			}
+		}
+		if (_frameCacheState != FrameCacheState::Recording) {
+			return;
+		}
+
+		const auto &original = frame()->original;
+		_frameCacheSize += original.bytesPerLine() * original.height();
+		if (_frameCacheSize > kFrameCacheMaxSize) {
+			clearFrameCache();
+			_frameCacheState = FrameCacheState::Disabled;
+			return;
+		}
+		auto cached = CachedFrame();
+		cached.original = original;
+		cached.alpha = frame()->alpha;
+		cached.positionMs = _nextFramePositionMs;
+		cached.when = _nextFrameWhen;
+		_frameCache.push_back(std::move(cached));
+	}
+
+	void finishFrameCache() {
+		if (_frameCache.empty()) {
+			_frameCacheState = FrameCacheState::Disabled;
+			return;
+		}
+
+		// The frame just decoded starts the next loop, it is the same
+		// as the first cached one, so we continue replaying after it.
+		for (auto i = 0, count = int(_frameCache.size()); i != count; ++i) {
+			const auto next = (i + 1 < count)
+				? _frameCache[i + 1].when
+				: _nextFrameWhen;
+			_frameCache[i].delay = std::max(
+				next - _frameCache[i].when,
+				TimeMs(1));
+		}
+		_frameCacheIndex = 0;
+		_frameCacheState = FrameCacheState::Ready;
+	}
+
+	ProcessResult replayCachedFrame(TimeMs ms) {
+		const auto delay = _frameCache[_frameCacheIndex].delay;
+		_frameCacheIndex = (_frameCacheIndex + 1) % int(_frameCache.size());
+		const auto &cached = _frameCache[_frameCacheIndex];
+
+		_nextFrameWhen = std::max(_nextFrameWhen + delay, ms);
+		_nextFramePositionMs = cached.positionMs;
+
+		frame()->original = cached.original;
+		frame()->alpha = cached.alpha;
+		frame()->pix = QPixmap();
+		frame()->pix = PrepareFrame(_request, frame()->original, frame()->alpha, frame()->cache);
+		frame()->when = _nextFrameWhen;
+		frame()->positionMs = _nextFramePositionMs;
 		return ProcessResult::CopyFrame;
 	}
 
+	void clearFrameCache() {
+		_frameCache.clear();
+		_frameCacheSize = 0;
+		_frameCacheIndex = 0;
+	}
+
 	bool renderFrame() {
 		Assert(frame() != 0 && _request.valid());
 		if (!_implementation->renderFrame(frame()->original, frame()->alpha, QSize(_request.framew, _request.frameh))) {
@@ -588,6 +765,26 @@ private:
 	TimeMs _nextFrameWhen = 0;
 	TimeMs _nextFramePositionMs = 0;
 
+	enum class FrameCacheState {
+		Waiting,
+		Recording,
+		Ready,
+		Disabled,
+	};
+	struct CachedFrame {
+		QImage original;
+		bool alpha = true;
+		TimeMs positionMs = 0;
+		TimeMs when = 0;
+		TimeMs delay = 0;
+	};
+	std::vector<CachedFrame> _frameCache;
+	FrameRequest _frameCacheRequest;
+	FrameCacheState _frameCacheState = FrameCacheState::Waiting;
+	int64 _frameCacheSize = 0;
+	int _frameCacheIndex = 0;
+	TimeMs _lastFramePositionMs = 0;
+
 	bool _autoPausedGif = false;
 	bool _started = false;
 	TimeMs _videoPausedAtMs = 0;
@@ -679,7 +876,6 @@ bool Manager::handleProcessResult(ReaderPrivate *reader, ProcessResult result, T
 	}
 
 	if (result == ProcessResult::Started) {
-		_loadLevel.fetchAndAddRelaxed(reader->_width * reader->_height - AverageGifSize);
 		it.key()->_durationMs = reader->_durationMs;
 		it.key()->_hasAudio = reader->_hasAudio;
 	}
@@ -721,7 +917,6 @@ bool Manager::handleProcessResult(ReaderPrivate *reader, ProcessResult result, T
 
 Manager::ResultHandleState Manager::handleResult(ReaderPrivate *reader, ProcessResult result, TimeMs ms) {
 	if (!handleProcessResult(reader, result, ms)) {
-		_loadLevel.fetchAndAddRelaxed(-1 * (reader->_width > 0 ? reader->_width * reader->_height : AverageGifSize));
 		delete reader;
 		return ResultHandleRemove;
 	}
@@ -764,6 +959,10 @@ void Manager::process() {
 
 	bool checkAllReaders = false;
 	auto ms = getms(), minms = ms + 86400 * 1000LL;
+
+	// Paused and not displayed readers don't decode anything, so only
+	// the playing ones are counted when new readers choose a thread.
+	auto loadLevel = 0;
 	{
 		QMutexLocker lock(&_readerPointersMutex);
 		for (auto it = _readerPointers.begin(), e = _readerPointers.end(); it != e; ++it) {
@@ -813,7 +1012,6 @@ void Manager::process() {
 			QMutexLocker lock(&_readerPointersMutex);
 			auto it = constUnsafeFindReaderPointer(reader);
 			if (it == _readerPointers.cend()) {
-				_loadLevel.fetchAndAddRelaxed(-1 * (reader->_width > 0 ? reader->_width * reader->_height : AverageGifSize));
 				delete reader;
 				i = _readers.erase(i);
 				continue;
@@ -822,8 +1020,14 @@ void Manager::process() {
 		if (!reader->_autoPausedGif && i.value() < minms) {
 			minms = i.value();
 		}
+		if (!reader->_autoPausedGif && !reader->_videoPausedAtMs) {
+			loadLevel += (reader->_width > 0)
+				? (reader->_width * reader->_height)
+				: AverageGifSize;
+		}
 		++i;
 	}
+	_loadLevel.store(loadLevel);
 
 	ms = getms();
 	if (_needReProcess || minms <= ms) {
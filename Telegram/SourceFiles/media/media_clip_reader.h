@@ -34,6 +34,20 @@ struct FrameRequest {
 	RectParts corners = RectPart::AllCorners;
 };
 
+inline bool operator==(const FrameRequest &a, const FrameRequest &b) {
+	return (a.factor == b.factor)
+		&& (a.framew == b.framew)
+		&& (a.frameh == b.frameh)
+		&& (a.outerw == b.outerw)
+		&& (a.outerh == b.outerh)
+		&& (a.radius == b.radius)
+		&& (a.corners == b.corners);
+}
+
+inline bool operator!=(const FrameRequest &a, const FrameRequest &b) {
+	return !(a == b);
+}
+
 enum ReaderSteps {
 	WaitingForDimensionsStep = -3, // before ReaderPrivate read the first image and got the original frame size
 	WaitingForRequestStep = -2, // before Reader got the original frame size and prepared the frame request
@@ -117,9 +131,23 @@ public:
 	~Reader();
 
 private:
+	friend class ReaderPointer;
+	friend ReaderPointer MakeSharedReader(
+		not_null<DocumentData*> document,
+		QSize frame,
+		QSize outer,
+		Callback &&callback);
+
 	void init(const FileLocation &location, const QByteArray &data);
 
+	int subscribe(Callback &&callback);
+
+	// Returns the count of subscriptions left.
+	int unsubscribe(int subscription);
+
 	Callback _callback;
+	base::flat_map<int, Callback> _subscriptions;
+	bool _shared = false;
 	Mode _mode;
 
 	State _state = State::Reading;
@@ -172,6 +200,14 @@ inline ReaderPointer MakeReader(Args&&... args) {
 	return ReaderPointer(new Reader(std::forward<Args>(args)...));
 }
 
+// Silent GIF readers for the same document and the same frame size are
+// shared, so that every frame is decoded once for all the viewers.
+ReaderPointer MakeSharedReader(
+	not_null<DocumentData*> document,
+	QSize frame,
+	QSize outer,
+	Reader::Callback &&callback);
+
 enum class ProcessResult {
 	Error,
 	Started,
@@ -34,6 +34,11 @@ constexpr auto kIdsLimit = 32;
 // Preload next messages if we went further from current than that.
 constexpr auto kIdsPreloadAfter = 28;
 
+// Download up to X next tracks while the current one is playing,
+// but don't start downloads after Y bytes are already queued.
+constexpr auto kPreloadTracksCount = 3;
+constexpr auto kPreloadTracksSizeLimit = 64 * 1024 * 1024;
+
 } // namespace
 
 void start(not_null<Audio::Instance*> instance) {
@@ -137,6 +142,9 @@ void Instance::playlistUpdated(not_null<Data*> data) {
 		data->playlistIndex = std::nullopt;
 	}
 	data->playlistChanges.fire({});
+	if (data->isPlaying) {
+		preloadNext(data);
+	}
 }
 
 bool Instance::validPlaylist(not_null<Data*> data) {
@@ -470,20 +478,32 @@ void Instance::preloadNext(not_null<Data*> data) {
 	if (!data->current || !data->playlistSlice || !data->playlistIndex) {
 		return;
 	}
-	const auto nextIndex = *data->playlistIndex + 1;
-	if (const auto item = itemByIndex(data, nextIndex)) {
-		if (const auto media = item->media()) {
-			if (const auto document = media->document()) {
-				const auto isLoaded = document->loaded(
-					DocumentData::FilePathResolveSaveFromDataSilent);
-				if (!isLoaded) {
-					DocumentOpenClickHandler::Open(
-						item->fullId(),
-						document,
-						item,
-						ActionOnLoadNone);
-				}
-			}
+	auto queuedSize = int64(0);
+	for (auto i = 1; i <= kPreloadTracksCount; ++i) {
+		const auto item = itemByIndex(data, *data->playlistIndex + i);
+		if (!item) {
+			break;
+		}
+		const auto media = item->media();
+		const auto document = media ? media->document() : nullptr;
+		if (!document) {
+			continue;
+		}
+		const auto isLoaded = document->loaded(
+			DocumentData::FilePathResolveSaveFromDataSilent);
+		if (isLoaded) {
+			continue;
+		} else if (i > 1
+			&& queuedSize + document->size > kPreloadTracksSizeLimit) {
+			break;
+		}
+		queuedSize += document->size;
+		if (!document->loading()) {
+			DocumentOpenClickHandler::Open(
+				item->fullId(),
+				document,
+				item,
+				ActionOnLoadNone);
 		}
 	}
 }
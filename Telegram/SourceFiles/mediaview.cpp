@@ -42,6 +42,12 @@ namespace {
 
 constexpr auto kPreloadCount = 4;
 
+// Scale that many loaded photos in the direction of browsing in advance.
+constexpr auto kPreparePhotosCount = 2;
+
+// Bytes of the scaled photos kept for the neighbours.
+constexpr auto kPreparedPhotosLimit = 64 * 1024 * 1024;
+
 // Preload X message ids before and after current.
 constexpr auto kIdsLimit = 48;
 
@@ -111,6 +117,7 @@ MediaView::MediaView()
 			subscribe(Auth().downloaderTaskFinished(), [this] {
 				if (!isHidden()) {
 					updateControls();
+					preparePreloadedPhotos();
 				}
 			});
 			subscribe(Auth().calls().currentCallChanged(), [this](Calls::Call *call) {
@@ -727,6 +734,9 @@ void MediaView::clearData() {
 	_doc = nullptr;
 	_fullScreenVideo = false;
 	_caption.clear();
+	_preparedPhotos.clear();
+	_currentZoomed = QPixmap();
+	_currentZoomedKey = 0;
 }
 
 MediaView::~MediaView() {
@@ -2070,6 +2080,22 @@ void MediaView::updateSilentVideoPlaybackState() {
 	updateVideoPlaybackState(state);
 }
 
+QSize MediaView::photoImageSize(not_null<PhotoData*> photo) const {
+	auto w = ConvertScale(photo->width());
+	auto h = ConvertScale(photo->height());
+	if (w > width()) {
+		h = qRound(h * width() / float64(w));
+		w = width();
+	}
+	if (h > height()) {
+		w = qRound(w * height() / float64(h));
+		h = height();
+	}
+	const auto pixw = w * cIntRetinaFactor();
+	const auto pixh = int((photo->height() * (qreal(pixw) / qreal(photo->width()))) + 0.9999);
+	return QSize(pixw, pixh);
+}
+
 void MediaView::validatePhotoImage(Image *image, bool blurred) {
 	if (!image || !image->loaded()) {
 		if (!blurred) {
@@ -2081,6 +2107,19 @@ void MediaView::validatePhotoImage(Image *image, bool blurred) {
 	}
 	const auto w = _width * cIntRetinaFactor();
 	const auto h = int((_photo->height() * (qreal(w) / qreal(_photo->width()))) + 0.9999);
+	if (!blurred) {
+		const auto i = _preparedPhotos.find(_photo);
+		if (i != end(_preparedPhotos)
+			&& i->second.size == QSize(w, h)
+			&& !i->second.image.isNull()) {
+			_current = App::pixmapFromImageInPlace(
+				base::take(i->second.image));
+			_preparedPhotos.erase(i);
+			_current.setDevicePixelRatio(cRetinaFactor());
+			_blurred = false;
+			return;
+		}
+	}
 	_current = image->pixNoCache(
 		fileOrigin(),
 		w,
@@ -2146,12 +2185,7 @@ void MediaView::paintEvent(QPaintEvent *e) {
 				p.fillRect(imgRect, _transparentBrush);
 			}
 			if (!toDraw.isNull()) {
-				if (toDraw.width() != _w * cIntRetinaFactor()) {
-					PainterHighQualityEnabler hq(p);
-					p.drawPixmap(QRect(_x, _y, _w, _h), toDraw);
-				} else {
-					p.drawPixmap(_x, _y, toDraw);
-				}
+				paintScaledImage(p, toDraw, r, (_photo != nullptr));
 			}
 
 			bool radial = false;
@@ -2400,6 +2434,47 @@ void MediaView::checkGroupThumbsAnimation() {
 	}
 }
 
+void MediaView::paintScaledImage(
+		Painter &p,
+		const QPixmap &image,
+		QRect clip,
+		bool cacheDownscaled) {
+	const auto size = QSize(_w, _h) * cIntRetinaFactor();
+	if (image.width() == size.width()) {
+		_currentZoomed = QPixmap();
+		p.drawPixmap(_x, _y, image);
+		return;
+	} else if (cacheDownscaled && image.width() > size.width()) {
+		// Scale once for the zoom level instead of on each pan frame.
+		if (_currentZoomedKey != image.cacheKey()
+			|| _currentZoomed.size() != size) {
+			_currentZoomed = image.scaled(
+				size,
+				Qt::IgnoreAspectRatio,
+				Qt::SmoothTransformation);
+			_currentZoomed.setDevicePixelRatio(cRetinaFactor());
+			_currentZoomedKey = image.cacheKey();
+		}
+		p.drawPixmap(_x, _y, _currentZoomed);
+		return;
+	}
+
+	// When zoomed in scale only the part of the image that is visible.
+	const auto visible = QRect(_x, _y, _w, _h).intersected(clip);
+	if (visible.isEmpty()) {
+		return;
+	}
+	const auto scaleX = image.width() / float64(_w);
+	const auto scaleY = image.height() / float64(_h);
+	const auto source = QRectF(
+		(visible.x() - _x) * scaleX,
+		(visible.y() - _y) * scaleY,
+		visible.width() * scaleX,
+		visible.height() * scaleY);
+	PainterHighQualityEnabler hq(p);
+	p.drawPixmap(QRectF(visible), image, source);
+}
+
 void MediaView::paintDocRadialLoading(Painter &p, bool radial, float64 radialOpacity) {
 	float64 o = overLevel(OverIcon);
 	if (radial || (_doc && !_doc->loaded())) {
@@ -2738,6 +2813,7 @@ void MediaView::preloadData(int delta) {
 	if (!_index) {
 		return;
 	}
+	_preloadDelta = delta;
 	auto from = *_index + (delta ? delta : -1);
 	auto till = *_index + (delta ? delta * kPreloadCount : 1);
 	if (from > till) std::swap(from, till);
@@ -2765,6 +2841,79 @@ void MediaView::preloadData(int delta) {
 			}
 		}
 	}
+	preparePreloadedPhotos();
+}
+
+void MediaView::preparePreloadedPhotos() {
+	auto indices = std::vector<int>();
+	if (_index && !isHidden()) {
+		if (_preloadDelta) {
+			for (auto i = 1; i <= kPreparePhotosCount; ++i) {
+				indices.push_back(*_index + _preloadDelta * i);
+			}
+		} else {
+			indices = { *_index + 1, *_index - 1 };
+		}
+	}
+
+	// Leave only the nearest photos ahead that fit in the limit, so
+	// changing the direction drops the photos scaled for the old one.
+	auto wanted = std::vector<std::pair<not_null<PhotoData*>, QSize>>();
+	auto bytes = 0;
+	for (const auto index : indices) {
+		const auto entity = entityByIndex(index);
+		const auto photo = base::get_if<not_null<PhotoData*>>(&entity.data);
+		if (!photo || (*photo)->isNull() || *photo == _photo) {
+			continue;
+		}
+		const auto size = photoImageSize(*photo);
+		bytes += size.width() * size.height() * 4;
+		if (size.isEmpty() || bytes > kPreparedPhotosLimit) {
+			break;
+		}
+		wanted.emplace_back(*photo, size);
+	}
+	for (auto i = begin(_preparedPhotos); i != end(_preparedPhotos);) {
+		const auto keep = ranges::find(
+			wanted,
+			i->first,
+			[](const auto &pair) { return pair.first; });
+		if (keep == end(wanted) || keep->second != i->second.size) {
+			i = _preparedPhotos.erase(i);
+		} else {
+			++i;
+		}
+	}
+
+	const auto weak = make_weak(this);
+	for (const auto &pair : wanted) {
+		const auto photo = pair.first;
+		const auto size = pair.second;
+		if (_preparedPhotos.contains(photo)
+			|| !photo->large()->loaded()) {
+			continue;
+		}
+		auto original = photo->large()->original();
+		if (original.isNull()) {
+			continue;
+		}
+		_preparedPhotos.emplace(photo, PreparedPhoto{ size });
+		crl::async([=, original = std::move(original)]() mutable {
+			auto image = Images::prepare(
+				std::move(original),
+				size.width(),
+				size.height(),
+				Images::Option::Smooth,
+				0,
+				0);
+			crl::on_main(weak, [=, image = std::move(image)]() mutable {
+				const auto i = _preparedPhotos.find(photo);
+				if (i != end(_preparedPhotos) && i->second.size == size) {
+					i->second.image = std::move(image);
+				}
+			});
+		});
+	}
 }
 
 void MediaView::mousePressEvent(QMouseEvent *e) {
@@ -140,6 +140,7 @@ private:
 	void moveToScreen();
 	bool moveToNext(int delta);
 	void preloadData(int delta);
+	void preparePreloadedPhotos();
 	struct Entity {
 		base::optional_variant<
 			not_null<PhotoData*>,
@@ -242,6 +243,11 @@ private:
 	void zoomUpdate(int32 &newZoom);
 
 	void paintDocRadialLoading(Painter &p, bool radial, float64 radialOpacity);
+	void paintScaledImage(
+		Painter &p,
+		const QPixmap &image,
+		QRect clip,
+		bool cacheDownscaled);
 	void paintThemePreview(Painter &p, QRect clip);
 
 	void updateOverRect(OverState state);
@@ -251,6 +257,7 @@ private:
 	void checkGroupThumbsAnimation();
 	void initGroupThumbs();
 
+	QSize photoImageSize(not_null<PhotoData*> photo) const;
 	void validatePhotoImage(Image *image, bool blurred);
 	void validatePhotoCurrentImage();
 
@@ -301,7 +308,17 @@ private:
 	bool _pressed = false;
 	int32 _dragging = 0;
 	QPixmap _current;
+	QPixmap _currentZoomed; // _current downscaled to the zoom level.
+	qint64 _currentZoomedKey = 0;
 	Media::Clip::ReaderPointer _gif;
+
+	// Photos next to the current one scaled to the screen on a worker.
+	struct PreparedPhoto {
+		QSize size;
+		QImage image;
+	};
+	base::flat_map<not_null<PhotoData*>, PreparedPhoto> _preparedPhotos;
+	int _preloadDelta = 0;
 	bool _blurred = true;
 
 	// Video without audio stream playback information.
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 extern "C" {
 #include <openssl/aes.h>
 #include <openssl/modes.h>
+#include <openssl/evp.h>
 } // extern "C"
 
 namespace MTP {
@@ -110,4 +111,43 @@ void aesCtrEncrypt(bytes::span data, const void *key, CTRState *state) {
 		(block128_f)AES_encrypt);
 }
 
+CTRStream::~CTRStream() {
+	if (_context) {
+		EVP_CIPHER_CTX_free(_context);
+	}
+}
+
+void CTRStream::start(bytes::const_span key, bytes::const_span ivec) {
+	Expects(key.size() == CTRState::KeySize);
+	Expects(ivec.size() == CTRState::IvecSize);
+
+	if (!_context) {
+		_context = EVP_CIPHER_CTX_new();
+		Assert(_context != nullptr);
+	}
+	EVP_EncryptInit_ex(
+		_context,
+		EVP_aes_256_ctr(),
+		nullptr,
+		reinterpret_cast<const uchar*>(key.data()),
+		reinterpret_cast<const uchar*>(ivec.data()));
+}
+
+void CTRStream::process(bytes::span data) {
+	Expects(_context != nullptr);
+	Expects(data.size() <= std::numeric_limits<int>::max());
+
+	if (data.empty()) {
+		return;
+	}
+	auto processed = 0;
+	EVP_EncryptUpdate(
+		_context,
+		reinterpret_cast<uchar*>(data.data()),
+		&processed,
+		reinterpret_cast<const uchar*>(data.data()),
+		int(data.size()));
+	Assert(processed == data.size());
+}
+
 } // namespace MTP
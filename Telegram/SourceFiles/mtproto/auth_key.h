@@ -11,6 +11,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <memory>
 #include "base/bytes.h"
 
+struct evp_cipher_ctx_st;
+
 namespace MTP {
 
 class AuthKey {
@@ -151,4 +153,24 @@ struct CTRState {
 };
 void aesCtrEncrypt(bytes::span data, const void *key, CTRState *state);
 
+// ctr stream for the obfuscated transport, the expanded key and the
+// counter are kept between the calls and EVP uses hardware AES (AES-NI)
+// when it is available, instead of a block by block software path.
+class CTRStream {
+public:
+	CTRStream() = default;
+	CTRStream(const CTRStream &other) = delete;
+	CTRStream &operator=(const CTRStream &other) = delete;
+	~CTRStream();
+
+	void start(bytes::const_span key, bytes::const_span ivec);
+
+	// Encrypts or decrypts inplace, the data may be of any size.
+	void process(bytes::span data);
+
+private:
+	evp_cipher_ctx_st *_context = nullptr;
+
+};
+
 } // namespace MTP
@@ -10,7 +10,19 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtp_instance.h"
 #include "mtproto/rpc_sender.h"
 
+#include <crl/crl_queue.h>
+
 namespace MTP {
+namespace {
+
+constexpr auto kWorkerQueuesCount = 4;
+
+crl::queue &WorkerQueue(uint64 key) {
+	static auto queues = std::array<crl::queue, kWorkerQueuesCount>();
+	return queues[key % kWorkerQueuesCount];
+}
+
+} // namespace
 
 class ConcurrentSender::RPCDoneHandler : public RPCAbstractDoneHandler {
 public:
@@ -132,6 +144,10 @@ void ConcurrentSender::RequestBuilder::setAfter(
 	_afterRequestId = requestId;
 }
 
+void ConcurrentSender::RequestBuilder::setWorkerKey(uint64 key) noexcept {
+	_handlers.workerKey = key;
+}
+
 mtpRequestId ConcurrentSender::RequestBuilder::send() {
 	const auto requestId = GetNextRequestId();
 	const auto dcId = _dcId;
@@ -174,18 +190,35 @@ void ConcurrentSender::senderRequestRegister(
 	_requests.emplace(requestId, std::move(handlers));
 }
 
-void ConcurrentSender::senderRequestDone(
+void ConcurrentSender::InvokeDone(
 		mtpRequestId requestId,
+		Handlers &handlers,
 		bytes::const_span result) {
+	try {
+		handlers.done(requestId, result);
+	} catch (Exception &e) {
+		handlers.fail(
+			requestId,
+			RPCError::Local(
+				"RESPONSE_PARSE_FAILED",
+				QString("exception text: ") + e.what()));
+	}
+}
+
+void ConcurrentSender::senderRequestDone(
+		mtpRequestId requestId,
+		bytes::vector &&result) {
 	if (auto handlers = _requests.take(requestId)) {
-		try {
-			handlers->done(requestId, result);
-		} catch (Exception &e) {
-			handlers->fail(
+		if (const auto key = handlers->workerKey) {
+			WorkerQueue(*key).async([
 				requestId,
-				RPCError::Local(
-					"RESPONSE_PARSE_FAILED",
-					QString("exception text: ") + e.what()));
+				handlers = std::move(*handlers),
+				result = std::move(result)
+			]() mutable {
+				InvokeDone(requestId, handlers, result);
+			});
+		} else {
+			InvokeDone(requestId, *handlers, result);
 		}
 	}
 }
@@ -194,7 +227,17 @@ void ConcurrentSender::senderRequestFail(
 		mtpRequestId requestId,
 		RPCError &&error) {
 	if (auto handlers = _requests.take(requestId)) {
-		handlers->fail(requestId, std::move(error));
+		if (const auto key = handlers->workerKey) {
+			WorkerQueue(*key).async([
+				requestId,
+				handlers = std::move(*handlers),
+				error = std::move(error)
+			]() mutable {
+				handlers.fail(requestId, std::move(error));
+			});
+		} else {
+			handlers->fail(requestId, std::move(error));
+		}
 	}
 }
 
@@ -41,6 +41,7 @@ class ConcurrentSender : public base::has_weak_ptr {
 	struct Handlers {
 		DoneHandler done;
 		FailHandler fail;
+		std::optional<uint64> workerKey;
 	};
 
 	enum class FailSkipPolicy {
@@ -71,6 +72,7 @@ class ConcurrentSender : public base::has_weak_ptr {
 		void setFailHandler(InvokeFullFail &&invoke) noexcept;
 		void setFailSkipPolicy(FailSkipPolicy policy) noexcept;
 		void setAfter(mtpRequestId requestId) noexcept;
+		void setWorkerKey(uint64 key) noexcept;
 
 	private:
 		not_null<ConcurrentSender*> _sender;
@@ -134,6 +136,12 @@ public:
 		[[nodiscard]] SpecificRequestBuilder &afterRequest(
 			mtpRequestId requestId) noexcept;
 
+		// Response parsing and handlers run on a worker thread instead
+		// of the sender runner, handlers with the same key run in order.
+		// They should only pass the prepared results to their owner.
+		[[nodiscard]] SpecificRequestBuilder &handleOnWorker(
+			uint64 key) noexcept;
+
 	private:
 		SpecificRequestBuilder(
 			not_null<ConcurrentSender*> sender,
@@ -180,10 +188,15 @@ private:
 	friend class RequestBuilder;
 	friend class SentRequestWrap;
 
+	static void InvokeDone(
+		mtpRequestId requestId,
+		Handlers &handlers,
+		bytes::const_span result);
+
 	void senderRequestRegister(mtpRequestId requestId, Handlers &&handlers);
 	void senderRequestDone(
 		mtpRequestId requestId,
-		bytes::const_span result);
+		bytes::vector &&result);
 	void senderRequestFail(
 		mtpRequestId requestId,
 		RPCError &&error);
@@ -206,7 +219,7 @@ void ConcurrentSender::RequestBuilder::setDoneHandler(
 		auto from = reinterpret_cast<const mtpPrime*>(result.data());
 		const auto end = from + result.size() / sizeof(mtpPrime);
 		Response data;
-		data.read(from, end);
+		internal::ReadReceived(data, from, end);
 		std::move(handler)(requestId, std::move(data));
 	};
 }
@@ -442,6 +455,14 @@ auto ConcurrentSender::SpecificRequestBuilder<Request>::afterRequest(
 	return *this;
 }
 
+template <typename Request>
+auto ConcurrentSender::SpecificRequestBuilder<Request>::handleOnWorker(
+	uint64 key
+) noexcept -> SpecificRequestBuilder & {
+	setWorkerKey(key);
+	return *this;
+}
+
 inline void ConcurrentSender::SentRequestWrap::cancel() {
 	_sender->senderRequestCancel(_requestId);
 }
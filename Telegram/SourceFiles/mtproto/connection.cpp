@@ -16,8 +16,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/application.h"
 #include "core/launcher.h"
 #include "lang/lang_keys.h"
+#include "storage/localstorage.h"
 #include "base/openssl_help.h"
 #include "base/qthelp_url.h"
+#include "base/perf_counters.h"
 
 extern "C" {
 #include <openssl/bn.h>
@@ -40,6 +42,7 @@ constexpr auto kRecreateKeyId = AuthKey::KeyId(0xFFFFFFFFFFFFFFFFULL);
 constexpr auto kIntSize = static_cast<int>(sizeof(mtpPrime));
 constexpr auto kMaxModExpSize = 256;
 constexpr auto kWaitForBetterTimeout = TimeMs(2000);
+constexpr auto kWaitForPreferredTimeout = TimeMs(500);
 constexpr auto kMinConnectedTimeout = TimeMs(1000);
 constexpr auto kMaxConnectedTimeout = TimeMs(8000);
 constexpr auto kMinReceiveTimeout = TimeMs(4000);
@@ -56,6 +59,8 @@ constexpr auto kRequestConfigTimeout = TimeMs(8000);
 // Don't try to handle messages larger than this size.
 constexpr auto kMaxMessageLength = 16 * 1024 * 1024;
 
+base::perf::Histogram ResponseTime("mtp.response_ms");
+
 QString LogIdsVector(const QVector<MTPlong> &ids) {
 	if (!ids.size()) return "[]";
 	auto idsStr = QString("[%1").arg(ids.cbegin()->v);
@@ -357,7 +362,10 @@ void ConnectionPrivate::appendTestConnection(
 			protocol,
 			thread(),
 			_connectionOptions->proxy),
-		priority
+		priority,
+		ip.toStdString(),
+		port,
+		getms(true)
 	});
 	auto weak = _testConnections.back().data.get();
 	connect(weak, &AbstractConnection::error, [=](int errorCode) {
@@ -399,9 +407,11 @@ int16 ConnectionPrivate::getProtocolDcId() const {
 
 void ConnectionPrivate::destroyAllConnections() {
 	_waitForBetterTimer.cancel();
+	_waitForPreferredTimer.cancel();
 	_waitForReceivedTimer.cancel();
 	_waitForConnectedTimer.cancel();
 	_testConnections.clear();
+	_delayedTestConnections.clear();
 	_connection = nullptr;
 }
 
@@ -421,6 +431,7 @@ ConnectionPrivate::ConnectionPrivate(
 , _waitForConnectedTimer(thread, [=] { waitConnectedFailed(); })
 , _waitForReceivedTimer(thread, [=] { waitReceivedFailed(); })
 , _waitForBetterTimer(thread, [=] { waitBetterFailed(); })
+, _waitForPreferredTimer(thread, [=] { waitPreferredFailed(); })
 , _waitForReceived(kMinReceiveTimeout)
 , _waitForConnected(kMinConnectedTimeout)
 , _pingSender(thread, [=] { sendPingByTimer(); })
@@ -458,6 +469,13 @@ ConnectionPrivate::ConnectionPrivate(
 }
 
 void ConnectionPrivate::onConfigLoaded() {
+	// We waited for the options of our dc only once, later config
+	// refreshes restart just the dcs that have their options changed.
+	disconnect(
+		_instance,
+		SIGNAL(configLoaded()),
+		this,
+		SLOT(onConfigLoaded()));
 	connectToServer(true);
 }
 
@@ -1130,6 +1148,7 @@ void ConnectionPrivate::connectToServer(bool afterConfig) {
 			: !useHttp
 			? Variants::Http
 			: Variants::ProtocolCount;
+		auto tests = std::vector<DelayedTestConnection>();
 		for (auto address = 0; address != Variants::AddressTypeCount; ++address) {
 			if (address == skipAddress) {
 				continue;
@@ -1139,14 +1158,53 @@ void ConnectionPrivate::connectToServer(bool afterConfig) {
 					continue;
 				}
 				for (const auto &endpoint : variants.data[address][protocol]) {
-					appendTestConnection(
+					tests.push_back({
 						static_cast<Variants::Protocol>(protocol),
-						QString::fromStdString(endpoint.ip),
+						endpoint.ip,
 						endpoint.port,
-						endpoint.secret);
+						endpoint.secret
+					});
 				}
 			}
 		}
+
+		// Try the endpoint that worked last time alone for a short while
+		// and start racing all the others only if it doesn't connect.
+		const auto preferred = special
+			? std::nullopt
+			: _instance->dcOptions()->preferredEndpoint(bareDc, _dcType);
+		const auto i = preferred
+			? ranges::find_if(tests, [&](const DelayedTestConnection &test) {
+				return (test.ip == preferred->ip)
+					&& (test.port == preferred->port);
+			})
+			: end(tests);
+		if (i != end(tests)) {
+			DEBUG_LOG(("MTP Info: trying preferred endpoint %1:%2 first, "
+				"connected in %3ms last time."
+				).arg(QString::fromStdString(i->ip)
+				).arg(i->port
+				).arg(preferred->connectTime));
+			const auto test = std::move(*i);
+			tests.erase(i);
+			appendTestConnection(
+				test.protocol,
+				QString::fromStdString(test.ip),
+				test.port,
+				test.protocolSecret);
+			_delayedTestConnections = std::move(tests);
+			if (!_delayedTestConnections.empty()) {
+				_waitForPreferredTimer.callOnce(kWaitForPreferredTimeout);
+			}
+		} else {
+			for (const auto &test : tests) {
+				appendTestConnection(
+					test.protocol,
+					QString::fromStdString(test.ip),
+					test.port,
+					test.protocolSecret);
+			}
+		}
 	}
 	if (_testConnections.empty()) {
 		if (_instance->isKeysDestroyer()) {
@@ -1256,6 +1314,7 @@ void ConnectionPrivate::onReceivedSome() {
 	if (firstSentAt > 0) {
 		const auto ms = getms(true) - firstSentAt;
 		DEBUG_LOG(("MTP Info: response in %1ms, _waitForReceived: %2ms").arg(ms).arg(_waitForReceived));
+		ResponseTime.add(ms);
 
 		if (ms > 0 && ms * 2 < _waitForReceived) {
 			_waitForReceived = qMax(ms * 2, kMinReceiveTimeout);
@@ -1339,6 +1398,12 @@ void ConnectionPrivate::waitBetterFailed() {
 	confirmBestConnection();
 }
 
+void ConnectionPrivate::waitPreferredFailed() {
+	DEBUG_LOG(("MTP Info: preferred endpoint didn't connect in %1ms."
+		).arg(kWaitForPreferredTimeout));
+	appendDelayedTestConnections();
+}
+
 void ConnectionPrivate::doDisconnect() {
 	destroyAllConnections();
 
@@ -1409,7 +1474,7 @@ void ConnectionPrivate::handleReceived() {
 		constexpr auto kMinimalEncryptedIntsCount = kEncryptedHeaderIntsCount + 4U; // + 1 data + 3 padding
 		constexpr auto kMinimalIntsCount = kExternalHeaderIntsCount + kMinimalEncryptedIntsCount;
 		auto intsCount = uint32(intsBuffer.size());
-		auto ints = intsBuffer.constData();
+		auto ints = intsBuffer.data();
 		if ((intsCount < kMinimalIntsCount) || (intsCount > kMaxMessageLength / kIntSize)) {
 			LOG(("TCP Error: bad message received, len %1").arg(intsCount * kIntSize));
 			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(ints, intsCount * kIntSize).str()));
@@ -1426,16 +1491,16 @@ void ConnectionPrivate::handleReceived() {
 		auto encryptedInts = ints + kExternalHeaderIntsCount;
 		auto encryptedIntsCount = (intsCount - kExternalHeaderIntsCount) & ~0x03U;
 		auto encryptedBytesCount = encryptedIntsCount * kIntSize;
-		auto decryptedBuffer = QByteArray(encryptedBytesCount, Qt::Uninitialized);
 		auto msgKey = *(MTPint128*)(ints + 2);
 
+		// The received buffer is ours, decrypt it in place.
 #ifdef TDESKTOP_MTPROTO_OLD
-		aesIgeDecrypt_oldmtp(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, key, msgKey);
+		aesIgeDecrypt_oldmtp(encryptedInts, encryptedInts, encryptedBytesCount, key, msgKey);
 #else // TDESKTOP_MTPROTO_OLD
-		aesIgeDecrypt(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, key, msgKey);
+		aesIgeDecrypt(encryptedInts, encryptedInts, encryptedBytesCount, key, msgKey);
 #endif // TDESKTOP_MTPROTO_OLD
 
-		auto decryptedInts = reinterpret_cast<const mtpPrime*>(decryptedBuffer.constData());
+		const auto decryptedInts = static_cast<const mtpPrime*>(encryptedInts);
 		auto serverSalt = *(uint64*)&decryptedInts[0];
 		auto session = *(uint64*)&decryptedInts[2];
 		auto msgId = *(uint64*)&decryptedInts[4];
@@ -2431,6 +2496,7 @@ void ConnectionPrivate::onConnected(
 		connection.get(),
 		[](const TestConnection &test) { return test.data.get(); });
 	Assert(i != end(_testConnections));
+	i->connectTime = getms(true) - i->startedAt;
 	const auto my = i->priority;
 	const auto j = ranges::find_if(
 		_testConnections,
@@ -2442,6 +2508,9 @@ void ConnectionPrivate::onConnected(
 	} else {
 		DEBUG_LOG(("MTP Info: connection through IPv4 succeed."));
 		_waitForBetterTimer.cancel();
+		_waitForPreferredTimer.cancel();
+		_delayedTestConnections.clear();
+		rememberPreferredEndpoint(*i);
 		_connection = std::move(i->data);
 		_testConnections.clear();
 
@@ -2454,11 +2523,11 @@ void ConnectionPrivate::onDisconnected(
 		not_null<AbstractConnection*> connection) {
 	removeTestConnection(connection);
 
-	if (_testConnections.empty()) {
+	if (!_testConnections.empty()) {
+		confirmBestConnection();
+	} else if (!appendDelayedTestConnections()) {
 		destroyAllConnections();
 		restart();
-	} else {
-		confirmBestConnection();
 	}
 }
 
@@ -2480,6 +2549,9 @@ void ConnectionPrivate::confirmBestConnection() {
 	DEBUG_LOG(("MTP Info: can't connect through better, using %1."
 		).arg(i->data->tag()));
 
+	_waitForPreferredTimer.cancel();
+	_delayedTestConnections.clear();
+	rememberPreferredEndpoint(*i);
 	_connection = std::move(i->data);
 	_testConnections.clear();
 
@@ -2496,6 +2568,51 @@ void ConnectionPrivate::removeTestConnection(
 		end(_testConnections));
 }
 
+bool ConnectionPrivate::appendDelayedTestConnections() {
+	_waitForPreferredTimer.cancel();
+	if (_delayedTestConnections.empty()) {
+		return false;
+	}
+	if (_testConnections.empty()) {
+		// The preferred endpoint has failed, don't try it first next time.
+		_instance->dcOptions()->forgetPreferredEndpoint(
+			BareDcId(_shiftedDcId),
+			_dcType);
+	}
+	DEBUG_LOG(("MTP Info: racing %1 other test connections."
+		).arg(_delayedTestConnections.size()));
+	for (const auto &test : base::take(_delayedTestConnections)) {
+		appendTestConnection(
+			test.protocol,
+			QString::fromStdString(test.ip),
+			test.port,
+			test.protocolSecret);
+	}
+	_waitForConnectedTimer.callOnce(_waitForConnected);
+	return true;
+}
+
+void ConnectionPrivate::rememberPreferredEndpoint(
+		const TestConnection &connection) {
+	// Mtproto proxy connections don't have an ip, it's in the proxy.
+	if (connection.ip.empty()
+		|| _dcType == DcType::Temporary
+		|| _instance->isKeysDestroyer()) {
+		return;
+	}
+	const auto changed = _instance->dcOptions()->setPreferredEndpoint(
+		BareDcId(_shiftedDcId),
+		_dcType,
+		connection.ip,
+		connection.port,
+		connection.connectTime);
+	if (changed) {
+		InvokeQueued(_instance, [] {
+			Local::writeSettings();
+		});
+	}
+}
+
 void ConnectionPrivate::updateAuthKey() 	{
 	QReadLocker lockFinished(&sessionDataMutex);
 	if (!sessionData || !_connection) return;
@@ -2783,18 +2900,80 @@ void ConnectionPrivate::dhClientParamsSend() {
 	// gen rand 'b'
 	auto randomSeed = bytes::vector(ModExpFirst::kRandomPowerSize);
 	bytes::set_random(randomSeed);
-	auto g_b_data = CreateModExp(_authKeyData->g, _authKeyStrings->dh_prime, randomSeed);
+
+	// Two 2048-bit modexps take a noticeable time and the connection
+	// thread is shared by many sessions, so they are done in background.
+	cancelDhClientParamsComputation();
+	const auto computation = std::make_shared<DhClientParamsComputation>();
+	computation->owner = this;
+	_dhClientParamsComputation = computation;
+	crl::async([
+		computation,
+		g = _authKeyData->g,
+		prime = _authKeyStrings->dh_prime,
+		g_a = _authKeyStrings->g_a,
+		randomSeed = std::move(randomSeed)
+	]() mutable {
+		auto g_b = CreateModExp(g, prime, randomSeed);
+		auto authKey = g_b.modexp.empty()
+			? bytes::vector()
+			: CreateAuthKey(g_a, g_b.randomPower, prime);
+		bytes::set_with_const(randomSeed, gsl::byte(0));
+
+		QMutexLocker lock(&computation->mutex);
+		if (!computation->owner) {
+			bytes::set_with_const(g_b.randomPower, gsl::byte(0));
+			bytes::set_with_const(authKey, gsl::byte(0));
+			return;
+		}
+		computation->g_b = std::move(g_b);
+		computation->authKey = std::move(authKey);
+		computation->ready = true;
+		QMetaObject::invokeMethod(
+			computation->owner,
+			"dhClientParamsComputed",
+			Qt::QueuedConnection);
+	});
+}
+
+void ConnectionPrivate::cancelDhClientParamsComputation() {
+	if (const auto computation = base::take(_dhClientParamsComputation)) {
+		QMutexLocker lock(&computation->mutex);
+		computation->owner = nullptr;
+		if (computation->ready) {
+			bytes::set_with_const(computation->g_b.randomPower, gsl::byte(0));
+			bytes::set_with_const(computation->authKey, gsl::byte(0));
+		}
+	}
+}
+
+void ConnectionPrivate::dhClientParamsComputed() {
+	const auto computation = _dhClientParamsComputation;
+	if (!computation || !_authKeyData || !_authKeyStrings || !_connection) {
+		return;
+	}
+	{
+		QMutexLocker lock(&computation->mutex);
+		if (!computation->ready) {
+			return;
+		}
+	}
+	_dhClientParamsComputation = nullptr;
+
+	const auto &g_b_data = computation->g_b;
 	if (g_b_data.modexp.empty()) {
 		LOG(("AuthKey Error: could not generate good g_b."));
 		return restart();
 	}
 
-	auto computedAuthKey = CreateAuthKey(_authKeyStrings->g_a, g_b_data.randomPower, _authKeyStrings->dh_prime);
+	auto &computedAuthKey = computation->authKey;
 	if (computedAuthKey.empty()) {
 		LOG(("AuthKey Error: could not generate auth_key."));
 		return restart();
 	}
 	AuthKey::FillData(_authKeyStrings->auth_key, computedAuthKey);
+	bytes::set_with_const(computation->g_b.randomPower, gsl::byte(0));
+	bytes::set_with_const(computedAuthKey, gsl::byte(0));
 
 	// count auth_key hashes - parts of sha1(auth_key)
 	auto auth_key_sha = hashSha1(_authKeyStrings->auth_key.data(), _authKeyStrings->auth_key.size());
@@ -2983,6 +3162,8 @@ void ConnectionPrivate::authKeyCreated() {
 }
 
 void ConnectionPrivate::clearAuthKeyData() {
+	cancelDhClientParamsComputation();
+
 	auto zeroMemory = [](bytes::span bytes) {
 #ifdef Q_OS_WIN2
 		SecureZeroMemory(bytes.data(), bytes.size());
@@ -3022,10 +3203,10 @@ void ConnectionPrivate::onError(
 	}
 	removeTestConnection(connection);
 
-	if (_testConnections.empty()) {
-		handleError(errorCode);
-	} else {
+	if (!_testConnections.empty()) {
 		confirmBestConnection();
+	} else if (!appendDelayedTestConnections()) {
+		handleError(errorCode);
 	}
 }
 
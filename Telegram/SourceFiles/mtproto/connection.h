@@ -133,6 +133,7 @@ public slots:
 	// Auth key creation packet receive slots
 	void pqAnswered();
 	void dhParamsAnswered();
+	void dhClientParamsComputed();
 	void dhClientParamsAnswered();
 
 	// General packet receive slot, connected to conn->receivedData signal
@@ -150,6 +151,16 @@ private:
 	struct TestConnection {
 		ConnectionPointer data;
 		int priority = 0;
+		std::string ip;
+		int port = 0;
+		TimeMs startedAt = 0;
+		TimeMs connectTime = 0;
+	};
+	struct DelayedTestConnection {
+		DcOptions::Variants::Protocol protocol;
+		std::string ip;
+		int port = 0;
+		bytes::vector protocolSecret;
 	};
 	void connectToServer(bool afterConfig = false);
 	void doDisconnect();
@@ -167,12 +178,15 @@ private:
 	void waitConnectedFailed();
 	void waitReceivedFailed();
 	void waitBetterFailed();
+	void waitPreferredFailed();
 	void markConnectionOld();
 	void sendPingByTimer();
 
 	void destroyAllConnections();
 	void confirmBestConnection();
 	void removeTestConnection(not_null<AbstractConnection*> connection);
+	bool appendDelayedTestConnections();
+	void rememberPreferredEndpoint(const TestConnection &connection);
 	int16 getProtocolDcId() const;
 
 	mtpMsgId placeToContainer(
@@ -239,6 +253,7 @@ private:
 	not_null<Connection*> _owner;
 	ConnectionPointer _connection;
 	std::vector<TestConnection> _testConnections;
+	std::vector<DelayedTestConnection> _delayedTestConnections;
 	TimeMs _startedConnectingAt = 0;
 
 	base::Timer _retryTimer; // exp retry timer
@@ -251,6 +266,7 @@ private:
 	base::Timer _waitForConnectedTimer;
 	base::Timer _waitForReceivedTimer;
 	base::Timer _waitForBetterTimer;
+	base::Timer _waitForPreferredTimer;
 	TimeMs _waitForReceived = 0;
 	TimeMs _waitForConnected = 0;
 	TimeMs firstSentAt = -1;
@@ -303,7 +319,19 @@ private:
 	std::unique_ptr<AuthKeyCreateData> _authKeyData;
 	std::unique_ptr<AuthKeyCreateStrings> _authKeyStrings;
 
+	// g_b and auth_key are computed in the background, the owner is
+	// cleared when the result is not needed anymore.
+	struct DhClientParamsComputation {
+		QMutex mutex;
+		ConnectionPrivate *owner = nullptr;
+		bool ready = false;
+		ModExpFirst g_b;
+		bytes::vector authKey;
+	};
+	std::shared_ptr<DhClientParamsComputation> _dhClientParamsComputation;
+
 	void dhClientParamsSend();
+	void cancelDhClientParamsComputation();
 	void authKeyCreated();
 	void clearAuthKeyData();
 
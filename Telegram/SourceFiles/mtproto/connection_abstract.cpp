@@ -14,6 +14,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace MTP {
 namespace internal {
+namespace {
+
+constexpr auto kSendBuffersPoolSize = size_t(4);
+constexpr auto kMaxPooledSendBufferInts = 16 * 1024;
+
+} // namespace
 
 ConnectionPointer::ConnectionPointer() = default;
 
@@ -78,8 +84,8 @@ ConnectionPointer::~ConnectionPointer() {
 mtpBuffer AbstractConnection::prepareSecurePacket(
 		uint64 keyId,
 		MTPint128 msgKey,
-		uint32 size) const {
-	auto result = mtpBuffer();
+		uint32 size) {
+	auto result = takeSendBuffer();
 	constexpr auto kTcpPrefixInts = 2;
 	constexpr auto kAuthKeyIdPosition = kTcpPrefixInts;
 	constexpr auto kAuthKeyIdInts = 2;
@@ -97,6 +103,26 @@ mtpBuffer AbstractConnection::prepareSecurePacket(
 	return result;
 }
 
+mtpBuffer AbstractConnection::takeSendBuffer() {
+	if (_sendBuffers.empty()) {
+		return mtpBuffer();
+	}
+	auto result = std::move(_sendBuffers.back());
+	_sendBuffers.pop_back();
+	return result;
+}
+
+void AbstractConnection::recycleSendBuffer(mtpBuffer &&buffer) {
+	if (_sendBuffers.size() >= kSendBuffersPoolSize
+		|| buffer.capacity() > kMaxPooledSendBufferInts) {
+		return;
+	}
+
+	// QVector::clear() releases the memory, resize(0) keeps capacity.
+	buffer.resize(0);
+	_sendBuffers.push_back(std::move(buffer));
+}
+
 gsl::span<const mtpPrime> AbstractConnection::parseNotSecureResponse(
 		const mtpBuffer &buffer) const {
 	const auto answer = buffer.data();
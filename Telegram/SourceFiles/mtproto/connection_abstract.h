@@ -106,7 +106,7 @@ public:
 	mtpBuffer prepareSecurePacket(
 		uint64 keyId,
 		MTPint128 msgKey,
-		uint32 size) const;
+		uint32 size);
 
 	gsl::span<const mtpPrime> parseNotSecureResponse(
 		const mtpBuffer &buffer) const;
@@ -134,6 +134,15 @@ protected:
 	mtpBuffer preparePQFake(const MTPint128 &nonce) const;
 	MTPResPQ readPQFakeReply(const mtpBuffer &buffer) const;
 
+	// Packets are copied to the socket / network request when sent,
+	// so their buffers can be reused for the next packets.
+	void recycleSendBuffer(mtpBuffer &&buffer);
+
+private:
+	mtpBuffer takeSendBuffer();
+
+	std::vector<mtpBuffer> _sendBuffers;
+
 };
 
 template <typename Request>
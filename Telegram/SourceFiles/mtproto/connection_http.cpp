@@ -38,12 +38,12 @@ void HttpConnection::sendData(mtpBuffer &&buffer) {
 
 	int32 requestSize = (buffer.size() - 2) * sizeof(mtpPrime);
 
-	QNetworkRequest request(url());
+	auto request = _request;
 	request.setHeader(QNetworkRequest::ContentLengthHeader, QVariant(requestSize));
-	request.setHeader(QNetworkRequest::ContentTypeHeader, QVariant(qsl("application/x-www-form-urlencoded")));
 
 	TCP_LOG(("HTTP Info: sending %1 len request").arg(requestSize));
 	_requests.insert(_manager.post(request, QByteArray((const char*)(&buffer[2]), requestSize)));
+	recycleSendBuffer(std::move(buffer));
 }
 
 void HttpConnection::disconnectFromServer() {
@@ -68,6 +68,7 @@ void HttpConnection::connectToServer(
 		const bytes::vector &protocolSecret,
 		int16 protocolDcId) {
 	_address = address;
+	_request = prepareRequest();
 	connect(
 		&_manager,
 		&QNetworkAccessManager::finished,
@@ -250,5 +251,21 @@ QUrl HttpConnection::url() const {
 	return QUrl(pattern.arg(_address).arg(kForceHttpPort));
 }
 
+QNetworkRequest HttpConnection::prepareRequest() const {
+	auto result = QNetworkRequest(url());
+	result.setHeader(
+		QNetworkRequest::ContentTypeHeader,
+		QVariant(qsl("application/x-www-form-urlencoded")));
+
+	// Ask the proxies to keep the connection, QNetworkAccessManager
+	// reuses up to six of them for the concurrent long polls. Pipelining
+	// stays disabled, requests would queue behind the held http_wait.
+	result.setRawHeader("Connection", "keep-alive");
+	result.setAttribute(
+		QNetworkRequest::HttpPipeliningAllowedAttribute,
+		false);
+	return result;
+}
+
 } // namespace internal
 } // namespace MTP
@@ -41,6 +41,7 @@ public:
 
 private:
 	QUrl url() const;
+	QNetworkRequest prepareRequest() const;
 
 	void requestFinished(QNetworkReply *reply);
 
@@ -55,6 +56,9 @@ private:
 	QNetworkAccessManager _manager;
 	QString _address;
 
+	// Url and headers are the same for all the requests to this address.
+	QNetworkRequest _request;
+
 	QSet<QNetworkReply*> _requests;
 
 	TimeMs _pingTime = 0;
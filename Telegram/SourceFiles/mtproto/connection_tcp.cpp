@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/bytes.h"
 #include "base/openssl_help.h"
 #include "base/qthelp_url.h"
+#include "base/perf_counters.h"
 
 extern "C" {
 #include <openssl/aes.h>
@@ -27,6 +28,9 @@ constexpr auto kMinPacketBuffer = 256;
 using ErrorSignal = void(QTcpSocket::*)(QAbstractSocket::SocketError);
 const auto QTcpSocket_error = ErrorSignal(&QAbstractSocket::error);
 
+base::perf::Counter BytesReceived("mtp.tcp.bytes_received");
+base::perf::Counter BytesSent("mtp.tcp.bytes_sent");
+
 } // namespace
 
 class TcpConnection::Protocol {
@@ -43,7 +47,8 @@ public:
 	static constexpr auto kUnknownSize = -1;
 	static constexpr auto kInvalidSize = -2;
 	virtual int readPacketLength(bytes::const_span bytes) const = 0;
-	virtual bytes::const_span readPacket(bytes::const_span bytes) const = 0;
+	virtual int readPacketHeaderLength(bytes::const_span bytes) const = 0;
+	bytes::const_span readPacket(bytes::const_span bytes) const;
 
 	virtual ~Protocol() = default;
 
@@ -64,10 +69,20 @@ public:
 	bytes::span finalizePacket(mtpBuffer &buffer) override;
 
 	int readPacketLength(bytes::const_span bytes) const override;
-	bytes::const_span readPacket(bytes::const_span bytes) const override;
+	int readPacketHeaderLength(bytes::const_span bytes) const override;
 
 };
 
+bytes::const_span TcpConnection::Protocol::readPacket(
+		bytes::const_span bytes) const {
+	const auto size = readPacketLength(bytes);
+	Assert(size != kUnknownSize
+		&& size != kInvalidSize
+		&& size <= bytes.size());
+	const auto sizeLength = readPacketHeaderLength(bytes);
+	return bytes.subspan(sizeLength, size - sizeLength);
+}
+
 uint32 TcpConnection::Protocol::Version0::id() const {
 	return 0xEFEFEFEFU;
 }
@@ -128,14 +143,11 @@ int TcpConnection::Protocol::Version0::readPacketLength(
 	return kInvalidSize;
 }
 
-bytes::const_span TcpConnection::Protocol::Version0::readPacket(
+int TcpConnection::Protocol::Version0::readPacketHeaderLength(
 		bytes::const_span bytes) const {
-	const auto size = readPacketLength(bytes);
-	Assert(size != kUnknownSize
-		&& size != kInvalidSize
-		&& size <= bytes.size());
-	const auto sizeLength = (static_cast<char>(bytes[0]) == 0x7F) ? 4 : 1;
-	return bytes.subspan(sizeLength, size - sizeLength);
+	Expects(!bytes.empty());
+
+	return (static_cast<char>(bytes[0]) == 0x7F) ? 4 : 1;
 }
 
 class TcpConnection::Protocol::Version1 : public Version0 {
@@ -175,7 +187,7 @@ public:
 	bytes::span finalizePacket(mtpBuffer &buffer) override;
 
 	int readPacketLength(bytes::const_span bytes) const override;
-	bytes::const_span readPacket(bytes::const_span bytes) const override;
+	int readPacketHeaderLength(bytes::const_span bytes) const override;
 
 };
 
@@ -213,14 +225,9 @@ int TcpConnection::Protocol::VersionD::readPacketLength(
 		: kInvalidSize;
 }
 
-bytes::const_span TcpConnection::Protocol::VersionD::readPacket(
+int TcpConnection::Protocol::VersionD::readPacketHeaderLength(
 		bytes::const_span bytes) const {
-	const auto size = readPacketLength(bytes);
-	Assert(size != kUnknownSize
-		&& size != kInvalidSize
-		&& size <= bytes.size());
-	const auto sizeLength = 4;
-	return bytes.subspan(sizeLength, size - sizeLength);
+	return 4;
 }
 
 auto TcpConnection::Protocol::Create(bytes::vector &&secret)
@@ -268,31 +275,77 @@ ConnectionPointer TcpConnection::clone(const ProxyData &proxy) {
 }
 
 void TcpConnection::ensureAvailableInBuffer(int amount) {
-	auto &buffer = _usingLargeBuffer ? _largeBuffer : _smallBuffer;
-	const auto full = bytes::make_span(buffer).subspan(
-		_offsetBytes);
+	Expects(amount <= _smallBuffer.size());
+
+	const auto full = bytes::make_span(_smallBuffer).subspan(_offsetBytes);
 	if (full.size() >= amount) {
 		return;
 	}
-	const auto read = full.subspan(0, _readBytes);
-	if (amount <= _smallBuffer.size()) {
-		if (_usingLargeBuffer) {
-			bytes::copy(_smallBuffer, read);
-			_usingLargeBuffer = false;
-			_largeBuffer.clear();
-		} else {
-			bytes::move(_smallBuffer, read);
-		}
-	} else if (amount <= _largeBuffer.size()) {
-		Assert(_usingLargeBuffer);
-		bytes::move(_largeBuffer, read);
-	} else {
-		auto enough = bytes::vector(amount);
-		bytes::copy(enough, read);
-		_largeBuffer = std::move(enough);
-		_usingLargeBuffer = true;
-	}
+	bytes::move(_smallBuffer, full.subspan(0, _readBytes));
+	_offsetBytes = 0;
+}
+
+void TcpConnection::startLargePacket(
+		bytes::const_span read,
+		int packetSize) {
+	Expects(!_usingLargeBuffer);
+	Expects(read.size() < packetSize);
+
+	const auto headerLength = _protocol->readPacketHeaderLength(read);
+	Assert(headerLength <= read.size());
+
+	const auto payload = read.subspan(headerLength);
+	_largePayloadSize = packetSize - headerLength;
+	_largeBuffer.resize(
+		(_largePayloadSize + sizeof(mtpPrime) - 1) / sizeof(mtpPrime));
+	bytes::copy(bytes::make_span(_largeBuffer), payload);
+	_usingLargeBuffer = true;
 	_offsetBytes = 0;
+	_readBytes = payload.size();
+	_leftBytes = packetSize - read.size();
+}
+
+bool TcpConnection::readLargePacket() {
+	Expects(_usingLargeBuffer);
+	Expects(_leftBytes > 0);
+
+	const auto free = bytes::make_span(_largeBuffer).subspan(
+		_readBytes,
+		_leftBytes);
+	const auto readCount = _socket.read(
+		reinterpret_cast<char*>(free.data()),
+		free.size());
+	if (readCount < 0) {
+		LOG(("TCP Error: socket read return %1").arg(readCount));
+		emit error(kErrorCodeOther);
+		return false;
+	} else if (!readCount) {
+		TCP_LOG(("TCP Info: no bytes read, but bytes available was true..."));
+		return false;
+	}
+	_receiveStream.process(free.subspan(0, readCount));
+	TCP_LOG(("TCP Info: read %1 bytes").arg(readCount));
+	BytesReceived.add(readCount);
+
+	_readBytes += readCount;
+	_leftBytes -= readCount;
+	if (_leftBytes > 0) {
+		TCP_LOG(("TCP Info: not enough %1 for packet! read %2"
+			).arg(_leftBytes
+			).arg(_readBytes));
+		emit receivedSome();
+		return true;
+	}
+	auto data = base::take(_largeBuffer);
+
+	// Shrinking a QVector doesn't reallocate it.
+	data.resize(_largePayloadSize / sizeof(mtpPrime));
+	_usingLargeBuffer = false;
+	_largePayloadSize = _readBytes = 0;
+	TCP_LOG(("TCP Info: packet received, size = %1"
+		).arg(data.size() * sizeof(mtpPrime)));
+	socketPacket(std::move(data));
+	return true;
 }
 
 void TcpConnection::socketRead() {
@@ -310,13 +363,19 @@ void TcpConnection::socketRead() {
 		_smallBuffer.resize(kSmallBufferSize);
 	}
 	do {
+		if (_usingLargeBuffer) {
+			if (!readLargePacket()) {
+				return;
+			}
+			continue;
+		}
 		const auto readLimit = (_leftBytes > 0)
 			? _leftBytes
 			: (kSmallBufferSize - _offsetBytes - _readBytes);
 		Assert(readLimit > 0);
 
-		auto &buffer = _usingLargeBuffer ? _largeBuffer : _smallBuffer;
-		const auto full = bytes::make_span(buffer).subspan(_offsetBytes);
+		const auto full = bytes::make_span(_smallBuffer).subspan(
+			_offsetBytes);
 		const auto free = full.subspan(_readBytes);
 		Assert(free.size() >= readLimit);
 
@@ -325,8 +384,9 @@ void TcpConnection::socketRead() {
 			readLimit);
 		if (readCount > 0) {
 			const auto read = free.subspan(0, readCount);
-			aesCtrEncrypt(read, _receiveKey, &_receiveState);
+			_receiveStream.process(read);
 			TCP_LOG(("TCP Info: read %1 bytes").arg(readCount));
+			BytesReceived.add(readCount);
 
 			_readBytes += readCount;
 			if (_leftBytes > 0) {
@@ -334,8 +394,6 @@ void TcpConnection::socketRead() {
 				_leftBytes -= readCount;
 				if (!_leftBytes) {
 					socketPacket(full.subspan(0, _readBytes));
-					_usingLargeBuffer = false;
-					_largeBuffer.clear();
 					_offsetBytes = _readBytes = 0;
 				} else {
 					TCP_LOG(("TCP Info: not enough %1 for packet! read %2"
@@ -364,6 +422,15 @@ void TcpConnection::socketRead() {
 
 						// If we have too little space left in the buffer.
 						ensureAvailableInBuffer(kMinPacketBuffer);
+					} else if (packetSize > kSmallBufferSize) {
+						// Read the rest of the packet without a copy.
+						startLargePacket(available, packetSize);
+						TCP_LOG(("TCP Info: reading large packet %1, "
+							"read %2"
+							).arg(packetSize
+							).arg(available.size()));
+						emit receivedSome();
+						break;
 					} else {
 						_leftBytes = packetSize - available.size();
 
@@ -518,11 +585,10 @@ void TcpConnection::writeConnectionStart() {
 		|| *second == reserved21);
 
 	// prepare encryption key/iv
-	_protocol->prepareKey(
-		bytes::make_span(_sendKey),
-		nonce.subspan(8, CTRState::KeySize));
-	bytes::copy(
-		bytes::make_span(_sendState.ivec),
+	auto key = bytes::array<CTRState::KeySize>();
+	_protocol->prepareKey(key, nonce.subspan(8, CTRState::KeySize));
+	_sendStream.start(
+		key,
 		nonce.subspan(8 + CTRState::KeySize, CTRState::IvecSize));
 
 	// prepare decryption key/iv
@@ -530,12 +596,11 @@ void TcpConnection::writeConnectionStart() {
 	const auto reversed = bytes::make_span(reversedBytes);
 	bytes::copy(reversed, nonce.subspan(8, reversed.size()));
 	std::reverse(reversed.begin(), reversed.end());
-	_protocol->prepareKey(
-		bytes::make_span(_receiveKey),
-		reversed.subspan(0, CTRState::KeySize));
-	bytes::copy(
-		bytes::make_span(_receiveState.ivec),
+	_protocol->prepareKey(key, reversed.subspan(0, CTRState::KeySize));
+	_receiveStream.start(
+		key,
 		reversed.subspan(CTRState::KeySize, CTRState::IvecSize));
+	bytes::set_with_const(key, gsl::byte(0));
 
 	// write protocol and dc ids
 	const auto protocol = reinterpret_cast<uint32*>(nonce.data() + 56);
@@ -544,7 +609,7 @@ void TcpConnection::writeConnectionStart() {
 	*dcId = _protocolDcId;
 
 	_socket.write(reinterpret_cast<const char*>(nonce.data()), 56);
-	aesCtrEncrypt(nonce, _sendKey, &_sendState);
+	_sendStream.process(nonce);
 	_socket.write(reinterpret_cast<const char*>(nonce.subspan(56).data()), 8);
 }
 
@@ -557,10 +622,12 @@ void TcpConnection::sendBuffer(mtpBuffer &&buffer) {
 	// buffer: 2 available int-s + data + available int.
 	const auto bytes = _protocol->finalizePacket(buffer);
 	TCP_LOG(("TCP Info: write packet %1 bytes").arg(bytes.size()));
-	aesCtrEncrypt(bytes, _sendKey, &_sendState);
+	_sendStream.process(bytes);
 	_socket.write(
 		reinterpret_cast<const char*>(bytes.data()),
 		bytes.size());
+	BytesSent.add(bytes.size());
+	recycleSendBuffer(std::move(buffer));
 }
 
 
@@ -620,8 +687,13 @@ TimeMs TcpConnection::fullConnectTimeout() const {
 void TcpConnection::socketPacket(bytes::const_span bytes) {
 	if (_status == Status::Finished) return;
 
+	socketPacket(parsePacket(bytes));
+}
+
+void TcpConnection::socketPacket(mtpBuffer &&data) {
+	if (_status == Status::Finished) return;
+
 	// old quickack?..
-	const auto data = parsePacket(bytes);
 	if (data.size() == 1) {
 		if (data[0] != 0) {
 			emit error(data[0]);
@@ -631,7 +703,7 @@ void TcpConnection::socketPacket(bytes::const_span bytes) {
 	//} else if (data.size() == 2) {
 		// new quickack?..
 	} else if (_status == Status::Ready) {
-		_receivedQueue.push_back(data);
+		_receivedQueue.push_back(std::move(data));
 		emit receivedData();
 	} else if (_status == Status::Waiting) {
 		try {
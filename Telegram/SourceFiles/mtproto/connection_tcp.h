@@ -52,6 +52,7 @@ private:
 	void writeConnectionStart();
 
 	void socketPacket(bytes::const_span bytes);
+	void socketPacket(mtpBuffer &&data);
 
 	void socketConnected();
 	void socketDisconnected();
@@ -59,6 +60,8 @@ private:
 
 	mtpBuffer parsePacket(bytes::const_span bytes);
 	void ensureAvailableInBuffer(int amount);
+	void startLargePacket(bytes::const_span read, int packetSize);
+	bool readLargePacket();
 	static void handleError(QAbstractSocket::SocketError e, QTcpSocket &sock);
 	static uint32 fourCharsToUInt(char ch1, char ch2, char ch3, char ch4) {
 		char ch[4] = { ch1, ch2, ch3, ch4 };
@@ -74,13 +77,15 @@ private:
 	int _readBytes = 0;
 	int _leftBytes = 0;
 	bytes::vector _smallBuffer;
-	bytes::vector _largeBuffer;
+
+	// Payload of a packet that doesn't fit in the small buffer is read
+	// right into the buffer that will be passed to ConnectionPrivate.
+	mtpBuffer _largeBuffer;
+	int _largePayloadSize = 0;
 	bool _usingLargeBuffer = false;
 
-	uchar _sendKey[CTRState::KeySize];
-	CTRState _sendState;
-	uchar _receiveKey[CTRState::KeySize];
-	CTRState _receiveState;
+	CTRStream _sendStream;
+	CTRStream _receiveStream;
 	class Protocol;
 	std::unique_ptr<Protocol> _protocol;
 	int16 _protocolDcId = 0;
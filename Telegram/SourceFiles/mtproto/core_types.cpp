@@ -9,6 +9,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "zlib.h"
 
+#include <atomic>
+
 namespace MTP {
 namespace {
 
@@ -145,6 +147,121 @@ bool SecureRequest::needAck() const {
 	return true;
 }
 
+namespace internal {
+namespace {
+
+// Received data smaller than that is read without an arena.
+constexpr auto kArenaMinReceivedSize = std::size_t(4 * 1024);
+
+// Objects take several times more memory than their serialization.
+constexpr auto kArenaSizeMultiplier = std::size_t(4);
+constexpr auto kArenaMinChunkSize = std::size_t(16 * 1024);
+constexpr auto kArenaMaxChunkSize = std::size_t(1024 * 1024);
+
+// Each block starts with a pointer to its arena, nullptr for heap.
+constexpr auto kBlockHeaderSize = sizeof(std::max_align_t);
+static_assert(kBlockHeaderSize >= sizeof(TypeDataArena*));
+
+thread_local TypeDataArena *CurrentArena = nullptr;
+
+std::size_t AlignedBlockSize(std::size_t size) {
+	constexpr auto kAlignment = alignof(std::max_align_t);
+	return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+} // namespace
+
+class TypeDataArena final {
+public:
+	explicit TypeDataArena(std::size_t chunkSize) : _chunkSize(chunkSize) {
+	}
+
+	void *allocate(std::size_t size) {
+		size = AlignedBlockSize(size);
+		if (size > _chunkSize / 4) {
+			return nullptr;
+		} else if (_position + size > _till) {
+			_chunks.emplace_back(new char[_chunkSize]);
+			_position = _chunks.back().get();
+			_till = _position + _chunkSize;
+		}
+		const auto result = _position;
+		_position += size;
+		ref();
+		return result;
+	}
+
+	void ref() {
+		++_counter;
+	}
+	void unref() {
+		if (!--_counter) {
+			delete this;
+		}
+	}
+
+private:
+	~TypeDataArena() = default;
+
+	std::size_t _chunkSize = 0;
+	std::vector<std::unique_ptr<char[]>> _chunks;
+	char *_position = nullptr;
+	char *_till = nullptr;
+
+	// Objects may be destroyed on a different thread.
+	std::atomic<int> _counter = 1;
+
+};
+
+void *TypeData::operator new(std::size_t size) {
+	const auto full = kBlockHeaderSize + size;
+	auto arena = CurrentArena;
+	auto block = arena
+		? static_cast<char*>(arena->allocate(full))
+		: nullptr;
+	if (!block) {
+		arena = nullptr;
+		block = static_cast<char*>(::operator new(full));
+	}
+	*reinterpret_cast<TypeDataArena**>(block) = arena;
+	return block + kBlockHeaderSize;
+}
+
+void TypeData::operator delete(void *data) {
+	if (!data) {
+		return;
+	}
+	const auto block = static_cast<char*>(data) - kBlockHeaderSize;
+	if (const auto arena = *reinterpret_cast<TypeDataArena**>(block)) {
+		arena->unref();
+	} else {
+		::operator delete(block);
+	}
+}
+
+TypeDataArenaScope::TypeDataArenaScope(
+		const mtpPrime *from,
+		const mtpPrime *end)
+: _previous(CurrentArena) {
+	const auto size = std::size_t(end - from) * sizeof(mtpPrime);
+	if (_previous || size < kArenaMinReceivedSize) {
+		return;
+	}
+	_arena = new TypeDataArena(snap(
+		size * kArenaSizeMultiplier,
+		kArenaMinChunkSize,
+		kArenaMaxChunkSize));
+	CurrentArena = _arena;
+}
+
+TypeDataArenaScope::~TypeDataArenaScope() {
+	if (_arena) {
+		CurrentArena = _previous;
+		_arena->unref();
+	}
+}
+
+} // namespace internal
 } // namespace MTP
 
 Exception::Exception(const QString &msg) noexcept : _msg(msg.toUtf8()) {
@@ -91,6 +91,8 @@ public:
 namespace MTP {
 namespace internal {
 
+class TypeDataArena;
+
 class TypeData {
 public:
 	TypeData() = default;
@@ -102,6 +104,10 @@ public:
 	virtual ~TypeData() {
 	}
 
+	// Allocated from the current TypeDataArena if there is one.
+	static void *operator new(std::size_t size);
+	static void operator delete(void *data);
+
 private:
 	void incrementCounter() const {
 		_counter.ref();
@@ -174,6 +180,33 @@ private:
 
 };
 
+// While the scope is alive all TypeData objects created on this thread
+// are placed in one arena, if the received data is large enough. The
+// arena is freed when the last of those objects is destroyed.
+class TypeDataArenaScope {
+public:
+	TypeDataArenaScope(const mtpPrime *from, const mtpPrime *end);
+	TypeDataArenaScope(const TypeDataArenaScope &other) = delete;
+	TypeDataArenaScope &operator=(const TypeDataArenaScope &other) = delete;
+	~TypeDataArenaScope();
+
+private:
+	TypeDataArena *_arena = nullptr;
+	TypeDataArena *_previous = nullptr;
+
+};
+
+// Large responses (dialogs, differences) contain thousands of objects,
+// read them into an arena instead of allocating each one separately.
+template <typename Type>
+inline void ReadReceived(
+		Type &to,
+		const mtpPrime *&from,
+		const mtpPrime *end) {
+	const auto arena = TypeDataArenaScope(from, end);
+	to.read(from, end);
+}
+
 } // namespace internal
 } // namespace MTP
 
@@ -731,9 +764,18 @@ public:
 		if (cons != mtpc_vector) throw mtpErrorUnexpected(cons, "MTPvector");
 		auto count = static_cast<uint32>(*(from++));
 
-		auto vector = QVector<T>(count, T());
-		for (auto &item : vector) {
-			item.read(from, end);
+		// Each item takes at least one mtpPrime, don't allocate
+		// a huge vector for a broken count before failing.
+		if (count > uint32(end - from)) throw mtpErrorInsufficient();
+
+		// Items are copies of one default value until they're read, so
+		// types with a single constructor don't allocate data twice.
+		const auto empty = T();
+		auto vector = QVector<T>();
+		vector.reserve(count);
+		for (auto i = uint32(0); i != count; ++i) {
+			vector.push_back(empty);
+			vector.back().read(from, end);
 		}
 		v = std::move(vector);
 	}
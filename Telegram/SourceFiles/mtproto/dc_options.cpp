@@ -218,6 +218,9 @@ void DcOptions::addFromOther(DcOptions &&options) {
 					_cdnPublicKeys[item.first].insert(std::move(entry));
 				}
 			}
+			for (auto &item : options._preferred) {
+				_preferred.insert(std::move(item));
+			}
 		}
 	}
 
@@ -371,7 +374,21 @@ QByteArray DcOptions::serialize() const {
 		}
 	}
 
-	constexpr auto kVersion = 1;
+	// Preferred endpoints.
+	auto preferredCount = 0;
+	size += sizeof(qint32);
+	for (const auto &[key, endpoint] : _preferred) {
+		if (key.second == DcType::Temporary) {
+			continue;
+		}
+		++preferredCount;
+		// id + type + port + connect time
+		size += sizeof(qint32) + sizeof(qint32) + sizeof(qint32);
+		size += sizeof(qint64);
+		size += sizeof(qint32) + endpoint.ip.size();
+	}
+
+	constexpr auto kVersion = 2;
 
 	auto result = QByteArray();
 	result.reserve(size);
@@ -406,6 +423,20 @@ QByteArray DcOptions::serialize() const {
 				<< Serialize::bytes(key.n)
 				<< Serialize::bytes(key.e);
 		}
+
+		// Preferred endpoints.
+		stream << qint32(preferredCount);
+		for (const auto &[key, endpoint] : _preferred) {
+			if (key.second == DcType::Temporary) {
+				continue;
+			}
+			stream << qint32(key.first)
+				<< qint32(key.second)
+				<< qint32(endpoint.port)
+				<< qint64(endpoint.connectTime)
+				<< qint32(endpoint.ip.size());
+			stream.writeRawData(endpoint.ip.data(), endpoint.ip.size());
+		}
 	}
 	return result;
 }
@@ -500,6 +531,49 @@ void DcOptions::constructFromSerialized(const QByteArray &serialized) {
 			}
 		}
 	}
+
+	// Read preferred endpoints
+	if (version > 1 && !stream.atEnd()) {
+		auto count = qint32(0);
+		stream >> count;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("MTP Error: Bad data for preferred endpoints in DcOptions::constructFromSerialized()"));
+			return;
+		}
+
+		for (auto i = 0; i != count; ++i) {
+			qint32 dcId = 0, type = 0, port = 0, ipSize = 0;
+			qint64 connectTime = 0;
+			stream >> dcId >> type >> port >> connectTime >> ipSize;
+
+			constexpr auto kMaxIpSize = 45;
+			if (stream.status() != QDataStream::Ok
+				|| ipSize <= 0
+				|| ipSize > kMaxIpSize) {
+				LOG(("MTP Error: Bad data for preferred endpoints inside DcOptions::constructFromSerialized()"));
+				return;
+			}
+
+			auto ip = std::string(ipSize, ' ');
+			stream.readRawData(ip.data(), ipSize);
+			if (stream.status() != QDataStream::Ok) {
+				LOG(("MTP Error: Bad data for preferred endpoints inside DcOptions::constructFromSerialized()"));
+				return;
+			}
+
+			switch (static_cast<DcType>(type)) {
+			case DcType::Regular:
+			case DcType::MediaDownload:
+			case DcType::Cdn:
+				_preferred[{ DcId(dcId), static_cast<DcType>(type) }] = {
+					ip,
+					port,
+					connectTime
+				};
+				break;
+			}
+		}
+	}
 }
 
 DcOptions::Ids DcOptions::configEnumDcIds() const {
@@ -534,6 +608,39 @@ DcType DcOptions::dcType(ShiftedDcId shiftedDcId) const {
 	return DcType::Regular;
 }
 
+auto DcOptions::preferredEndpoint(DcId dcId, DcType type) const
+-> std::optional<PreferredEndpoint> {
+	ReadLocker lock(this);
+	const auto i = _preferred.find({ dcId, type });
+	if (i == _preferred.end()) {
+		return std::nullopt;
+	}
+	return i->second;
+}
+
+bool DcOptions::setPreferredEndpoint(
+		DcId dcId,
+		DcType type,
+		const std::string &ip,
+		int port,
+		TimeMs connectTime) {
+	WriteLocker lock(this);
+	auto &endpoint = _preferred[{ dcId, type }];
+	if (endpoint.ip == ip && endpoint.port == port) {
+		// Smooth the connect time so that a single slow connect
+		// doesn't outweigh the whole history of this endpoint.
+		endpoint.connectTime = (endpoint.connectTime + connectTime) / 2;
+		return false;
+	}
+	endpoint = { ip, port, connectTime };
+	return true;
+}
+
+bool DcOptions::forgetPreferredEndpoint(DcId dcId, DcType type) {
+	WriteLocker lock(this);
+	return _preferred.erase({ dcId, type }) > 0;
+}
+
 void DcOptions::setCDNConfig(const MTPDcdnConfig &config) {
 	WriteLocker lock(this);
 	_cdnPublicKeys.clear();
@@ -85,6 +85,24 @@ public:
 	Variants lookup(DcId dcId, DcType type, bool throughProxy) const;
 	DcType dcType(ShiftedDcId shiftedDcId) const;
 
+	// The endpoint the last connection to the dc was established through.
+	// Next time it is tried first, before racing all the other ones.
+	struct PreferredEndpoint {
+		std::string ip;
+		int port = 0;
+		TimeMs connectTime = 0;
+	};
+	std::optional<PreferredEndpoint> preferredEndpoint(
+		DcId dcId,
+		DcType type) const;
+	bool setPreferredEndpoint(
+		DcId dcId,
+		DcType type,
+		const std::string &ip,
+		int port,
+		TimeMs connectTime);
+	bool forgetPreferredEndpoint(DcId dcId, DcType type);
+
 	void setCDNConfig(const MTPDcdnConfig &config);
 	bool hasCDNKeysForDc(DcId dcId) const;
 	bool getDcRSAKey(DcId dcId, const QVector<MTPlong> &fingerprints, internal::RSAPublicKey *result) const;
@@ -127,6 +145,7 @@ private:
 	std::set<DcId> _cdnDcIds;
 	std::map<uint64, internal::RSAPublicKey> _publicKeys;
 	std::map<DcId, std::map<uint64, internal::RSAPublicKey>> _cdnPublicKeys;
+	std::map<std::pair<DcId, DcType>, PreferredEndpoint> _preferred;
 	mutable QReadWriteLock _useThroughLockers;
 
 	mutable base::Observable<Ids> _changed;
@@ -58,7 +58,7 @@ constexpr ShiftedDcId updaterDcId(DcId dcId) {
 	return ShiftDcId(dcId, kUpdaterDcShift);
 }
 
-constexpr auto kDownloadSessionsCount = 2;
+constexpr auto kDownloadSessionsCount = 4;
 constexpr auto kUploadSessionsCount = 2;
 
 namespace internal {
@@ -135,7 +135,7 @@ public:
 	}
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		auto response = TResponse();
-		response.read(from, end);
+		MTP::internal::ReadReceived(response, from, end);
 		(*_onDone)(std::move(response));
 	}
 
@@ -153,7 +153,7 @@ public:
 	}
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		auto response = TResponse();
-		response.read(from, end);
+		MTP::internal::ReadReceived(response, from, end);
 		(*_onDone)(std::move(response), requestId);
 	}
 
@@ -381,7 +381,7 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		if (_owner) {
 			auto response = TResponse();
-			response.read(from, end);
+			MTP::internal::ReadReceived(response, from, end);
 			(static_cast<TReceiver*>(_owner)->*_onDone)(std::move(response));
 		}
 	}
@@ -401,7 +401,7 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		if (_owner) {
 			auto response = TResponse();
-			response.read(from, end);
+			MTP::internal::ReadReceived(response, from, end);
 			(static_cast<TReceiver*>(_owner)->*_onDone)(std::move(response), requestId);
 		}
 	}
@@ -487,7 +487,7 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		if (_owner) {
 			auto response = TResponse();
-			response.read(from, end);
+			MTP::internal::ReadReceived(response, from, end);
 			(static_cast<TReceiver*>(_owner)->*_onDone)(_b, std::move(response));
 		}
 	}
@@ -508,7 +508,7 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		if (_owner) {
 			auto response = TResponse();
-			response.read(from, end);
+			MTP::internal::ReadReceived(response, from, end);
 			(static_cast<TReceiver*>(_owner)->*_onDone)(_b, std::move(response), requestId);
 		}
 	}
@@ -878,7 +878,7 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		if (this->_handler) {
 			auto response = TResponse();
-			response.read(from, end);
+			MTP::internal::ReadReceived(response, from, end);
 			this->_handler(std::move(response));
 		}
 	}
@@ -892,7 +892,7 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) override {
 		if (this->_handler) {
 			auto response = TResponse();
-			response.read(from, end);
+			MTP::internal::ReadReceived(response, from, end);
 			this->_handler(std::move(response), requestId);
 		}
 	}
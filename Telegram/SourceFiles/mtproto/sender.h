@@ -60,7 +60,7 @@ class Sender {
 
 				if (handler) {
 					auto result = Response();
-					result.read(from, end);
+					internal::ReadReceived(result, from, end);
 					Policy::handle(std::move(handler), requestId, std::move(result));
 				}
 			}
@@ -66,9 +66,7 @@ void SessionData::setKey(const AuthKeyPtr &key) {
 		_authKey = key;
 
 		DEBUG_LOG(("MTP Info: new auth key set in SessionData, id %1, setting random server_session %2").arg(key ? key->keyId() : 0).arg(session));
-		QWriteLocker locker(&_lock);
-		if (_session != session) {
-			_session = session;
+		if (_session.exchange(session) != session) {
 			_messagesSent = 0;
 		}
 		_layerInited = false;
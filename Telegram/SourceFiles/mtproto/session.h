@@ -9,6 +9,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "base/timer.h"
 #include "mtproto/rpc_sender.h"
+#include "base/flat_map.h"
+
+#include <atomic>
 
 namespace MTP {
 
@@ -42,35 +45,36 @@ public:
 
 };
 
+// Msg ids are almost always received in increasing order, so they're
+// kept in a flat map: new ids are appended and old ones are trimmed
+// from the front, without a node allocation for each received message.
 class ReceivedMsgIds {
 public:
 	bool registerMsgId(mtpMsgId msgId, bool needAck) {
-		auto i = _idsNeedAck.constFind(msgId);
-		if (i == _idsNeedAck.cend()) {
-			if (_idsNeedAck.size() < kIdsBufferSize || msgId > min()) {
-				_idsNeedAck.insert(msgId, needAck);
-				return true;
-			}
+		if (_idsNeedAck.size() >= kIdsBufferSize && msgId <= min()) {
 			MTP_LOG(-1, ("No need to handle - %1 < min = %2").arg(msgId).arg(min()));
-		} else {
+			return false;
+		} else if (!_idsNeedAck.emplace(msgId, needAck).second) {
 			MTP_LOG(-1, ("No need to handle - %1 already is in map").arg(msgId));
+			return false;
 		}
-		return false;
+		return true;
 	}
 
 	mtpMsgId min() const {
-		return _idsNeedAck.isEmpty() ? 0 : _idsNeedAck.cbegin().key();
+		return _idsNeedAck.empty() ? 0 : _idsNeedAck.front().first;
 	}
 
 	mtpMsgId max() const {
-		auto end = _idsNeedAck.cend();
-		return _idsNeedAck.isEmpty() ? 0 : (--end).key();
+		return _idsNeedAck.empty() ? 0 : _idsNeedAck.back().first;
 	}
 
 	void shrink() {
-		auto size = _idsNeedAck.size();
-		while (size-- > kIdsBufferSize) {
-			_idsNeedAck.erase(_idsNeedAck.begin());
+		const auto size = int(_idsNeedAck.size());
+		if (size > kIdsBufferSize) {
+			_idsNeedAck.erase(
+				_idsNeedAck.begin(),
+				_idsNeedAck.begin() + (size - kIdsBufferSize));
 		}
 	}
 
@@ -80,11 +84,11 @@ public:
 		NoAckNeeded,
 	};
 	State lookup(mtpMsgId msgId) const {
-		auto i = _idsNeedAck.constFind(msgId);
-		if (i == _idsNeedAck.cend()) {
+		const auto i = _idsNeedAck.find(msgId);
+		if (i == _idsNeedAck.end()) {
 			return State::NotFound;
 		}
-		return i.value() ? State::NeedsAck : State::NoAckNeeded;
+		return i->second ? State::NeedsAck : State::NoAckNeeded;
 	}
 
 	void clear() {
@@ -92,7 +96,7 @@ public:
 	}
 
 private:
-	QMap<mtpMsgId, bool> _idsNeedAck;
+	base::flat_map<mtpMsgId, bool> _idsNeedAck;
 
 };
 
@@ -141,14 +145,11 @@ public:
 	void setSession(uint64 session) {
 		DEBUG_LOG(("MTP Info: setting server_session: %1").arg(session));
 
-		QWriteLocker locker(&_lock);
-		if (_session != session) {
-			_session = session;
+		if (_session.exchange(session) != session) {
 			_messagesSent = 0;
 		}
 	}
 	uint64 getSession() const {
-		QReadLocker locker(&_lock);
 		return _session;
 	}
 	void setConnectionInited(bool inited = true) {
@@ -168,11 +169,9 @@ public:
 	}
 
 	void setSalt(uint64 salt) {
-		QWriteLocker locker(&_lock);
 		_salt = salt;
 	}
 	uint64 getSalt() const {
-		QReadLocker locker(&_lock);
 		return _salt;
 	}
 
@@ -182,11 +181,9 @@ public:
 	void setKey(const AuthKeyPtr &key);
 
 	bool isCheckedKey() const {
-		QReadLocker locker(&_lock);
 		return _keyChecked;
 	}
 	void setCheckedKey(bool checked) {
-		QWriteLocker locker(&_lock);
 		_keyChecked = checked;
 	}
 
@@ -271,24 +268,25 @@ public:
 	}
 
 	uint32 nextRequestSeqNumber(bool needAck = true) {
-		QWriteLocker locker(&_lock);
-		auto result = _messagesSent;
-		_messagesSent += (needAck ? 1 : 0);
+		const auto result = needAck
+			? _messagesSent.fetch_add(1)
+			: _messagesSent.load();
 		return result * 2 + (needAck ? 1 : 0);
 	}
 
 	void clear(Instance *instance);
 
 private:
-	uint64 _session = 0;
-	uint64 _salt = 0;
+	// Read on every sent / received packet, so they're kept lock-free.
+	std::atomic<uint64> _session = 0;
+	std::atomic<uint64> _salt = 0;
 
-	uint32 _messagesSent = 0;
+	std::atomic<uint32> _messagesSent = 0;
 
 	not_null<Session*> _owner;
 
 	AuthKeyPtr _authKey;
-	bool _keyChecked = false;
+	std::atomic<bool> _keyChecked = false;
 	bool _layerInited = false;
 	ConnectionOptions _options;
 
@@ -303,7 +301,7 @@ private:
 	QList<SerializedMessage> _receivedUpdates; // list of updates that should be processed in the main thread
 
 	// mutexes
-	mutable QReadWriteLock _lock;
+	mutable QReadWriteLock _lock; // for _options
 	mutable QReadWriteLock _toSendLock;
 	mutable QReadWriteLock _haveSentLock;
 	mutable QReadWriteLock _toResendLock;
@@ -234,7 +234,9 @@ void SpecialConfigRequest::sendNextRequest() {
 	_attempts.pop_back();
 	if (!_attempts.empty()) {
 		App::CallDelayed(kSendNextTimeout, this, [=] {
-			sendNextRequest();
+			if (!_attempts.empty()) {
+				sendNextRequest();
+			}
 		});
 	}
 	performRequest(attempt);
@@ -276,14 +278,26 @@ void SpecialConfigRequest::requestFinished(
 		Type type,
 		not_null<QNetworkReply*> reply) {
 	const auto result = finalizeRequest(reply);
-	switch (type) {
-	case Type::App: handleResponse(result); break;
-	case Type::Dns: {
-		constexpr auto kTypeRestriction = 16; // TXT
-		handleResponse(ConcatenateDnsTxtFields(
-			ParseDnsResponse(result, kTypeRestriction)));
-	} break;
-	default: Unexpected("Type in SpecialConfigRequest::requestFinished.");
+	const auto handled = [&] {
+		switch (type) {
+		case Type::App: return handleResponse(result);
+		case Type::Dns: {
+			constexpr auto kTypeRestriction = 16; // TXT
+			return handleResponse(ConcatenateDnsTxtFields(
+				ParseDnsResponse(result, kTypeRestriction)));
+		}
+		}
+		Unexpected("Type in SpecialConfigRequest::requestFinished.");
+	}();
+	if (handled) {
+		// All the sources serve the same signed config, first one wins.
+		_attempts.clear();
+		for (auto &request : base::take(_requests)) {
+			request.destroy();
+		}
+	} else if (!_attempts.empty() && _requests.empty()) {
+		// Nothing is in flight, don't wait for the next attempt timeout.
+		sendNextRequest();
 	}
 }
 
@@ -373,20 +387,20 @@ bool SpecialConfigRequest::decryptSimpleConfig(const QByteArray &bytes) {
 	return true;
 }
 
-void SpecialConfigRequest::handleResponse(const QByteArray &bytes) {
+bool SpecialConfigRequest::handleResponse(const QByteArray &bytes) {
 	if (!decryptSimpleConfig(bytes)) {
-		return;
+		return false;
 	}
 	Assert(_simpleConfig.type() == mtpc_help_configSimple);
 	auto &config = _simpleConfig.c_help_configSimple();
 	auto now = unixtime();
 	if (now < config.vdate.v || now > config.vexpires.v) {
 		LOG(("Config Error: Bad date frame for simple config: %1-%2, our time is %3.").arg(config.vdate.v).arg(config.vexpires.v).arg(now));
-		return;
+		return false;
 	}
 	if (config.vrules.v.empty()) {
 		LOG(("Config Error: Empty simple config received."));
-		return;
+		return false;
 	}
 	for (auto &rule : config.vrules.v) {
 		Assert(rule.type() == mtpc_accessPointRule);
@@ -423,6 +437,7 @@ void SpecialConfigRequest::handleResponse(const QByteArray &bytes) {
 			}
 		}
 	}
+	return true;
 }
 
 DomainResolver::DomainResolver(Fn<void(
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "observer_peer.h"
 
 #include "base/observer.h"
+#include <rpl/event_stream.h>
 
 namespace Notify {
 namespace {
@@ -28,6 +29,28 @@ void FinishCallback() {
 
 base::Observable<PeerUpdate, PeerUpdatedHandler> PeerUpdatedObservable;
 
+// Viewers of a single peer are indexed by that peer, so that an update
+// is not checked by every such viewer in the app. Node-based std::map is
+// used because streams can be added while some other stream is firing.
+std::map<not_null<PeerData*>, rpl::event_stream<PeerUpdate>> PeerStreams;
+
+void SendUpdate(const PeerUpdate &update) {
+	PeerUpdatedObservable.notify(update, true);
+
+	const auto peer = update.peer;
+	const auto i = PeerStreams.find(peer);
+	if (i == end(PeerStreams)) {
+		return;
+	}
+	i->second.fire_copy(update);
+
+	// The stream could be erased by a nested update of the same peer.
+	const auto j = PeerStreams.find(peer);
+	if (j != end(PeerStreams) && !j->second.has_consumers()) {
+		PeerStreams.erase(j);
+	}
+}
+
 } // namespace
 
 void mergePeerUpdate(PeerUpdate &mergeTo, const PeerUpdate &mergeFrom) {
@@ -75,11 +98,11 @@ void peerUpdatedSendDelayed() {
 
 	auto smallList = base::take(*SmallUpdates);
 	auto allList = base::take(*AllUpdates);
-	for (auto &update : smallList) {
-		PeerUpdated().notify(std::move(update), true);
+	for (const auto &update : smallList) {
+		SendUpdate(update);
 	}
-	for (auto &update : allList) {
-		PeerUpdated().notify(std::move(update), true);
+	for (const auto &update : allList) {
+		SendUpdate(update);
 	}
 
 	if (SmallUpdates->isEmpty()) {
@@ -88,6 +111,10 @@ void peerUpdatedSendDelayed() {
 	}
 }
 
+void peerUpdatedSendNow(const PeerUpdate &update) {
+	SendUpdate(update);
+}
+
 base::Observable<PeerUpdate, PeerUpdatedHandler> &PeerUpdated() {
 	return PeerUpdatedObservable;
 }
@@ -108,11 +135,14 @@ rpl::producer<PeerUpdate> PeerUpdateViewer(
 rpl::producer<PeerUpdate> PeerUpdateViewer(
 		not_null<PeerData*> peer,
 		PeerUpdate::Flags flags) {
-	return PeerUpdateViewer(
-		flags
-	) | rpl::filter([=](const PeerUpdate &update) {
-		return (update.peer == peer);
-	});
+	return [=](const auto &consumer) {
+		return PeerStreams[peer].events(
+		) | rpl::filter([=](const PeerUpdate &update) {
+			return (update.flags & flags) != 0;
+		}) | rpl::start_with_next([=](const PeerUpdate &update) {
+			consumer.put_next_copy(update);
+		});
+	};
 }
 
 rpl::producer<PeerUpdate> PeerUpdateValue(
@@ -84,6 +84,11 @@ inline void peerUpdatedDelayed(PeerData *peer, PeerUpdate::Flags events) {
 }
 void peerUpdatedSendDelayed();
 
+// Sends the update right away, without merging it with the delayed ones.
+// Use it instead of PeerUpdated().notify(), which skips PeerUpdateViewer()
+// and PeerUpdateValue() producers of the updated peer.
+void peerUpdatedSendNow(const PeerUpdate &update);
+
 class PeerUpdatedHandler {
 public:
 	template <typename Lambda>
@@ -43,11 +43,13 @@ AesParams PrepareAesParams(bytes::const_span bytesForEncryptionKey) {
 	return PrepareAesParamsWithHash(openssl::Sha512(bytesForEncryptionKey));
 }
 
+// Works with prefix and bytes as if they were joined in one buffer.
 bytes::vector EncryptOrDecrypt(
+		bytes::const_span prefix,
 		bytes::const_span initial,
 		AesParams &&params,
 		int encryptOrDecrypt) {
-	Expects((initial.size() & 0x0F) == 0);
+	Expects(((prefix.size() + initial.size()) & 0x0F) == 0);
 	Expects(params.key.size() == kAesKeyLength);
 	Expects(params.iv.size() == kAesIvLength);
 
@@ -66,27 +68,53 @@ bytes::vector EncryptOrDecrypt(
 			).arg(error));
 		return {};
 	}
-	auto result = bytes::vector(initial.size());
-	AES_cbc_encrypt(
-		reinterpret_cast<const uchar*>(initial.data()),
-		reinterpret_cast<uchar*>(result.data()),
+	auto result = bytes::vector(prefix.size() + initial.size());
+	const auto process = [&](bytes::const_span from, bytes::span to) {
+		// AES_cbc_encrypt() leaves the chaining state in the iv.
+		AES_cbc_encrypt(
+			reinterpret_cast<const uchar*>(from.data()),
+			reinterpret_cast<uchar*>(to.data()),
+			from.size(),
+			&aesKey,
+			reinterpret_cast<uchar*>(params.iv.data()),
+			encryptOrDecrypt);
+	};
+	const auto head = std::min(
 		initial.size(),
-		&aesKey,
-		reinterpret_cast<uchar*>(params.iv.data()),
-		encryptOrDecrypt);
+		(kAlignTo - (prefix.size() % kAlignTo)) % kAlignTo);
+	if (!prefix.empty()) {
+		const auto first = bytes::concatenate(
+			prefix,
+			initial.subspan(0, head));
+		process(first, gsl::make_span(result).subspan(0, first.size()));
+	}
+	process(
+		initial.subspan(head),
+		gsl::make_span(result).subspan(prefix.size() + head));
 	return result;
 }
 
 bytes::vector Encrypt(
 		bytes::const_span decrypted,
 		AesParams &&params) {
-	return EncryptOrDecrypt(decrypted, std::move(params), AES_ENCRYPT);
+	return EncryptOrDecrypt({}, decrypted, std::move(params), AES_ENCRYPT);
+}
+
+bytes::vector EncryptWithPrefix(
+		bytes::const_span prefix,
+		bytes::const_span decrypted,
+		AesParams &&params) {
+	return EncryptOrDecrypt(
+		prefix,
+		decrypted,
+		std::move(params),
+		AES_ENCRYPT);
 }
 
 bytes::vector Decrypt(
 		bytes::const_span encrypted,
 		AesParams &&params) {
-	return EncryptOrDecrypt(encrypted, std::move(params), AES_DECRYPT);
+	return EncryptOrDecrypt({}, encrypted, std::move(params), AES_DECRYPT);
 }
 
 bool CheckBytesMod255(bytes::const_span bytes) {
@@ -335,15 +363,15 @@ EncryptedData EncryptData(
 		- ((bytes.size() + randomPadding) % kAlignTo);
 	Assert(padding >= kMinPadding && padding <= kMaxPadding);
 
-	auto unencrypted = bytes::vector(padding + bytes.size());
-	Assert(unencrypted.size() % kAlignTo == 0);
+	Assert((padding + bytes.size()) % kAlignTo == 0);
 
-	unencrypted[0] = static_cast<gsl::byte>(padding);
-	memset_rand(unencrypted.data() + 1, padding - 1);
-	bytes::copy(
-		gsl::make_span(unencrypted).subspan(padding),
+	// Don't copy large files only to put the padding in front of them.
+	auto prefix = bytes::vector(padding);
+	prefix[0] = static_cast<gsl::byte>(padding);
+	memset_rand(prefix.data() + 1, padding - 1);
+	const auto dataHash = openssl::Sha256(
+		bytes::const_span(prefix),
 		bytes);
-	const auto dataHash = openssl::Sha256(unencrypted);
 	const auto bytesForEncryptionKey = bytes::concatenate(
 		dataSecret,
 		dataHash);
@@ -352,7 +380,7 @@ EncryptedData EncryptData(
 	return {
 		{ dataSecret.begin(), dataSecret.end() },
 		{ dataHash.begin(), dataHash.end() },
-		Encrypt(unencrypted, std::move(params))
+		EncryptWithPrefix(prefix, bytes, std::move(params))
 	};
 }
 
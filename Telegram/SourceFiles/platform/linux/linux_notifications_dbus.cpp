@@ -0,0 +1,315 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "platform/linux/linux_notifications_dbus.h"
+
+#include "history/history.h"
+#include "lang/lang_keys.h"
+#include "data/data_peer.h"
+#include "core/application.h"
+#include "styles/style_window.h"
+
+#include <QtDBus>
+
+namespace {
+
+// The "image-data" hint, a raw (iiibiiay) image.
+struct NotificationImage {
+	QImage image;
+};
+
+} // namespace
+
+Q_DECLARE_METATYPE(NotificationImage);
+
+namespace {
+
+QDBusArgument &operator<<(
+		QDBusArgument &argument,
+		const NotificationImage &data) {
+	const auto &image = data.image;
+	argument.beginStructure();
+	argument
+		<< image.width()
+		<< image.height()
+		<< image.bytesPerLine()
+		<< true // has_alpha
+		<< 8 // bits_per_sample
+		<< 4 // channels
+		<< QByteArray(
+			reinterpret_cast<const char*>(image.constBits()),
+			image.byteCount());
+	argument.endStructure();
+	return argument;
+}
+
+const QDBusArgument &operator>>(
+		const QDBusArgument &argument,
+		NotificationImage &data) {
+	// We never receive images, but the marshaller wants both directions.
+	return argument;
+}
+
+} // namespace
+
+namespace Platform {
+namespace Notifications {
+namespace {
+
+const auto kService = qstr("org.freedesktop.Notifications");
+const auto kObjectPath = qstr("/org/freedesktop/Notifications");
+const auto kInterface = kService;
+
+QDBusMessage MethodCall(const QString &method) {
+	return QDBusMessage::createMethodCall(
+		kService,
+		kObjectPath,
+		kInterface,
+		method);
+}
+
+} // namespace
+
+bool DBusManager::Available() {
+	const auto bus = QDBusConnection::sessionBus();
+	if (!bus.isConnected()) {
+		return false;
+	}
+	const auto interface = bus.interface();
+	return interface && interface->isServiceRegistered(kService).value();
+}
+
+DBusManager::DBusManager(Window::Notifications::System *system)
+: NativeManager(system) {
+	qDBusRegisterMetaType<NotificationImage>();
+
+	auto bus = QDBusConnection::sessionBus();
+	bus.connect(
+		kService,
+		kObjectPath,
+		kInterface,
+		qsl("ActionInvoked"),
+		this,
+		SLOT(actionInvoked(uint,QString)));
+	bus.connect(
+		kService,
+		kObjectPath,
+		kInterface,
+		qsl("NotificationClosed"),
+		this,
+		SLOT(notificationClosed(uint,uint)));
+
+	requestCapabilities();
+}
+
+void DBusManager::requestCapabilities() {
+	const auto watcher = new QDBusPendingCallWatcher(
+		QDBusConnection::sessionBus().asyncCall(
+			MethodCall(qsl("GetCapabilities"))),
+		this);
+	connect(watcher, &QDBusPendingCallWatcher::finished, this, [=](
+			QDBusPendingCallWatcher *call) {
+		call->deleteLater();
+
+		const auto reply = QDBusPendingReply<QStringList>(*call);
+		if (reply.isError()) {
+			LOG(("Notifications Error: could not get capabilities, %1"
+				).arg(reply.error().message()));
+			applyCapabilities(QStringList());
+		} else {
+			applyCapabilities(reply.value());
+		}
+	});
+}
+
+void DBusManager::applyCapabilities(const QStringList &capabilities) {
+	LOG(("Notifications capabilities: %1"
+		).arg(capabilities.join(qstr(", "))));
+
+	_capabilitiesReceived = true;
+	_actionsSupported = capabilities.contains(qsl("actions"));
+	_markupSupported = capabilities.contains(qsl("body-markup"));
+	if (capabilities.contains(qsl("append"))) {
+		_appendHint = qsl("append");
+	} else if (capabilities.contains(qsl("x-canonical-append"))) {
+		_appendHint = qsl("x-canonical-append");
+	}
+	for (auto &notification : base::take(_queued)) {
+		send(std::move(notification));
+	}
+}
+
+void DBusManager::doShowNativeNotification(
+		PeerData *peer,
+		MsgId msgId,
+		const QString &title,
+		const QString &subtitle,
+		const QString &msg,
+		bool hideNameAndPhoto,
+		bool hideReplyButton) {
+	auto notification = Queued();
+	notification.peerId = peer->id;
+	notification.msgId = msgId;
+	notification.title = title;
+	notification.subtitle = subtitle;
+	notification.msg = msg;
+	notification.userpic = (hideNameAndPhoto
+		? Core::App().logoNoMargin().scaled(
+			st::notifyMacPhotoSize,
+			st::notifyMacPhotoSize,
+			Qt::IgnoreAspectRatio,
+			Qt::SmoothTransformation)
+		: peer->genUserpicRounded(st::notifyMacPhotoSize).toImage()
+	).convertToFormat(QImage::Format_RGBA8888);
+
+	if (_capabilitiesReceived) {
+		send(std::move(notification));
+	} else {
+		_queued.push_back(std::move(notification));
+	}
+}
+
+void DBusManager::send(Queued &&notification) {
+	const auto escape = [&](const QString &text) {
+		return _markupSupported ? text.toHtmlEscaped() : text;
+	};
+	const auto subtitle = escape(notification.subtitle);
+	const auto msg = escape(notification.msg);
+	const auto body = subtitle.isEmpty()
+		? msg
+		: ((_markupSupported
+			? (qstr("<b>") + subtitle + qstr("</b>"))
+			: subtitle) + '\n' + msg);
+
+	auto actions = QStringList();
+	if (_actionsSupported) {
+		actions << qsl("default") << lang(lng_notification_reply);
+	}
+	auto hints = QVariantMap();
+	hints.insert(qsl("desktop-entry"), qsl("telegramdesktop"));
+	if (!_appendHint.isEmpty()) {
+		hints.insert(_appendHint, qsl("true"));
+	}
+	if (!notification.userpic.isNull()) {
+		hints.insert(
+			qsl("image-data"),
+			QVariant::fromValue(NotificationImage{
+				std::move(notification.userpic) }));
+	}
+
+	const auto shown = Shown{ notification.peerId, notification.msgId };
+	const auto replacesId = findShown(shown.peerId, shown.msgId);
+	if (replacesId) {
+		_shown.remove(replacesId);
+	}
+
+	auto message = MethodCall(qsl("Notify"));
+	message.setArguments({
+		qsl("Telegram Desktop"),
+		QVariant::fromValue(replacesId),
+		QString(),
+		escape(notification.title),
+		body,
+		actions,
+		hints,
+		-1 // expire_timeout, leave it for the server
+	});
+	const auto pendingId = ++_pendingIdCounter;
+	_pending.emplace(pendingId, shown);
+
+	const auto watcher = new QDBusPendingCallWatcher(
+		QDBusConnection::sessionBus().asyncCall(message),
+		this);
+	connect(watcher, &QDBusPendingCallWatcher::finished, this, [=](
+			QDBusPendingCallWatcher *call) {
+		call->deleteLater();
+
+		const auto reply = QDBusPendingReply<uint>(*call);
+		const auto i = _pending.find(pendingId);
+		if (reply.isError()) {
+			LOG(("Notifications Error: could not show, %1"
+				).arg(reply.error().message()));
+			if (i != end(_pending)) {
+				_pending.erase(i);
+			}
+			return;
+		}
+		const auto id = reply.value();
+		if (i == end(_pending)) {
+			// Cleared while we were waiting for the server.
+			close(id);
+			return;
+		}
+		_shown[id] = i->second;
+		_pending.erase(i);
+	});
+}
+
+uint DBusManager::findShown(PeerId peerId, MsgId msgId) const {
+	for (const auto &[id, shown] : _shown) {
+		if (shown.peerId == peerId && shown.msgId == msgId) {
+			return id;
+		}
+	}
+	return 0;
+}
+
+void DBusManager::close(uint id) {
+	auto message = MethodCall(qsl("CloseNotification"));
+	message.setArguments({ QVariant::fromValue(id) });
+	QDBusConnection::sessionBus().send(message);
+}
+
+void DBusManager::doClearAllFast() {
+	_queued.clear();
+	_pending.clear();
+	for (const auto &[id, shown] : base::take(_shown)) {
+		close(id);
+	}
+}
+
+void DBusManager::doClearFromHistory(History *history) {
+	const auto peerId = history->peer->id;
+	_queued.erase(
+		ranges::remove(_queued, peerId, &Queued::peerId),
+		end(_queued));
+	for (auto i = begin(_pending); i != end(_pending);) {
+		if (i->second.peerId == peerId) {
+			i = _pending.erase(i);
+		} else {
+			++i;
+		}
+	}
+	for (auto i = begin(_shown); i != end(_shown);) {
+		if (i->second.peerId == peerId) {
+			close(i->first);
+			i = _shown.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+void DBusManager::actionInvoked(uint id, const QString &actionKey) {
+	const auto i = _shown.find(id);
+	if (i == end(_shown)) {
+		return;
+	}
+	const auto shown = i->second;
+	notificationActivated(shown.peerId, shown.msgId);
+}
+
+void DBusManager::notificationClosed(uint id, uint reason) {
+	_shown.remove(id);
+}
+
+DBusManager::~DBusManager() {
+	doClearAllFast();
+}
+
+} // namespace Notifications
+} // namespace Platform
@@ -0,0 +1,79 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "window/notifications_manager.h"
+
+namespace Platform {
+namespace Notifications {
+
+// Talks to org.freedesktop.Notifications with asynchronous D-Bus calls,
+// so a slow or a missing notification daemon never blocks the GUI thread.
+class DBusManager
+	: public QObject
+	, public Window::Notifications::NativeManager {
+	Q_OBJECT
+
+public:
+	static bool Available();
+
+	DBusManager(Window::Notifications::System *system);
+	~DBusManager();
+
+protected:
+	void doShowNativeNotification(
+		PeerData *peer,
+		MsgId msgId,
+		const QString &title,
+		const QString &subtitle,
+		const QString &msg,
+		bool hideNameAndPhoto,
+		bool hideReplyButton) override;
+	void doClearAllFast() override;
+	void doClearFromHistory(History *history) override;
+
+private slots:
+	void actionInvoked(uint id, const QString &actionKey);
+	void notificationClosed(uint id, uint reason);
+
+private:
+	struct Queued {
+		PeerId peerId = 0;
+		MsgId msgId = 0;
+		QString title;
+		QString subtitle;
+		QString msg;
+		QImage userpic;
+	};
+	struct Shown {
+		PeerId peerId = 0;
+		MsgId msgId = 0;
+	};
+
+	void requestCapabilities();
+	void applyCapabilities(const QStringList &capabilities);
+	void send(Queued &&notification);
+	void close(uint id);
+	uint findShown(PeerId peerId, MsgId msgId) const;
+
+	bool _capabilitiesReceived = false;
+	bool _actionsSupported = false;
+	bool _markupSupported = false;
+	QString _appendHint;
+	std::vector<Queued> _queued;
+
+	// Sent Notify calls that didn't return an id yet.
+	base::flat_map<uint64, Shown> _pending;
+	uint64 _pendingIdCounter = 0;
+
+	base::flat_map<uint, Shown> _shown;
+
+};
+
+} // namespace Notifications
+} // namespace Platform
@@ -21,6 +21,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Platform {
 namespace {
 
+constexpr auto kIconCountersUpdateDelay = TimeMs(250);
+
 bool noQtTrayIcon = false, tryAppIndicator = false;
 bool useGtkBase = false, useAppIndicator = false, useStatusIcon = false, trayIconChecked = false, useUnityCount = false;
 
@@ -199,6 +201,11 @@ MainWindow::MainWindow() {
 
 	connect(&_psUpdateIndicatorTimer, SIGNAL(timeout()), this, SLOT(psUpdateIndicator()));
 	_psUpdateIndicatorTimer.setSingleShot(true);
+
+	connect(&_updateIconCountersTimer, &QTimer::timeout, this, [=] {
+		updateIconCounters();
+	});
+	_updateIconCountersTimer.setSingleShot(true);
 }
 
 bool MainWindow::hasTrayIcon() const {
@@ -337,10 +344,30 @@ void MainWindow::psUpdateIndicator() {
 
 void MainWindow::unreadCounterChangedHook() {
 	setWindowTitle(titleText());
-	updateIconCounters();
+
+	if (_updateIconCountersTimer.isActive()) {
+		return;
+	} else if (Core::App().unreadBadge() == _iconCountersCounter
+		&& Core::App().unreadBadgeMuted() == _iconCountersMuted
+		&& _trayIconSize == _iconCountersTraySize) {
+		return;
+	}
+	const auto now = getms();
+	const auto next = _lastIconCountersUpdate + kIconCountersUpdateDelay;
+	if (now >= next) {
+		updateIconCounters();
+	} else {
+		_updateIconCountersTimer.start(next - now);
+	}
 }
 
 void MainWindow::updateIconCounters() {
+	_updateIconCountersTimer.stop();
+	_lastIconCountersUpdate = getms();
+	_iconCountersCounter = Core::App().unreadBadge();
+	_iconCountersMuted = Core::App().unreadBadgeMuted();
+	_iconCountersTraySize = _trayIconSize;
+
 	updateWindowIcon();
 
 	const auto counter = Core::App().unreadBadge();
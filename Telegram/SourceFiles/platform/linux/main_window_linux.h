@@ -61,6 +61,14 @@ private:
 	QTimer _psUpdateIndicatorTimer;
 	TimeMs _psLastIndicatorUpdate = 0;
 
+	// Unread changes come in bursts, the tray icon follows at most
+	// a few times a second and only if what it shows is different.
+	QTimer _updateIconCountersTimer;
+	TimeMs _lastIconCountersUpdate = 0;
+	int _iconCountersCounter = -1;
+	bool _iconCountersMuted = false;
+	int _iconCountersTraySize = 0;
+
 };
 
 } // namespace Platform
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "window/notifications_utilities.h"
 #include "platform/linux/linux_libnotify.h"
 #include "platform/linux/linux_libs.h"
+#include "platform/linux/linux_notifications_dbus.h"
 #include "history/history.h"
 #include "lang/lang_keys.h"
 
@@ -262,6 +263,10 @@ auto LibNotifyServerName = QString();
 #endif // !TDESKTOP_DISABLE_GTK_INTEGRATION
 
 bool Supported() {
+	static const auto DBusAvailable = DBusManager::Available();
+	if (DBusAvailable) {
+		return true;
+	}
 #ifndef TDESKTOP_DISABLE_GTK_INTEGRATION
 	static auto Checked = false;
 	if (!Checked) {
@@ -276,11 +281,14 @@ bool Supported() {
 }
 
 std::unique_ptr<Window::Notifications::Manager> Create(Window::Notifications::System *system) {
-#ifndef TDESKTOP_DISABLE_GTK_INTEGRATION
 	if (Global::NativeNotifications() && Supported()) {
+		if (DBusManager::Available()) {
+			return std::make_unique<DBusManager>(system);
+		}
+#ifndef TDESKTOP_DISABLE_GTK_INTEGRATION
 		return std::make_unique<Manager>(system);
-	}
 #endif // !TDESKTOP_DISABLE_GTK_INTEGRATION
+	}
 	return nullptr;
 }
 
@@ -0,0 +1,75 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "base/benchmark.h"
+
+#include <rpl/event_stream.h>
+#include <rpl/filter.h>
+#include <rpl/map.h>
+
+namespace {
+
+constexpr auto kFiresCount = 1000;
+constexpr int kSubscribersCounts[] = { 1, 10, 100, 1000 };
+
+} // namespace
+
+BENCHMARK_CASE("rpl::event_stream") {
+	for (const auto subscribers : kSubscribersCounts) {
+		const auto count = std::to_string(subscribers);
+		auto sum = 0;
+
+		auto stream = rpl::event_stream<int>();
+		auto lifetime = rpl::lifetime();
+		for (auto i = 0; i != subscribers; ++i) {
+			stream.events(
+			) | rpl::start_with_next([&](int value) {
+				sum += value;
+			}, lifetime);
+		}
+		runner.measure(
+			"fire to " + count,
+			kFiresCount * subscribers,
+			[&] {
+				for (auto i = 0; i != kFiresCount; ++i) {
+					stream.fire_copy(i);
+				}
+				base::benchmark::DoNotOptimize(sum);
+			});
+
+		auto mapped = rpl::event_stream<int>();
+		for (auto i = 0; i != subscribers; ++i) {
+			mapped.events(
+			) | rpl::filter([](int value) {
+				return (value & 1) == 0;
+			}) | rpl::map([](int value) {
+				return value * 2;
+			}) | rpl::start_with_next([&](int value) {
+				sum += value;
+			}, lifetime);
+		}
+		runner.measure(
+			"fire through filter and map to " + count,
+			kFiresCount * subscribers,
+			[&] {
+				for (auto i = 0; i != kFiresCount; ++i) {
+					mapped.fire_copy(i);
+				}
+				base::benchmark::DoNotOptimize(sum);
+			});
+	}
+
+	runner.measure("subscribe and unsubscribe", kFiresCount, [] {
+		auto stream = rpl::event_stream<int>();
+		for (auto i = 0; i != kFiresCount; ++i) {
+			auto lifetime = rpl::lifetime();
+			stream.events(
+			) | rpl::start_with_next([](int) {
+			}, lifetime);
+		}
+	});
+}
@@ -8,7 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/unique_function.h"
-#include <deque>
+#include <vector>
 
 namespace rpl {
 namespace details {
@@ -49,7 +49,9 @@ public:
 	~lifetime() { destroy(); }
 
 private:
-	std::deque<base::unique_function<void()>> _callbacks;
+	// Callbacks are called from the last one added to the first one.
+	// Unlike std::deque an empty std::vector doesn't allocate anything.
+	std::vector<base::unique_function<void()>> _callbacks;
 
 };
 
@@ -70,20 +72,25 @@ inline lifetime::lifetime(Destroy &&destroy) {
 
 template <typename Destroy, typename>
 inline void lifetime::add(Destroy &&destroy) {
-	_callbacks.push_front(destroy);
+	_callbacks.emplace_back(std::forward<Destroy>(destroy));
 }
 
 inline void lifetime::add(lifetime &&other) {
 	auto callbacks = details::take(other._callbacks);
+	if (_callbacks.empty()) {
+		_callbacks = std::move(callbacks);
+		return;
+	}
 	_callbacks.insert(
-		_callbacks.begin(),
+		_callbacks.end(),
 		std::make_move_iterator(callbacks.begin()),
 		std::make_move_iterator(callbacks.end()));
 }
 
 inline void lifetime::destroy() {
-	for (auto &callback : details::take(_callbacks)) {
-		callback();
+	auto callbacks = details::take(_callbacks);
+	for (auto i = callbacks.rbegin(), e = callbacks.rend(); i != e; ++i) {
+		(*i)();
 	}
 }
 
@@ -23,8 +23,58 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "window/themes/window_theme.h"
 #include "window/themes/window_theme_editor.h"
 #include "media/media_audio_track.h"
+#include "boxes/abstract_box.h"
+#include "ui/widgets/labels.h"
+#include "ui/wrap/padding_wrap.h"
+#include "base/perf_counters.h"
+#include "base/timer.h"
+#include "lang/lang_keys.h"
+#include "styles/style_boxes.h"
 
 namespace Settings {
+namespace {
+
+constexpr auto kUpdatePerfCountersTimeout = TimeMs(1000);
+
+class PerfCountersBox : public BoxContent {
+public:
+	PerfCountersBox(QWidget*) {
+	}
+
+protected:
+	void prepare() override;
+
+private:
+	void updateText();
+
+	QPointer<Ui::FlatLabel> _text;
+	base::Timer _updateTextTimer;
+
+};
+
+void PerfCountersBox::prepare() {
+	setTitle([] { return QString("Performance Counters"); });
+
+	addButton(langFactory(lng_close), [=] { closeBox(); });
+	_text = setInnerWidget(
+		object_ptr<Ui::PaddingWrap<Ui::FlatLabel>>(
+			this,
+			object_ptr<Ui::FlatLabel>(this, st::boxLabel),
+			st::boxPadding))->entity();
+	_text->setSelectable(true);
+	updateText();
+	_updateTextTimer.setCallback([=] { updateText(); });
+	_updateTextTimer.callEach(kUpdatePerfCountersTimeout);
+	setDimensions(st::boxWideWidth, st::boxMaxListHeight);
+}
+
+void PerfCountersBox::updateText() {
+	const auto snapshot = base::perf::TakeSnapshot();
+	_text->setText(QString::fromStdString(
+		base::perf::FormatSnapshot(snapshot)));
+}
+
+} // namespace
 
 auto GenerateCodes() {
 	auto codes = std::map<QString, Fn<void()>>();
@@ -121,6 +171,14 @@ auto GenerateCodes() {
 	codes.emplace(qsl("export"), [] {
 		Auth().data().startExport();
 	});
+	codes.emplace(qsl("scrollbench"), [] {
+		if (const auto main = App::main()) {
+			main->startScrollBenchmark();
+		}
+	});
+	codes.emplace(qsl("perfcounters"), [] {
+		Ui::show(Box<PerfCountersBox>());
+	});
 
 	auto audioFilters = qsl("Audio files (*.wav *.mp3);;") + FileDialog::AllFilesFilter();
 	auto audioKeys = {
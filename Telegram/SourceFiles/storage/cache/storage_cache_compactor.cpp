@@ -9,11 +9,17 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "storage/cache/storage_cache_database_object.h"
 #include "storage/cache/storage_cache_binlog_reader.h"
+#include "base/concurrent_timer.h"
 #include <unordered_set>
 
 namespace Storage {
 namespace Cache {
 namespace details {
+namespace {
+
+constexpr auto kMinChunkSize = size_type(16);
+
+} // namespace
 
 class CompactorObject {
 public:
@@ -41,6 +47,10 @@ private:
 	bool readHeader();
 	bool openCompact();
 	void parseChunk();
+	void parseNextChunk();
+	crl::time_type countThrottleDelay() const;
+	void adjustChunkSize();
+	void reportProgress();
 	void fail();
 	void done(int64 till);
 	void finish();
@@ -75,6 +85,10 @@ private:
 	File _compact;
 	BinlogWrapper _wrapper;
 	size_type _partSize = 0;
+	size_type _chunkSize = 0;
+	crl::time_type _started = 0;
+	crl::time_type _chunkStarted = 0;
+	base::ConcurrentTimer _throttleTimer;
 	std::unordered_set<Key> _written;
 	base::variant<
 		std::vector<MultiStore::Part>,
@@ -98,8 +112,12 @@ CompactorObject::CompactorObject(
 , _key(std::move(key))
 , _info(info)
 , _wrapper(_binlog, _settings, _info.till)
-, _partSize(_settings.maxBundledRecords) { // Perhaps a better estimate?
+, _partSize(_settings.maxBundledRecords) // Perhaps a better estimate?
+, _chunkSize(_settings.compactChunkSize)
+, _started(crl::time())
+, _throttleTimer(_weak, [=] { parseChunk(); }) {
 	Expects(_settings.compactChunkSize > 0);
+	Expects(_settings.compactBytesPerSecond >= 0);
 
 	_written.reserve(_info.keysCount);
 	start();
@@ -154,6 +172,8 @@ bool CompactorObject::readHeader() {
 }
 
 bool CompactorObject::openCompact() {
+	_header.keysCount = uint32(_info.keysCount);
+
 	const auto path = compactPath();
 	const auto result = _compact.open(path, File::Mode::Write, _key);
 	if (result != File::Result::Success) {
@@ -245,7 +265,7 @@ bool CompactorObject::writeMultiStore() {
 }
 
 std::vector<Key> CompactorObject::readChunk() {
-	const auto limit = _settings.compactChunkSize;
+	const auto limit = _chunkSize;
 	auto result = std::vector<Key>();
 	while (result.size() < limit) {
 		if (!readBlock(result)) {
@@ -297,6 +317,7 @@ bool CompactorObject::readBlock(std::vector<Key> &result) {
 }
 
 void CompactorObject::parseChunk() {
+	_chunkStarted = crl::time();
 	auto keys = readChunk();
 	if (_wrapper.failed()) {
 		fail();
@@ -328,7 +349,54 @@ void CompactorObject::processValues(
 			return;
 		}
 	}
-	parseChunk();
+	reportProgress();
+	adjustChunkSize();
+	parseNextChunk();
+}
+
+void CompactorObject::parseNextChunk() {
+	if (const auto delay = countThrottleDelay()) {
+		_throttleTimer.callOnce(delay);
+	} else {
+		parseChunk();
+	}
+}
+
+crl::time_type CompactorObject::countThrottleDelay() const {
+	const auto limit = _settings.compactBytesPerSecond;
+	if (!limit) {
+		return 0;
+	}
+	const auto processed = _binlog.offset() + _compact.offset();
+	const auto allowed = (crl::time() - _started) * limit / 1000;
+	if (processed <= allowed) {
+		return 0;
+	}
+	return std::min(
+		crl::time_type((processed - allowed) * 1000 / limit),
+		_settings.compactMaxChunkDelay);
+}
+
+void CompactorObject::adjustChunkSize() {
+	const auto limit = _settings.compactMaxChunkLatency;
+	if (!limit) {
+		return;
+	}
+	const auto minimal = std::min(kMinChunkSize, _settings.compactChunkSize);
+	const auto latency = crl::time() - _chunkStarted;
+	if (latency > limit) {
+		_chunkSize = std::max(_chunkSize / 2, minimal);
+	} else if (latency * 2 < limit) {
+		_chunkSize = std::min(_chunkSize * 2, _settings.compactChunkSize);
+	}
+}
+
+void CompactorObject::reportProgress() {
+	const auto read = _binlog.offset();
+	const auto written = _compact.offset();
+	_database.with([=](DatabaseObject &database) {
+		database.compactorProgress(read, written);
+	});
 }
 
 auto CompactorObject::fillList(RawSpan values) -> RawSpan {
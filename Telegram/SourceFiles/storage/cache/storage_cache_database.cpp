@@ -8,28 +8,52 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/cache/storage_cache_database.h"
 
 #include "storage/cache/storage_cache_database_object.h"
+#include "base/perf_counters.h"
 
 namespace Storage {
 namespace Cache {
+namespace {
+
+base::perf::Counter TasksQueued("cache.tasks");
+base::perf::Histogram TaskWaitTime("cache.task_wait_ms");
+base::perf::Histogram TaskRunTime("cache.task_run_ms");
+
+// All database calls go through its crl queue, so they are measured here:
+// the time a call waits behind the others and the time it takes to run.
+template <typename Wrapped, typename Method>
+void Enqueue(Wrapped &wrapped, Method &&method) {
+	TasksQueued.add();
+	wrapped.with([
+		method = std::forward<Method>(method),
+		queued = crl::time()
+	](auto &unwrapped) mutable {
+		const auto started = crl::time();
+		TaskWaitTime.add(started - queued);
+		method(unwrapped);
+		TaskRunTime.add(crl::time() - started);
+	});
+}
+
+} // namespace
 
 Database::Database(const QString &path, const Settings &settings)
 : _wrapped(path, settings) {
 }
 
 void Database::reconfigure(const Settings &settings) {
-	_wrapped.with([settings](Implementation &unwrapped) mutable {
+	Enqueue(_wrapped, [settings](Implementation &unwrapped) mutable {
 		unwrapped.reconfigure(settings);
 	});
 }
 
 void Database::updateSettings(const SettingsUpdate &update) {
-	_wrapped.with([update](Implementation &unwrapped) mutable {
+	Enqueue(_wrapped, [update](Implementation &unwrapped) mutable {
 		unwrapped.updateSettings(update);
 	});
 }
 
 void Database::open(EncryptionKey &&key, FnMut<void(Error)> &&done) {
-	_wrapped.with([
+	Enqueue(_wrapped, [
 		key = std::move(key),
 		done = std::move(done)
 	](Implementation &unwrapped) mutable {
@@ -38,7 +62,7 @@ void Database::open(EncryptionKey &&key, FnMut<void(Error)> &&done) {
 }
 
 void Database::close(FnMut<void()> &&done) {
-	_wrapped.with([
+	Enqueue(_wrapped, [
 		done = std::move(done)
 	](Implementation &unwrapped) mutable {
 		unwrapped.close(std::move(done));
@@ -46,7 +70,7 @@ void Database::close(FnMut<void()> &&done) {
 }
 
 void Database::waitForCleaner(FnMut<void()> &&done) {
-	_wrapped.with([
+	Enqueue(_wrapped, [
 		done = std::move(done)
 	](Implementation &unwrapped) mutable {
 		unwrapped.waitForCleaner(std::move(done));
@@ -72,7 +96,7 @@ void Database::get(const Key &key, FnMut<void(QByteArray&&)> &&done) {
 }
 
 void Database::remove(const Key &key, FnMut<void(Error)> &&done) {
-	_wrapped.with([
+	Enqueue(_wrapped, [
 		key,
 		done = std::move(done)
 	](Implementation &unwrapped) mutable {
@@ -94,7 +118,7 @@ void Database::copyIfEmpty(
 		const Key &from,
 		const Key &to,
 		FnMut<void(Error)> &&done) {
-	_wrapped.with([
+	Enqueue(_wrapped, [
 		from,
 		to,
 		done = std::move(done)
@@ -107,7 +131,7 @@ void Database::moveIfEmpty(
 		const Key &from,
 		const Key &to,
 		FnMut<void(Error)> &&done) {
-	_wrapped.with([
+	Enqueue(_wrapped, [
 		from,
 		to,
 		done = std::move(done)
@@ -120,7 +144,7 @@ void Database::put(
 		const Key &key,
 		TaggedValue &&value,
 		FnMut<void(Error)> &&done) {
-	_wrapped.with([
+	Enqueue(_wrapped, [
 		key,
 		value = std::move(value),
 		done = std::move(done)
@@ -133,7 +157,7 @@ void Database::putIfEmpty(
 		const Key &key,
 		TaggedValue &&value,
 		FnMut<void(Error)> &&done) {
-	_wrapped.with([
+	Enqueue(_wrapped, [
 		key,
 		value = std::move(value),
 		done = std::move(done)
@@ -145,7 +169,7 @@ void Database::putIfEmpty(
 void Database::getWithTag(
 		const Key &key,
 		FnMut<void(TaggedValue&&)> &&done) {
-	_wrapped.with([
+	Enqueue(_wrapped, [
 		key,
 		done = std::move(done)
 	](Implementation &unwrapped) mutable {
@@ -153,6 +177,17 @@ void Database::getWithTag(
 	});
 }
 
+void Database::getMany(
+		std::vector<Key> &&keys,
+		FnMut<void(std::vector<TaggedValue>&&)> &&done) {
+	Enqueue(_wrapped, [
+		keys = std::move(keys),
+		done = std::move(done)
+	](Implementation &unwrapped) mutable {
+		unwrapped.getMany(keys, std::move(done));
+	});
+}
+
 auto Database::statsOnMain() const -> rpl::producer<Stats> {
 	return _wrapped.producer_on_main([](const Implementation &unwrapped) {
 		return unwrapped.stats();
@@ -160,7 +195,7 @@ auto Database::statsOnMain() const -> rpl::producer<Stats> {
 }
 
 void Database::clear(FnMut<void(Error)> &&done) {
-	_wrapped.with([
+	Enqueue(_wrapped, [
 		done = std::move(done)
 	](Implementation &unwrapped) mutable {
 		unwrapped.clear(std::move(done));
@@ -168,7 +203,7 @@ void Database::clear(FnMut<void(Error)> &&done) {
 }
 
 void Database::clearByTag(uint8 tag, FnMut<void(Error)> &&done) {
-	_wrapped.with([
+	Enqueue(_wrapped, [
 		tag,
 		done = std::move(done)
 	](Implementation &unwrapped) mutable {
@@ -33,6 +33,8 @@ public:
 	void open(EncryptionKey &&key, FnMut<void(Error)> &&done = nullptr);
 	void close(FnMut<void()> &&done = nullptr);
 
+	// Values smaller than Settings::combineWritesBelow are buffered and
+	// written later together, done() is called once the value is buffered.
 	void put(
 		const Key &key,
 		QByteArray &&value,
@@ -64,6 +66,12 @@ public:
 		FnMut<void(Error)> &&done = nullptr);
 	void getWithTag(const Key &key, FnMut<void(TaggedValue&&)> &&done);
 
+	// Values are delivered in the order of the keys,
+	// empty TaggedValue for each key that was not found.
+	void getMany(
+		std::vector<Key> &&keys,
+		FnMut<void(std::vector<TaggedValue>&&)> &&done);
+
 	using Stats = details::Stats;
 	using TaggedSummary = details::TaggedSummary;
 	rpl::producer<Stats> statsOnMain() const;
@@ -0,0 +1,89 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "base/benchmark.h"
+
+#include "storage/cache/storage_cache_database.h"
+#include "storage/storage_encryption.h"
+#include "base/concurrent_timer.h"
+#include <crl/crl.h>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+
+using namespace Storage::Cache;
+
+namespace {
+
+constexpr auto kRecordsCount = 1024;
+constexpr int kValueSizes[] = { 64, 4 * 1024, 64 * 1024 };
+
+const auto name = QString("benchmark.db");
+
+const auto key = Storage::EncryptionKey(bytes::make_vector(
+	bytes::make_span("\
+abcdefgh01234567abcdefgh01234567abcdefgh01234567abcdefgh01234567\
+abcdefgh01234567abcdefgh01234567abcdefgh01234567abcdefgh01234567\
+abcdefgh01234567abcdefgh01234567abcdefgh01234567abcdefgh01234567\
+abcdefgh01234567abcdefgh01234567abcdefgh01234567abcdefgh01234567\
+").subspan(0, Storage::EncryptionKey::kSize)));
+
+crl::semaphore Semaphore;
+
+Key RecordKey(int index) {
+	return Key{ uint64(index) * 2, (uint64(index) << 32) + 3 };
+}
+
+void Wait(Database &db) {
+	// Requests are processed in order, so when the last one is done,
+	// all the previous ones are done as well.
+	db.get(RecordKey(-1), [](QByteArray) { Semaphore.release(); });
+	Semaphore.acquire();
+}
+
+} // namespace
+
+BENCHMARK_CASE("Storage::Cache::Database") {
+	static auto init = [] {
+		int argc = 0;
+		char **argv = nullptr;
+		static QCoreApplication application(argc, argv);
+		static base::ConcurrentTimerEnvironment environment;
+		return true;
+	}();
+
+	auto settings = Database::Settings();
+	settings.trackEstimatedTime = false;
+	settings.totalSizeLimit = 0;
+	settings.totalTimeLimit = 0;
+	Database db(name, settings);
+	db.clear([](Error) { Semaphore.release(); });
+	Semaphore.acquire();
+	db.open(base::duplicate(key), [](Error) { Semaphore.release(); });
+	Semaphore.acquire();
+
+	for (const auto size : kValueSizes) {
+		const auto count = std::to_string(size);
+		const auto value = QByteArray(size, 'a');
+
+		runner.measure("put " + count, kRecordsCount, [&] {
+			for (auto i = 0; i != kRecordsCount; ++i) {
+				db.put(RecordKey(i), QByteArray(value), nullptr);
+			}
+			Wait(db);
+		});
+		runner.measure("get " + count, kRecordsCount, [&] {
+			for (auto i = 0; i != kRecordsCount; ++i) {
+				db.get(RecordKey(i), nullptr);
+			}
+			Wait(db);
+		});
+	}
+
+	db.close([] { Semaphore.release(); });
+	Semaphore.acquire();
+	QDir(name).removeRecursively();
+}
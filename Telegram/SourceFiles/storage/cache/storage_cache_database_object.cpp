@@ -18,6 +18,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <xxhash.h>
 #include <QtCore/QDir>
 #include <unordered_map>
+#include <chrono>
 #include <set>
 
 namespace Storage {
@@ -27,6 +28,10 @@ namespace {
 
 constexpr auto kMaxDelayAfterFailure = 24 * 60 * 60 * crl::time_type(1000);
 
+// Packed place is { 0xFF, pack index (2 bytes), offset / 16 (4 bytes) }.
+constexpr auto kPackedPlaceMarker = uint8(0xFF);
+constexpr auto kPackedOffsetUnit = int64(16);
+
 uint32 CountChecksum(bytes::const_span data) {
 	const auto seed = uint32(0);
 	return XXH32(data.data(), data.size(), seed);
@@ -54,10 +59,49 @@ QString PlaceFromId(PlaceId place) {
 	return result;
 }
 
+uint16 PackFromPlace(PlaceId place) {
+	return uint16(place[1]) | (uint16(place[2]) << 8);
+}
+
+int64 OffsetFromPlace(PlaceId place) {
+	auto blocks = uint32();
+	for (auto i = 0; i != 4; ++i) {
+		blocks |= uint32(place[3 + i]) << (i * 8);
+	}
+	return int64(blocks) * kPackedOffsetUnit;
+}
+
+PlaceId PackedPlace(uint16 pack, int64 offset) {
+	Expects(offset >= 0 && !(offset % kPackedOffsetUnit));
+	Expects(offset / kPackedOffsetUnit <= std::numeric_limits<uint32>::max());
+
+	const auto blocks = uint32(offset / kPackedOffsetUnit);
+	auto result = PlaceId();
+	result[0] = kPackedPlaceMarker;
+	result[1] = uint8(pack & 0xFF);
+	result[2] = uint8(pack >> 8);
+	for (auto i = 0; i != 4; ++i) {
+		result[3 + i] = uint8((blocks >> (i * 8)) & 0xFF);
+	}
+	return result;
+}
+
+int64 PaddedSize(size_type size) {
+	return (int64(size) + kPackedOffsetUnit - 1)
+		/ kPackedOffsetUnit
+		* kPackedOffsetUnit;
+}
+
 int32 GetUnixtime() {
 	return std::max(int32(time(nullptr)), 1);
 }
 
+int64 GetMicroseconds() {
+	using namespace std::chrono;
+	const auto now = steady_clock::now().time_since_epoch();
+	return duration_cast<microseconds>(now).count();
+}
+
 } // namespace
 
 DatabaseObject::Entry::Entry(
@@ -81,7 +125,8 @@ DatabaseObject::DatabaseObject(
 , _base(ComputeBasePath(path))
 , _settings(settings)
 , _writeBundlesTimer(_weak, [=] { writeBundles(); checkCompactor(); })
-, _pruneTimer(_weak, [=] { prune(); }) {
+, _pruneTimer(_weak, [=] { prune(); })
+, _writeCombinedTimer(_weak, [=] { writeCombined(); }) {
 	checkSettings();
 }
 
@@ -102,6 +147,14 @@ void DatabaseObject::updateSettings(const SettingsUpdate &update) {
 
 void DatabaseObject::checkSettings() {
 	Expects(_settings.staleRemoveChunk > 0);
+	Expects(_settings.combineWritesBelow >= 0
+		&& _settings.combineWritesBelow <= _settings.maxDataSize);
+	Expects(_settings.packValuesBelow >= 0
+		&& _settings.packValuesBelow <= _settings.maxDataSize);
+	Expects(!_settings.packValuesBelow
+		|| (_settings.packSegmentSize > _settings.packValuesBelow
+			&& (_settings.packSegmentSize / kPackedOffsetUnit
+				<= std::numeric_limits<uint32>::max())));
 	Expects(_settings.maxDataSize > 0
 		&& _settings.maxDataSize < kDataSizeLimit);
 	Expects(_settings.maxBundledRecords > 0
@@ -110,6 +163,9 @@ void DatabaseObject::checkSettings() {
 		|| _settings.totalTimeLimit > 0);
 	Expects(!_settings.totalSizeLimit
 		|| _settings.totalSizeLimit > _settings.maxDataSize);
+	for (const auto &pair : _settings.taggedSizeLimits) {
+		Expects(!pair.second || pair.second > _settings.maxDataSize);
+	}
 }
 
 template <typename Callback, typename ...Args>
@@ -126,6 +182,11 @@ Error DatabaseObject::ioError(const QString &path) const {
 }
 
 void DatabaseObject::open(EncryptionKey &&key, FnMut<void(Error)> &&done) {
+	if (_binlog.isOpen() && _key.data() == key.data()) {
+		// Kept open by Storage::Databases, no need to read it again.
+		invokeCallback(done, Error::NoError());
+		return;
+	}
 	close(nullptr);
 
 	const auto error = openSomeBinlog(std::move(key));
@@ -220,6 +281,10 @@ File::Result DatabaseObject::openBinlog(
 bool DatabaseObject::readHeader() {
 	if (const auto header = BinlogWrapper::ReadHeader(_binlog, _settings)) {
 		_time.setRelative((_time.system = header->systemTime));
+
+		// Avoid rehashing the whole index many times during the replay.
+		_map.reserve(header->keysCount);
+		_packedPlaces = (header->flags & header->kPackedPlaces) != 0;
 		return true;
 	}
 	return false;
@@ -232,6 +297,11 @@ bool DatabaseObject::writeHeader() {
 	if (_settings.trackEstimatedTime) {
 		header.flags |= header.kTrackEstimatedTime;
 	}
+
+	// Only binlogs started with this flag can't have random places
+	// that look like packed ones, so packing is enabled just for them.
+	header.flags |= header.kPackedPlaces;
+	_packedPlaces = true;
 	return _binlog.write(bytes::object_as_span(&header));
 }
 
@@ -281,6 +351,7 @@ void DatabaseObject::readBinlog() {
 		});
 	}
 	adjustRelativeTime();
+	removeEmptyPacks();
 	optimize();
 }
 
@@ -312,6 +383,8 @@ bool DatabaseObject::startDelayedPruning() {
 		if (_settings.totalSizeLimit > 0
 			&& _totalSize > _settings.totalSizeLimit) {
 			return true;
+		} else if (taggedSizeLimitExceeded()) {
+			return true;
 		} else if ((!_minimalEntryTime && !_map.empty())
 			|| _minimalEntryTime <= before) {
 			return true;
@@ -343,6 +416,7 @@ void DatabaseObject::prune() {
 	auto stale = base::flat_set<Key>();
 	auto staleTotalSize = int64();
 	collectTimeStale(stale, staleTotalSize);
+	collectTaggedSizeStale(stale, staleTotalSize);
 	collectSizeStale(stale, staleTotalSize);
 	if (stale.size() <= _settings.staleRemoveChunk) {
 		clearStaleNow(stale);
@@ -433,6 +507,61 @@ void DatabaseObject::collectTimeStale(
 	}
 }
 
+bool DatabaseObject::taggedSizeLimitExceeded() const {
+	for (const auto &[tag, limit] : _settings.taggedSizeLimits) {
+		if (limit <= 0) {
+			continue;
+		} else if (const auto i = _taggedStats.find(tag)
+			; i != end(_taggedStats) && i->second.totalSize > limit) {
+			return true;
+		}
+	}
+	return false;
+}
+
+int64 DatabaseObject::evictionScore(const Entry &entry, uint64 now) const {
+	switch (_settings.evictionPolicy) {
+	case EvictionPolicy::LeastRecentlyUsed:
+		return int64(entry.useTime);
+	case EvictionPolicy::SizeAndRecency: {
+		const auto age = (now > entry.useTime) ? (now - entry.useTime) : 0;
+		return -int64((age + 1) * uint64(entry.size));
+	} break;
+	}
+	Unexpected("Policy in DatabaseObject::evictionScore.");
+}
+
+void DatabaseObject::collectTaggedSizeStale(
+		base::flat_set<Key> &stale,
+		int64 &staleTotalSize) {
+	for (const auto &[tag, limit] : _settings.taggedSizeLimits) {
+		if (limit <= 0) {
+			continue;
+		}
+		const auto i = _taggedStats.find(tag);
+		if (i == end(_taggedStats) || i->second.totalSize <= limit) {
+			continue;
+		}
+		auto staleTaggedSize = int64();
+		for (const auto &key : stale) {
+			const auto j = _map.find(key);
+			if (j != end(_map) && j->second.tag == tag) {
+				staleTaggedSize += j->second.size;
+			}
+		}
+		const auto removeSize = i->second.totalSize
+			- staleTaggedSize
+			- limit;
+		if (removeSize <= 0) {
+			continue;
+		}
+		const auto filter = [tag = tag](const Entry &entry) {
+			return (entry.tag == tag);
+		};
+		collectSizeStaleFiltered(stale, staleTotalSize, removeSize, filter);
+	}
+}
+
 void DatabaseObject::collectSizeStale(
 		base::flat_set<Key> &stale,
 		int64 &staleTotalSize) {
@@ -442,6 +571,17 @@ void DatabaseObject::collectSizeStale(
 	if (removeSize <= 0) {
 		return;
 	}
+	const auto all = [](const Entry &entry) { return true; };
+	collectSizeStaleFiltered(stale, staleTotalSize, removeSize, all);
+}
+
+template <typename Filter>
+void DatabaseObject::collectSizeStaleFiltered(
+		base::flat_set<Key> &stale,
+		int64 &staleTotalSize,
+		int64 removeSize,
+		Filter &&filter) {
+	Expects(removeSize > 0);
 
 	using Bucket = std::pair<const Key, Entry>;
 	auto oldest = base::flat_multi_map<
@@ -450,30 +590,32 @@ void DatabaseObject::collectSizeStale(
 		std::greater<>>();
 	auto oldestTotalSize = int64();
 
-	const auto canRemoveFirst = [&](const Entry &adding) {
+	const auto now = countRelativeTime();
+	const auto canRemoveFirst = [&](const Entry &adding, int64 score) {
 		const auto totalSizeAfterAdd = oldestTotalSize + adding.size;
 		const auto &first = oldest.begin()->second->second;
-		return (adding.useTime <= first.useTime
+		return (score <= oldest.begin()->first
 			&& (totalSizeAfterAdd - removeSize >= first.size));
 	};
 
 	for (const auto &bucket : _map) {
 		const auto &entry = bucket.second;
-		if (stale.contains(bucket.first)) {
+		if (!filter(entry) || stale.contains(bucket.first)) {
 			continue;
 		}
+		const auto score = evictionScore(entry, now);
 		const auto add = (oldestTotalSize < removeSize)
 			? true
-			: (entry.useTime < oldest.begin()->second->second.useTime);
+			: (score < oldest.begin()->first);
 		if (!add) {
 			continue;
 		}
-		while (!oldest.empty() && canRemoveFirst(entry)) {
+		while (!oldest.empty() && canRemoveFirst(entry, score)) {
 			oldestTotalSize -= oldest.begin()->second->second.size;
 			oldest.erase(oldest.begin());
 		}
 		oldestTotalSize += entry.size;
-		oldest.emplace(entry.useTime, &bucket);
+		oldest.emplace(score, &bucket);
 	}
 
 	for (const auto &pair : oldest) {
@@ -626,6 +768,43 @@ void DatabaseObject::updateStats(const Entry &was, const Entry &now) {
 			summary.totalSize -= was.size;
 		}
 	}
+	updatePackStats(was, now);
+	pushStatsDelayed();
+}
+
+void DatabaseObject::updatePackStats(const Entry &was, const Entry &now) {
+	if (was.size && isPackedPlace(was.place)) {
+		_packsLiveSize[PackFromPlace(was.place)] -= PaddedSize(was.size);
+	}
+	if (now.size && isPackedPlace(now.place)) {
+		_packsLiveSize[PackFromPlace(now.place)] += PaddedSize(now.size);
+	}
+}
+
+void DatabaseObject::countHit(uint8 tag, int64 bytesRead) {
+	++_accessStats.hits;
+	_accessStats.bytesRead += bytesRead;
+	if (tag) {
+		auto &summary = _taggedAccessStats[tag];
+		++summary.hits;
+		summary.bytesRead += bytesRead;
+	}
+	pushStatsDelayed();
+}
+
+void DatabaseObject::countMiss(std::optional<uint8> tag) {
+	++_accessStats.misses;
+	if (tag && *tag) {
+		++_taggedAccessStats[*tag].misses;
+	}
+	pushStatsDelayed();
+}
+
+void DatabaseObject::countWritten(uint8 tag, int64 bytesWritten) {
+	_accessStats.bytesWritten += bytesWritten;
+	if (tag) {
+		_taggedAccessStats[tag].bytesWritten += bytesWritten;
+	}
 	pushStatsDelayed();
 }
 
@@ -678,6 +857,15 @@ void DatabaseObject::applyTimePoint(EstimatedTimePoint time) {
 	}
 }
 
+void DatabaseObject::compactorProgress(int64 read, int64 written) {
+	if (!_compactor.object) {
+		return;
+	}
+	_compactor.read = read;
+	_compactor.written = written;
+	pushStatsDelayed();
+}
+
 void DatabaseObject::compactorDone(
 		const QString &path,
 		int64 originalReadTill) {
@@ -719,23 +907,34 @@ void DatabaseObject::compactorDone(
 	}
 	_binlogExcessLength -= _compactor.excessLength;
 	Assert(_binlogExcessLength >= 0);
+
+	++_compactionStats.finished;
+	_compactionStats.totalRead += _compactor.till;
+	_compactionStats.totalWritten += _compactor.written;
+	pushStatsDelayed();
+
+	reclaimPacks();
 }
 
 void DatabaseObject::compactorFail() {
 	const auto delay = _compactor.delayAfterFailure;
+	++_compactionStats.failed;
 	_compactor = CompactorWrap();
 	_compactor.nextAttempt = crl::time() + delay;
 	_compactor.delayAfterFailure = std::min(
 		delay * 2,
 		kMaxDelayAfterFailure);
 	QFile(compactReadyPath()).remove();
+	pushStatsDelayed();
 }
 
 void DatabaseObject::close(FnMut<void()> &&done) {
 	if (_binlog.isOpen()) {
+		writeCombined();
 		writeBundles();
 		_binlog.close();
 	}
+	_pack.close();
 	invokeCallback(done);
 	clearState();
 }
@@ -747,15 +946,27 @@ void DatabaseObject::clearState() {
 	_removing = {};
 	_accessed = {};
 	_stale = {};
+	_combined = {};
+	_combinedSize = 0;
+	_binlogFlushDelayed = false;
+	_packedPlaces = false;
+	_packIndex = 0;
+	_packsLiveSize = {};
 	_time = {};
 	_binlogExcessLength = 0;
 	_totalSize = 0;
 	_minimalEntryTime = 0;
 	_entriesWithMinimalTimeCount = 0;
 	_taggedStats = {};
+	_accessStats = {};
+	_taggedAccessStats = {};
+	_getLatency = {};
+	_putLatency = {};
+	_compactionStats = {};
 	_pushingStats = false;
 	_writeBundlesTimer.cancel();
 	_pruneTimer.cancel();
+	_writeCombinedTimer.cancel();
 	_compactor = CompactorWrap();
 }
 
@@ -767,9 +978,29 @@ void DatabaseObject::put(
 		remove(key, std::move(done));
 		return;
 	}
+	const auto guard = gsl::finally([&, started = GetMicroseconds()] {
+		_putLatency.add(GetMicroseconds() - started);
+	});
 	_removing.erase(key);
 	_stale.erase(ranges::remove(_stale, key), end(_stale));
 
+	if (value.bytes.size() < _settings.combineWritesBelow) {
+		putCombined(key, std::move(value));
+		invokeCallback(done, Error::NoError());
+		return;
+	}
+	eraseCombined(key);
+	putNow(key, std::move(value), std::move(done));
+}
+
+void DatabaseObject::putNow(
+		const Key &key,
+		TaggedValue &&value,
+		FnMut<void(Error)> &&done) {
+	if (_packedPlaces && value.bytes.size() < _settings.packValuesBelow) {
+		putPacked(key, std::move(value), std::move(done));
+		return;
+	}
 	const auto checksum = CountChecksum(bytes::make_span(value.bytes));
 	const auto maybepath = writeKeyPlace(key, value, checksum);
 	if (!maybepath) {
@@ -782,6 +1013,8 @@ void DatabaseObject::put(
 		return;
 	}
 	const auto path = *maybepath;
+	const auto tag = value.tag;
+	const auto size = value.bytes.size();
 	File data;
 	const auto result = data.open(path, File::Mode::Write, _key);
 	switch (result) {
@@ -804,6 +1037,7 @@ void DatabaseObject::put(
 			invokeCallback(done, ioError(path));
 		} else {
 			data.flush();
+			countWritten(tag, size);
 			invokeCallback(done, Error::NoError());
 			optimize();
 		}
@@ -813,6 +1047,92 @@ void DatabaseObject::put(
 	}
 }
 
+void DatabaseObject::putPacked(
+		const Key &key,
+		TaggedValue &&value,
+		FnMut<void(Error)> &&done) {
+	const auto size = size_type(value.bytes.size());
+	const auto checksum = CountChecksum(bytes::make_span(value.bytes));
+	auto removePath = QString();
+	if (const auto i = _map.find(key); i != end(_map)) {
+		const auto &already = i->second;
+		if (already.tag == value.tag
+			&& already.size == size
+			&& already.checksum == checksum
+			&& readValueData(already.place, size) == value.bytes) {
+			// Nothing changed.
+			invokeCallback(done, Error::NoError());
+			recordEntryAccess(key);
+			return;
+		} else if (!isPackedPlace(already.place)) {
+			removePath = placePath(already.place);
+		}
+	}
+	const auto tag = value.tag;
+	const auto place = appendToPack(bytes::make_detached_span(value.bytes));
+	if (!place) {
+		invokeCallback(done, ioError(packPath(_packIndex)));
+		return;
+	}
+	const auto entry = Entry(*place, tag, checksum, size, 0);
+	const auto result = writeExistingPlace(key, entry);
+	if (result.type == Error::Type::None) {
+		countWritten(tag, size);
+		if (!removePath.isEmpty()) {
+			QFile(removePath).remove();
+		}
+	}
+	invokeCallback(done, result);
+	optimize();
+}
+
+void DatabaseObject::putCombined(const Key &key, TaggedValue &&value) {
+	eraseCombined(key);
+	_combinedSize += value.bytes.size();
+	_combined.emplace(key, std::move(value));
+	writeCombinedLazy();
+}
+
+bool DatabaseObject::eraseCombined(const Key &key) {
+	const auto i = _combined.find(key);
+	if (i == end(_combined)) {
+		return false;
+	}
+	_combinedSize -= i->second.bytes.size();
+	_combined.erase(i);
+	return true;
+}
+
+void DatabaseObject::writeCombinedLazy() {
+	if (_combinedSize >= _settings.combinedWritesLimit
+		|| _combined.size() >= _settings.maxBundledRecords) {
+		writeCombined();
+	} else if (!_writeCombinedTimer.isActive()) {
+		_writeCombinedTimer.callOnce(_settings.combinedWritesDelay);
+	}
+}
+
+void DatabaseObject::writeCombined() {
+	_writeCombinedTimer.cancel();
+	if (_combined.empty()) {
+		return;
+	}
+	_combinedSize = 0;
+
+	// Flush the binlog once for all the written records.
+	_binlogFlushDelayed = true;
+	for (auto &[key, value] : base::take(_combined)) {
+		putNow(key, std::move(value), nullptr);
+	}
+	_binlogFlushDelayed = false;
+	if (_binlog.isOpen()) {
+		_binlog.flush();
+	}
+	if (_pack.isOpen()) {
+		_pack.flush();
+	}
+}
+
 template <typename StoreRecord>
 std::optional<QString> DatabaseObject::writeKeyPlaceGeneric(
 		StoreRecord &&record,
@@ -834,11 +1154,11 @@ std::optional<QString> DatabaseObject::writeKeyPlaceGeneric(
 			&& readValueData(already.place, size) == value.bytes) {
 			return QString();
 		}
-		record.place = already.place;
+		record.place = isPackedPlace(already.place)
+			? chooseFreePlace()
+			: already.place;
 	} else {
-		do {
-			bytes::set_random(bytes::object_as_span(&record.place));
-		} while (!isFreePlace(record.place));
+		record.place = chooseFreePlace();
 	}
 	const auto result = placePath(record.place);
 	auto writeable = record;
@@ -847,7 +1167,9 @@ std::optional<QString> DatabaseObject::writeKeyPlaceGeneric(
 		_binlog.close();
 		return QString();
 	}
-	_binlog.flush();
+	if (!_binlogFlushDelayed) {
+		_binlog.flush();
+	}
 
 	const auto applied = processRecordStore(
 		&record,
@@ -903,7 +1225,9 @@ Error DatabaseObject::writeExistingPlaceGeneric(
 		_binlog.close();
 		return ioError(binlogPath());
 	}
-	_binlog.flush();
+	if (!_binlogFlushDelayed) {
+		_binlog.flush();
+	}
 
 	const auto applied = processRecordStore(
 		&record,
@@ -935,34 +1259,93 @@ Error DatabaseObject::writeExistingPlace(
 void DatabaseObject::get(
 		const Key &key,
 		FnMut<void(TaggedValue&&)> &&done) {
+	const auto guard = gsl::finally([&, started = GetMicroseconds()] {
+		_getLatency.add(GetMicroseconds() - started);
+	});
+	if (const auto i = _combined.find(key); i != end(_combined)) {
+		countHit(i->second.tag, 0);
+		invokeCallback(done, TaggedValue(i->second));
+		return;
+	}
 	const auto i = _map.find(key);
 	if (i == _map.end()) {
+		countMiss(std::nullopt);
 		invokeCallback(done, TaggedValue());
 		return;
 	}
-	const auto &entry = i->second;
+	invokeCallback(done, readEntry(key, i->second));
+}
+
+void DatabaseObject::getMany(
+		const std::vector<Key> &keys,
+		FnMut<void(std::vector<TaggedValue>&&)> &&done) {
+	struct Found {
+		Key key;
+		Entry entry;
+		size_type index = 0;
+	};
+	const auto guard = gsl::finally([&, started = GetMicroseconds()] {
+		_getLatency.add(GetMicroseconds() - started);
+	});
+	auto result = std::vector<TaggedValue>(keys.size());
+	auto found = std::vector<Found>();
+	found.reserve(keys.size());
+	for (auto index = size_type(), count = size_type(keys.size())
+		; index != count
+		; ++index) {
+		const auto &key = keys[index];
+		if (const auto i = _combined.find(key); i != end(_combined)) {
+			countHit(i->second.tag, 0);
+			result[index] = i->second;
+		} else if (const auto j = _map.find(key); j != end(_map)) {
+			found.push_back({ key, j->second, index });
+		} else {
+			countMiss(std::nullopt);
+		}
+	}
+
+	// Read the value files in the order of their places on disk.
+	ranges::sort(found, std::less<>(), [](const Found &value) {
+		return value.entry.place;
+	});
 
+	for (const auto &[key, entry, index] : found) {
+		result[index] = readEntry(key, entry);
+	}
+	invokeCallback(done, std::move(result));
+}
+
+TaggedValue DatabaseObject::readEntry(const Key &key, const Entry &entry) {
 	auto bytes = readValueData(entry.place, entry.size);
-	if (bytes.isEmpty()) {
-		remove(key, nullptr);
-		invokeCallback(done, TaggedValue());
-	} else if (CountChecksum(bytes::make_span(bytes)) != entry.checksum) {
+	if (bytes.isEmpty()
+		|| CountChecksum(bytes::make_span(bytes)) != entry.checksum) {
+		countMiss(entry.tag);
 		remove(key, nullptr);
-		invokeCallback(done, TaggedValue());
-	} else {
-		invokeCallback(done, TaggedValue(std::move(bytes), entry.tag));
-		recordEntryAccess(key);
+		return TaggedValue();
 	}
+	countHit(entry.tag, bytes.size());
+	auto result = TaggedValue(std::move(bytes), entry.tag);
+	recordEntryAccess(key);
+	return result;
 }
 
 QByteArray DatabaseObject::readValueData(PlaceId place, size_type size) const {
-	const auto path = placePath(place);
+	const auto packed = isPackedPlace(place);
+	const auto path = packed
+		? packPath(PackFromPlace(place))
+		: placePath(place);
+	const auto mode = _settings.mapValuesOnRead
+		? File::Mode::ReadMapped
+		: File::Mode::Read;
 	File data;
-	const auto result = data.open(path, File::Mode::Read, _key);
+	const auto result = data.open(path, mode, _key);
 	switch (result) {
 	case File::Result::Failed:
 	case File::Result::WrongKey: return QByteArray();
 	case File::Result::Success: {
+		if (packed && !data.seek(OffsetFromPlace(place))) {
+			return QByteArray();
+		}
 		auto result = QByteArray(size, Qt::Uninitialized);
 		const auto bytes = bytes::make_detached_span(result);
 		const auto read = data.readWithPadding(bytes);
@@ -985,14 +1368,20 @@ void DatabaseObject::recordEntryAccess(const Key &key) {
 }
 
 void DatabaseObject::remove(const Key &key, FnMut<void(Error)> &&done) {
+	eraseCombined(key);
+
 	const auto i = _map.find(key);
 	if (i != _map.end()) {
 		_removing.emplace(key);
 		writeMultiRemoveLazy();
 
+		const auto packed = isPackedPlace(i->second.place);
 		const auto path = placePath(i->second.place);
 		eraseMapEntry(i);
-		if (QFile(path).remove() || !QFile(path).exists()) {
+		if (packed) {
+			// Pack segments are removed when they hold no values.
+			invokeCallback(done, Error::NoError());
+		} else if (QFile(path).remove() || !QFile(path).exists()) {
 			invokeCallback(done, Error::NoError());
 		} else {
 			invokeCallback(done, ioError(path));
@@ -1006,7 +1395,7 @@ void DatabaseObject::putIfEmpty(
 		const Key &key,
 		TaggedValue &&value,
 		FnMut<void(Error)> &&done) {
-	if (_map.find(key) != end(_map)) {
+	if (_combined.contains(key) || _map.find(key) != end(_map)) {
 		invokeCallback(done, Error::NoError());
 		return;
 	}
@@ -1017,7 +1406,7 @@ void DatabaseObject::copyIfEmpty(
 		const Key &from,
 		const Key &to,
 		FnMut<void(Error)> &&done) {
-	if (_map.find(to) != end(_map)) {
+	if (_combined.contains(to) || _map.find(to) != end(_map)) {
 		invokeCallback(done, Error::NoError());
 		return;
 	}
@@ -1030,6 +1419,7 @@ void DatabaseObject::moveIfEmpty(
 		const Key &from,
 		const Key &to,
 		FnMut<void(Error)> &&done) {
+	writeCombined();
 	if (_map.find(to) != end(_map)) {
 		invokeCallback(done, Error::NoError());
 		return;
@@ -1063,6 +1453,16 @@ Stats DatabaseObject::collectStats() const {
 	result.tagged = _taggedStats;
 	result.full.count = _map.size();
 	result.full.totalSize = _totalSize;
+	result.access = _accessStats;
+	result.taggedAccess = _taggedAccessStats;
+	result.getLatency = _getLatency;
+	result.putLatency = _putLatency;
+	result.compaction = _compactionStats;
+	if (_compactor.object) {
+		result.compaction.till = _compactor.till;
+		result.compaction.read = _compactor.read;
+		result.compaction.written = _compactor.written;
+	}
 	result.clearing = (_cleaner.object != nullptr) || !_stale.empty();
 	return result;
 }
@@ -1157,6 +1557,7 @@ void DatabaseObject::writeBundles() {
 	if (_settings.trackEstimatedTime) {
 		writeMultiAccess();
 	}
+	removeEmptyPacks();
 }
 
 void DatabaseObject::createCleaner() {
@@ -1206,6 +1607,8 @@ void DatabaseObject::checkCompactor() {
 		base::duplicate(_key),
 		info);
 	_compactor.excessLength = _binlogExcessLength;
+	_compactor.till = info.till;
+	pushStatsDelayed();
 }
 
 void DatabaseObject::clear(FnMut<void(Error)> &&done) {
@@ -1227,6 +1630,8 @@ void DatabaseObject::clear(FnMut<void(Error)> &&done) {
 }
 
 void DatabaseObject::clearByTag(uint8 tag, FnMut<void(Error)> &&done) {
+	writeCombined();
+
 	const auto hadStale = !_stale.empty();
 	for (const auto &[key, entry] : _map) {
 		if (entry.tag == tag) {
@@ -1303,7 +1708,155 @@ QString DatabaseObject::placePath(PlaceId place) const {
 }
 
 bool DatabaseObject::isFreePlace(PlaceId place) const {
-	return !QFile(placePath(place)).exists();
+	return !isPackedPlace(place) && !QFile(placePath(place)).exists();
+}
+
+PlaceId DatabaseObject::chooseFreePlace() const {
+	auto result = PlaceId();
+	do {
+		bytes::set_random(bytes::object_as_span(&result));
+	} while (!isFreePlace(result));
+	return result;
+}
+
+QString DatabaseObject::PacksFolder() {
+	return QStringLiteral("packs");
+}
+
+QString DatabaseObject::packPath(uint16 pack) const {
+	return _path + PacksFolder() + '/' + QString::number(pack);
+}
+
+bool DatabaseObject::isPackedPlace(PlaceId place) const {
+	return _packedPlaces && (place[0] == kPackedPlaceMarker);
+}
+
+std::optional<PlaceId> DatabaseObject::appendToPack(bytes::span bytes) {
+	Expects(_packedPlaces);
+
+	const auto padded = PaddedSize(bytes.size());
+	if ((!_pack.isOpen()
+		|| _pack.offset() + padded > _settings.packSegmentSize)
+		&& !openNextPack()) {
+		return std::nullopt;
+	}
+	const auto offset = _pack.offset();
+	if (!_pack.writeWithPadding(bytes)) {
+		_pack.close();
+		return std::nullopt;
+	}
+	if (!_binlogFlushDelayed) {
+		_pack.flush();
+	}
+	return PackedPlace(_packIndex, offset);
+}
+
+bool DatabaseObject::openNextPack() {
+	_pack.close();
+
+	// Each session starts a new segment, so a segment tail left
+	// unfinished after a crash is never appended to.
+	auto index = _packIndex;
+	do {
+		++index;
+	} while (!index
+		|| _packsLiveSize.contains(index)
+		|| QFile(packPath(index)).exists());
+	const auto result = _pack.open(packPath(index), File::Mode::Write, _key);
+	if (result != File::Result::Success) {
+		return false;
+	}
+	_packIndex = index;
+	return true;
+}
+
+void DatabaseObject::removeEmptyPacks() {
+	if (!_packedPlaces) {
+		return;
+	}
+	const auto entries = QDir(_path + PacksFolder()).entryList(QDir::Files);
+	for (const auto &entry : entries) {
+		auto ok = false;
+		const auto pack = entry.toUShort(&ok);
+		if (!ok || (_pack.isOpen() && pack == _packIndex)) {
+			continue;
+		} else if (const auto i = _packsLiveSize.find(pack)
+			; i == end(_packsLiveSize) || i->second <= 0) {
+			QFile(packPath(pack)).remove();
+		}
+	}
+	for (auto i = begin(_packsLiveSize); i != end(_packsLiveSize);) {
+		if (i->second <= 0 && i->first != _packIndex) {
+			i = _packsLiveSize.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+void DatabaseObject::reclaimPacks() {
+	if (!_packedPlaces) {
+		return;
+	}
+	auto sparsest = std::optional<uint16>();
+	auto sparsestRatio = 0.5;
+	for (const auto &[pack, liveSize] : _packsLiveSize) {
+		if (liveSize <= 0 || (_pack.isOpen() && pack == _packIndex)) {
+			continue;
+		}
+		const auto fullSize = QFileInfo(packPath(pack)).size();
+		if (fullSize <= 0) {
+			continue;
+		}
+		const auto ratio = liveSize / double(fullSize);
+		if (ratio < sparsestRatio) {
+			sparsest = pack;
+			sparsestRatio = ratio;
+		}
+	}
+	if (sparsest) {
+		repackValues(*sparsest);
+		removeEmptyPacks();
+	}
+}
+
+void DatabaseObject::repackValues(uint16 pack) {
+	auto moving = std::vector<Raw>();
+	for (const auto &[key, entry] : _map) {
+		if (isPackedPlace(entry.place) && PackFromPlace(entry.place) == pack) {
+			moving.emplace_back(key, entry);
+		}
+	}
+
+	// Read the values in the order of their offsets in the segment.
+	ranges::sort(moving, std::less<>(), [](const Raw &value) {
+		return value.second.place;
+	});
+
+	_binlogFlushDelayed = true;
+	for (const auto &[key, entry] : moving) {
+		auto bytes = readValueData(entry.place, entry.size);
+		if (bytes.isEmpty()) {
+			remove(key, nullptr);
+			continue;
+		}
+		const auto place = appendToPack(bytes::make_detached_span(bytes));
+		if (!place) {
+			break;
+		}
+		auto moved = entry;
+		moved.place = *place;
+		if (writeExistingPlace(key, moved).type != Error::Type::None) {
+			break;
+		}
+	}
+	_binlogFlushDelayed = false;
+	if (_binlog.isOpen()) {
+		_binlog.flush();
+	}
+	if (_pack.isOpen()) {
+		_pack.flush();
+	}
 }
 
 } // namespace details
@@ -41,6 +41,9 @@ public:
 		TaggedValue &&value,
 		FnMut<void(Error)> &&done);
 	void get(const Key &key, FnMut<void(TaggedValue&&)> &&done);
+	void getMany(
+		const std::vector<Key> &keys,
+		FnMut<void(std::vector<TaggedValue>&&)> &&done);
 	void remove(const Key &key, FnMut<void(Error)> &&done);
 
 	void putIfEmpty(
@@ -65,6 +68,7 @@ public:
 	static QString BinlogFilename();
 	static QString CompactReadyFilename();
 
+	void compactorProgress(int64 read, int64 written);
 	void compactorDone(const QString &path, int64 originalReadTill);
 	void compactorFail();
 
@@ -97,6 +101,9 @@ private:
 	struct CompactorWrap {
 		std::unique_ptr<Compactor> object;
 		int64 excessLength = 0;
+		int64 till = 0;
+		int64 read = 0;
+		int64 written = 0;
 		crl::time_type nextAttempt = 0;
 		crl::time_type delayAfterFailure = 10 * crl::time_type(1000);
 		base::binary_guard guard;
@@ -160,22 +167,50 @@ private:
 	void collectTimeStale(
 		base::flat_set<Key> &stale,
 		int64 &staleTotalSize);
+	void collectTaggedSizeStale(
+		base::flat_set<Key> &stale,
+		int64 &staleTotalSize);
 	void collectSizeStale(
 		base::flat_set<Key> &stale,
 		int64 &staleTotalSize);
+	template <typename Filter>
+	void collectSizeStaleFiltered(
+		base::flat_set<Key> &stale,
+		int64 &staleTotalSize,
+		int64 removeSize,
+		Filter &&filter);
+	bool taggedSizeLimitExceeded() const;
+	int64 evictionScore(const Entry &entry, uint64 now) const;
 	void startStaleClear();
 	void clearStaleNow(const base::flat_set<Key> &stale);
 	void clearStaleChunkDelayed();
 	void clearStaleChunk();
 
 	void updateStats(const Entry &was, const Entry &now);
+	void countHit(uint8 tag, int64 bytesRead);
+	void countMiss(std::optional<uint8> tag);
+	void countWritten(uint8 tag, int64 bytesWritten);
 	Stats collectStats() const;
 	void pushStatsDelayed();
 	void pushStats();
 
+	void putNow(
+		const Key &key,
+		TaggedValue &&value,
+		FnMut<void(Error)> &&done);
+	void putPacked(
+		const Key &key,
+		TaggedValue &&value,
+		FnMut<void(Error)> &&done);
+	void putCombined(const Key &key, TaggedValue &&value);
+	bool eraseCombined(const Key &key);
+	void writeCombinedLazy();
+	void writeCombined();
+
 	void setMapEntry(const Key &key, Entry &&entry);
 	void eraseMapEntry(const Map::const_iterator &i);
 	void recordEntryAccess(const Key &key);
+	TaggedValue readEntry(const Key &key, const Entry &entry);
 	QByteArray readValueData(PlaceId place, size_type size) const;
 
 	Version findAvailableVersion() const;
@@ -185,6 +220,17 @@ private:
 
 	QString placePath(PlaceId place) const;
 	bool isFreePlace(PlaceId place) const;
+	PlaceId chooseFreePlace() const;
+
+	static QString PacksFolder();
+	QString packPath(uint16 pack) const;
+	bool isPackedPlace(PlaceId place) const;
+	std::optional<PlaceId> appendToPack(bytes::span bytes);
+	bool openNextPack();
+	void updatePackStats(const Entry &was, const Entry &now);
+	void removeEmptyPacks();
+	void reclaimPacks();
+	void repackValues(uint16 pack);
 
 	template <typename StoreRecord>
 	std::optional<QString> writeKeyPlaceGeneric(
@@ -225,6 +271,14 @@ private:
 	std::set<Key> _removing;
 	std::set<Key> _accessed;
 	std::vector<Key> _stale;
+	base::flat_map<Key, TaggedValue> _combined;
+	int64 _combinedSize = 0;
+	bool _binlogFlushDelayed = false;
+
+	bool _packedPlaces = false;
+	File _pack;
+	uint16 _packIndex = 0;
+	base::flat_map<uint16, int64> _packsLiveSize;
 
 	EstimatedTimePoint _time;
 
@@ -234,12 +288,18 @@ private:
 	size_type _entriesWithMinimalTimeCount = 0;
 
 	base::flat_map<uint8, TaggedSummary> _taggedStats;
+	AccessSummary _accessStats;
+	base::flat_map<uint8, AccessSummary> _taggedAccessStats;
+	LatencyHistogram _getLatency;
+	LatencyHistogram _putLatency;
+	CompactionSummary _compactionStats;
 	rpl::event_stream<Stats> _stats;
 	bool _pushingStats = false;
 	bool _clearingStale = false;
 
 	base::ConcurrentTimer _writeBundlesTimer;
 	base::ConcurrentTimer _pruneTimer;
+	base::ConcurrentTimer _writeCombinedTimer;
 
 	CleanerWrap _cleaner;
 	CompactorWrap _compactor;
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/concurrent_timer.h"
 #include <crl/crl.h>
 #include <QtCore/QFile>
+#include <QtCore/QDir>
 #include <QtWidgets/QApplication>
 #include <thread>
 
@@ -117,6 +118,20 @@ Database::TaggedValue GetWithTag(Database &db, const Key &key) {
 	return ValueWithTag;
 }
 
+auto ValuesMany = std::vector<Database::TaggedValue>();
+const auto GetValuesMany = [](std::vector<Database::TaggedValue> values) {
+	ValuesMany = values;
+	Semaphore.release();
+};
+
+std::vector<Database::TaggedValue> GetMany(
+		Database &db,
+		std::vector<Key> &&keys) {
+	db.getMany(std::move(keys), GetValuesMany);
+	Semaphore.acquire();
+	return ValuesMany;
+}
+
 Error Put(Database &db, const Key &key, QByteArray &&value) {
 	db.put(key, std::move(value), GetResult);
 	Semaphore.acquire();
@@ -448,6 +463,32 @@ TEST_CASE("encrypted cache db", "[storage_cache_database]") {
 		REQUIRE((Get(db, Key{ 1, 0 }) == Test2()));
 		Close(db);
 	}
+	SECTION("reading many values from db") {
+		Database db(name, Settings);
+
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		const auto values = GetMany(db, {
+			Key{ 1, 0 },
+			Key{ 1, 1 },
+			Key{ 0, 1 },
+		});
+		REQUIRE(values.size() == 3);
+		REQUIRE(((values[0].bytes == Test2()) && (values[0].tag == 0)));
+		REQUIRE(values[1].bytes.isEmpty());
+		REQUIRE(((values[2].bytes == Test1()) && (values[2].tag == 1)));
+		Close(db);
+	}
+	SECTION("reading mapped db") {
+		auto settings = Settings;
+		settings.mapValuesOnRead = true;
+		Database db(name, settings);
+
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		REQUIRE((Get(db, Key{ 0, 1 }) == Test1()));
+		REQUIRE((Get(db, Key{ 1, 0 }) == Test2()));
+		REQUIRE(Get(db, Key{ 1, 1 }).isEmpty());
+		Close(db);
+	}
 	SECTION("deleting in db by tag") {
 		Database db(name, Settings);
 
@@ -510,6 +551,41 @@ TEST_CASE("encrypted cache db", "[storage_cache_database]") {
 		}
 		Close(db);
 	}
+	SECTION("small values stored in pack segments") {
+		auto settings = Settings;
+		settings.packValuesBelow = 20;
+		Database db(name, settings);
+
+		REQUIRE(Clear(db).type == Error::Type::None);
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		const auto path = GetBinlogPath();
+		const auto packs = QFileInfo(path).absolutePath() + "/packs";
+		REQUIRE(Put(db, Key{ 0, 1 }, Test1()).type == Error::Type::None);
+		REQUIRE(Put(db, Key{ 1, 0 }, Test2()).type == Error::Type::None);
+		REQUIRE(Put(db, Key{ 1, 1 }, Test1()).type == Error::Type::None);
+		REQUIRE(QDir(packs).entryList(QDir::Files).size() == 1);
+		REQUIRE((Get(db, Key{ 0, 1 }) == Test1()));
+		REQUIRE((Get(db, Key{ 1, 0 }) == Test2()));
+		Remove(db, Key{ 1, 0 });
+		REQUIRE(Get(db, Key{ 1, 0 }).isEmpty());
+		REQUIRE(Put(db, Key{ 1, 1 }, Test2()).type == Error::Type::None);
+		Close(db);
+
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		REQUIRE((Get(db, Key{ 0, 1 }) == Test1()));
+		REQUIRE(Get(db, Key{ 1, 0 }).isEmpty());
+		REQUIRE((Get(db, Key{ 1, 1 }) == Test2()));
+		REQUIRE(Put(db, Key{ 1, 0 }, Test1()).type == Error::Type::None);
+		REQUIRE(QDir(packs).entryList(QDir::Files).size() == 2);
+		Remove(db, Key{ 0, 1 });
+		Remove(db, Key{ 1, 1 });
+		Close(db);
+
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		REQUIRE((Get(db, Key{ 1, 0 }) == Test1()));
+		REQUIRE(QDir(packs).entryList(QDir::Files).size() == 1);
+		Close(db);
+	}
 }
 
 TEST_CASE("cache db remove", "[storage_cache_database]") {
@@ -574,6 +650,30 @@ TEST_CASE("cache db bundled actions", "[storage_cache_database]") {
 		Close(db);
 		REQUIRE(QFile(path).size() > size);
 	}
+	SECTION("db small values written combined") {
+		auto settings = Settings;
+		settings.combineWritesBelow = 20;
+		Database db(name, settings);
+
+		REQUIRE(Clear(db).type == Error::Type::None);
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		const auto path = GetBinlogPath();
+		const auto size = QFile(path).size();
+		REQUIRE(Put(db, Key{ 0, 1 }, Test1()).type == Error::Type::None);
+		REQUIRE(Put(db, Key{ 1, 0 }, Test2()).type == Error::Type::None);
+		REQUIRE(QFile(path).size() == size);
+		REQUIRE((Get(db, Key{ 0, 1 }) == Test1()));
+		Remove(db, Key{ 1, 0 });
+		REQUIRE(Get(db, Key{ 1, 0 }).isEmpty());
+		AdvanceTime(2);
+		REQUIRE(QFile(path).size() > size);
+		Close(db);
+
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		REQUIRE((Get(db, Key{ 0, 1 }) == Test1()));
+		REQUIRE(Get(db, Key{ 1, 0 }).isEmpty());
+		Close(db);
+	}
 	SECTION("db remove written lazily") {
 		Database db(name, Settings);
 
@@ -672,6 +772,28 @@ TEST_CASE("cache db limits", "[storage_cache_database]") {
 		REQUIRE((Get(db, Key{ 2, 2 }) == Test2()));
 		Close(db);
 	}
+	SECTION("db tag size limit") {
+		auto settings = Settings;
+		settings.trackEstimatedTime = true;
+		settings.taggedSizeLimits.emplace(uint8(1), 15 * 2);
+		Database db(name, settings);
+
+		db.clear(nullptr);
+		db.open(base::duplicate(key), nullptr);
+		db.put(Key{ 0, 1 }, Database::TaggedValue(Test1(), 1), nullptr);
+		db.put(Key{ 1, 0 }, Test2(), nullptr);
+		AdvanceTime(2);
+		db.put(Key{ 1, 1 }, Database::TaggedValue(Test1(), 1), nullptr);
+		db.put(Key{ 2, 0 }, Database::TaggedValue(Test1(), 1), nullptr);
+		AdvanceTime(2);
+
+		// Only the oldest value with the overflowed tag is removed.
+		REQUIRE(Get(db, Key{ 0, 1 }).isEmpty());
+		REQUIRE((Get(db, Key{ 1, 0 }) == Test2()));
+		REQUIRE((Get(db, Key{ 1, 1 }) == Test1()));
+		REQUIRE((Get(db, Key{ 2, 0 }) == Test1()));
+		Close(db);
+	}
 	SECTION("db time limit") {
 		auto settings = Settings;
 		settings.trackEstimatedTime = true;
@@ -48,6 +48,36 @@ TaggedValue::TaggedValue(QByteArray &&bytes, uint8 tag)
 : bytes(std::move(bytes)), tag(tag) {
 }
 
+void LatencyHistogram::add(int64 microseconds) {
+	auto index = 0;
+	while (index + 1 < kBucketsCount && (int64(1) << index) <= microseconds) {
+		++index;
+	}
+	++buckets[index];
+}
+
+size_type LatencyHistogram::count() const {
+	return ranges::accumulate(buckets, size_type(0));
+}
+
+int64 LatencyHistogram::percentile(float64 part) const {
+	Expects(part >= 0. && part <= 1.);
+
+	const auto total = count();
+	if (!total) {
+		return 0;
+	}
+	const auto till = size_type(std::ceil(total * part));
+	auto counted = size_type(0);
+	for (auto index = 0; index != kBucketsCount; ++index) {
+		counted += buckets[index];
+		if (counted >= till) {
+			return (int64(1) << index);
+		}
+	}
+	return (int64(1) << (kBucketsCount - 1));
+}
+
 QString ComputeBasePath(const QString &original) {
 	const auto result = QDir(original).absolutePath();
 	return result.endsWith('/') ? result : (result + '/');
@@ -64,20 +64,36 @@ constexpr auto kBundledRecordsLimit
 	= size_type(1 << (RecordsCount().size() * 8));
 constexpr auto kDataSizeLimit = size_type(1 << (EntrySize().size() * 8));
 
+enum class EvictionPolicy {
+	LeastRecentlyUsed,
+	SizeAndRecency, // Prefer evicting large entries that weren't used long.
+};
+
 struct Settings {
 	size_type maxBundledRecords = 16 * 1024;
 	size_type readBlockSize = 8 * 1024 * 1024;
+	bool mapValuesOnRead = false;
 	size_type maxDataSize = (kDataSizeLimit - 1);
 	crl::time_type writeBundleDelay = 15 * 60 * crl::time_type(1000);
+	size_type combineWritesBelow = 0; // Zero disables write combining.
+	size_type combinedWritesLimit = 1024 * 1024;
+	crl::time_type combinedWritesDelay = crl::time_type(1000);
+	size_type packValuesBelow = 0; // Zero disables packing small values.
+	int64 packSegmentSize = 16 * 1024 * 1024;
 	size_type staleRemoveChunk = 256;
 
 	int64 compactAfterExcess = 8 * 1024 * 1024;
 	int64 compactAfterFullSize = 0;
 	size_type compactChunkSize = 16 * 1024;
+	int64 compactBytesPerSecond = 0; // Zero means no limit.
+	crl::time_type compactMaxChunkDelay = 5 * crl::time_type(1000);
+	crl::time_type compactMaxChunkLatency = 0; // Zero means no limit.
 
 	bool trackEstimatedTime = true;
 	int64 totalSizeLimit = 1024 * 1024 * 1024;
 	size_type totalTimeLimit = 31 * 24 * 60 * 60; // One month in seconds.
+	base::flat_map<uint8, int64> taggedSizeLimits;
+	EvictionPolicy evictionPolicy = EvictionPolicy::LeastRecentlyUsed;
 	crl::time_type pruneTimeout = 5 * crl::time_type(1000);
 	crl::time_type maxPruneCheckTimeout = 3600 * crl::time_type(1000);
 
@@ -101,9 +117,42 @@ struct TaggedSummary {
 	size_type count = 0;
 	size_type totalSize = 0;
 };
+struct CompactionSummary {
+	int64 till = 0; // Binlog size to compact or zero if not compacting.
+	int64 read = 0;
+	int64 written = 0;
+
+	// Write amplification is (binlog size + totalWritten) / binlog size.
+	size_type finished = 0;
+	size_type failed = 0;
+	int64 totalRead = 0;
+	int64 totalWritten = 0;
+};
+struct AccessSummary {
+	size_type hits = 0;
+	size_type misses = 0; // Tagged misses count only unreadable values.
+	int64 bytesRead = 0;
+	int64 bytesWritten = 0;
+};
+struct LatencyHistogram {
+	// Bucket i counts requests that took less than 2^i microseconds,
+	// the last one also counts all the slower requests.
+	static constexpr auto kBucketsCount = 20;
+
+	void add(int64 microseconds);
+	size_type count() const;
+	int64 percentile(float64 part) const;
+
+	std::array<size_type, kBucketsCount> buckets = { { 0 } };
+};
 struct Stats {
 	TaggedSummary full;
 	base::flat_map<uint8, TaggedSummary> tagged;
+	AccessSummary access;
+	base::flat_map<uint8, AccessSummary> taggedAccess;
+	LatencyHistogram getLatency;
+	LatencyHistogram putLatency;
+	CompactionSummary compaction;
 	bool clearing = false;
 };
 
@@ -126,6 +175,9 @@ struct BasicHeader {
 
 	static constexpr auto kTrackEstimatedTime = 0x01U;
 
+	// Places starting with 0xFF address values inside pack segment files.
+	static constexpr auto kPackedPlaces = 0x02U;
+
 	Format getFormat() const {
 		return static_cast<Format>(format);
 	}
@@ -136,7 +188,9 @@ struct BasicHeader {
 	uint32 format : 8;
 	uint32 flags : 24;
 	uint32 systemTime = 0;
-	uint32 reserved1 = 0;
+
+	// Keys count in the compacted binlog, used as a hint on replay.
+	uint32 keysCount = 0;
 	uint32 reserved2 = 0;
 };
 
@@ -27,6 +27,72 @@ namespace {
 // How much time without download causes additional session kill.
 constexpr auto kKillSessionTimeout = TimeMs(5000);
 
+// Small files use only the first sessions, large files are striped over
+// all of the download sessions (each with its own tcp connection), so
+// that one file isn't limited by the window of a single connection.
+constexpr auto kSmallFileSessionsCount = 2;
+constexpr auto kStripeFileMinSize = 2 * 1024 * 1024;
+static_assert(kSmallFileSessionsCount <= MTP::kDownloadSessionsCount);
+
+// How long a warmed up session is kept if nothing is loaded through it.
+constexpr auto kWarmUpSessionTimeout = TimeMs(60000);
+
+// Parallel part requests limits for one dc.
+constexpr auto kDefaultQueriesLimit = 16;
+constexpr auto kMinQueriesLimit = 2;
+constexpr auto kMaxQueriesLimit = 32;
+
+// While the round trip stays below minimal * kGrowDurationRatio we add
+// one more parallel request, when it grows above minimal * kDropDuration
+// ratio the requests are queued up somewhere and we cut them by a quarter.
+constexpr auto kGrowDurationRatio = 2;
+constexpr auto kDropDurationRatio = 4;
+
+// Minimal round trip is forgotten each window to follow network changes.
+constexpr auto kStatsWindow = TimeMs(10000);
+
+// Large media is auto loaded only if the measured link to its dc could
+// load it in that time, otherwise it waits for the user to open it.
+constexpr auto kAutoLoadCheckMinSize = 4 * 1024 * 1024;
+constexpr auto kAutoLoadMaxDuration = TimeMs(60000);
+
+// Partially loaded progressive photos are decoded again only after
+// that many new bytes were received.
+constexpr auto kProgressiveImageStep = 16 * 1024;
+
+// Returns std::nullopt while the frame header is not received yet.
+std::optional<bool> IsProgressiveJpeg(const QByteArray &data) {
+	const auto size = data.size();
+	const auto bytes = reinterpret_cast<const uchar*>(data.constData());
+	if (size < 2) {
+		return std::nullopt;
+	} else if (bytes[0] != 0xFF || bytes[1] != 0xD8) {
+		return false;
+	}
+	auto offset = 2;
+	while (offset + 4 <= size) {
+		if (bytes[offset] != 0xFF) {
+			return false;
+		}
+		const auto marker = bytes[offset + 1];
+		if (marker == 0xFF) {
+			++offset;
+			continue;
+		} else if (marker == 0xC2) {
+			return true;
+		} else if ((marker >= 0xC0 && marker <= 0xCF
+			&& marker != 0xC4
+			&& marker != 0xC8
+			&& marker != 0xCC)
+			|| marker == 0xDA
+			|| marker == 0xD9) {
+			return false;
+		}
+		offset += 2 + ((int(bytes[offset + 2]) << 8) | bytes[offset + 3]);
+	}
+	return std::nullopt;
+}
+
 } // namespace
 
 Downloader::Downloader()
@@ -48,20 +114,54 @@ void Downloader::requestedAmountIncrement(MTP::DcId dcId, int index, int amount)
 	if (it->second[index]) {
 		killDownloadSessionsStop(dcId);
 	} else {
-		killDownloadSessionsStart(dcId);
+		killDownloadSessionsStart(dcId, kKillSessionTimeout);
 	}
 }
 
-void Downloader::killDownloadSessionsStart(MTP::DcId dcId) {
-	if (!_killDownloadSessionTimes.contains(dcId)) {
-		_killDownloadSessionTimes.emplace(
+void Downloader::warmUp(MTP::DcId dcId) {
+	if (!dcId) {
+		return;
+	}
+	const auto i = _requestedBytesAmount.find(dcId);
+	if (i != _requestedBytesAmount.cend()
+		&& ranges::find_if(i->second, [](int64 amount) {
+			return amount != 0;
+		}) != i->second.end()) {
+		// Something is being loaded, the session is alive anyway.
+		return;
+	}
+	killDownloadSessionsStart(dcId, kWarmUpSessionTimeout);
+	if (_warmedUp.contains(dcId)) {
+		return;
+	}
+	_warmedUp.emplace(dcId);
+
+	// Any request requiring authorization creates the key, connects
+	// and exports the authorization to that dc, the same way the first
+	// upload.getFile request would do.
+	MTP::send(
+		MTPusers_GetUsers(
+			MTP_vector<MTPInputUser>(1, MTP_inputUserSelf())),
+		RPCResponseHandler(),
+		MTP::downloadDcId(
 			dcId,
-			getms() + MTP::kAckSendWaiting + kKillSessionTimeout);
+			chooseDcIndexForRequest(dcId, kSmallFileSessionsCount)));
+}
+
+void Downloader::killDownloadSessionsStart(
+		MTP::DcId dcId,
+		TimeMs timeout) {
+	const auto now = getms();
+	const auto when = now + MTP::kAckSendWaiting + timeout;
+	auto &killAt = _killDownloadSessionTimes[dcId];
+	if (killAt < when) {
+		killAt = when;
 	}
-	if (!_killDownloadSessionsTimer.isActive()) {
-		_killDownloadSessionsTimer.callOnce(
-			MTP::kAckSendWaiting + kKillSessionTimeout + 5);
+	auto left = when - now;
+	for (const auto &[id, time] : _killDownloadSessionTimes) {
+		accumulate_min(left, time - now);
 	}
+	_killDownloadSessionsTimer.callOnce(std::max(left, TimeMs(0)) + 5);
 }
 
 void Downloader::killDownloadSessionsStop(MTP::DcId dcId) {
@@ -79,6 +179,7 @@ void Downloader::killDownloadSessions() {
 			for (int j = 0; j < MTP::kDownloadSessionsCount; ++j) {
 				MTP::stopSession(MTP::downloadDcId(i->first, j));
 			}
+			_warmedUp.remove(i->first);
 			i = _killDownloadSessionTimes.erase(i);
 		} else {
 			if (i->second - ms < left) {
@@ -92,11 +193,16 @@ void Downloader::killDownloadSessions() {
 	}
 }
 
-int Downloader::chooseDcIndexForRequest(MTP::DcId dcId) const {
+int Downloader::chooseDcIndexForRequest(
+		MTP::DcId dcId,
+		int sessionsCount) const {
+	Expects(sessionsCount > 0
+		&& sessionsCount <= MTP::kDownloadSessionsCount);
+
 	auto result = 0;
 	auto it = _requestedBytesAmount.find(dcId);
 	if (it != _requestedBytesAmount.cend()) {
-		for (auto i = 1; i != MTP::kDownloadSessionsCount; ++i) {
+		for (auto i = 1; i != sessionsCount; ++i) {
 			if (it->second[i] < it->second[result]) {
 				result = i;
 			}
@@ -105,6 +211,100 @@ int Downloader::chooseDcIndexForRequest(MTP::DcId dcId) const {
 	return result;
 }
 
+void Downloader::requestSucceeded(
+		MTP::DcId dcId,
+		TimeMs duration,
+		int bytes) {
+	const auto now = getms();
+	duration = std::max(duration, TimeMs(1));
+
+	auto &stats = _dcStats[dcId];
+	if (!stats.queriesLimit) {
+		stats.queriesLimit = kDefaultQueriesLimit;
+		stats.windowStart = now;
+	}
+	stats.windowBytes += bytes;
+	if (!stats.windowMinDuration || stats.windowMinDuration > duration) {
+		stats.windowMinDuration = duration;
+	}
+	if (!stats.minDuration || stats.minDuration > duration) {
+		stats.minDuration = duration;
+	}
+	stats.smoothedDuration = stats.smoothedDuration
+		? (stats.smoothedDuration * 7 + duration) / 8
+		: duration;
+	stats.smoothedBytes = stats.smoothedBytes
+		? (stats.smoothedBytes * 7 + bytes) / 8
+		: bytes;
+	if (now - stats.windowStart >= kStatsWindow) {
+		stats.bytesPerSecond = stats.windowBytes
+			* 1000
+			/ (now - stats.windowStart);
+		stats.minDuration = stats.windowMinDuration;
+		stats.windowMinDuration = 0;
+		stats.windowBytes = 0;
+		stats.windowStart = now;
+	}
+
+	// Change the limit at most once a round of requests.
+	if (++stats.completedSinceChange < stats.queriesLimit) {
+		return;
+	}
+	const auto was = stats.queriesLimit;
+	if (stats.smoothedDuration < stats.minDuration * kGrowDurationRatio) {
+		stats.queriesLimit = std::min(was + 1, kMaxQueriesLimit);
+	} else if (stats.smoothedDuration
+		> stats.minDuration * kDropDurationRatio) {
+		stats.queriesLimit = std::max(was - was / 4, kMinQueriesLimit);
+	}
+	stats.completedSinceChange = 0;
+	if (stats.queriesLimit != was) {
+		DEBUG_LOG(("Download Info: dc %1 queries limit %2 -> %3, "
+			"round trip %4 ms (min %5 ms), %6 bytes per second."
+			).arg(dcId
+			).arg(was
+			).arg(stats.queriesLimit
+			).arg(stats.smoothedDuration
+			).arg(stats.minDuration
+			).arg(stats.bytesPerSecond));
+	}
+}
+
+int Downloader::queriesLimit(MTP::DcId dcId) const {
+	const auto i = _dcStats.find(dcId);
+	return (i != end(_dcStats) && i->second.queriesLimit)
+		? i->second.queriesLimit
+		: kDefaultQueriesLimit;
+}
+
+bool Downloader::fastEnoughForAutoLoad(MTP::DcId dcId, int size) const {
+	if (size < kAutoLoadCheckMinSize) {
+		return true;
+	}
+	const auto i = _dcStats.find(dcId);
+	if (i == end(_dcStats) || !i->second.smoothedDuration) {
+		return true;
+	}
+
+	// The window average includes idle time, so the capacity is estimated
+	// from the parallel requests of a typical size and their round trip.
+	const auto &stats = i->second;
+	const auto bytesPerSecond = stats.smoothedBytes
+		* stats.queriesLimit
+		* 1000
+		/ stats.smoothedDuration;
+	const auto result = (size * 1000LL)
+		<= (bytesPerSecond * kAutoLoadMaxDuration);
+	if (!result) {
+		DEBUG_LOG(("Download Info: skipping auto load of %1 bytes "
+			"from dc %2, estimated %3 bytes per second."
+			).arg(size
+			).arg(dcId
+			).arg(bytesPerSecond));
+	}
+	return result;
+}
+
 Downloader::~Downloader() {
 	killDownloadSessions();
 }
@@ -126,6 +326,9 @@ struct FileLoaderQueue {
 	}
 	int queriesCount = 0;
 	int queriesLimit = 0;
+	std::array<int, Storage::kLoadPrioritiesCount> queriesByPriority = { {
+		0
+	} };
 	FileLoader *start = nullptr;
 	FileLoader *end = nullptr;
 };
@@ -137,6 +340,19 @@ LoaderQueues queues;
 
 FileLoaderQueue _webQueue(kMaxWebFileQueries);
 
+// Part of the parallel requests limit that the loaders of the given
+// or lower priority classes can take all together.
+int PriorityQueriesLimit(int queriesLimit, Storage::LoadPriority priority) {
+	switch (priority) {
+	case Storage::LoadPriority::Interactive:
+	case Storage::LoadPriority::Visible: return queriesLimit;
+	case Storage::LoadPriority::Prefetch:
+		return std::max(queriesLimit * 3 / 4, 1);
+	case Storage::LoadPriority::Bulk: return std::max(queriesLimit / 2, 1);
+	}
+	Unexpected("Priority in PriorityQueriesLimit.");
+}
+
 QThread *_webLoadThread = nullptr;
 WebLoadManager *_webLoadManager = nullptr;
 WebLoadManager *webLoadManager() {
@@ -156,6 +372,7 @@ FileLoader::FileLoader(
 	uint8 cacheTag)
 : _downloader(&Auth().downloader())
 , _autoLoading(autoLoading)
+, _loadPriority(Storage::LoadPriority::Visible)
 , _cacheTag(cacheTag)
 , _filename(toFile)
 , _file(_filename)
@@ -192,20 +409,26 @@ void FileLoader::finishWithBytes(const QByteArray &data) {
 }
 
 QByteArray FileLoader::imageFormat(const QSize &shrinkBox) const {
-	if (_imageFormat.isEmpty() && _locationType == UnknownFileLocation) {
+	if (_imageFormat.isEmpty()
+		&& !_imageRead
+		&& _locationType == UnknownFileLocation) {
 		readImage(shrinkBox);
 	}
 	return _imageFormat;
 }
 
 QImage FileLoader::imageData(const QSize &shrinkBox) const {
-	if (_imageData.isNull() && _locationType == UnknownFileLocation) {
+	if (_imageData.isNull()
+		&& !_imageRead
+		&& _locationType == UnknownFileLocation) {
 		readImage(shrinkBox);
 	}
 	return _imageData;
 }
 
 void FileLoader::readImage(const QSize &shrinkBox) const {
+	_imageDecoding = nullptr;
+	_imageRead = true;
 	auto format = QByteArray();
 	auto image = App::readImage(_data, &format, false);
 	if (!image.isNull()) {
@@ -218,6 +441,97 @@ void FileLoader::readImage(const QSize &shrinkBox) const {
 	}
 }
 
+QImage FileLoader::takeProgressiveImage() {
+	return base::take(_progressiveImage);
+}
+
+void FileLoader::decodeProgressiveImage() {
+	if (_finished
+		|| _fileIsOpen
+		|| _progressiveDecoding
+		|| _locationType != UnknownFileLocation
+		|| _data.size() < _progressiveDecodedSize + kProgressiveImageStep) {
+		return;
+	}
+	if (!_progressive.has_value()) {
+		_progressive = IsProgressiveJpeg(_data);
+	}
+	if (!_progressive.value_or(false)) {
+		return;
+	}
+	_progressiveDecodedSize = _data.size();
+	auto [first, second] = base::make_binary_guard();
+	_progressiveDecoding = std::move(first);
+	crl::async([
+		=,
+		bytes = _data,
+		guard = std::move(second)
+	]() mutable {
+		auto image = App::readImage(bytes, nullptr, false);
+		crl::on_main([
+			=,
+			image = std::move(image),
+			guard = std::move(guard)
+		]() mutable {
+			if (!guard) {
+				return;
+			}
+			_progressiveDecoding = nullptr;
+			if (!_finished && !image.isNull()) {
+				_progressiveImage = std::move(image);
+				_downloader->taskFinished().notify();
+			}
+		});
+	});
+}
+
+bool FileLoader::prepareImageData(const QSize &shrinkBox) {
+	if (_imageRead
+		|| !_imageData.isNull()
+		|| _locationType != UnknownFileLocation) {
+		return true;
+	} else if (_imageDecoding) {
+		return false;
+	}
+	auto [first, second] = base::make_binary_guard();
+	_imageDecoding = std::move(first);
+	crl::async([
+		=,
+		bytes = _data,
+		guard = std::move(second)
+	]() mutable {
+		auto format = QByteArray();
+		auto image = App::readImage(bytes, &format, false);
+		if (!image.isNull()
+			&& !shrinkBox.isEmpty()
+			&& (image.width() > shrinkBox.width()
+				|| image.height() > shrinkBox.height())) {
+			image = image.scaled(
+				shrinkBox,
+				Qt::KeepAspectRatio,
+				Qt::SmoothTransformation);
+		}
+		crl::on_main([
+			=,
+			image = std::move(image),
+			format = std::move(format),
+			guard = std::move(guard)
+		]() mutable {
+			if (!guard) {
+				return;
+			}
+			_imageDecoding = nullptr;
+			_imageRead = true;
+			if (!image.isNull()) {
+				_imageData = std::move(image);
+				_imageFormat = std::move(format);
+			}
+			_downloader->taskFinished().notify();
+		});
+	});
+	return false;
+}
+
 Data::FileOrigin FileLoader::fileOrigin() const {
 	return Data::FileOrigin();
 }
@@ -252,20 +566,62 @@ void FileLoader::notifyAboutProgress() {
 }
 
 void FileLoader::LoadNextFromQueue(not_null<FileLoaderQueue*> queue) {
+	for (auto index = 0; index != Storage::kLoadPrioritiesCount; ++index) {
+		const auto priority = static_cast<Storage::LoadPriority>(index);
+		for (auto i = queue->start; i;) {
+			if (QueueFull(queue, priority)) {
+				break;
+			} else if (i->_loadPriority != priority || !i->loadPart()) {
+				i = i->_next;
+			}
+		}
+		if (queue->queriesCount >= queue->queriesLimit) {
+			return;
+		}
+	}
+}
+
+bool FileLoader::QueueFull(
+		not_null<FileLoaderQueue*> queue,
+		Storage::LoadPriority priority) {
 	if (queue->queriesCount >= queue->queriesLimit) {
+		return true;
+	}
+	auto queries = 0;
+	for (auto index = int(priority)
+		; index != Storage::kLoadPrioritiesCount
+		; ++index) {
+		queries += queue->queriesByPriority[index];
+	}
+	return (queries >= PriorityQueriesLimit(queue->queriesLimit, priority));
+}
+
+void FileLoader::setLoadPriority(Storage::LoadPriority priority) {
+	if (_loadPriority == priority) {
 		return;
 	}
-	for (auto i = queue->start; i;) {
-		if (i->loadPart()) {
-			if (queue->queriesCount >= queue->queriesLimit) {
-				return;
-			}
-		} else {
-			i = i->_next;
-		}
+	_queue->queriesByPriority[int(_loadPriority)] -= _queriesCount;
+	_loadPriority = priority;
+	_queue->queriesByPriority[int(_loadPriority)] += _queriesCount;
+	if (_inQueue) {
+		LoadNextFromQueue(_queue);
 	}
 }
 
+void FileLoader::queryStarted() {
+	++_queriesCount;
+	++_queue->queriesCount;
+	++_queue->queriesByPriority[int(_loadPriority)];
+}
+
+void FileLoader::queryFinished() {
+	Expects(_queriesCount > 0);
+
+	--_queriesCount;
+	--_queue->queriesCount;
+	--_queue->queriesByPriority[int(_loadPriority)];
+}
+
 void FileLoader::removeFromQueue() {
 	if (!_inQueue) return;
 	if (_next) {
@@ -523,7 +879,7 @@ void FileLoader::cancel(bool fail) {
 }
 
 void FileLoader::startLoading(bool loadFirst, bool prior) {
-	if ((_queue->queriesCount >= _queue->queriesLimit && (!loadFirst || !prior)) || _finished) {
+	if ((QueueFull(_queue, _loadPriority) && (!loadFirst || !prior)) || _finished) {
 		return;
 	}
 	loadPart();
@@ -680,7 +1036,11 @@ bool mtpFileLoader::loadPart() {
 		return false;
 	}
 
-	makeRequest(_nextRequestOffset);
+	if (streamingToCache()) {
+		requestPartFromCache(_nextRequestOffset);
+	} else {
+		makeRequest(_nextRequestOffset);
+	}
 	_nextRequestOffset += partSize();
 	return true;
 }
@@ -704,7 +1064,13 @@ int mtpFileLoader::partSize() const {
 mtpFileLoader::RequestData mtpFileLoader::prepareRequest(int offset) const {
 	auto result = RequestData();
 	result.dcId = _cdnDcId ? _cdnDcId : _dcId;
-	result.dcIndex = _size ? _downloader->chooseDcIndexForRequest(result.dcId) : 0;
+	result.dcIndex = _size
+		? _downloader->chooseDcIndexForRequest(
+			result.dcId,
+			(_size >= kStripeFileMinSize
+				? MTP::kDownloadSessionsCount
+				: kSmallFileSessionsCount))
+		: 0;
 	result.offset = offset;
 	return result;
 }
@@ -823,6 +1189,9 @@ void mtpFileLoader::normalPartLoaded(
 	Expects(!_finished);
 	Expects(result.type() == mtpc_upload_fileCdnRedirect || result.type() == mtpc_upload_file);
 
+	if (result.type() == mtpc_upload_file) {
+		countRequestSpeed(requestId, result.c_upload_file().vbytes.v.size());
+	}
 	auto offset = finishSentRequestGetOffset(requestId);
 	if (result.type() == mtpc_upload_fileCdnRedirect) {
 		return switchToCDN(offset, result.c_upload_fileCdnRedirect());
@@ -836,6 +1205,7 @@ void mtpFileLoader::webPartLoaded(
 		mtpRequestId requestId) {
 	Expects(result.type() == mtpc_upload_webFile);
 
+	countRequestSpeed(requestId, result.c_upload_webFile().vbytes.v.size());
 	auto offset = finishSentRequestGetOffset(requestId);
 	auto &webFile = result.c_upload_webFile();
 	if (!_size) {
@@ -851,6 +1221,9 @@ void mtpFileLoader::webPartLoaded(
 void mtpFileLoader::cdnPartLoaded(const MTPupload_CdnFile &result, mtpRequestId requestId) {
 	Expects(!_finished);
 
+	if (result.type() == mtpc_upload_cdnFile) {
+		countRequestSpeed(requestId, result.c_upload_cdnFile().vbytes.v.size());
+	}
 	auto offset = finishSentRequestGetOffset(requestId);
 	if (result.type() == mtpc_upload_cdnFileReuploadNeeded) {
 		auto requestData = RequestData();
@@ -947,6 +1320,9 @@ void mtpFileLoader::getCdnFileHashesDone(const MTPVector<MTPFileHash> &result, m
 			const auto goodBytes = std::move(i->second);
 			const auto weak = QPointer<mtpFileLoader>(this);
 			i = _cdnUncheckedParts.erase(i);
+			if (streamingToCache()) {
+				putPartToCache(goodOffset, bytes::make_span(goodBytes));
+			}
 			if (!feedPart(goodOffset, bytes::make_span(goodBytes))
 				|| !weak) {
 				return;
@@ -975,8 +1351,21 @@ void mtpFileLoader::placeSentRequest(mtpRequestId requestId, const RequestData &
 	Expects(!_finished);
 
 	_downloader->requestedAmountIncrement(requestData.dcId, requestData.dcIndex, partSize());
-	++_queue->queriesCount;
-	_sentRequests.emplace(requestId, requestData);
+	queryStarted();
+	auto &sent = _sentRequests.emplace(requestId, requestData).first->second;
+	sent.sent = getms();
+}
+
+void mtpFileLoader::countRequestSpeed(mtpRequestId requestId, int bytes) {
+	const auto i = _sentRequests.find(requestId);
+	Assert(i != end(_sentRequests));
+
+	const auto &requestData = i->second;
+	_downloader->requestSucceeded(
+		requestData.dcId,
+		getms() - requestData.sent,
+		bytes);
+	_queue->queriesLimit = _downloader->queriesLimit(requestData.dcId);
 }
 
 int mtpFileLoader::finishSentRequestGetOffset(mtpRequestId requestId) {
@@ -986,7 +1375,7 @@ int mtpFileLoader::finishSentRequestGetOffset(mtpRequestId requestId) {
 	auto requestData = it->second;
 	_downloader->requestedAmountIncrement(requestData.dcId, requestData.dcIndex, -partSize());
 
-	--_queue->queriesCount;
+	queryFinished();
 	_sentRequests.erase(it);
 
 	return requestData.offset;
@@ -1032,6 +1421,7 @@ bool mtpFileLoader::feedPart(int offset, bytes::const_span buffer) {
 		_lastComplete = true;
 	}
 	if (_sentRequests.empty()
+		&& _cacheRequests.empty()
 		&& _cdnUncheckedParts.empty()
 		&& (_lastComplete || (_size && _nextRequestOffset >= _size))) {
 		if (!_filename.isEmpty() && (_toCache == LoadToCacheAsWell)) {
@@ -1075,16 +1465,77 @@ bool mtpFileLoader::feedPart(int offset, bytes::const_span buffer) {
 	}
 	if (_finished) {
 		_downloader->taskFinished().notify();
+	} else if (!_skippedBytes) {
+		decodeProgressiveImage();
 	}
 	return true;
 }
 
 void mtpFileLoader::partLoaded(int offset, bytes::const_span buffer) {
+	if (streamingToCache() && !buffer.empty()) {
+		putPartToCache(offset, buffer);
+	}
 	if (feedPart(offset, buffer)) {
 		notifyAboutProgress();
 	}
 }
 
+bool mtpFileLoader::streamingToCache() const {
+	return (_id != 0) && (_size > Storage::kMaxFileInMemory);
+}
+
+void mtpFileLoader::requestPartFromCache(int offset) {
+	Expects(!_finished);
+
+	auto [first, second] = base::make_binary_guard();
+	_cacheRequests.emplace(offset, std::move(first));
+	queryStarted();
+
+	auto done = [=, guard = std::move(second)](QByteArray &&value) mutable {
+		crl::on_main([
+			=,
+			value = std::move(value),
+			guard = std::move(guard)
+		]() mutable {
+			if (!guard) {
+				return;
+			}
+			cachedPartLoaded(offset, std::move(value));
+		});
+	};
+	Auth().data().cache().get(
+		Data::DocumentPartCacheKey(_dcId, _id, offset),
+		std::move(done));
+}
+
+void mtpFileLoader::cachedPartLoaded(int offset, QByteArray &&bytes) {
+	Expects(!_finished);
+
+	_cacheRequests.remove(offset);
+	queryFinished();
+
+	const auto size = int(bytes.size());
+	const auto complete = (size == partSize())
+		|| (size > 0 && offset + size == _size);
+	if (!complete) {
+		makeRequest(offset);
+		return;
+	}
+	if (feedPart(offset, bytes::make_span(bytes))) {
+		notifyAboutProgress();
+	}
+}
+
+void mtpFileLoader::putPartToCache(int offset, bytes::const_span buffer) {
+	Auth().data().cache().put(
+		Data::DocumentPartCacheKey(_dcId, _id, offset),
+		Storage::Cache::Database::TaggedValue(
+			QByteArray(
+				reinterpret_cast<const char*>(buffer.data()),
+				buffer.size()),
+			_cacheTag));
+}
+
 bool mtpFileLoader::partFailed(
 		const RPCError &error,
 		mtpRequestId requestId) {
@@ -1135,6 +1586,10 @@ void mtpFileLoader::cancelRequests() {
 		MTP::cancel(requestId);
 		finishSentRequestGetOffset(requestId);
 	}
+	for (auto i = 0, count = int(_cacheRequests.size()); i != count; ++i) {
+		queryFinished();
+	}
+	_cacheRequests.clear();
 }
 
 void mtpFileLoader::switchToCDN(
@@ -24,6 +24,17 @@ constexpr auto kMaxWallPaperInMemory = kMaxFileInMemory;
 constexpr auto kMaxAnimationInMemory = kMaxFileInMemory; // 10 MB gif and mp4 animations held in memory while playing
 constexpr auto kMaxWallPaperDimension = 4096; // 4096x4096 is max area.
 
+// Loaders of a higher priority class go first and lower classes can't
+// take all the parallel requests of a dc, so there always is some room
+// for the visible content requests.
+enum class LoadPriority {
+	Interactive, // Opened or saved by user.
+	Visible, // Painted right now, auto loaded included.
+	Prefetch, // Expected to be painted soon.
+	Bulk, // Background downloads nobody is looking at.
+};
+constexpr auto kLoadPrioritiesCount = 4;
+
 class Downloader final {
 public:
 	Downloader();
@@ -38,12 +49,36 @@ public:
 	}
 
 	void requestedAmountIncrement(MTP::DcId dcId, int index, int amount);
-	int chooseDcIndexForRequest(MTP::DcId dcId) const;
+	int chooseDcIndexForRequest(MTP::DcId dcId, int sessionsCount) const;
+
+	// Media from this dc is on screen, keep a download session to it
+	// ready, so that loading doesn't wait for a handshake and export.
+	void warmUp(MTP::DcId dcId);
+
+	// Parallel part requests limit adapts to the measured round trip.
+	void requestSucceeded(MTP::DcId dcId, TimeMs duration, int bytes);
+	int queriesLimit(MTP::DcId dcId) const;
+
+	// False if a large file wouldn't load in reasonable time on the link
+	// measured to this dc, true while nothing is known about the link.
+	bool fastEnoughForAutoLoad(MTP::DcId dcId, int size) const;
 
 	~Downloader();
 
 private:
-	void killDownloadSessionsStart(MTP::DcId dcId);
+	struct DcStats {
+		int queriesLimit = 0;
+		int completedSinceChange = 0;
+		TimeMs minDuration = 0;
+		TimeMs smoothedDuration = 0;
+		int64 smoothedBytes = 0;
+		TimeMs windowStart = 0;
+		TimeMs windowMinDuration = 0;
+		int64 windowBytes = 0;
+		int64 bytesPerSecond = 0;
+	};
+
+	void killDownloadSessionsStart(MTP::DcId dcId, TimeMs timeout);
 	void killDownloadSessionsStop(MTP::DcId dcId);
 	void killDownloadSessions();
 
@@ -53,7 +88,9 @@ private:
 	using RequestedInDc = std::array<int64, MTP::kDownloadSessionsCount>;
 	std::map<MTP::DcId, RequestedInDc> _requestedBytesAmount;
 
+	base::flat_map<MTP::DcId, DcStats> _dcStats;
 	base::flat_map<MTP::DcId, TimeMs> _killDownloadSessionTimes;
+	base::flat_set<MTP::DcId> _warmedUp;
 	base::Timer _killDownloadSessionsTimer;
 
 };
@@ -101,6 +138,14 @@ public:
 	}
 	QByteArray imageFormat(const QSize &shrinkBox = QSize()) const;
 	QImage imageData(const QSize &shrinkBox = QSize()) const;
+
+	// Starts decoding the loaded image in the background if required.
+	// Returns false while decoding, taskFinished() is notified after.
+	bool prepareImageData(const QSize &shrinkBox);
+
+	// While a progressive JPEG photo is loading the received scans are
+	// decoded in the background, this returns the newest of the results.
+	QImage takeProgressiveImage();
 	QString fileName() const {
 		return _filename;
 	}
@@ -131,6 +176,10 @@ public:
 	bool autoLoading() const {
 		return _autoLoading;
 	}
+	Storage::LoadPriority loadPriority() const {
+		return _loadPriority;
+	}
+	void setLoadPriority(Storage::LoadPriority priority);
 
 	virtual void stop() {
 	}
@@ -165,9 +214,16 @@ protected:
 	void cancel(bool failed);
 
 	void notifyAboutProgress();
+	void decodeProgressiveImage();
 	static void LoadNextFromQueue(not_null<FileLoaderQueue*> queue);
+	static bool QueueFull(
+		not_null<FileLoaderQueue*> queue,
+		Storage::LoadPriority priority);
 	virtual bool loadPart() = 0;
 
+	void queryStarted();
+	void queryFinished();
+
 	not_null<Storage::Downloader*> _downloader;
 	FileLoader *_prev = nullptr;
 	FileLoader *_next = nullptr;
@@ -176,6 +232,8 @@ protected:
 
 	bool _paused = false;
 	bool _autoLoading = false;
+	Storage::LoadPriority _loadPriority = Storage::LoadPriority::Visible;
+	int _queriesCount = 0;
 	uint8 _cacheTag = 0;
 	bool _inQueue = false;
 	bool _finished = false;
@@ -195,8 +253,15 @@ protected:
 	LocationType _locationType;
 
 	base::binary_guard _localLoading;
+	mutable base::binary_guard _imageDecoding;
 	mutable QByteArray _imageFormat;
 	mutable QImage _imageData;
+	mutable bool _imageRead = false;
+
+	base::binary_guard _progressiveDecoding;
+	QImage _progressiveImage;
+	std::optional<bool> _progressive;
+	int _progressiveDecodedSize = 0;
 
 };
 
@@ -259,6 +324,7 @@ private:
 		MTP::DcId dcId = 0;
 		int dcIndex = 0;
 		int offset = 0;
+		TimeMs sent = 0;
 	};
 	struct CdnFileHash {
 		CdnFileHash(int limit, QByteArray hash) : limit(limit), hash(hash) {
@@ -285,10 +351,18 @@ private:
 	bool feedPart(int offset, bytes::const_span buffer);
 	void partLoaded(int offset, bytes::const_span buffer);
 
+	// Large documents keep each loaded part in the cache, so
+	// an interrupted or repeated load doesn't download them again.
+	bool streamingToCache() const;
+	void requestPartFromCache(int offset);
+	void cachedPartLoaded(int offset, QByteArray &&bytes);
+	void putPartToCache(int offset, bytes::const_span buffer);
+
 	bool partFailed(const RPCError &error, mtpRequestId requestId);
 	bool cdnPartFailed(const RPCError &error, mtpRequestId requestId);
 
 	void placeSentRequest(mtpRequestId requestId, const RequestData &requestData);
+	void countRequestSpeed(mtpRequestId requestId, int bytes);
 	int finishSentRequestGetOffset(mtpRequestId requestId);
 	void switchToCDN(int offset, const MTPDupload_fileCdnRedirect &redirect);
 	void addCdnHashes(const QVector<MTPFileHash> &hashes);
@@ -302,6 +376,7 @@ private:
 	CheckCdnHashResult checkCdnFileHash(int offset, bytes::const_span buffer);
 
 	std::map<mtpRequestId, RequestData> _sentRequests;
+	base::flat_map<int, base::binary_guard> _cacheRequests;
 
 	bool _lastComplete = false;
 	int32 _skippedBytes = 0;
@@ -13,13 +13,28 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_document.h"
 #include "data/data_photo.h"
 #include "data/data_session.h"
+#include "storage/localstorage.h"
 #include "auth_session.h"
 
+#include <crl/crl_object_on_queue.h>
+#include <deque>
+
 namespace Storage {
 namespace {
 
-// max 512kb uploaded at the same time in each session
-constexpr auto kMaxUploadFileParallelSize = MTP::kUploadSessionsCount * 512 * 1024;
+// Parts sent at the same time in each session, the next part is sent
+// as soon as one of them is acknowledged.
+constexpr auto kUploadRequestsPerSession = 4;
+
+// Max 1mb uploaded at the same time in each session, by all the files.
+constexpr auto kMaxUploadSessionParallelSize = 1024 * 1024;
+
+// Files from the beginning of the queue uploaded at the same time.
+constexpr auto kMaxUploadingFiles = 4;
+
+// Parts of a document read from the disk before they are sent.
+constexpr auto kReadAheadParts = kUploadRequestsPerSession
+	* MTP::kUploadSessionsCount;
 
 constexpr auto kDocumentMaxPartsCount = 3000;
 
@@ -38,12 +53,85 @@ constexpr auto kDocumentUploadPartSize3 = 256 * 1024;
 // 512kb for large document ( <= 1500mb )
 constexpr auto kDocumentUploadPartSize4 = 512 * 1024;
 
-// One part each half second, if not uploaded faster.
-constexpr auto kUploadRequestInterval = TimeMs(500);
-
 // How much time without upload causes additional session kill.
 constexpr auto kKillSessionTimeout = TimeMs(5000);
 
+// Uploaded parts of an unfinished big file are not kept forever.
+constexpr auto kResumableUploadTimeout = TimeId(24 * 60 * 60);
+
+// Delay in saving the progress of the resumable uploads to the disk.
+constexpr auto kWriteResumableUploadsDelay = TimeMs(5000);
+
+// Reads the document parts one by one and counts the MD5 hash of the
+// whole document on a worker thread, so the main thread doesn't block
+// on the disk while sending large files.
+class PartsReader {
+public:
+	using Done = FnMut<void(QByteArray &&part, QByteArray &&md5)>;
+
+	PartsReader(
+		crl::weak_on_queue<PartsReader> weak,
+		const QString &path,
+		int partSize,
+		int partsCount,
+		int startPart,
+		bool countMd5);
+
+	// An empty part means a read error. MD5 hex of the whole document
+	// is passed with the last part if it was requested.
+	void readNext(Done &&done);
+
+private:
+	QFile _file;
+	int _partSize = 0;
+	int _partsCount = 0;
+	int _partsRead = 0;
+	bool _countMd5 = false;
+	bool _failed = false;
+	HashMd5 _md5;
+
+};
+
+PartsReader::PartsReader(
+	crl::weak_on_queue<PartsReader> weak,
+	const QString &path,
+	int partSize,
+	int partsCount,
+	int startPart,
+	bool countMd5)
+: _file(path)
+, _partSize(partSize)
+, _partsCount(partsCount)
+, _partsRead(startPart)
+, _countMd5(countMd5) {
+	Expects(!_countMd5 || !_partsRead);
+}
+
+void PartsReader::readNext(Done &&done) {
+	if (!_failed && !_file.isOpen()) {
+		_failed = !_file.open(QIODevice::ReadOnly)
+			|| !_file.seek(qint64(_partsRead) * _partSize);
+	}
+	auto part = _failed ? QByteArray() : _file.read(_partSize);
+	if (part.isEmpty()) {
+		_failed = true;
+		done(QByteArray(), QByteArray());
+		return;
+	}
+	if (_countMd5) {
+		_md5.feed(part.constData(), part.size());
+	}
+	auto md5 = QByteArray();
+	if (++_partsRead == _partsCount) {
+		_file.close();
+		if (_countMd5) {
+			md5 = QByteArray(32, Qt::Uninitialized);
+			hashMd5Hex(_md5.result(), md5.data());
+		}
+	}
+	done(std::move(part), std::move(md5));
+}
+
 } // namespace
 
 struct Uploader::File {
@@ -52,6 +140,7 @@ struct Uploader::File {
 
 	void setDocSize(int32 size);
 	bool setPartSize(uint32 partSize);
+	bool resumable() const;
 
 	std::shared_ptr<FileLoadResult> file;
 	SendMediaReady media;
@@ -65,7 +154,18 @@ struct Uploader::File {
 
 	HashMd5 md5Hash;
 
-	std::unique_ptr<QFile> docFile;
+	base::flat_map<mtpRequestId, QByteArray> requestsSent;
+	base::flat_map<mtpRequestId, int32> docRequestsSent;
+
+	// Differs from id() for a big file upload resumed after a restart.
+	uint64 docFileId = 0;
+	QDateTime docModified;
+
+	std::unique_ptr<crl::object_on_queue<PartsReader>> docReader;
+	uint64 docReaderId = 0;
+	std::deque<QByteArray> docReadParts;
+	QByteArray docReadMd5;
+	int32 docReadRequested = 0;
 	int32 docSentParts = 0;
 	int32 docSize = 0;
 	int32 docPartSize = 0;
@@ -84,6 +184,7 @@ Uploader::File::File(const SendMediaReady &media) : media(media) {
 	} else {
 		docSize = docPartSize = docPartsCount = 0;
 	}
+	docFileId = id();
 }
 Uploader::File::File(const std::shared_ptr<FileLoadResult> &file)
 : file(file) {
@@ -98,6 +199,7 @@ Uploader::File::File(const std::shared_ptr<FileLoadResult> &file)
 	} else {
 		docSize = docPartSize = docPartsCount = 0;
 	}
+	docFileId = id();
 }
 
 void Uploader::File::setDocSize(int32 size) {
@@ -124,6 +226,14 @@ bool Uploader::File::setPartSize(uint32 partSize) {
 	return (docPartsCount <= kDocumentMaxPartsCount);
 }
 
+bool Uploader::File::resumable() const {
+	const auto &content = file ? file->content : media.data;
+	const auto &path = file ? file->filepath : media.file;
+	return (docSize > kUseBigFilesFrom)
+		&& content.isEmpty()
+		&& !path.isEmpty();
+}
+
 uint64 Uploader::File::id() const {
 	return file ? file->id : media.id;
 }
@@ -140,9 +250,8 @@ const QString &Uploader::File::filename() const {
 	return file ? file->filename : media.filename;
 }
 
-Uploader::Uploader() {
-	nextTimer.setSingleShot(true);
-	connect(&nextTimer, SIGNAL(timeout()), this, SLOT(sendNext()));
+Uploader::Uploader()
+: _writeResumableUploadsTimer([=] { writeResumableUploads(); }) {
 	stopSessionsTimer.setSingleShot(true);
 	connect(&stopSessionsTimer, SIGNAL(timeout()), this, SLOT(stopSessions()));
 }
@@ -178,7 +287,8 @@ void Uploader::uploadMedia(
 			document->setLocation(FileLocation(media.file));
 		}
 	}
-	queue.emplace(msgId, File(media));
+	const auto i = queue.emplace(msgId, File(media)).first;
+	resumeUpload(i->second);
 	sendNext();
 }
 
@@ -222,12 +332,13 @@ void Uploader::upload(
 			document->setLocation(FileLocation(file->filepath));
 		}
 	}
-	queue.emplace(msgId, File(file));
+	const auto i = queue.emplace(msgId, File(file)).first;
+	resumeUpload(i->second);
 	sendNext();
 }
 
-void Uploader::currentFailed() {
-	auto j = queue.find(uploadingId);
+void Uploader::failed(const FullMsgId &msgId) {
+	auto j = queue.find(msgId);
 	if (j != queue.end()) {
 		if (j->second.type() == SendMediaType::Photo) {
 			_photoFailed.fire_copy(j->first);
@@ -242,20 +353,193 @@ void Uploader::currentFailed() {
 		} else if (j->second.type() == SendMediaType::Secure) {
 			_secureFailed.fire_copy(j->first);
 		} else {
-			Unexpected("Type in Uploader::currentFailed.");
+			Unexpected("Type in Uploader::failed.");
 		}
+		forgetUploadProgress(j->second);
+		cancelRequests(j->second);
 		queue.erase(j);
 	}
 
-	requestsSent.clear();
-	docRequestsSent.clear();
-	dcMap.clear();
-	uploadingId = FullMsgId();
-	sentSize = 0;
-	for (int i = 0; i < MTP::kUploadSessionsCount; ++i) {
-		sentSizes[i] = 0;
+	sendNext();
+}
+
+void Uploader::cancelRequests(File &file) {
+	for (const auto &[requestId, bytes] : base::take(file.requestsSent)) {
+		MTP::cancel(requestId);
+		requestDone(requestId, bytes.size());
+	}
+	for (const auto &[requestId, part] : base::take(file.docRequestsSent)) {
+		MTP::cancel(requestId);
+		requestDone(requestId, file.docPartSize);
 	}
+}
+
+int Uploader::requestDone(mtpRequestId requestId, int size) {
+	requestFiles.remove(requestId);
+	const auto i = dcMap.find(requestId);
+	if (i == dcMap.end()) {
+		return -1;
+	}
+	const auto dc = i->second;
+	dcMap.erase(i);
+	sentSizes[dc] -= size;
+	--sentRequests[dc];
+	return dc;
+}
 
+void Uploader::resumeUpload(File &file) {
+	if (!file.resumable()) {
+		return;
+	}
+	const auto &path = file.file ? file.file->filepath : file.media.file;
+	file.docModified = QFileInfo(path).lastModified();
+
+	const auto &uploads = resumableUploads();
+	const auto i = ranges::find_if(uploads, [&](
+			const ResumableUpload &upload) {
+		return (upload.path == path)
+			&& (upload.size == file.docSize)
+			&& (upload.modified == file.docModified)
+			&& (upload.partSize == file.docPartSize);
+	});
+	if (i == end(uploads)
+		|| i->partsDone <= 0
+		|| i->partsDone >= file.docPartsCount) {
+		return;
+	}
+	const auto fileId = i->fileId;
+	const auto alreadyUploading = ranges::find_if(queue, [&](
+			const auto &pair) {
+		return (pair.second.docFileId == fileId);
+	}) != end(queue);
+	if (alreadyUploading) {
+		return;
+	}
+	LOG(("Upload Info: resuming '%1' from part %2 of %3."
+		).arg(path
+		).arg(i->partsDone
+		).arg(file.docPartsCount));
+	file.docFileId = i->fileId;
+	file.docSentParts = file.docReadRequested = i->partsDone;
+}
+
+void Uploader::saveUploadProgress(const File &file) {
+	if (!file.resumable()) {
+		return;
+	}
+	auto partsDone = file.docSentParts;
+	for (const auto &[requestId, part] : file.docRequestsSent) {
+		partsDone = std::min(partsDone, part);
+	}
+	const auto &path = file.file ? file.file->filepath : file.media.file;
+	auto &uploads = resumableUploads();
+	auto i = ranges::find(uploads, path, &ResumableUpload::path);
+	if (i == end(uploads)) {
+		uploads.push_back({ path });
+		i = end(uploads) - 1;
+	}
+	i->size = file.docSize;
+	i->modified = file.docModified;
+	i->fileId = file.docFileId;
+	i->partSize = file.docPartSize;
+	i->partsDone = partsDone;
+	i->saved = unixtime();
+	if (!_writeResumableUploadsTimer.isActive()) {
+		_writeResumableUploadsTimer.callOnce(kWriteResumableUploadsDelay);
+	}
+}
+
+void Uploader::forgetUploadProgress(const File &file) {
+	if (!file.resumable()) {
+		return;
+	}
+	auto &uploads = resumableUploads();
+	const auto i = ranges::find(
+		uploads,
+		file.docFileId,
+		&ResumableUpload::fileId);
+	if (i != end(uploads)) {
+		uploads.erase(i);
+		writeResumableUploads();
+	}
+}
+
+std::vector<ResumableUpload> &Uploader::resumableUploads() {
+	if (!_resumableUploads) {
+		_resumableUploads = Local::ReadResumableUploads();
+		const auto now = unixtime();
+		const auto expired = ranges::remove_if(*_resumableUploads, [&](
+				const ResumableUpload &upload) {
+			return (upload.saved + kResumableUploadTimeout <= now)
+				|| (upload.saved > now);
+		});
+		if (expired != end(*_resumableUploads)) {
+			_resumableUploads->erase(expired, end(*_resumableUploads));
+			writeResumableUploads();
+		}
+	}
+	return *_resumableUploads;
+}
+
+void Uploader::writeResumableUploads() {
+	_writeResumableUploadsTimer.cancel();
+	if (_resumableUploads) {
+		Local::WriteResumableUploads(*_resumableUploads);
+	}
+}
+
+void Uploader::readNextParts(const FullMsgId &msgId, File &file) {
+	if (!file.docReader) {
+		const auto filepath = file.file
+			? file.file->filepath
+			: file.media.file;
+		file.docReader = std::make_unique<
+			crl::object_on_queue<PartsReader>>(
+				filepath,
+				file.docPartSize,
+				file.docPartsCount,
+				file.docReadRequested,
+				(file.docSize <= kUseBigFilesFrom));
+		file.docReaderId = ++_lastDocReaderId;
+	}
+	while (file.docReadRequested < file.docPartsCount
+		&& (file.docReadRequested - file.docSentParts < kReadAheadParts)) {
+		++file.docReadRequested;
+		auto done = [=, readerId = file.docReaderId](
+				QByteArray &&part,
+				QByteArray &&md5) {
+			crl::on_main(this, [
+				=,
+				part = std::move(part),
+				md5 = std::move(md5)
+			]() mutable {
+				partRead(msgId, readerId, std::move(part), std::move(md5));
+			});
+		};
+		file.docReader->with([done = std::move(done)](
+				PartsReader &reader) mutable {
+			reader.readNext(std::move(done));
+		});
+	}
+}
+
+void Uploader::partRead(
+		const FullMsgId &msgId,
+		uint64 readerId,
+		QByteArray &&part,
+		QByteArray &&md5) {
+	const auto i = queue.find(msgId);
+	if (i == queue.end() || i->second.docReaderId != readerId) {
+		return;
+	} else if (part.isEmpty()) {
+		failed(msgId);
+		return;
+	}
+	auto &file = i->second;
+	file.docReadParts.push_back(std::move(part));
+	if (!md5.isEmpty()) {
+		file.docReadMd5 = std::move(md5);
+	}
 	sendNext();
 }
 
@@ -265,8 +549,25 @@ void Uploader::stopSessions() {
 	}
 }
 
+std::optional<int> Uploader::chooseSession(int size) const {
+	auto todc = 0;
+	for (auto dc = 1; dc != MTP::kUploadSessionsCount; ++dc) {
+		if (sentSizes[dc] < sentSizes[todc]
+			|| (sentSizes[dc] == sentSizes[todc]
+				&& sentRequests[dc] < sentRequests[todc])) {
+			todc = dc;
+		}
+	}
+	if (sentRequests[todc] >= kUploadRequestsPerSession
+		|| (sentSizes[todc] > 0
+			&& sentSizes[todc] + size > kMaxUploadSessionParallelSize)) {
+		return std::nullopt;
+	}
+	return todc;
+}
+
 void Uploader::sendNext() {
-	if (sentSize >= kMaxUploadFileParallelSize || _pausedId.msg) return;
+	if (_pausedId.msg) return;
 
 	bool stopping = stopSessionsTimer.isActive();
 	if (queue.empty()) {
@@ -280,22 +581,37 @@ void Uploader::sendNext() {
 	if (stopping) {
 		stopSessionsTimer.stop();
 	}
-	auto i = uploadingId.msg ? queue.find(uploadingId) : queue.begin();
-	if (!uploadingId.msg) {
-		uploadingId = i->first;
-	} else if (i == queue.end()) {
-		i = queue.begin();
-		uploadingId = i->first;
-	}
-	auto &uploadingData = i->second;
 
-	auto todc = 0;
-	for (auto dc = 1; dc != MTP::kUploadSessionsCount; ++dc) {
-		if (sentSizes[dc] < sentSizes[todc]) {
-			todc = dc;
+	// First files in the queue are uploaded at the same time, serve them
+	// in turns, so that small files don't wait behind a large one.
+	const auto uploadingCount = std::min(
+		int(queue.size()),
+		kMaxUploadingFiles);
+	const auto till = std::next(queue.begin(), uploadingCount);
+	auto i = queue.upper_bound(_lastServedId);
+	for (auto checked = 0; checked != uploadingCount; ++checked, ++i) {
+		if (i == till || i == queue.end()) {
+			i = queue.begin();
+		}
+		const auto msgId = i->first;
+		switch (sendPart(msgId, i->second)) {
+		case SendPartResult::Sent:
+			_lastServedId = msgId;
+			[[fallthrough]];
+		case SendPartResult::Finished:
+			sendNext();
+			return;
+		case SendPartResult::SessionsFull:
+			return;
+		case SendPartResult::Waiting:
+			break;
 		}
 	}
+}
 
+Uploader::SendPartResult Uploader::sendPart(
+		const FullMsgId &msgId,
+		File &uploadingData) {
 	auto &parts = uploadingData.file
 		? ((uploadingData.type() == SendMediaType::Photo
 			|| uploadingData.type() == SendMediaType::Secure)
@@ -310,94 +626,30 @@ void Uploader::sendNext() {
 		: uploadingData.media.thumbId;
 	if (parts.isEmpty()) {
 		if (uploadingData.docSentParts >= uploadingData.docPartsCount) {
-			if (requestsSent.empty() && docRequestsSent.empty()) {
-				const auto silent = uploadingData.file
-					&& uploadingData.file->to.silent;
-				if (uploadingData.type() == SendMediaType::Photo) {
-					auto photoFilename = uploadingData.filename();
-					if (!photoFilename.endsWith(qstr(".jpg"), Qt::CaseInsensitive)) {
-						// Server has some extensions checking for inputMediaUploadedPhoto,
-						// so force the extension to be .jpg anyway. It doesn't matter,
-						// because the filename from inputFile is not used anywhere.
-						photoFilename += qstr(".jpg");
-					}
-					const auto md5 = uploadingData.file
-						? uploadingData.file->filemd5
-						: uploadingData.media.jpeg_md5;
-					const auto file = MTP_inputFile(
-						MTP_long(uploadingData.id()),
-						MTP_int(uploadingData.partsCount),
-						MTP_string(photoFilename),
-						MTP_bytes(md5));
-					_photoReady.fire({ uploadingId, silent, file });
-				} else if (uploadingData.type() == SendMediaType::File
-					|| uploadingData.type() == SendMediaType::WallPaper
-					|| uploadingData.type() == SendMediaType::Audio) {
-					QByteArray docMd5(32, Qt::Uninitialized);
-					hashMd5Hex(uploadingData.md5Hash.result(), docMd5.data());
-
-					const auto file = (uploadingData.docSize > kUseBigFilesFrom)
-						? MTP_inputFileBig(
-							MTP_long(uploadingData.id()),
-							MTP_int(uploadingData.docPartsCount),
-							MTP_string(uploadingData.filename()))
-						: MTP_inputFile(
-							MTP_long(uploadingData.id()),
-							MTP_int(uploadingData.docPartsCount),
-							MTP_string(uploadingData.filename()),
-							MTP_bytes(docMd5));
-					if (uploadingData.partsCount) {
-						const auto thumbFilename = uploadingData.file
-							? uploadingData.file->thumbname
-							: (qsl("thumb.") + uploadingData.media.thumbExt);
-						const auto thumbMd5 = uploadingData.file
-							? uploadingData.file->thumbmd5
-							: uploadingData.media.jpeg_md5;
-						const auto thumb = MTP_inputFile(
-							MTP_long(uploadingData.thumbId()),
-							MTP_int(uploadingData.partsCount),
-							MTP_string(thumbFilename),
-							MTP_bytes(thumbMd5));
-						_thumbDocumentReady.fire({
-							uploadingId,
-							silent,
-							file,
-							thumb });
-					} else {
-						_documentReady.fire({ uploadingId, silent, file });
-					}
-				} else if (uploadingData.type() == SendMediaType::Secure) {
-					_secureReady.fire({
-						uploadingId,
-						uploadingData.id(),
-						uploadingData.partsCount });
-				}
-				queue.erase(uploadingId);
-				uploadingId = FullMsgId();
-				sendNext();
+			if (uploadingData.requestsSent.empty()
+				&& uploadingData.docRequestsSent.empty()) {
+				finished(msgId, uploadingData);
+				return SendPartResult::Finished;
 			}
-			return;
+			return SendPartResult::Waiting;
 		}
 
 		auto &content = uploadingData.file
 			? uploadingData.file->content
 			: uploadingData.media.data;
+		const auto todc = chooseSession(uploadingData.docPartSize);
+		if (!todc) {
+			return SendPartResult::SessionsFull;
+		}
 		QByteArray toSend;
 		if (content.isEmpty()) {
-			if (!uploadingData.docFile) {
-				const auto filepath = uploadingData.file
-					? uploadingData.file->filepath
-					: uploadingData.media.file;
-				uploadingData.docFile = std::make_unique<QFile>(filepath);
-				if (!uploadingData.docFile->open(QIODevice::ReadOnly)) {
-					currentFailed();
-					return;
-				}
-			}
-			toSend = uploadingData.docFile->read(uploadingData.docPartSize);
-			if (uploadingData.docSize <= kUseBigFilesFrom) {
-				uploadingData.md5Hash.feed(toSend.constData(), toSend.size());
+			readNextParts(msgId, uploadingData);
+			if (uploadingData.docReadParts.empty()) {
+				// Waiting for the reader, it will call sendNext().
+				return SendPartResult::Waiting;
 			}
+			toSend = std::move(uploadingData.docReadParts.front());
+			uploadingData.docReadParts.pop_front();
 		} else {
 			const auto offset = uploadingData.docSentParts
 				* uploadingData.docPartSize;
@@ -412,20 +664,20 @@ void Uploader::sendNext() {
 		if ((toSend.size() > uploadingData.docPartSize)
 			|| ((toSend.size() < uploadingData.docPartSize
 				&& uploadingData.docSentParts + 1 != uploadingData.docPartsCount))) {
-			currentFailed();
-			return;
+			failed(msgId);
+			return SendPartResult::Finished;
 		}
 		mtpRequestId requestId;
 		if (uploadingData.docSize > kUseBigFilesFrom) {
 			requestId = MTP::send(
 				MTPupload_SaveBigFilePart(
-					MTP_long(uploadingData.id()),
+					MTP_long(uploadingData.docFileId),
 					MTP_int(uploadingData.docSentParts),
 					MTP_int(uploadingData.docPartsCount),
 					MTP_bytes(toSend)),
 				rpcDone(&Uploader::partLoaded),
 				rpcFail(&Uploader::partFailed),
-				MTP::uploadDcId(todc));
+				MTP::uploadDcId(*todc));
 		} else {
 			requestId = MTP::send(
 				MTPupload_SaveFilePart(
@@ -434,17 +686,24 @@ void Uploader::sendNext() {
 					MTP_bytes(toSend)),
 				rpcDone(&Uploader::partLoaded),
 				rpcFail(&Uploader::partFailed),
-				MTP::uploadDcId(todc));
+				MTP::uploadDcId(*todc));
 		}
-		docRequestsSent.emplace(requestId, uploadingData.docSentParts);
-		dcMap.emplace(requestId, todc);
-		sentSize += uploadingData.docPartSize;
-		sentSizes[todc] += uploadingData.docPartSize;
+		uploadingData.docRequestsSent.emplace(
+			requestId,
+			uploadingData.docSentParts);
+		requestFiles.emplace(requestId, msgId);
+		dcMap.emplace(requestId, *todc);
+		sentSizes[*todc] += uploadingData.docPartSize;
+		++sentRequests[*todc];
 
 		uploadingData.docSentParts++;
 	} else {
 		auto part = parts.begin();
 
+		const auto todc = chooseSession(part.value().size());
+		if (!todc) {
+			return SendPartResult::SessionsFull;
+		}
 		const auto requestId = MTP::send(
 			MTPupload_SaveFilePart(
 				MTP_long(partsOfId),
@@ -452,23 +711,97 @@ void Uploader::sendNext() {
 				MTP_bytes(part.value())),
 			rpcDone(&Uploader::partLoaded),
 			rpcFail(&Uploader::partFailed),
-			MTP::uploadDcId(todc));
-		requestsSent.emplace(requestId, part.value());
-		dcMap.emplace(requestId, todc);
-		sentSize += part.value().size();
-		sentSizes[todc] += part.value().size();
+			MTP::uploadDcId(*todc));
+		uploadingData.requestsSent.emplace(requestId, part.value());
+		requestFiles.emplace(requestId, msgId);
+		dcMap.emplace(requestId, *todc);
+		sentSizes[*todc] += part.value().size();
+		++sentRequests[*todc];
 
 		parts.erase(part);
 	}
-	nextTimer.start(kUploadRequestInterval);
+	return SendPartResult::Sent;
+}
+
+void Uploader::finished(const FullMsgId &msgId, File &uploadingData) {
+	const auto silent = uploadingData.file
+		&& uploadingData.file->to.silent;
+	if (uploadingData.type() == SendMediaType::Photo) {
+		auto photoFilename = uploadingData.filename();
+		if (!photoFilename.endsWith(qstr(".jpg"), Qt::CaseInsensitive)) {
+			// Server has some extensions checking for inputMediaUploadedPhoto,
+			// so force the extension to be .jpg anyway. It doesn't matter,
+			// because the filename from inputFile is not used anywhere.
+			photoFilename += qstr(".jpg");
+		}
+		const auto md5 = uploadingData.file
+			? uploadingData.file->filemd5
+			: uploadingData.media.jpeg_md5;
+		const auto file = MTP_inputFile(
+			MTP_long(uploadingData.id()),
+			MTP_int(uploadingData.partsCount),
+			MTP_string(photoFilename),
+			MTP_bytes(md5));
+		_photoReady.fire({ msgId, silent, file });
+	} else if (uploadingData.type() == SendMediaType::File
+		|| uploadingData.type() == SendMediaType::WallPaper
+		|| uploadingData.type() == SendMediaType::Audio) {
+		auto docMd5 = uploadingData.docReadMd5;
+		if (docMd5.isEmpty()) {
+			docMd5 = QByteArray(32, Qt::Uninitialized);
+			hashMd5Hex(
+				uploadingData.md5Hash.result(),
+				docMd5.data());
+		}
+
+		const auto file = (uploadingData.docSize > kUseBigFilesFrom)
+			? MTP_inputFileBig(
+				MTP_long(uploadingData.docFileId),
+				MTP_int(uploadingData.docPartsCount),
+				MTP_string(uploadingData.filename()))
+			: MTP_inputFile(
+				MTP_long(uploadingData.id()),
+				MTP_int(uploadingData.docPartsCount),
+				MTP_string(uploadingData.filename()),
+				MTP_bytes(docMd5));
+		if (uploadingData.partsCount) {
+			const auto thumbFilename = uploadingData.file
+				? uploadingData.file->thumbname
+				: (qsl("thumb.") + uploadingData.media.thumbExt);
+			const auto thumbMd5 = uploadingData.file
+				? uploadingData.file->thumbmd5
+				: uploadingData.media.jpeg_md5;
+			const auto thumb = MTP_inputFile(
+				MTP_long(uploadingData.thumbId()),
+				MTP_int(uploadingData.partsCount),
+				MTP_string(thumbFilename),
+				MTP_bytes(thumbMd5));
+			_thumbDocumentReady.fire({
+				msgId,
+				silent,
+				file,
+				thumb });
+		} else {
+			_documentReady.fire({ msgId, silent, file });
+		}
+	} else if (uploadingData.type() == SendMediaType::Secure) {
+		_secureReady.fire({
+			msgId,
+			uploadingData.id(),
+			uploadingData.partsCount });
+	}
+	forgetUploadProgress(uploadingData);
+	queue.erase(msgId);
 }
 
 void Uploader::cancel(const FullMsgId &msgId) {
 	uploaded.erase(msgId);
-	if (uploadingId == msgId) {
-		currentFailed();
-	} else {
-		queue.erase(msgId);
+	const auto i = queue.find(msgId);
+	if (i != queue.end()) {
+		forgetUploadProgress(i->second);
+		cancelRequests(i->second);
+		queue.erase(i);
+		sendNext();
 	}
 }
 
@@ -486,84 +819,79 @@ void Uploader::confirm(const FullMsgId &msgId) {
 
 void Uploader::clear() {
 	uploaded.clear();
-	queue.clear();
-	for (const auto &requestData : requestsSent) {
-		MTP::cancel(requestData.first);
+	for (auto &[msgId, file] : queue) {
+		cancelRequests(file);
 	}
-	requestsSent.clear();
-	for (const auto &requestData : docRequestsSent) {
-		MTP::cancel(requestData.first);
-	}
-	docRequestsSent.clear();
+	queue.clear();
+	requestFiles.clear();
 	dcMap.clear();
-	sentSize = 0;
 	for (int i = 0; i < MTP::kUploadSessionsCount; ++i) {
 		MTP::stopSession(MTP::uploadDcId(i));
 		sentSizes[i] = 0;
+		sentRequests[i] = 0;
 	}
 	stopSessionsTimer.stop();
 }
 
 void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
-	auto j = docRequestsSent.end();
-	auto i = requestsSent.find(requestId);
-	if (i == requestsSent.cend()) {
-		j = docRequestsSent.find(requestId);
-	}
-	if (i != requestsSent.cend() || j != docRequestsSent.cend()) {
-		if (mtpIsFalse(result)) { // failed to upload current file
-			currentFailed();
-			return;
-		} else {
-			auto dcIt = dcMap.find(requestId);
-			if (dcIt == dcMap.cend()) { // must not happen
-				currentFailed();
-				return;
-			}
-			auto dc = dcIt->second;
-			dcMap.erase(dcIt);
-
-			int32 sentPartSize = 0;
-			auto k = queue.find(uploadingId);
-			Assert(k != queue.cend());
-			auto &[fullId, file] = *k;
-			if (i != requestsSent.cend()) {
-				sentPartSize = i->second.size();
-				requestsSent.erase(i);
-			} else {
-				sentPartSize = file.docPartSize;
-				docRequestsSent.erase(j);
-			}
-			sentSize -= sentPartSize;
-			sentSizes[dc] -= sentPartSize;
-			if (file.type() == SendMediaType::Photo) {
-				file.fileSentSize += sentPartSize;
-				const auto photo = Auth().data().photo(file.id());
-				if (photo->uploading() && file.file) {
-					photo->uploadingData->size = file.file->partssize;
-					photo->uploadingData->offset = file.fileSentSize;
-				}
-				_photoProgress.fire_copy(fullId);
-			} else if (file.type() == SendMediaType::File
-				|| file.type() == SendMediaType::WallPaper
-				|| file.type() == SendMediaType::Audio) {
-				const auto document = Auth().data().document(file.id());
-				if (document->uploading()) {
-					const auto doneParts = file.docSentParts
-						- int(docRequestsSent.size());
-					document->uploadingData->offset = std::min(
-						document->uploadingData->size,
-						doneParts * file.docPartSize);
-				}
-				_documentProgress.fire_copy(fullId);
-			} else if (file.type() == SendMediaType::Secure) {
-				file.fileSentSize += sentPartSize;
-				_secureProgress.fire_copy({
-					fullId,
-					file.fileSentSize,
-					file.file->partssize });
-			}
+	const auto owner = requestFiles.find(requestId);
+	const auto k = (owner != requestFiles.end())
+		? queue.find(owner->second)
+		: queue.end();
+	if (k == queue.end()) {
+		sendNext();
+		return;
+	}
+	const auto fullId = k->first;
+	auto &file = k->second;
+	const auto i = file.requestsSent.find(requestId);
+	const auto j = file.docRequestsSent.find(requestId);
+	if (i == file.requestsSent.end() && j == file.docRequestsSent.end()) {
+		sendNext();
+		return;
+	} else if (mtpIsFalse(result)) { // failed to upload current file
+		failed(fullId);
+		return;
+	}
+	auto sentPartSize = 0;
+	if (i != file.requestsSent.end()) {
+		sentPartSize = i->second.size();
+		file.requestsSent.erase(i);
+	} else {
+		sentPartSize = file.docPartSize;
+		file.docRequestsSent.erase(j);
+	}
+	if (requestDone(requestId, sentPartSize) < 0) { // must not happen
+		failed(fullId);
+		return;
+	}
+	if (file.type() == SendMediaType::Photo) {
+		file.fileSentSize += sentPartSize;
+		const auto photo = Auth().data().photo(file.id());
+		if (photo->uploading() && file.file) {
+			photo->uploadingData->size = file.file->partssize;
+			photo->uploadingData->offset = file.fileSentSize;
 		}
+		_photoProgress.fire_copy(fullId);
+	} else if (file.type() == SendMediaType::File
+		|| file.type() == SendMediaType::WallPaper
+		|| file.type() == SendMediaType::Audio) {
+		const auto document = Auth().data().document(file.id());
+		if (document->uploading()) {
+			const auto doneParts = file.docSentParts
+				- int(file.docRequestsSent.size());
+			document->uploadingData->offset = std::min(
+				document->uploadingData->size,
+				doneParts * file.docPartSize);
+		}
+		saveUploadProgress(file);
+		_documentProgress.fire_copy(fullId);
+	} else if (file.type() == SendMediaType::Secure) {
+		file.fileSentSize += sentPartSize;
+		_secureProgress.fire_copy({
+			fullId,
+			file.fileSentSize,
+			file.file->partssize });
 	}
 
 	sendNext();
@@ -573,15 +901,20 @@ bool Uploader::partFailed(const RPCError &error, mtpRequestId requestId) {
 	if (MTP::isDefaultHandledError(error)) return false;
 
 	// failed to upload current file
-	if ((requestsSent.find(requestId) != requestsSent.cend())
-		|| (docRequestsSent.find(requestId) != docRequestsSent.cend())) {
-		currentFailed();
+	const auto owner = requestFiles.find(requestId);
+	if (owner != requestFiles.end()) {
+		const auto msgId = owner->second;
+		failed(msgId);
+	} else {
+		sendNext();
 	}
-	sendNext();
 	return true;
 }
 
 Uploader::~Uploader() {
+	if (_writeResumableUploadsTimer.isActive()) {
+		writeResumableUploads();
+	}
 	clear();
 }
 
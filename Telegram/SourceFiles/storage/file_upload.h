@@ -7,6 +7,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include "base/timer.h"
+
 struct FileLoadResult;
 struct SendMediaReady;
 
@@ -46,6 +48,18 @@ struct UploadSecureDone {
 	int partsCount = 0;
 };
 
+// Progress of a big file upload from the disk, saved in the local
+// storage, so that sending the same file again continues the upload.
+struct ResumableUpload {
+	QString path;
+	int64 size = 0;
+	QDateTime modified;
+	uint64 fileId = 0;
+	int32 partSize = 0;
+	int32 partsDone = 0;
+	TimeId saved = 0;
+};
+
 class Uploader : public QObject, public RPCSender {
 	Q_OBJECT
 
@@ -105,23 +119,51 @@ public slots:
 
 private:
 	struct File;
-
+	enum class SendPartResult {
+		Sent,
+		Waiting,
+		SessionsFull,
+		Finished,
+	};
+
+	std::optional<int> chooseSession(int size) const;
+	SendPartResult sendPart(const FullMsgId &msgId, File &file);
+	void finished(const FullMsgId &msgId, File &file);
+	void failed(const FullMsgId &msgId);
+	void cancelRequests(File &file);
+
+	// Returns the session index of the request or -1 if not found.
+	int requestDone(mtpRequestId requestId, int size);
+
+	void resumeUpload(File &file);
+	void saveUploadProgress(const File &file);
+	void forgetUploadProgress(const File &file);
+	std::vector<ResumableUpload> &resumableUploads();
+	void writeResumableUploads();
+
+	void readNextParts(const FullMsgId &msgId, File &file);
+	void partRead(
+		const FullMsgId &msgId,
+		uint64 readerId,
+		QByteArray &&part,
+		QByteArray &&md5);
 	void partLoaded(const MTPBool &result, mtpRequestId requestId);
 	bool partFailed(const RPCError &err, mtpRequestId requestId);
 
-	void currentFailed();
-
-	base::flat_map<mtpRequestId, QByteArray> requestsSent;
-	base::flat_map<mtpRequestId, int32> docRequestsSent;
+	base::flat_map<mtpRequestId, FullMsgId> requestFiles;
 	base::flat_map<mtpRequestId, int32> dcMap;
-	uint32 sentSize = 0;
-	uint32 sentSizes[MTP::kUploadSessionsCount] = { 0 };
+	int sentSizes[MTP::kUploadSessionsCount] = { 0 };
+	int sentRequests[MTP::kUploadSessionsCount] = { 0 };
+	uint64 _lastDocReaderId = 0;
+
+	std::optional<std::vector<ResumableUpload>> _resumableUploads;
+	base::Timer _writeResumableUploadsTimer;
 
-	FullMsgId uploadingId;
+	FullMsgId _lastServedId;
 	FullMsgId _pausedId;
 	std::map<FullMsgId, File> queue;
 	std::map<FullMsgId, File> uploaded;
-	QTimer nextTimer, stopSessionsTimer;
+	QTimer stopSessionsTimer;
 
 	rpl::event_stream<UploadedPhoto> _photoReady;
 	rpl::event_stream<UploadedDocument> _documentReady;
@@ -20,6 +20,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "boxes/confirm_box.h"
 #include "storage/file_download.h"
 #include "storage/storage_media_prepare.h"
+#include "base/perf_counters.h"
 
 namespace {
 
@@ -27,6 +28,8 @@ constexpr auto kThumbnailQuality = 87;
 constexpr auto kThumbnailSize = 320;
 constexpr auto kPhotoUploadPartSize = 32 * 1024;
 
+base::perf::Histogram TasksWaiting("task_queue.waiting");
+
 using Storage::ValidateThumbDimensions;
 
 struct PreparedFileThumbnail {
@@ -299,7 +302,14 @@ SendMediaReady PrepareWallPaper(const QImage &image) {
 		0);
 }
 
-TaskQueue::TaskQueue(TimeMs stopTimeoutMs) {
+TaskQueue::TaskQueue(
+	TimeMs stopTimeoutMs,
+	QThread::Priority priority,
+	int threadsCount)
+: _priority(priority)
+, _threadsCount(threadsCount) {
+	Expects(_threadsCount > 0);
+
 	if (stopTimeoutMs > 0) {
 		_stopTimer = new QTimer(this);
 		connect(_stopTimer, SIGNAL(timeout()), this, SLOT(stop()));
@@ -312,10 +322,12 @@ TaskId TaskQueue::addTask(std::unique_ptr<Task> &&task) {
 	const auto result = task->id();
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
+		_tasksOrder.push_back(result);
 		_tasksToProcess.push_back(std::move(task));
+		TasksWaiting.add(_tasksToProcess.size());
 	}
 
-	wakeThread();
+	wakeThreads();
 
 	return result;
 }
@@ -324,29 +336,53 @@ void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		for (auto &task : tasks) {
+			_tasksOrder.push_back(task->id());
 			_tasksToProcess.push_back(std::move(task));
 		}
+		TasksWaiting.add(_tasksToProcess.size());
 	}
 
-	wakeThread();
+	wakeThreads();
 }
 
-void TaskQueue::wakeThread() {
-	if (!_thread) {
-		_thread = new QThread();
+void TaskQueue::wakeThreads() {
+	if (_threads.empty()) {
+		_threads.reserve(_threadsCount);
+		for (auto i = 0; i != _threadsCount; ++i) {
+			auto thread = Thread();
+			thread.thread = new QThread();
 
-		_worker = new TaskQueueWorker(this);
-		_worker->moveToThread(_thread);
+			thread.worker = new TaskQueueWorker(this);
+			thread.worker->moveToThread(thread.thread);
 
-		connect(this, SIGNAL(taskAdded()), _worker, SLOT(onTaskAdded()));
-		connect(_worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
+			connect(this, SIGNAL(taskAdded()), thread.worker, SLOT(onTaskAdded()));
+			connect(thread.worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
 
-		_thread->start();
+			thread.thread->start(_priority);
+			_threads.push_back(thread);
+		}
 	}
 	if (_stopTimer) _stopTimer->stop();
 	emit taskAdded();
 }
 
+bool TaskQueue::moveProcessedToFinish() {
+	QMutexLocker lock(&_tasksToFinishMutex);
+	const auto wasEmpty = _tasksToFinish.empty();
+	auto moved = false;
+	while (!_tasksOrder.empty()) {
+		const auto i = _tasksProcessed.find(_tasksOrder.front());
+		if (i == _tasksProcessed.end()) {
+			break;
+		}
+		_tasksToFinish.push_back(std::move(i->second));
+		_tasksProcessed.erase(i);
+		_tasksOrder.pop_front();
+		moved = true;
+	}
+	return wasEmpty && moved;
+}
+
 void TaskQueue::cancelTask(TaskId id) {
 	const auto removeFrom = [&](std::deque<std::unique_ptr<Task>> &queue) {
 		const auto proj = [](const std::unique_ptr<Task> &task) {
@@ -357,15 +393,34 @@ void TaskQueue::cancelTask(TaskId id) {
 			queue.erase(i);
 		}
 	};
+	auto finishReady = false;
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		removeFrom(_tasksToProcess);
-		if (_taskInProcessId == id) {
-			_taskInProcessId = TaskId();
+		_tasksProcessed.remove(id);
+		const auto i = ranges::find(_tasksInProcess, id);
+		if (i != _tasksInProcess.end()) {
+			_tasksInProcess.erase(i);
+		}
+		const auto j = ranges::find(_tasksOrder, id);
+		if (j != _tasksOrder.end()) {
+			const auto wasFirst = (j == _tasksOrder.begin());
+			_tasksOrder.erase(j);
+
+			// Tasks processed after the cancelled one may be finished now.
+			finishReady = wasFirst && moveProcessedToFinish();
 		}
 	}
-	QMutexLocker lock(&_tasksToFinishMutex);
-	removeFrom(_tasksToFinish);
+	{
+		QMutexLocker lock(&_tasksToFinishMutex);
+		removeFrom(_tasksToFinish);
+	}
+	if (finishReady) {
+		QMetaObject::invokeMethod(
+			this,
+			"onTaskProcessed",
+			Qt::QueuedConnection);
+	}
 }
 
 void TaskQueue::onTaskProcessed() {
@@ -382,24 +437,31 @@ void TaskQueue::onTaskProcessed() {
 
 	if (_stopTimer) {
 		QMutexLocker lock(&_tasksToProcessMutex);
-		if (_tasksToProcess.empty() && !_taskInProcessId) {
+		if (_tasksOrder.empty()) {
 			_stopTimer->start();
 		}
 	}
 }
 
 void TaskQueue::stop() {
-	if (_thread) {
-		_thread->requestInterruption();
-		_thread->quit();
+	if (!_threads.empty()) {
+		for (const auto &thread : _threads) {
+			thread.thread->requestInterruption();
+			thread.thread->quit();
+		}
 		DEBUG_LOG(("Waiting for taskThread to finish"));
-		_thread->wait();
-		delete base::take(_worker);
-		delete base::take(_thread);
+		for (const auto &thread : _threads) {
+			thread.thread->wait();
+			delete thread.worker;
+			delete thread.thread;
+		}
+		_threads.clear();
 	}
 	_tasksToProcess.clear();
 	_tasksToFinish.clear();
-	_taskInProcessId = TaskId();
+	_tasksProcessed.clear();
+	_tasksOrder.clear();
+	_tasksInProcess.clear();
 }
 
 TaskQueue::~TaskQueue() {
@@ -419,7 +481,7 @@ void TaskQueueWorker::onTaskAdded() {
 			if (!_queue->_tasksToProcess.empty()) {
 				task = std::move(_queue->_tasksToProcess.front());
 				_queue->_tasksToProcess.pop_front();
-				_queue->_taskInProcessId = task->id();
+				_queue->_tasksInProcess.push_back(task->id());
 			}
 		}
 
@@ -428,14 +490,15 @@ void TaskQueueWorker::onTaskAdded() {
 			bool emitTaskProcessed = false;
 			{
 				QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
-				if (_queue->_taskInProcessId == task->id()) {
-					_queue->_taskInProcessId = TaskId();
-					someTasksLeft = !_queue->_tasksToProcess.empty();
-
-					QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
-					emitTaskProcessed = _queue->_tasksToFinish.empty();
-					_queue->_tasksToFinish.push_back(std::move(task));
+				auto &inProcess = _queue->_tasksInProcess;
+				const auto i = ranges::find(inProcess, task->id());
+				if (i != inProcess.end()) {
+					inProcess.erase(i);
+					const auto id = task->id();
+					_queue->_tasksProcessed.emplace(id, std::move(task));
+					emitTaskProcessed = _queue->moveProcessedToFinish();
 				}
+				someTasksLeft = !_queue->_tasksToProcess.empty();
 			}
 			if (emitTaskProcessed) {
 				emit taskProcessed();
@@ -859,15 +922,23 @@ void FileLoadTask::process() {
 			if (isAnimation) {
 				attributes.push_back(MTP_documentAttributeAnimated());
 			} else if (_type != SendMediaType::File) {
-				auto thumb = (w > 100 || h > 100) ? fullimage.scaled(100, 100, Qt::KeepAspectRatio, Qt::SmoothTransformation) : fullimage;
+				// Each smaller size is scaled from the previous one,
+				// so a large original is scaled down only once.
+				const auto scaled = [](const QImage &image, int size) {
+					return (image.width() > size || image.height() > size)
+						? image.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation)
+						: image;
+				};
+				auto full = scaled(fullimage, 1280);
+				auto medium = scaled(full, 320);
+				auto thumb = scaled(medium, 100);
+
 				photoThumbs.emplace('s', thumb);
 				photoSizes.push_back(MTP_photoSize(MTP_string("s"), MTP_fileLocationUnavailable(MTP_long(0), MTP_int(0), MTP_long(0)), MTP_int(thumb.width()), MTP_int(thumb.height()), MTP_int(0)));
 
-				auto medium = (w > 320 || h > 320) ? fullimage.scaled(320, 320, Qt::KeepAspectRatio, Qt::SmoothTransformation) : fullimage;
 				photoThumbs.emplace('m', medium);
 				photoSizes.push_back(MTP_photoSize(MTP_string("m"), MTP_fileLocationUnavailable(MTP_long(0), MTP_int(0), MTP_long(0)), MTP_int(medium.width()), MTP_int(medium.height()), MTP_int(0)));
 
-				auto full = (w > 1280 || h > 1280) ? fullimage.scaled(1280, 1280, Qt::KeepAspectRatio, Qt::SmoothTransformation) : fullimage;
 				photoThumbs.emplace('y', full);
 				photoSizes.push_back(MTP_photoSize(MTP_string("y"), MTP_fileLocationUnavailable(MTP_long(0), MTP_int(0), MTP_long(0)), MTP_int(full.width()), MTP_int(full.height()), MTP_int(0)));
 
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/variant.h"
+#include "base/flat_map.h"
 
 enum class CompressConfirm {
 	Auto,
@@ -105,7 +106,12 @@ class TaskQueue : public QObject {
 	Q_OBJECT
 
 public:
-	explicit TaskQueue(TimeMs stopTimeoutMs = 0); // <= 0 - never stop worker
+	// Tasks are processed by up to threadsCount threads at once,
+	// but finish() is always called in the order of addition.
+	explicit TaskQueue(
+		TimeMs stopTimeoutMs = 0, // <= 0 - never stop worker
+		QThread::Priority priority = QThread::InheritPriority,
+		int threadsCount = 1);
 
 	TaskId addTask(std::unique_ptr<Task> &&task);
 	void addTasks(std::vector<std::unique_ptr<Task>> &&tasks);
@@ -123,14 +129,25 @@ public slots:
 private:
 	friend class TaskQueueWorker;
 
-	void wakeThread();
+	struct Thread {
+		QThread *thread = nullptr;
+		TaskQueueWorker *worker = nullptr;
+	};
+
+	void wakeThreads();
+
+	// Must be locked: _tasksToProcessMutex.
+	bool moveProcessedToFinish();
 
 	std::deque<std::unique_ptr<Task>> _tasksToProcess;
 	std::deque<std::unique_ptr<Task>> _tasksToFinish;
-	TaskId _taskInProcessId = TaskId();
+	base::flat_map<TaskId, std::unique_ptr<Task>> _tasksProcessed;
+	std::deque<TaskId> _tasksOrder;
+	std::vector<TaskId> _tasksInProcess;
 	QMutex _tasksToProcessMutex, _tasksToFinishMutex;
-	QThread *_thread = nullptr;
-	TaskQueueWorker *_worker = nullptr;
+	std::vector<Thread> _threads;
+	QThread::Priority _priority = QThread::InheritPriority;
+	int _threadsCount = 1;
 	QTimer *_stopTimer = nullptr;
 
 };
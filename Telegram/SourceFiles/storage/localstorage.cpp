@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/serialize_common.h"
 #include "storage/storage_encrypted_file.h"
 #include "storage/storage_clear_legacy.h"
+#include "storage/file_upload.h"
 #include "chat_helpers/stickers.h"
 #include "data/data_drafts.h"
 #include "data/data_user.h"
@@ -21,6 +22,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/export_settings.h"
 #include "core/crash_reports.h"
 #include "core/update_checker.h"
+#include "core/startup_trace.h"
 #include "observer_peer.h"
 #include "mainwidget.h"
 #include "mainwindow.h"
@@ -48,6 +50,12 @@ constexpr auto kFileLoaderQueueStopTimeout = TimeMs(5000);
 constexpr auto kDefaultStickerInstallDate = TimeId(1);
 constexpr auto kProxyTypeShift = 1024;
 constexpr auto kWriteMapTimeout = TimeMs(1000);
+constexpr auto kWriteStickersTimeout = TimeMs(3000);
+
+// Locations journal is compacted into the full locations file
+// when it has more records than a quarter of all locations.
+constexpr auto kLocationsJournalMinCompactRecords = 1024;
+constexpr auto kLocationsJournalCompactDivider = 4;
 constexpr auto kSavedBackgroundFormat = QImage::Format_ARGB32_Premultiplied;
 
 constexpr auto kWallPaperLegacySerializeTagId = int32(-111);
@@ -98,6 +106,20 @@ enum class FileOption {
 using FileOptions = base::flags<FileOption>;
 inline constexpr auto is_flag_type(FileOption) { return true; };
 
+enum class StickersFile {
+	Installed = (1 << 0),
+	Featured = (1 << 1),
+	Recent = (1 << 2),
+	Faved = (1 << 3),
+	Archived = (1 << 4),
+};
+using StickersFiles = base::flags<StickersFile>;
+inline constexpr auto is_flag_type(StickersFile) { return true; };
+
+// Sticker sets are often changed several times in a row (each received
+// set, each reorder), so their files are written once after a delay.
+StickersFiles _stickersToWrite;
+
 bool keyAlreadyUsed(QString &name, FileOptions options = FileOption::User | FileOption::Safe) {
 	name += '0';
 	if (QFileInfo(name).exists()) return true;
@@ -162,9 +184,27 @@ auto SettingsKey = MTP::AuthKeyPtr();
 auto PassKey = MTP::AuthKeyPtr();
 auto LocalKey = MTP::AuthKeyPtr();
 
-void createLocalKey(const QByteArray &pass, QByteArray *salt, MTP::AuthKeyPtr *result) {
+// Key derived by preparePasscode() in the background.
+struct DerivedPassKey {
+	QByteArray pass;
+	QByteArray salt;
+	MTP::AuthKeyPtr key;
+};
+auto DerivedPass = DerivedPassKey();
+
+// Salt of the map that could not be read without the passcode.
+auto PassNeededSalt = QByteArray();
+
+MTP::AuthKeyPtr deriveLocalKey(const QByteArray &pass, const QByteArray &salt) {
 	auto key = MTP::AuthKey::Data { { gsl::byte{} } };
 	auto iterCount = pass.size() ? LocalEncryptIterCount : LocalEncryptNoPwdIterCount; // dont slow down for no password
+
+	PKCS5_PBKDF2_HMAC_SHA1(pass.constData(), pass.size(), (const uchar*)salt.constData(), salt.size(), iterCount, key.size(), (uchar*)key.data());
+
+	return std::make_shared<MTP::AuthKey>(key);
+}
+
+void createLocalKey(const QByteArray &pass, QByteArray *salt, MTP::AuthKeyPtr *result) {
 	auto newSalt = QByteArray();
 	if (!salt) {
 		newSalt.resize(LocalEncryptSaltSize);
@@ -172,11 +212,13 @@ void createLocalKey(const QByteArray &pass, QByteArray *salt, MTP::AuthKeyPtr *r
 		salt = &newSalt;
 
 		cSetLocalSalt(newSalt);
+	} else if (DerivedPass.key
+		&& DerivedPass.pass == pass
+		&& DerivedPass.salt == *salt) {
+		*result = base::take(DerivedPass).key;
+		return;
 	}
-
-	PKCS5_PBKDF2_HMAC_SHA1(pass.constData(), pass.size(), (uchar*)salt->data(), salt->size(), iterCount, key.size(), (uchar*)key.data());
-
-	*result = std::make_shared<MTP::AuthKey>(key);
+	*result = deriveLocalKey(pass, *salt);
 }
 
 struct FileReadDescriptor {
@@ -523,6 +565,7 @@ enum { // Local Storage Keys
 	lskExportSettings = 0x13, // no data
 	lskBackground = 0x14, // no data
 	lskSelfSerialized = 0x15, // serialized self
+	lskResumableUploads = 0x16, // no data
 };
 
 enum {
@@ -631,6 +674,10 @@ DraftsMap _draftsMap, _draftCursorsMap;
 typedef QMap<PeerId, bool> DraftsNotReadMap;
 DraftsNotReadMap _draftsNotReadMap;
 
+// Drafts are written again on each chat switch, even if nothing changed.
+// Not encrypted contents of the last written drafts files by peer.
+QMap<PeerId, QByteArray> _draftsWrittenData;
+
 typedef QPair<FileKey, qint32> FileDesc; // file, size
 
 typedef QMultiMap<MediaKey, FileLocation> FileLocations;
@@ -670,6 +717,7 @@ qint64 _cacheTotalSizeLimit = Database::Settings().totalSizeLimit;
 qint32 _cacheTotalTimeLimit = Database::Settings().totalTimeLimit;
 
 FileKey _exportSettingsKey = 0;
+FileKey _resumableUploadsKey = 0;
 
 FileKey _savedPeersKey = 0;
 FileKey _langPackKey = 0;
@@ -694,16 +742,161 @@ AuthSessionSettings &GetStoredAuthSessionCache() {
 
 void _writeMap(WriteMapWhen when = WriteMapWhen::Soon);
 
+void _ensureLocationsRead();
+
+// Single file changes are appended to the journal and the full
+// locations file is rewritten only when the journal is compacted.
+enum class LocationsJournalRecord : quint32 {
+	Write = 1,
+	Remove = 2,
+};
+
+int _locationsJournalRecords = 0;
+
+QString _locationsJournalPath(const QString &basePath, FileKey key) {
+	return basePath + toFilePart(key) + 'j';
+}
+
+void _clearLocationsJournal() {
+	if (_locationsKey && _userWorking()) {
+		QFile::remove(_locationsJournalPath(_userBasePath, _locationsKey));
+	}
+	_locationsJournalRecords = 0;
+}
+
+// Returns true if the locations were changed.
+bool _applyFileLocation(
+		FileLocations &locations,
+		FileLocationPairs &pairs,
+		FileLocationAliases &aliases,
+		MediaKey location,
+		const FileLocation &local) {
+	FileLocationAliases::const_iterator aliasIt = aliases.constFind(location);
+	if (aliasIt != aliases.cend()) {
+		location = aliasIt.value();
+	}
+
+	FileLocationPairs::iterator i = pairs.find(local.fname);
+	if (i != pairs.cend()) {
+		if (i.value().second == local) {
+			if (i.value().first != location) {
+				aliases.insert(location, i.value().first);
+				return true;
+			}
+			return false;
+		}
+		if (i.value().first != location) {
+			for (FileLocations::iterator j = locations.find(i.value().first), e = locations.end(); (j != e) && (j.key() == i.value().first);) {
+				if (j.value() == i.value().second) {
+					locations.erase(j);
+					break;
+				}
+			}
+			pairs.erase(i);
+		}
+	}
+	locations.insert(location, local);
+	pairs.insert(local.fname, FileLocationPair(location, local));
+	return true;
+}
+
+void _removeFileLocation(
+		FileLocations &locations,
+		FileLocationPairs &pairs,
+		MediaKey location,
+		const QString &fname) {
+	for (FileLocations::iterator i = locations.find(location); (i != locations.end()) && (i.key() == location); ++i) {
+		if (i.value().fname == fname) {
+			pairs.remove(fname);
+			locations.erase(i);
+			return;
+		}
+	}
+}
+
+void _writeLocations(WriteMapWhen when);
+
+void _appendLocationsJournal(EncryptedDescriptor &data) {
+	if (!_userWorking()) return;
+
+	if (!_locationsKey) {
+		// Nothing to append to, write the full locations file.
+		_writeLocations(WriteMapWhen::Fast);
+		return;
+	}
+	QFile file(_locationsJournalPath(_userBasePath, _locationsKey));
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		LOG(("App Error: could not open locations journal for writing."));
+		_writeLocations(WriteMapWhen::Fast);
+		return;
+	}
+	if (!file.size()) {
+		file.write(tdfMagic, tdfMagicLen);
+		qint32 version = AppVersion;
+		file.write((const char*)&version, sizeof(version));
+	}
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_1);
+	stream << FileWriteDescriptor::prepareEncrypted(data);
+	stream.setDevice(nullptr);
+	file.close();
+
+	const auto compactRecords = std::max(
+		kLocationsJournalMinCompactRecords,
+		_fileLocations.size() / kLocationsJournalCompactDivider);
+	if (++_locationsJournalRecords >= compactRecords) {
+		_writeLocations(WriteMapWhen::Soon);
+	}
+}
+
+void _appendLocationsJournalWrite(
+		MediaKey location,
+		const FileLocation &local) {
+	const auto size = sizeof(quint32)
+		+ sizeof(quint64) * 2
+		+ Serialize::stringSize(local.name())
+		+ Serialize::bytearraySize(local.bookmark())
+		+ Serialize::dateTimeSize()
+		+ sizeof(quint32);
+	EncryptedDescriptor data(size);
+	data.stream
+		<< quint32(LocationsJournalRecord::Write)
+		<< quint64(location.first)
+		<< quint64(location.second)
+		<< local.name()
+		<< local.bookmark()
+		<< local.modified
+		<< quint32(local.size);
+	_appendLocationsJournal(data);
+}
+
+void _appendLocationsJournalRemove(
+		MediaKey location,
+		const QString &fname) {
+	const auto size = sizeof(quint32)
+		+ sizeof(quint64) * 2
+		+ Serialize::stringSize(fname);
+	EncryptedDescriptor data(size);
+	data.stream
+		<< quint32(LocationsJournalRecord::Remove)
+		<< quint64(location.first)
+		<< quint64(location.second)
+		<< fname;
+	_appendLocationsJournal(data);
+}
+
 void _writeLocations(WriteMapWhen when = WriteMapWhen::Soon) {
 	if (when != WriteMapWhen::Now) {
 		_manager->writeLocations(when == WriteMapWhen::Fast);
 		return;
 	}
+	_ensureLocationsRead();
 	if (!_working()) return;
 
 	_manager->writingLocations();
 	if (_fileLocations.isEmpty()) {
 		if (_locationsKey) {
+			_clearLocationsJournal();
 			clearKey(_locationsKey);
 			_locationsKey = 0;
 			_mapChanged = true;
@@ -763,15 +956,116 @@ void _writeLocations(WriteMapWhen when = WriteMapWhen::Soon) {
 
 		FileWriteDescriptor file(_locationsKey);
 		file.writeEncrypted(data);
+		file.finish();
+
+		// All the journal records are in the full file now.
+		_clearLocationsJournal();
 	}
 }
 
-void _readLocations() {
+struct LocationsRead {
+	FileLocations locations;
+	FileLocationPairs pairs;
+	FileLocationAliases aliases;
+	std::vector<quint64> webLocationKeys;
+	int journalRecords = 0;
+	bool failed = false;
+	QSemaphore ready;
+};
+
+// File locations can be many and they are not needed for the first
+// frame, so they are read in background and waited for on first access.
+std::shared_ptr<LocationsRead> _locationsRead;
+
+void _readLocationsJournal(
+		LocationsRead &result,
+		const QString &journalPath,
+		const MTP::AuthKeyPtr &localKey) {
+	QFile file(journalPath);
+	if (!file.exists() || !file.open(QIODevice::ReadWrite)) {
+		return;
+	}
+	char magic[tdfMagicLen];
+	qint32 version = 0;
+	if (file.read(magic, tdfMagicLen) != tdfMagicLen
+		|| memcmp(magic, tdfMagic, tdfMagicLen)
+		|| file.read((char*)&version, sizeof(version)) != sizeof(version)
+		|| version > AppVersion) {
+		LOG(("App Error: bad locations journal header."));
+		file.resize(0);
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_1);
+	auto good = file.pos();
+	while (!stream.atEnd()) {
+		QByteArray encrypted;
+		stream >> encrypted;
+
+		EncryptedDescriptor data;
+		if (stream.status() != QDataStream::Ok
+			|| !decryptLocal(data, encrypted, localKey)) {
+			break;
+		}
+		quint32 type = 0;
+		quint64 first = 0, second = 0;
+		data.stream >> type >> first >> second;
+		const auto location = MediaKey(first, second);
+		if (type == quint32(LocationsJournalRecord::Write)) {
+			FileLocation local;
+			QByteArray bookmark;
+			data.stream
+				>> local.fname
+				>> bookmark
+				>> local.modified
+				>> local.size;
+			if (data.stream.status() != QDataStream::Ok) {
+				break;
+			}
+			local.setBookmark(bookmark);
+			_applyFileLocation(
+				result.locations,
+				result.pairs,
+				result.aliases,
+				location,
+				local);
+		} else if (type == quint32(LocationsJournalRecord::Remove)) {
+			QString fname;
+			data.stream >> fname;
+			if (data.stream.status() != QDataStream::Ok) {
+				break;
+			}
+			_removeFileLocation(
+				result.locations,
+				result.pairs,
+				location,
+				fname);
+		} else {
+			break;
+		}
+		good = file.pos();
+		++result.journalRecords;
+	}
+	stream.setDevice(nullptr);
+
+	// Drop the record that was being written when the app was killed,
+	// so that the new records are appended after the last good one.
+	if (good < file.size()) {
+		LOG(("App Error: bad locations journal tail, %1 bytes dropped."
+			).arg(file.size() - good));
+		file.resize(good);
+	}
+}
+
+void _readLocations(
+		LocationsRead &result,
+		FileKey locationsKey,
+		const QString &journalPath,
+		const MTP::AuthKeyPtr &localKey) {
 	FileReadDescriptor locations;
-	if (!readEncryptedFile(locations, _locationsKey)) {
-		clearKey(_locationsKey);
-		_locationsKey = 0;
-		_writeMap();
+	if (!readEncryptedFile(locations, locationsKey, FileOption::User | FileOption::Safe, localKey)) {
+		result.failed = true;
 		return;
 	}
 
@@ -795,8 +1089,8 @@ void _readLocations() {
 
 		MediaKey key(first, second);
 
-		_fileLocations.insert(key, loc);
-		_fileLocationPairs.insert(loc.fname, FileLocationPair(key, loc));
+		result.locations.insert(key, loc);
+		result.pairs.insert(loc.fname, FileLocationPair(key, loc));
 	}
 
 	if (endMarkFound) {
@@ -805,7 +1099,7 @@ void _readLocations() {
 		for (quint32 i = 0; i < cnt; ++i) {
 			quint64 kfirst, ksecond, vfirst, vsecond;
 			locations.stream >> kfirst >> ksecond >> vfirst >> vsecond;
-			_fileLocationAliases.insert(MediaKey(kfirst, ksecond), MediaKey(vfirst, vsecond));
+			result.aliases.insert(MediaKey(kfirst, ksecond), MediaKey(vfirst, vsecond));
 		}
 
 		if (!locations.stream.atEnd()) {
@@ -816,10 +1110,70 @@ void _readLocations() {
 				quint64 key;
 				qint32 size;
 				locations.stream >> url >> key >> size;
-				clearKey(key, FileOption::User);
+				result.webLocationKeys.push_back(key);
 			}
 		}
 	}
+
+	_readLocationsJournal(result, journalPath, localKey);
+}
+
+void _ensureLocationsRead() {
+	if (!_locationsRead) {
+		return;
+	}
+	const auto read = base::take(_locationsRead);
+	read->ready.acquire();
+
+	if (read->failed) {
+		_clearLocationsJournal();
+		clearKey(_locationsKey);
+		_locationsKey = 0;
+		_writeMap();
+		return;
+	}
+	_fileLocations = std::move(read->locations);
+	_fileLocationPairs = std::move(read->pairs);
+	_fileLocationAliases = std::move(read->aliases);
+	_locationsJournalRecords = read->journalRecords;
+	for (const auto key : read->webLocationKeys) {
+		clearKey(key, FileOption::User);
+	}
+	if (_locationsJournalRecords >= kLocationsJournalMinCompactRecords) {
+		_writeLocations(WriteMapWhen::Soon);
+	}
+}
+
+void _cancelLocationsRead() {
+	if (const auto read = base::take(_locationsRead)) {
+		read->ready.acquire();
+	}
+}
+
+void _startLocationsRead() {
+	Expects(_locationsKey != 0);
+
+	_cancelLocationsRead();
+	const auto read = std::make_shared<LocationsRead>();
+	_locationsRead = read;
+	crl::async([
+		=,
+		key = _locationsKey,
+		journalPath = _locationsJournalPath(_userBasePath, _locationsKey),
+		localKey = LocalKey
+	] {
+		const auto ms = getms();
+		auto trace = Core::StartupTrace::Scope("Local::readLocations");
+		_readLocations(*read, key, journalPath, localKey);
+		trace.finish();
+		LOG(("Locations read time: %1").arg(getms() - ms));
+		read->ready.release();
+		crl::on_main([=] {
+			if (_locationsRead == read) {
+				_ensureLocationsRead();
+			}
+		});
+	});
 }
 
 void _writeReportSpamStatuses() {
@@ -2243,8 +2597,10 @@ ReadMapState _readMap(const QByteArray &pass) {
 	EncryptedDescriptor keyData, map;
 	if (!decryptLocal(keyData, keyEncrypted, PassKey)) {
 		LOG(("App Info: could not decrypt pass-protected key from map file, maybe bad password..."));
+		PassNeededSalt = salt;
 		return ReadMapPassNeeded;
 	}
+	PassNeededSalt = QByteArray();
 	auto key = Serialize::read<MTP::AuthKey::Data>(keyData.stream);
 	if (keyData.stream.status() != QDataStream::Ok || !keyData.stream.atEnd()) {
 		LOG(("App Error: could not read pass-protected key from map file"));
@@ -2270,6 +2626,7 @@ ReadMapState _readMap(const QByteArray &pass) {
 	quint64 savedGifsKey = 0;
 	quint64 backgroundKeyDay = 0, backgroundKeyNight = 0;
 	quint64 userSettingsKey = 0, recentHashtagsAndBotsKey = 0, savedPeersKey = 0, exportSettingsKey = 0;
+	quint64 resumableUploadsKey = 0;
 	while (!map.stream.atEnd()) {
 		quint32 keyType;
 		map.stream >> keyType;
@@ -2359,6 +2716,9 @@ ReadMapState _readMap(const QByteArray &pass) {
 		case lskExportSettings: {
 			map.stream >> exportSettingsKey;
 		} break;
+		case lskResumableUploads: {
+			map.stream >> resumableUploadsKey;
+		} break;
 		default:
 		LOG(("App Error: unknown key type in encrypted map: %1").arg(keyType));
 		return ReadMapFailed;
@@ -2388,6 +2748,7 @@ ReadMapState _readMap(const QByteArray &pass) {
 	_userSettingsKey = userSettingsKey;
 	_recentHashtagsAndBotsKey = recentHashtagsAndBotsKey;
 	_exportSettingsKey = exportSettingsKey;
+	_resumableUploadsKey = resumableUploadsKey;
 	_oldMapVersion = mapData.version;
 	if (_oldMapVersion < AppVersion) {
 		_mapChanged = true;
@@ -2397,7 +2758,7 @@ ReadMapState _readMap(const QByteArray &pass) {
 	}
 
 	if (_locationsKey) {
-		_readLocations();
+		_startLocationsRead();
 	}
 	if (_reportSpamStatusesKey) {
 		_readReportSpamStatuses();
@@ -2491,6 +2852,7 @@ void _writeMap(WriteMapWhen when) {
 	if (_userSettingsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_recentHashtagsAndBotsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_exportSettingsKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (_resumableUploadsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 
 	EncryptedDescriptor mapData(mapSize);
 	if (!self.isEmpty()) {
@@ -2548,6 +2910,9 @@ void _writeMap(WriteMapWhen when) {
 	if (_exportSettingsKey) {
 		mapData.stream << quint32(lskExportSettings) << quint64(_exportSettingsKey);
 	}
+	if (_resumableUploadsKey) {
+		mapData.stream << quint32(lskResumableUploads) << quint64(_resumableUploadsKey);
+	}
 	map.writeEncrypted(mapData);
 
 	_mapChanged = false;
@@ -2572,7 +2937,9 @@ void start() {
 	Expects(!_manager);
 
 	_manager = new internal::Manager();
-	_localLoader = new TaskQueue(kFileLoaderQueueStopTimeout);
+	_localLoader = new TaskQueue(
+		kFileLoaderQueueStopTimeout,
+		QThread::LowestPriority);
 
 	_basePath = cWorkingDir() + qsl("tdata/");
 	if (!QDir().exists(_basePath)) QDir().mkpath(_basePath);
@@ -2796,20 +3163,25 @@ void reset() {
 		_localLoader->stop();
 	}
 
+	_cancelLocationsRead();
 	_passKeySalt.clear(); // reset passcode, local key
 	_draftsMap.clear();
+	_draftsWrittenData.clear();
 	_draftCursorsMap.clear();
 	_fileLocations.clear();
 	_fileLocationPairs.clear();
 	_fileLocationAliases.clear();
 	_draftsNotReadMap.clear();
+	_locationsJournalRecords = 0;
 	_locationsKey = _reportSpamStatusesKey = _trustedBotsKey = 0;
 	_recentStickersKeyOld = 0;
 	_installedStickersKey = _featuredStickersKey = _recentStickersKey = _favedStickersKey = _archivedStickersKey = 0;
+	_stickersToWrite = StickersFiles();
 	_savedGifsKey = 0;
 	_backgroundKeyDay = _backgroundKeyNight = 0;
 	Window::Theme::Background()->reset();
 	_userSettingsKey = _recentHashtagsAndBotsKey = _savedPeersKey = _exportSettingsKey = 0;
+	_resumableUploadsKey = 0;
 	_oldMapVersion = _oldSettingsVersion = 0;
 	_cacheTotalSizeLimit = Database::Settings().totalSizeLimit;
 	_cacheTotalTimeLimit = Database::Settings().totalTimeLimit;
@@ -2820,6 +3192,23 @@ void reset() {
 	_writeMtpData();
 }
 
+void preparePasscode(const QByteArray &passcode, Fn<void()> done) {
+	const auto salt = _passKeySalt.isEmpty()
+		? PassNeededSalt
+		: _passKeySalt;
+	if (passcode.isEmpty() || salt.size() != LocalEncryptSaltSize) {
+		done();
+		return;
+	}
+	crl::async([=] {
+		auto key = deriveLocalKey(passcode, salt);
+		crl::on_main([=, key = std::move(key)]() mutable {
+			DerivedPass = { passcode, salt, std::move(key) };
+			done();
+		});
+	});
+}
+
 bool checkPasscode(const QByteArray &passcode) {
 	auto checkKey = MTP::AuthKeyPtr();
 	createLocalKey(passcode, &_passKeySalt, &checkKey);
@@ -2856,6 +3245,7 @@ base::flat_set<QString> CollectGoodNames() {
 		_backgroundKeyDay,
 		_recentHashtagsAndBotsKey,
 		_exportSettingsKey,
+		_resumableUploadsKey,
 		_savedPeersKey,
 		_trustedBotsKey
 	};
@@ -2878,6 +3268,9 @@ base::flat_set<QString> CollectGoodNames() {
 	for (const auto &value : keys) {
 		push(value);
 	}
+	if (_locationsKey) {
+		result.emplace(toFilePart(_locationsKey) + 'j');
+	}
 	return result;
 }
 
@@ -2918,6 +3311,7 @@ void writeDrafts(const PeerId &peer, const MessageDraft &localDraft, const Messa
 			_mapChanged = true;
 			_writeMap();
 		}
+		_draftsWrittenData.remove(peer);
 
 		_draftsNotReadMap.remove(peer);
 	} else {
@@ -2926,6 +3320,7 @@ void writeDrafts(const PeerId &peer, const MessageDraft &localDraft, const Messa
 			i = _draftsMap.insert(peer, genKey());
 			_mapChanged = true;
 			_writeMap(WriteMapWhen::Fast);
+			_draftsWrittenData.remove(peer);
 		}
 
 		auto msgTags = TextUtilities::SerializeTags(
@@ -2944,10 +3339,16 @@ void writeDrafts(const PeerId &peer, const MessageDraft &localDraft, const Messa
 		data.stream << editDraft.textWithTags.text << editTags;
 		data.stream << qint32(editDraft.msgId) << qint32(editDraft.previewCancelled ? 1 : 0);
 
+		_draftsNotReadMap.remove(peer);
+
+		auto &written = _draftsWrittenData[peer];
+		if (written == data.data) {
+			return;
+		}
+		written = data.data;
+
 		FileWriteDescriptor file(i.value());
 		file.writeEncrypted(data);
-
-		_draftsNotReadMap.remove(peer);
 	}
 }
 
@@ -3102,36 +3503,22 @@ bool hasDraft(const PeerId &peer) {
 void writeFileLocation(MediaKey location, const FileLocation &local) {
 	if (local.fname.isEmpty()) return;
 
-	FileLocationAliases::const_iterator aliasIt = _fileLocationAliases.constFind(location);
-	if (aliasIt != _fileLocationAliases.cend()) {
-		location = aliasIt.value();
-	}
+	_ensureLocationsRead();
 
-	FileLocationPairs::iterator i = _fileLocationPairs.find(local.fname);
-	if (i != _fileLocationPairs.cend()) {
-		if (i.value().second == local) {
-			if (i.value().first != location) {
-				_fileLocationAliases.insert(location, i.value().first);
-				_writeLocations(WriteMapWhen::Fast);
-			}
-			return;
-		}
-		if (i.value().first != location) {
-			for (FileLocations::iterator j = _fileLocations.find(i.value().first), e = _fileLocations.end(); (j != e) && (j.key() == i.value().first);) {
-				if (j.value() == i.value().second) {
-					_fileLocations.erase(j);
-					break;
-				}
-			}
-			_fileLocationPairs.erase(i);
-		}
+	const auto changed = _applyFileLocation(
+		_fileLocations,
+		_fileLocationPairs,
+		_fileLocationAliases,
+		location,
+		local);
+	if (changed) {
+		_appendLocationsJournalWrite(location, local);
 	}
-	_fileLocations.insert(location, local);
-	_fileLocationPairs.insert(local.fname, FileLocationPair(location, local));
-	_writeLocations(WriteMapWhen::Fast);
 }
 
 FileLocation readFileLocation(MediaKey location, bool check) {
+	_ensureLocationsRead();
+
 	FileLocationAliases::const_iterator aliasIt = _fileLocationAliases.constFind(location);
 	if (aliasIt != _fileLocationAliases.cend()) {
 		location = aliasIt.value();
@@ -3141,9 +3528,10 @@ FileLocation readFileLocation(MediaKey location, bool check) {
 	for (FileLocations::iterator i = _fileLocations.find(location); (i != _fileLocations.end()) && (i.key() == location);) {
 		if (check) {
 			if (!i.value().check()) {
-				_fileLocationPairs.remove(i.value().fname);
+				const auto fname = i.value().fname;
+				_fileLocationPairs.remove(fname);
 				i = _fileLocations.erase(i);
-				_writeLocations();
+				_appendLocationsJournalRemove(location, fname);
 				continue;
 			}
 		}
@@ -3210,6 +3598,8 @@ void updateCacheSettings(Storage::Cache::Database::SettingsUpdate &update) {
 	_writeUserSettings();
 }
 
+namespace {
+
 class CountWaveformTask : public Task {
 public:
 	CountWaveformTask(DocumentData *doc)
@@ -3225,28 +3615,22 @@ public:
 		if (!_doc) return;
 
 		_waveform = audioCountWaveform(_loc, _data);
-		uchar wavemax = 0;
-		for (int32 i = 0, l = _waveform.size(); i < l; ++i) {
-			uchar waveat = _waveform.at(i);
-			if (wavemax < waveat) wavemax = waveat;
-		}
-		_wavemax = wavemax;
+		_wavemax = CountWavemax(_waveform);
 	}
 	void finish() {
 		if (const auto voice = _doc ? _doc->voice() : nullptr) {
 			if (!_waveform.isEmpty()) {
 				voice->waveform = _waveform;
 				voice->wavemax = _wavemax;
+				if (_doc->hasRemoteLocation()) {
+					Auth().data().cache().put(
+						_doc->waveformCacheKey(),
+						Storage::Cache::Database::TaggedValue{
+							SerializeWaveform(_waveform),
+							Data::kWaveformCacheTag });
+				}
 			}
-			if (voice->waveform.isEmpty()) {
-				voice->waveform.resize(1);
-				voice->waveform[0] = -2;
-				voice->wavemax = 0;
-			} else if (voice->waveform[0] < 0) {
-				voice->waveform[0] = -2;
-				voice->wavemax = 0;
-			}
-			Auth().data().requestDocumentViewRepaint(_doc);
+			ApplyCountedWaveform(_doc);
 		}
 	}
 	virtual ~CountWaveformTask() {
@@ -3255,6 +3639,37 @@ public:
 		}
 	}
 
+	static char CountWavemax(const VoiceWaveform &waveform) {
+		uchar wavemax = 0;
+		for (int32 i = 0, l = waveform.size(); i < l; ++i) {
+			uchar waveat = waveform.at(i);
+			if (wavemax < waveat) wavemax = waveat;
+		}
+		return wavemax;
+	}
+	static QByteArray SerializeWaveform(const VoiceWaveform &waveform) {
+		return QByteArray(
+			reinterpret_cast<const char*>(waveform.constData()),
+			waveform.size());
+	}
+	static VoiceWaveform DeserializeWaveform(const QByteArray &bytes) {
+		auto result = VoiceWaveform(bytes.size());
+		memcpy(result.data(), bytes.constData(), bytes.size());
+		return result;
+	}
+	static void ApplyCountedWaveform(not_null<DocumentData*> document) {
+		const auto voice = document->voice();
+		if (voice->waveform.isEmpty()) {
+			voice->waveform.resize(1);
+			voice->waveform[0] = -2;
+			voice->wavemax = 0;
+		} else if (voice->waveform[0] < 0) {
+			voice->waveform[0] = -2;
+			voice->wavemax = 0;
+		}
+		Auth().data().requestDocumentViewRepaint(document);
+	}
+
 protected:
 	DocumentData *_doc;
 	FileLocation _loc;
@@ -3264,22 +3679,80 @@ protected:
 
 };
 
-void countVoiceWaveform(DocumentData *document) {
-	if (const auto voice = document->voice()) {
-		if (_localLoader) {
-			voice->waveform.resize(1 + sizeof(TaskId));
-			voice->waveform[0] = -1; // counting
-			TaskId taskId = _localLoader->addTask(
-				std::make_unique<CountWaveformTask>(document));
-			memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
-		}
+TaskId CountingWaveformTaskId(not_null<VoiceData*> voice) {
+	auto result = TaskId();
+	const auto &waveform = voice->waveform;
+	if (waveform.size() == int(1 + sizeof(TaskId)) && waveform[0] == -1) {
+		memcpy(&result, waveform.constData() + 1, sizeof(result));
 	}
+	return result;
 }
 
-void cancelTask(TaskId id) {
-	if (_localLoader) {
-		_localLoader->cancelTask(id);
+bool CountingWaveform(not_null<VoiceData*> voice, TaskId taskId) {
+	const auto &waveform = voice->waveform;
+	return (waveform.size() == int(1 + sizeof(TaskId)))
+		&& (waveform[0] == -1)
+		&& (CountingWaveformTaskId(voice) == taskId);
+}
+
+void MarkCountingWaveform(not_null<VoiceData*> voice, TaskId taskId) {
+	voice->waveform.resize(1 + sizeof(TaskId));
+	voice->waveform[0] = -1; // counting
+	memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
+}
+
+void StartCountWaveformTask(not_null<DocumentData*> document) {
+	MarkCountingWaveform(
+		document->voice(),
+		_localLoader->addTask(
+			std::make_unique<CountWaveformTask>(document)));
+}
+
+} // namespace
+
+void countVoiceWaveform(not_null<DocumentData*> document) {
+	const auto voice = document->voice();
+	if (!voice || !_localLoader) {
+		return;
+	}
+
+	// Waiting for the cache, TaskId() until the task is started.
+	MarkCountingWaveform(voice, TaskId());
+	if (!document->hasRemoteLocation()) {
+		StartCountWaveformTask(document);
+		return;
+	}
+	const auto weak = base::make_weak(&Auth());
+	auto done = [=](QByteArray &&value) {
+		crl::on_main(weak, [=, bytes = std::move(value)] {
+			const auto voice = document->voice();
+			if (!voice || !CountingWaveform(voice, TaskId())) {
+				return;
+			} else if (bytes.isEmpty() || !_localLoader) {
+				StartCountWaveformTask(document);
+				return;
+			}
+			voice->waveform = CountWaveformTask::DeserializeWaveform(bytes);
+			voice->wavemax = CountWaveformTask::CountWavemax(
+				voice->waveform);
+			CountWaveformTask::ApplyCountedWaveform(document);
+		});
+	};
+	Auth().data().cache().get(document->waveformCacheKey(), std::move(done));
+}
+
+void cancelVoiceWaveform(not_null<VoiceData*> voice) {
+	if (voice->waveform.isEmpty() || voice->waveform[0] != -1) {
+		return;
+	}
+	if (const auto taskId = CountingWaveformTaskId(voice)) {
+		if (_localLoader) {
+			_localLoader->cancelTask(taskId);
+		}
 	}
+
+	// It will be counted again if anyone shows it later.
+	voice->waveform.clear();
 }
 
 void _writeStickerSet(QDataStream &stream, const Stickers::Set &set) {
@@ -3527,7 +4000,7 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 		}
 
 		Serialize::Document::StickerSetInfo info(setId, setAccess, setShortName);
-		OrderedSet<DocumentId> read;
+		base::flat_set<DocumentId> read;
 		for (int32 j = 0; j < scnt; ++j) {
 			auto document = Serialize::Document::readStickerFromStream(stickers.version, stickers.stream, info);
 			if (!document || !document->sticker()) continue;
@@ -3611,7 +4084,7 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 	}
 }
 
-void writeInstalledStickers() {
+void _writeInstalledStickersNow() {
 	if (!Global::started()) return;
 
 	_writeStickerSets(_installedStickersKey, [](const Stickers::Set &set) {
@@ -3632,7 +4105,7 @@ void writeInstalledStickers() {
 	}, Auth().data().stickerSetsOrder());
 }
 
-void writeFeaturedStickers() {
+void _writeFeaturedStickersNow() {
 	if (!Global::started()) return;
 
 	_writeStickerSets(_featuredStickersKey, [](const Stickers::Set &set) {
@@ -3651,7 +4124,7 @@ void writeFeaturedStickers() {
 	}, Auth().data().featuredStickerSetsOrder());
 }
 
-void writeRecentStickers() {
+void _writeRecentStickersNow() {
 	if (!Global::started()) return;
 
 	_writeStickerSets(_recentStickersKey, [](const Stickers::Set &set) {
@@ -3662,7 +4135,7 @@ void writeRecentStickers() {
 	}, Stickers::Order());
 }
 
-void writeFavedStickers() {
+void _writeFavedStickersNow() {
 	if (!Global::started()) return;
 
 	_writeStickerSets(_favedStickersKey, [](const Stickers::Set &set) {
@@ -3673,7 +4146,7 @@ void writeFavedStickers() {
 	}, Stickers::Order());
 }
 
-void writeArchivedStickers() {
+void _writeArchivedStickersNow() {
 	if (!Global::started()) return;
 
 	_writeStickerSets(_archivedStickersKey, [](const Stickers::Set &set) {
@@ -3684,6 +4157,60 @@ void writeArchivedStickers() {
 	}, Auth().data().archivedStickerSetsOrder());
 }
 
+void _writeStickersDelayed(StickersFile file) {
+	if (!_manager) {
+		return;
+	}
+	_stickersToWrite |= file;
+	_manager->writeStickers();
+}
+
+void _writeStickersNow() {
+	const auto files = base::take(_stickersToWrite);
+	if (!files || !AuthSession::Exists()) {
+		return;
+	}
+	if (files & StickersFile::Installed) {
+		_writeInstalledStickersNow();
+	}
+	if (files & StickersFile::Featured) {
+		_writeFeaturedStickersNow();
+	}
+	if (files & StickersFile::Recent) {
+		_writeRecentStickersNow();
+	}
+	if (files & StickersFile::Faved) {
+		_writeFavedStickersNow();
+	}
+	if (files & StickersFile::Archived) {
+		_writeArchivedStickersNow();
+	}
+}
+
+void writeInstalledStickers() {
+	_writeStickersDelayed(StickersFile::Installed);
+}
+
+void writeFeaturedStickers() {
+	_writeStickersDelayed(StickersFile::Featured);
+}
+
+void writeRecentStickers() {
+	_writeStickersDelayed(StickersFile::Recent);
+}
+
+void writeFavedStickers() {
+	_writeStickersDelayed(StickersFile::Faved);
+}
+
+void writeArchivedStickers() {
+	_writeStickersDelayed(StickersFile::Archived);
+}
+
+void writePendingStickers() {
+	_writeStickersNow();
+}
+
 void importOldRecentStickers() {
 	if (!_recentStickersKeyOld) return;
 
@@ -3950,7 +4477,7 @@ void readSavedGifs() {
 	quint32 cnt;
 	gifs.stream >> cnt;
 	saved.reserve(cnt);
-	OrderedSet<DocumentId> read;
+	base::flat_set<DocumentId> read;
 	for (uint32 i = 0; i < cnt; ++i) {
 		auto document = Serialize::Document::readFromStream(gifs.version, gifs.stream);
 		if (!document || !document->isGifv()) continue;
@@ -4816,6 +5343,90 @@ void readSavedPeers() {
 	Auth().api().requestPeers(peers);
 }
 
+void WriteResumableUploads(
+		const std::vector<Storage::ResumableUpload> &uploads) {
+	if (!_working()) return;
+
+	if (uploads.empty()) {
+		if (_resumableUploadsKey) {
+			clearKey(_resumableUploadsKey);
+			_resumableUploadsKey = 0;
+			_mapChanged = true;
+		}
+		_writeMap();
+		return;
+	}
+	if (!_resumableUploadsKey) {
+		_resumableUploadsKey = genKey();
+		_mapChanged = true;
+		_writeMap(WriteMapWhen::Fast);
+	}
+	quint32 size = sizeof(quint32);
+	for (const auto &upload : uploads) {
+		size += Serialize::stringSize(upload.path)
+			+ sizeof(qint64)
+			+ Serialize::dateTimeSize()
+			+ sizeof(quint64)
+			+ sizeof(qint32) * 3;
+	}
+	EncryptedDescriptor data(size);
+	data.stream << quint32(uploads.size());
+	for (const auto &upload : uploads) {
+		data.stream
+			<< upload.path
+			<< qint64(upload.size)
+			<< upload.modified
+			<< quint64(upload.fileId)
+			<< qint32(upload.partSize)
+			<< qint32(upload.partsDone)
+			<< qint32(upload.saved);
+	}
+
+	FileWriteDescriptor file(_resumableUploadsKey);
+	file.writeEncrypted(data);
+}
+
+std::vector<Storage::ResumableUpload> ReadResumableUploads() {
+	if (!_resumableUploadsKey) {
+		return {};
+	}
+	FileReadDescriptor file;
+	if (!readEncryptedFile(file, _resumableUploadsKey)) {
+		clearKey(_resumableUploadsKey);
+		_resumableUploadsKey = 0;
+		_writeMap();
+		return {};
+	}
+
+	quint32 count = 0;
+	file.stream >> count;
+	auto result = std::vector<Storage::ResumableUpload>();
+	for (auto i = quint32(0); i != count; ++i) {
+		auto upload = Storage::ResumableUpload();
+		qint64 size = 0;
+		quint64 fileId = 0;
+		qint32 partSize = 0, partsDone = 0, saved = 0;
+		file.stream
+			>> upload.path
+			>> size
+			>> upload.modified
+			>> fileId
+			>> partSize
+			>> partsDone
+			>> saved;
+		if (!_checkStreamStatus(file.stream)) {
+			return {};
+		}
+		upload.size = size;
+		upload.fileId = fileId;
+		upload.partSize = partSize;
+		upload.partsDone = partsDone;
+		upload.saved = saved;
+		result.push_back(std::move(upload));
+	}
+	return result;
+}
+
 void addSavedPeer(PeerData *peer, const QDateTime &position) {
 	auto &savedPeers = cRefSavedPeers();
 	auto i = savedPeers.find(peer);
@@ -4972,6 +5583,7 @@ bool ClearManager::addTask(int task) {
 			_draftsMap.clear();
 			_mapChanged = true;
 		}
+		_draftsWrittenData.clear();
 		if (!_draftCursorsMap.isEmpty()) {
 			_draftCursorsMap.clear();
 			_mapChanged = true;
@@ -5107,6 +5719,8 @@ Manager::Manager() {
 	connect(&_mapWriteTimer, SIGNAL(timeout()), this, SLOT(mapWriteTimeout()));
 	_locationsWriteTimer.setSingleShot(true);
 	connect(&_locationsWriteTimer, SIGNAL(timeout()), this, SLOT(locationsWriteTimeout()));
+	_stickersWriteTimer.setSingleShot(true);
+	connect(&_stickersWriteTimer, SIGNAL(timeout()), this, SLOT(stickersWriteTimeout()));
 }
 
 void Manager::writeMap(bool fast) {
@@ -5133,6 +5747,14 @@ void Manager::writingLocations() {
 	_locationsWriteTimer.stop();
 }
 
+void Manager::writeStickers() {
+	// Don't postpone the write on each change, so that a long series
+	// of changes still gets saved in time.
+	if (!_stickersWriteTimer.isActive()) {
+		_stickersWriteTimer.start(kWriteStickersTimeout);
+	}
+}
+
 void Manager::mapWriteTimeout() {
 	_writeMap(WriteMapWhen::Now);
 }
@@ -5141,7 +5763,16 @@ void Manager::locationsWriteTimeout() {
 	_writeLocations(WriteMapWhen::Now);
 }
 
+void Manager::stickersWriteTimeout() {
+	_writeStickersNow();
+}
+
 void Manager::finish() {
+	// Sticker files can change the map, so they are written first.
+	if (_stickersWriteTimer.isActive()) {
+		_stickersWriteTimer.stop();
+		stickersWriteTimeout();
+	}
 	if (_mapWriteTimer.isActive()) {
 		mapWriteTimeout();
 	}
@@ -12,6 +12,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/localimageloader.h"
 #include "auth_session.h"
 
+struct VoiceData;
+
 namespace Data {
 class WallPaper;
 } // namespace Data
@@ -22,6 +24,7 @@ struct Language;
 
 namespace Storage {
 class EncryptionKey;
+struct ResumableUpload;
 } // namespace Storage
 
 namespace Window {
@@ -49,6 +52,9 @@ QString readAutoupdatePrefix();
 
 void reset();
 
+// Derives the passcode key on a background thread, so that a following
+// checkPasscode() or readMap() with the same passcode doesn't block.
+void preparePasscode(const QByteArray &passcode, Fn<void()> done);
 bool checkPasscode(const QByteArray &passcode);
 void setPasscode(const QByteArray &passcode);
 
@@ -117,15 +123,15 @@ Storage::EncryptionKey cacheKey();
 Storage::Cache::Database::Settings cacheSettings();
 void updateCacheSettings(Storage::Cache::Database::SettingsUpdate &update);
 
-void countVoiceWaveform(DocumentData *document);
-
-void cancelTask(TaskId id);
+void countVoiceWaveform(not_null<DocumentData*> document);
+void cancelVoiceWaveform(not_null<VoiceData*> voice);
 
 void writeInstalledStickers();
 void writeFeaturedStickers();
 void writeRecentStickers();
 void writeFavedStickers();
 void writeArchivedStickers();
+void writePendingStickers();
 void readInstalledStickers();
 void readFeaturedStickers();
 void readRecentStickers();
@@ -162,6 +168,10 @@ void saveRecentSearchHashtags(const QString &text);
 void WriteExportSettings(const Export::Settings &settings);
 Export::Settings ReadExportSettings();
 
+void WriteResumableUploads(
+	const std::vector<Storage::ResumableUpload> &uploads);
+std::vector<Storage::ResumableUpload> ReadResumableUploads();
+
 void addSavedPeer(PeerData *peer, const QDateTime &position);
 void removeSavedPeer(PeerData *peer);
 void readSavedPeers();
@@ -189,15 +199,18 @@ public:
 	void writingMap();
 	void writeLocations(bool fast);
 	void writingLocations();
+	void writeStickers();
 	void finish();
 
 public slots:
 	void mapWriteTimeout();
 	void locationsWriteTimeout();
+	void stickersWriteTimeout();
 
 private:
 	QTimer _mapWriteTimer;
 	QTimer _locationsWriteTimer;
+	QTimer _stickersWriteTimer;
 
 };
 
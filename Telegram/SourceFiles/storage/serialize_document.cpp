@@ -76,6 +76,7 @@ DocumentData *Document::readFromStreamHelper(int streamAppVersion, QDataStream &
 	stream >> type;
 
 	QVector<MTPDocumentAttribute> attributes;
+	attributes.reserve(3); // filename + sticker / animated + size / video
 	if (!name.isEmpty()) {
 		attributes.push_back(MTP_documentAttributeFilename(MTP_string(name)));
 	}
@@ -159,8 +160,8 @@ DocumentData *Document::readFromStream(int streamAppVersion, QDataStream &stream
 int Document::sizeInStream(DocumentData *document) {
 	int result = 0;
 
-	// id + access + date + version
-	result += sizeof(quint64) + sizeof(quint64) + sizeof(qint32) + sizeof(qint32);
+	// id + access + date + file_reference + version
+	result += sizeof(quint64) + sizeof(quint64) + sizeof(qint32) + bytearraySize(document->_fileReference) + sizeof(qint32);
 	// + namelen + name + mimelen + mime + dc + size
 	result += stringSize(document->filename()) + stringSize(document->mimeString()) + sizeof(qint32) + sizeof(qint32);
 	// + width + height
@@ -10,6 +10,27 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/cache/storage_cache_database.h"
 
 namespace Storage {
+namespace {
+
+constexpr auto kStatsLogInterval = 5 * 60 * crl::time_type(1000);
+constexpr auto kDefaultKeepWarmTimeout = 30 * crl::time_type(1000);
+
+QString AccessText(const Cache::details::AccessSummary &summary) {
+	return QString("hits %1, misses %2, read %3, written %4"
+	).arg(summary.hits
+	).arg(summary.misses
+	).arg(summary.bytesRead
+	).arg(summary.bytesWritten);
+}
+
+QString LatencyText(const Cache::details::LatencyHistogram &histogram) {
+	return QString("%1 requests, p50 %2us, p99 %3us"
+	).arg(histogram.count()
+	).arg(histogram.percentile(0.5)
+	).arg(histogram.percentile(0.99));
+}
+
+} // namespace
 
 DatabasePointer::DatabasePointer(
 	not_null<Databases*> owner,
@@ -66,41 +87,99 @@ Databases::Kept::Kept(std::unique_ptr<Cache::Database> &&database)
 : database(std::move(database)) {
 }
 
+Databases::Databases() : _keepWarmTimeout(kDefaultKeepWarmTimeout) {
+}
+
 DatabasePointer Databases::get(
 		const QString &path,
 		const Cache::details::Settings &settings) {
 	if (const auto i = _map.find(path); i != end(_map)) {
 		auto &kept = i->second;
-		Assert(kept.destroying.alive());
-		kept.destroying = nullptr;
+		if (kept.keepWarm.isActive()) {
+			// Still open, Database::open() with the same key is a no-op.
+			kept.keepWarm.cancel();
+		} else {
+			Assert(kept.destroying.alive());
+			kept.destroying = nullptr;
+		}
 		kept.database->reconfigure(settings);
 		return DatabasePointer(this, kept.database);
 	}
 	const auto [i, ok] = _map.emplace(
 		path,
 		std::make_unique<Cache::Database>(path, settings));
+	if (Logs::DebugEnabled()) {
+		logStats(path, i->second);
+	}
 	return DatabasePointer(this, i->second.database);
 }
 
+void Databases::logStats(const QString &path, Kept &kept) {
+	kept.database->statsOnMain(
+	) | rpl::filter([=, &kept](const Cache::Database::Stats &stats) {
+		const auto now = crl::time();
+		if (kept.statsLogged && now - kept.statsLogged < kStatsLogInterval) {
+			return false;
+		}
+		kept.statsLogged = now;
+		return true;
+	}) | rpl::start_with_next([=](Cache::Database::Stats &&stats) {
+		DEBUG_LOG(("Cache Stats: %1, %2 values, %3 bytes."
+			).arg(path
+			).arg(stats.full.count
+			).arg(stats.full.totalSize));
+		DEBUG_LOG(("Cache Stats: %1"
+			).arg(AccessText(stats.access)));
+		for (const auto &[tag, summary] : stats.taggedAccess) {
+			DEBUG_LOG(("Cache Stats: tag %1, %2"
+				).arg(tag
+				).arg(AccessText(summary)));
+		}
+		DEBUG_LOG(("Cache Stats: get %1, put %2"
+			).arg(LatencyText(stats.getLatency)
+			).arg(LatencyText(stats.putLatency)));
+		DEBUG_LOG(("Cache Stats: compactions %1 finished, %2 failed, "
+			"read %3, written %4"
+			).arg(stats.compaction.finished
+			).arg(stats.compaction.failed
+			).arg(stats.compaction.totalRead
+			).arg(stats.compaction.totalWritten));
+	}, kept.lifetime);
+}
+
+void Databases::setKeepWarmTimeout(crl::time_type timeout) {
+	_keepWarmTimeout = timeout;
+}
+
 void Databases::destroy(Cache::Database *database) {
 	for (auto &entry : _map) {
 		const auto &path = entry.first; // Need to capture it in lambda.
 		auto &kept = entry.second;
 		if (kept.database.get() == database) {
 			Assert(!kept.destroying.alive());
-			auto [first, second] = base::make_binary_guard();
-			kept.destroying = std::move(first);
-			database->close();
-			database->waitForCleaner([=, guard = std::move(second)]() mutable {
-				crl::on_main([=, guard = std::move(guard)]{
-					if (!guard) {
-						return;
-					}
-					_map.erase(path);
-				});
-			});
+			Assert(!kept.keepWarm.isActive());
+			if (_keepWarmTimeout > 0) {
+				kept.keepWarm.setCallback([=, &kept] { close(path, kept); });
+				kept.keepWarm.callOnce(_keepWarmTimeout);
+			} else {
+				close(path, kept);
+			}
 		}
 	}
 }
 
+void Databases::close(const QString &path, Kept &kept) {
+	auto [first, second] = base::make_binary_guard();
+	kept.destroying = std::move(first);
+	kept.database->close();
+	kept.database->waitForCleaner([=, guard = std::move(second)]() mutable {
+		crl::on_main([=, guard = std::move(guard)]{
+			if (!guard) {
+				return;
+			}
+			_map.erase(path);
+		});
+	});
+}
+
 } // namespace Storage
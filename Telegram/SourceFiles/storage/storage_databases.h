@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "storage/cache/storage_cache_database.h"
 #include "base/binary_guard.h"
+#include "base/timer.h"
 
 namespace Storage {
 namespace Cache {
@@ -48,10 +49,17 @@ private:
 
 class Databases {
 public:
+	Databases();
+
 	DatabasePointer get(
 		const QString &path,
 		const Cache::details::Settings &settings);
 
+	// A released database stays open for this long, so that getting
+	// the same path again doesn't reread its binlog. Zero closes it
+	// as soon as the last pointer goes away.
+	void setKeepWarmTimeout(crl::time_type timeout);
+
 private:
 	friend class DatabasePointer;
 
@@ -60,11 +68,17 @@ private:
 
 		std::unique_ptr<Cache::Database> database;
 		base::binary_guard destroying;
+		base::Timer keepWarm;
+		crl::time_type statsLogged = 0;
+		rpl::lifetime lifetime;
 	};
 
 	void destroy(Cache::Database *database);
+	void close(const QString &path, Kept &kept);
+	void logStats(const QString &path, Kept &kept);
 
 	std::map<QString, Kept> _map;
+	crl::time_type _keepWarmTimeout = 0;
 
 };
 
@@ -51,7 +51,8 @@ File::Result File::open(
 
 	const auto info = QFileInfo(path);
 	const auto dir = info.absoluteDir();
-	if (mode != Mode::Read && !dir.exists()) {
+	const auto reading = (mode == Mode::Read || mode == Mode::ReadMapped);
+	if (!reading && !dir.exists()) {
 		if (!QDir().mkpath(dir.absolutePath())) {
 			return Result::Failed;
 		}
@@ -75,6 +76,7 @@ File::Result File::open(
 File::Result File::attemptOpen(Mode mode, const EncryptionKey &key) {
 	switch (mode) {
 	case Mode::Read: return attemptOpenForRead(key);
+	case Mode::ReadMapped: return attemptOpenForReadMapped(key);
 	case Mode::ReadAppend: return attemptOpenForReadAppend(key);
 	case Mode::Write: return attemptOpenForWrite(key);
 	}
@@ -88,6 +90,18 @@ File::Result File::attemptOpenForRead(const EncryptionKey &key) {
 	return readHeader(key);
 }
 
+File::Result File::attemptOpenForReadMapped(const EncryptionKey &key) {
+	if (!_data.open(QIODevice::ReadOnly)) {
+		return Result::Failed;
+	}
+	if (const auto size = _data.size(); size > 0) {
+		// If the mapping fails we silently fall back to the plain reads.
+		_mapped = _data.map(0, size);
+		_mappedSize = _mapped ? size : 0;
+	}
+	return readHeader(key);
+}
+
 File::Result File::attemptOpenForReadAppend(const EncryptionKey &key) {
 	if (!_lock.lock(_data, QIODevice::ReadWrite)) {
 		return Result::LockFailed;
@@ -138,9 +152,9 @@ bool File::writeHeader(const EncryptionKey &key) {
 
 File::Result File::readHeader(const EncryptionKey &key) {
 	Expects(!_state.has_value());
-	Expects(_data.pos() == 0);
+	Expects(positionPlain() == 0);
 
-	if (!_data.seek(FileLock::kSkipBytes)) {
+	if (!seekPlain(FileLock::kSkipBytes)) {
 		return Result::Failed;
 	}
 	auto header = BasicHeader();
@@ -171,15 +185,58 @@ File::Result File::readHeader(const EncryptionKey &key) {
 }
 
 size_type File::readPlain(bytes::span bytes) {
+	if (_mapped) {
+		const auto left = std::max(_mappedSize - _mappedPosition, int64(0));
+		const auto count = std::min(int64(bytes.size()), left);
+		bytes::copy(
+			bytes.subspan(0, count),
+			bytes::make_span(_mapped + _mappedPosition, count));
+		_mappedPosition += count;
+		return count;
+	}
 	return _data.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
 }
 
+size_type File::readMapped(bytes::span bytes) {
+	Expects(_mapped != nullptr);
+	Expects(_state.has_value());
+
+	// Decrypt right from the mapping without an intermediate copy.
+	const auto left = std::max(_mappedSize - _mappedPosition, int64(0));
+	const auto count = std::min(
+		int64(bytes.size()),
+		left - (left % kBlockSize));
+	if (count > 0) {
+		_state->decrypt(
+			bytes::make_span(_mapped + _mappedPosition, count),
+			bytes.subspan(0, count),
+			_encryptionOffset);
+		_encryptionOffset += count;
+		_mappedPosition += count;
+	}
+	return count;
+}
+
 size_type File::writePlain(bytes::const_span bytes) {
 	return _data.write(
 		reinterpret_cast<const char*>(bytes.data()),
 		bytes.size());
 }
 
+int64 File::positionPlain() const {
+	return _mapped ? _mappedPosition : _data.pos();
+}
+
+bool File::seekPlain(int64 position) {
+	if (!_mapped) {
+		return _data.seek(position);
+	} else if (position < 0 || position > _mappedSize) {
+		return false;
+	}
+	_mappedPosition = position;
+	return true;
+}
+
 void File::decrypt(bytes::span bytes) {
 	Expects(_state.has_value());
 
@@ -197,6 +254,9 @@ void File::encrypt(bytes::span bytes) {
 size_type File::read(bytes::span bytes) {
 	Expects(bytes.size() % kBlockSize == 0);
 
+	if (_mapped) {
+		return readMapped(bytes);
+	}
 	auto count = readPlain(bytes);
 	if (const auto back = -(count % kBlockSize)) {
 		if (!_data.seek(_data.pos() + back)) {
@@ -292,6 +352,11 @@ bool File::flush() {
 
 void File::close() {
 	_lock.unlock();
+	if (_mapped) {
+		_data.unmap(_mapped);
+		_mapped = nullptr;
+	}
+	_mappedSize = _mappedPosition = 0;
 	_data.close();
 	_data.setFileName(QString());
 	_dataSize = _encryptionOffset = 0;
@@ -316,7 +381,7 @@ bool File::seek(int64 offset) {
 	const auto realOffset = sizeof(BasicHeader) + offset;
 	if (offset < 0 || offset > _dataSize) {
 		return false;
-	} else if (!_data.seek(FileLock::kSkipBytes + realOffset)) {
+	} else if (!seekPlain(FileLock::kSkipBytes + realOffset)) {
 		return false;
 	}
 	_encryptionOffset = realOffset - kSaltSize;
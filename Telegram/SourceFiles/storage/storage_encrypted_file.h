@@ -18,6 +18,7 @@ class File {
 public:
 	enum class Mode {
 		Read,
+		ReadMapped,
 		ReadAppend,
 		Write,
 	};
@@ -49,6 +50,7 @@ public:
 private:
 	Result attemptOpen(Mode mode, const EncryptionKey &key);
 	Result attemptOpenForRead(const EncryptionKey &key);
+	Result attemptOpenForReadMapped(const EncryptionKey &key);
 	Result attemptOpenForReadAppend(const EncryptionKey &key);
 	Result attemptOpenForWrite(const EncryptionKey &key);
 
@@ -56,7 +58,10 @@ private:
 	Result readHeader(const EncryptionKey &key);
 
 	size_type readPlain(bytes::span bytes);
+	size_type readMapped(bytes::span bytes);
 	size_type writePlain(bytes::const_span bytes);
+	int64 positionPlain() const;
+	bool seekPlain(int64 position);
 	void decrypt(bytes::span bytes);
 	void encrypt(bytes::span bytes);
 	void decryptBack(bytes::span bytes);
@@ -66,6 +71,11 @@ private:
 	int64 _encryptionOffset = 0;
 	int64 _dataSize = 0;
 
+	// In ReadMapped mode we read straight from the file mapping.
+	uchar *_mapped = nullptr;
+	int64 _mappedSize = 0;
+	int64 _mappedPosition = 0;
+
 	std::optional<CtrState> _state;
 
 };
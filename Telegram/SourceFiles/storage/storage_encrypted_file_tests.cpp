@@ -160,6 +160,26 @@ TEST_CASE("simple encrypted file", "[storage_encrypted_file]") {
 		REQUIRE(read == data.size());
 		REQUIRE(data == bytes::concatenate(Test1, Test1));
 	}
+	SECTION("reading mapped file") {
+		Storage::File file;
+
+		const auto result = file.open(
+			Name,
+			Storage::File::Mode::ReadMapped,
+			Key);
+		REQUIRE(result == Storage::File::Result::Success);
+		REQUIRE(file.size() == 3 * Test1.size());
+
+		const auto success = file.seek(Test1.size());
+		REQUIRE(success);
+
+		auto data = bytes::vector(48);
+		const auto read = file.read(data);
+		REQUIRE(read == 32);
+		data.resize(read);
+		REQUIRE(data == bytes::concatenate(Test1, Test1));
+		REQUIRE(file.offset() == 3 * Test1.size());
+	}
 	SECTION("moving file") {
 		const auto result = Storage::File::Move(Name, "other.file");
 		REQUIRE(result);
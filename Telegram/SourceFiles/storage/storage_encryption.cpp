@@ -19,31 +19,44 @@ CtrState::CtrState(bytes::const_span key, bytes::const_span iv) {
 	bytes::copy(_iv, iv);
 }
 
-template <typename Method>
-void CtrState::process(bytes::span data, int64 offset, Method method) {
-	Expects((data.size() % kBlockSize) == 0);
+void CtrState::process(
+		bytes::const_span from,
+		bytes::span to,
+		int64 offset) {
+	Expects(from.size() == to.size());
+	Expects((from.size() % kBlockSize) == 0);
 	Expects((offset % kBlockSize) == 0);
 
-	AES_KEY aes;
-	AES_set_encrypt_key(
-		reinterpret_cast<const uchar*>(_key.data()),
-		_key.size() * CHAR_BIT,
-		&aes);
+	// EVP uses hardware AES (AES-NI, ARMv8) when it is available
+	// and processes many blocks at once instead of one by one.
+	const auto context = EVP_CIPHER_CTX_new();
+	Assert(context != nullptr);
+	const auto guard = gsl::finally([&] {
+		EVP_CIPHER_CTX_free(context);
+	});
 
-	unsigned char ecountBuf[kBlockSize] = { 0 };
-	unsigned int offsetInBlock = 0;
 	const auto blockIndex = offset / kBlockSize;
-	auto iv = incrementedIv(blockIndex);
-
-	CRYPTO_ctr128_encrypt(
-		reinterpret_cast<const uchar*>(data.data()),
-		reinterpret_cast<uchar*>(data.data()),
-		data.size(),
-		&aes,
-		reinterpret_cast<unsigned char*>(iv.data()),
-		ecountBuf,
-		&offsetInBlock,
-		(block128_f)method);
+	const auto iv = incrementedIv(blockIndex);
+	EVP_EncryptInit_ex(
+		context,
+		EVP_aes_256_ctr(),
+		nullptr,
+		reinterpret_cast<const uchar*>(_key.data()),
+		reinterpret_cast<const uchar*>(iv.data()));
+
+	constexpr auto kMaxPart = size_type(1 << 30);
+	for (auto done = size_type(); done != from.size();) {
+		const auto part = std::min(from.size() - done, kMaxPart);
+		auto processed = 0;
+		EVP_EncryptUpdate(
+			context,
+			reinterpret_cast<uchar*>(to.data() + done),
+			&processed,
+			reinterpret_cast<const uchar*>(from.data() + done),
+			int(part));
+		Assert(processed == part);
+		done += part;
+	}
 }
 
 auto CtrState::incrementedIv(int64 blockIndex)
@@ -66,11 +79,18 @@ auto CtrState::incrementedIv(int64 blockIndex)
 }
 
 void CtrState::encrypt(bytes::span data, int64 offset) {
-	return process(data, offset, AES_encrypt);
+	return process(data, data, offset);
 }
 
 void CtrState::decrypt(bytes::span data, int64 offset) {
-	return process(data, offset, AES_encrypt);
+	return process(data, data, offset);
+}
+
+void CtrState::decrypt(
+		bytes::const_span from,
+		bytes::span to,
+		int64 offset) {
+	return process(from, to, offset);
 }
 
 EncryptionKey::EncryptionKey(bytes::vector &&data)
@@ -0,0 +1,89 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "storage/storage_encryption.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+const auto Key = bytes::make_span("\
+abcdefgh01234567abcdefgh01234567\
+").subspan(0, Storage::CtrState::kKeySize);
+
+// The counter overflows in the lower bytes on the first blocks.
+const auto Iv = bytes::make_span(
+	"\x01\x02\x03\x04\x05\x06\x07\x08\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xF0"
+).subspan(0, Storage::CtrState::kIvSize);
+
+bytes::vector MakeData(size_type size) {
+	auto result = bytes::vector(size);
+	for (auto i = size_type(); i != size; ++i) {
+		result[i] = bytes::type(i * 7 + 3);
+	}
+	return result;
+}
+
+} // namespace
+
+TEST_CASE("ctr state encryption", "[storage_encryption]") {
+	auto state = Storage::CtrState(Key, Iv);
+	const auto original = MakeData(64 * Storage::CtrState::kBlockSize);
+
+	SECTION("encrypt and decrypt") {
+		auto data = original;
+		state.encrypt(data, 0);
+		REQUIRE(data != original);
+		state.decrypt(data, 0);
+		REQUIRE(data == original);
+	}
+	SECTION("parts at offsets match the whole") {
+		auto whole = original;
+		state.encrypt(whole, 0);
+
+		auto parts = original;
+		const auto span = bytes::make_span(parts);
+		const auto first = 17 * Storage::CtrState::kBlockSize;
+		state.encrypt(span.subspan(0, first), 0);
+		state.encrypt(span.subspan(first), first);
+		REQUIRE(parts == whole);
+	}
+	SECTION("decrypt to other buffer") {
+		auto encrypted = original;
+		state.encrypt(encrypted, 0);
+
+		auto decrypted = bytes::vector(encrypted.size());
+		state.decrypt(encrypted, decrypted, 0);
+		REQUIRE(decrypted == original);
+	}
+}
+
+TEST_CASE("ctr state benchmark", "[.][storage_encryption][benchmark]") {
+	auto state = Storage::CtrState(Key, Iv);
+	constexpr auto kBlockSize = 8 * 1024 * 1024;
+	constexpr auto kRepeat = 32;
+	auto data = MakeData(kBlockSize);
+
+	const auto start = std::chrono::steady_clock::now();
+	for (auto i = 0; i != kRepeat; ++i) {
+		state.decrypt(data, int64(i) * kBlockSize);
+	}
+	const auto elapsed = std::chrono::duration_cast<
+		std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - start).count();
+	const auto megabytes = (int64(kBlockSize) * kRepeat) / (1024 * 1024);
+	std::cout
+		<< "CtrState::decrypt: "
+		<< megabytes
+		<< " MB in "
+		<< elapsed
+		<< " ms."
+		<< std::endl;
+}
@@ -52,6 +52,52 @@ QSize PrepareShownDimensions(const QImage &preview) {
 		: result;
 }
 
+void PrepareAlbumMedia(PreparedFile &file, int previewWidth) {
+	if (!file.path.isEmpty()) {
+		file.mime = Core::MimeTypeForFile(QFileInfo(file.path)).name();
+		file.information = FileLoadTask::ReadMediaInformation(
+			file.path,
+			QByteArray(),
+			file.mime);
+	} else if (!file.content.isEmpty()) {
+		file.mime = Core::MimeTypeForData(file.content).name();
+		file.information = FileLoadTask::ReadMediaInformation(
+			QString(),
+			file.content,
+			file.mime);
+	} else {
+		Assert(file.information != nullptr);
+	}
+
+	using Image = FileMediaInformation::Image;
+	using Video = FileMediaInformation::Video;
+	if (const auto image = base::get_if<Image>(
+			&file.information->media)) {
+		if (ValidPhotoForAlbum(*image)) {
+			file.shownDimensions = PrepareShownDimensions(image->data);
+			file.preview = Images::prepareOpaque(image->data.scaledToWidth(
+				std::min(previewWidth, ConvertScale(image->data.width()))
+					* cIntRetinaFactor(),
+				Qt::SmoothTransformation));
+			Assert(!file.preview.isNull());
+			file.preview.setDevicePixelRatio(cRetinaFactor());
+			file.type = PreparedFile::AlbumType::Photo;
+		}
+	} else if (const auto video = base::get_if<Video>(
+			&file.information->media)) {
+		if (ValidVideoForAlbum(*video)) {
+			auto blurred = Images::prepareBlur(Images::prepareOpaque(video->thumbnail));
+			file.shownDimensions = PrepareShownDimensions(video->thumbnail);
+			file.preview = std::move(blurred).scaledToWidth(
+				previewWidth * cIntRetinaFactor(),
+				Qt::SmoothTransformation);
+			Assert(!file.preview.isNull());
+			file.preview.setDevicePixelRatio(cRetinaFactor());
+			file.type = PreparedFile::AlbumType::Video;
+		}
+	}
+}
+
 bool PrepareAlbumMediaIsWaiting(
 		QSemaphore &semaphore,
 		PreparedFile &file,
@@ -59,49 +105,7 @@ bool PrepareAlbumMediaIsWaiting(
 	// TODO: Use some special thread queue, like a separate QThreadPool.
 	crl::async([=, &semaphore, &file] {
 		const auto guard = gsl::finally([&] { semaphore.release(); });
-		if (!file.path.isEmpty()) {
-			file.mime = Core::MimeTypeForFile(QFileInfo(file.path)).name();
-			file.information = FileLoadTask::ReadMediaInformation(
-				file.path,
-				QByteArray(),
-				file.mime);
-		} else if (!file.content.isEmpty()) {
-			file.mime = Core::MimeTypeForData(file.content).name();
-			file.information = FileLoadTask::ReadMediaInformation(
-				QString(),
-				file.content,
-				file.mime);
-		} else {
-			Assert(file.information != nullptr);
-		}
-
-		using Image = FileMediaInformation::Image;
-		using Video = FileMediaInformation::Video;
-		if (const auto image = base::get_if<Image>(
-				&file.information->media)) {
-			if (ValidPhotoForAlbum(*image)) {
-				file.shownDimensions = PrepareShownDimensions(image->data);
-				file.preview = Images::prepareOpaque(image->data.scaledToWidth(
-					std::min(previewWidth, ConvertScale(image->data.width()))
-						* cIntRetinaFactor(),
-					Qt::SmoothTransformation));
-				Assert(!file.preview.isNull());
-				file.preview.setDevicePixelRatio(cRetinaFactor());
-				file.type = PreparedFile::AlbumType::Photo;
-			}
-		} else if (const auto video = base::get_if<Video>(
-				&file.information->media)) {
-			if (ValidVideoForAlbum(*video)) {
-				auto blurred = Images::prepareBlur(Images::prepareOpaque(video->thumbnail));
-				file.shownDimensions = PrepareShownDimensions(video->thumbnail);
-				file.preview = std::move(blurred).scaledToWidth(
-					previewWidth * cIntRetinaFactor(),
-					Qt::SmoothTransformation);
-				Assert(!file.preview.isNull());
-				file.preview.setDevicePixelRatio(cRetinaFactor());
-				file.type = PreparedFile::AlbumType::Video;
-			}
-		}
+		PrepareAlbumMedia(file, previewWidth);
 	});
 	return true;
 }
@@ -113,22 +117,26 @@ void PrepareAlbum(PreparedList &result, int previewWidth) {
 	}
 
 	result.albumIsPossible = (count > 1);
+	if (!count) {
+		return;
+	}
 	auto waiting = 0;
 	QSemaphore semaphore;
-	for (auto &file : result.files) {
+	for (auto &file : result.files | ranges::view::drop(1)) {
 		if (PrepareAlbumMediaIsWaiting(semaphore, file, previewWidth)) {
 			++waiting;
 		}
 	}
-	if (waiting > 0) {
-		semaphore.acquire(waiting);
-		if (result.albumIsPossible) {
-			const auto badIt = ranges::find(
-				result.files,
-				PreparedFile::AlbumType::None,
-				[](const PreparedFile &file) { return file.type; });
-			result.albumIsPossible = (badIt == result.files.end());
-		}
+
+	// Don't just wait for the workers, prepare the first file right here.
+	PrepareAlbumMedia(result.files.front(), previewWidth);
+	semaphore.acquire(waiting);
+	if (result.albumIsPossible) {
+		const auto badIt = ranges::find(
+			result.files,
+			PreparedFile::AlbumType::None,
+			[](const PreparedFile &file) { return file.type; });
+		result.albumIsPossible = (badIt == result.files.end());
 	}
 }
 
@@ -45,8 +45,16 @@ SparseIdsList::AddResult SparseIdsList::uniteAndAdd(
 	const auto firstToErase = uniteFrom + 1;
 	if (firstToErase != uniteTill) {
 		for (auto it = firstToErase; it != uniteTill; ++it) {
+			auto taken = base::flat_set<MsgId>();
+			_slices.modify(it, [&](Slice &slice) {
+				std::swap(taken, slice.messages);
+			});
 			_slices.modify(uniteFrom, [&](Slice &slice) {
-				slice.merge(it->messages, it->range);
+				// Merge the smaller set into the larger one.
+				if (taken.size() > slice.messages.size()) {
+					std::swap(taken, slice.messages);
+				}
+				slice.merge(taken, it->range);
 			});
 		}
 		_slices.erase(firstToErase, uniteTill);
@@ -274,6 +274,7 @@ TemplatesIndex ComputeIndex(const TemplatesData &data) {
 
 	auto uniqueFirst = std::map<QChar, base::flat_set<Id>>();
 	auto uniqueFull = std::map<Id, base::flat_set<Term>>();
+	auto uniqueKeys = std::map<QString, base::flat_set<Id>>();
 	const auto pushString = [&](
 			const Id &id,
 			const QString &string,
@@ -289,6 +290,7 @@ TemplatesIndex ComputeIndex(const TemplatesData &data) {
 			const auto id = std::make_pair(path, normalized);
 			for (const auto &key : question.normalizedKeys) {
 				pushString(id, key, kWeightStep * kWeightStep);
+				uniqueKeys[key].emplace(id);
 			}
 			pushString(id, question.question, kWeightStep);
 			pushString(id, question.value, 1);
@@ -302,6 +304,9 @@ TemplatesIndex ComputeIndex(const TemplatesData &data) {
 	for (const auto &[id, unique] : uniqueFull) {
 		result.full.emplace(id, unique | ranges::to_vector);
 	}
+	for (const auto &[key, unique] : uniqueKeys) {
+		result.keys.emplace(key, unique | ranges::to_vector);
+	}
 	return result;
 }
 
@@ -321,23 +326,33 @@ void ReplaceFileIndex(
 	}
 
 	using Id = TemplatesIndex::Id;
-	for (auto &[ch, list] : result.first) {
-		auto i = ranges::lower_bound(
-			list,
-			std::make_pair(path, QString()));
-		auto j = std::find_if(i, end(list), [&](const Id &id) {
-			return id.first != path;
-		});
-		list.erase(i, j);
-	}
-	for (auto &[ch, list] : source.first) {
-		auto &to = result.first[ch];
-		to.insert(
-			end(to),
-			std::make_move_iterator(begin(list)),
-			std::make_move_iterator(end(list)));
-		ranges::sort(to);
-	}
+	const auto replace = [&](auto &to, auto &from) {
+		for (auto i = begin(to); i != end(to);) {
+			auto &list = i->second;
+			auto j = ranges::lower_bound(
+				list,
+				std::make_pair(path, QString()));
+			auto k = std::find_if(j, end(list), [&](const Id &id) {
+				return id.first != path;
+			});
+			list.erase(j, k);
+			if (list.empty()) {
+				i = to.erase(i);
+			} else {
+				++i;
+			}
+		}
+		for (auto &[key, list] : from) {
+			auto &ids = to[key];
+			ids.insert(
+				end(ids),
+				std::make_move_iterator(begin(list)),
+				std::make_move_iterator(end(list)));
+			ranges::sort(ids);
+		}
+	};
+	replace(result.first, source.first);
+	replace(result.keys, source.keys);
 }
 
 void MoveKeys(TemplatesFile &to, const TemplatesFile &from) {
@@ -626,16 +641,15 @@ auto Templates::matchExact(QString query) const
 
 	query = NormalizeKey(query);
 
-	for (const auto &[path, file] : _data.files) {
-		for (const auto &[normalized, question] : file.questions) {
-			for (const auto &key : question.normalizedKeys) {
-				if (key == query) {
-					return QuestionByKey{ question, key };
-				}
-			}
-		}
+	const auto i = _index.keys.find(query);
+	if (i == end(_index.keys)) {
+		return {};
 	}
-	return {};
+	const auto &id = i->second.front();
+	return QuestionByKey{
+		_data.files.at(id.first).questions.at(id.second),
+		query
+	};
 }
 
 auto Templates::matchFromEnd(QString query) const
@@ -644,26 +658,23 @@ auto Templates::matchFromEnd(QString query) const
 		query = query.mid(query.size() - _maxKeyLength);
 	}
 
-	const auto size = query.size();
-	auto queries = std::vector<QString>();
-	queries.reserve(size);
-	for (auto i = 0; i != size; ++i) {
-		queries.push_back(NormalizeKey(query.mid(size - i - 1)));
-	}
-
-	auto result = std::optional<QuestionByKey>();
-	for (const auto &[path, file] : _data.files) {
-		for (const auto &[normalized, question] : file.questions) {
-			for (const auto &key : question.normalizedKeys) {
-				if (key.size() <= queries.size()
-					&& queries[key.size() - 1] == key
-					&& (!result || result->key.size() <= key.size())) {
-					result = QuestionByKey{ question, key };
-				}
-			}
+	// The longest matching key wins.
+	for (auto length = query.size(); length > 0; --length) {
+		const auto key = NormalizeKey(query.mid(query.size() - length));
+		if (key.size() != length) {
+			continue;
+		}
+		const auto i = _index.keys.find(key);
+		if (i == end(_index.keys)) {
+			continue;
 		}
+		const auto &id = i->second.back();
+		return QuestionByKey{
+			_data.files.at(id.first).questions.at(id.second),
+			key
+		};
 	}
-	return result;
+	return {};
 }
 
 Templates::~Templates() = default;
@@ -36,6 +36,7 @@ struct TemplatesIndex {
 
 	std::map<QChar, std::vector<Id>> first;
 	std::map<Id, std::vector<Term>> full;
+	std::map<QString, std::vector<Id>> keys; // normalized key
 };
 
 } // namespace details
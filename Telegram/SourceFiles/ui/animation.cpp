@@ -16,9 +16,12 @@ Reader *const ReaderPointer::BadPointer = SharedMemoryLocation<Reader, 0>();
 
 ReaderPointer::~ReaderPointer() {
 	if (valid()) {
-		delete _pointer;
+		if (!_subscription || !_pointer->unsubscribe(_subscription)) {
+			delete _pointer;
+		}
 	}
 	_pointer = nullptr;
+	_subscription = 0;
 }
 
 } // namespace Clip
@@ -26,9 +29,24 @@ ReaderPointer::~ReaderPointer() {
 
 namespace {
 
+// While all the windows are hidden or minimized nobody sees the frames,
+// so we only keep the animations going to let them finish in time.
+constexpr auto kHiddenAnimationTimerDelta = 250;
+constexpr auto kStatsPeriod = TimeMs(1000);
+
 AnimationManager *_manager = nullptr;
 bool AnimationsDisabled = false;
 
+bool AnyWindowShown() {
+	for (const auto window : QGuiApplication::topLevelWindows()) {
+		if (window->isVisible()
+			&& !(window->windowState() & Qt::WindowMinimized)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 } // namespace
 
 namespace anim {
@@ -158,6 +176,41 @@ void BasicAnimation::stop() {
 AnimationManager::AnimationManager() : _timer(this) {
 	_timer.setSingleShot(false);
 	connect(&_timer, &QTimer::timeout, this, &AnimationManager::step);
+	connect(
+		qApp,
+		&QGuiApplication::applicationStateChanged,
+		this,
+		[=] { updateTimerInterval(); });
+}
+
+void AnimationManager::updateTimerInterval() {
+	if (!_timer.isActive()) {
+		return;
+	}
+	const auto interval = AnyWindowShown()
+		? AnimationTimerDelta
+		: kHiddenAnimationTimerDelta;
+	if (_timer.interval() != interval) {
+		_timer.start(interval);
+	}
+}
+
+void AnimationManager::countFrame(TimeMs ms) {
+	if (!Logs::DebugEnabled()) {
+		return;
+	}
+	++_statsFrames;
+	accumulate_max(_statsMaxObjects, int(_objects.size()));
+	if (!_statsStart) {
+		_statsStart = ms;
+	} else if (ms - _statsStart >= kStatsPeriod) {
+		DEBUG_LOG(("Animations: %1 frames in %2 ms, up to %3 active."
+			).arg(_statsFrames
+			).arg(ms - _statsStart
+			).arg(_statsMaxObjects));
+		_statsStart = ms;
+		_statsFrames = _statsMaxObjects = 0;
+	}
 }
 
 void AnimationManager::start(BasicAnimation *obj) {
@@ -202,6 +255,7 @@ void AnimationManager::registerClip(not_null<Media::Clip::Manager*> clip) {
 void AnimationManager::step() {
 	_iterating = true;
 	const auto ms = getms();
+	countFrame(ms);
 	for (const auto object : _objects) {
 		if (!_stopping.contains(object)) {
 			object->step(ms, true);
@@ -223,6 +277,10 @@ void AnimationManager::step() {
 	}
 	if (_objects.empty()) {
 		_timer.stop();
+		_statsStart = 0;
+		_statsFrames = _statsMaxObjects = 0;
+	} else {
+		updateTimerInterval();
 	}
 }
 
@@ -20,11 +20,15 @@ class ReaderPointer {
 public:
 	ReaderPointer(std::nullptr_t = nullptr) {
 	}
-	explicit ReaderPointer(Reader *pointer) : _pointer(pointer) {
+	explicit ReaderPointer(Reader *pointer, int subscription = 0)
+	: _pointer(pointer)
+	, _subscription(subscription) {
 	}
 	ReaderPointer(const ReaderPointer &other) = delete;
 	ReaderPointer &operator=(const ReaderPointer &other) = delete;
-	ReaderPointer(ReaderPointer &&other) : _pointer(base::take(other._pointer)) {
+	ReaderPointer(ReaderPointer &&other)
+	: _pointer(base::take(other._pointer))
+	, _subscription(base::take(other._subscription)) {
 	}
 	ReaderPointer &operator=(ReaderPointer &&other) {
 		swap(other);
@@ -32,6 +36,7 @@ public:
 	}
 	void swap(ReaderPointer &other) {
 		qSwap(_pointer, other._pointer);
+		qSwap(_subscription, other._subscription);
 	}
 	Reader *get() const {
 		return valid() ? _pointer : nullptr;
@@ -65,6 +70,7 @@ public:
 
 private:
 	Reader *_pointer = nullptr;
+	int _subscription = 0;
 	static Reader *const BadPointer;
 
 };
@@ -716,9 +722,15 @@ private:
 		Media::Clip::Reader *reader,
 		qint32 threadIndex,
 		qint32 notification);
+	void updateTimerInterval();
+	void countFrame(TimeMs ms);
 
 	base::flat_set<BasicAnimation*> _objects, _starting, _stopping;
 	QTimer _timer;
 	bool _iterating = false;
 
+	TimeMs _statsStart = 0;
+	int _statsFrames = 0;
+	int _statsMaxObjects = 0;
+
 };
@@ -8,12 +8,34 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/effects/panel_animation.h"
 
 namespace Ui {
+namespace {
+
+// Panels are shown again and again with the same size, so the frame of
+// the last finished animation is kept instead of allocating a new one.
+// Every frame fully overwrites the painted area, old contents are fine.
+QImage &ReleasedFrame() {
+	static auto result = QImage();
+	return result;
+}
+
+} // namespace
+
+RoundShadowAnimation::~RoundShadowAnimation() {
+	if (!_frame.isNull() && _frame.isDetached()) {
+		ReleasedFrame() = std::move(_frame);
+	}
+}
 
 void RoundShadowAnimation::start(int frameWidth, int frameHeight, float64 devicePixelRatio) {
 	Assert(!started());
 	_frameWidth = frameWidth;
 	_frameHeight = frameHeight;
-	_frame = QImage(_frameWidth, _frameHeight, QImage::Format_ARGB32_Premultiplied);
+	auto &released = ReleasedFrame();
+	if (released.size() == QSize(_frameWidth, _frameHeight)) {
+		_frame = base::take(released);
+	} else {
+		_frame = QImage(_frameWidth, _frameHeight, QImage::Format_ARGB32_Premultiplied);
+	}
 	_frame.setDevicePixelRatio(devicePixelRatio);
 	_frameIntsPerLine = (_frame.bytesPerLine() >> 2);
 	_frameInts = reinterpret_cast<uint32*>(_frame.bits());
@@ -13,6 +13,8 @@ namespace Ui {
 
 class RoundShadowAnimation {
 public:
+	~RoundShadowAnimation();
+
 	void setCornerMasks(const QImage &topLeft, const QImage &topRight, const QImage &bottomLeft, const QImage &bottomRight);
 
 protected:
@@ -47,14 +47,24 @@ public:
 	void draw(QPainter &p, EmojiPtr emoji, int x, int y);
 
 private:
-	void readCache();
+	bool ensureSpriteLoaded(int index);
+	int chooseSpriteToCache() const;
 	void generateCache();
-	void checkUniversalImages();
-	void pushSprite(QImage &&data);
+	void generateSprite(int index);
+	void spriteReady(int index, QImage &&data);
+	void checkUniversalId();
+	bool checkUniversalImages();
+	void setSprite(int index, QImage &&data);
 
 	int _id = 0;
 	int _size = 0;
+
+	// Sprites are kept in memory only after they were drawn once.
+	// Others are only checked to be cached on disk.
 	std::vector<QPixmap> _sprites;
+	std::vector<bool> _stored;
+	std::vector<bool> _wanted;
+	int _generatingIndex = -1;
 	base::binary_guard _generating;
 
 };
@@ -881,19 +891,22 @@ void Draw(QPainter &p, EmojiPtr emoji, int size, int x, int y) {
 	}
 }
 
-Instance::Instance(int size) : _id(Universal->id()), _size(size) {
+Instance::Instance(int size)
+: _id(Universal->id())
+, _size(size)
+, _sprites(SpritesCount)
+, _stored(SpritesCount, false)
+, _wanted(SpritesCount, false) {
 	Expects(Universal != nullptr);
 
-	readCache();
-	if (!cached()) {
-		generateCache();
-	}
+	generateCache();
 }
 
 bool Instance::cached() const {
 	Expects(Universal != nullptr);
 
-	return (Universal->id() == _id) && (_sprites.size() == SpritesCount);
+	return (Universal->id() == _id)
+		&& (ranges::find(_stored, false) == _stored.end());
 }
 
 void Instance::draw(QPainter &p, EmojiPtr emoji, int x, int y) {
@@ -901,9 +914,11 @@ void Instance::draw(QPainter &p, EmojiPtr emoji, int x, int y) {
 		generateCache();
 	}
 	const auto sprite = emoji->sprite();
-	if (sprite >= _sprites.size()) {
+	if (!ensureSpriteLoaded(sprite)) {
 		Assert(Universal != nullptr);
-		Universal->draw(p, emoji, _size, x, y);
+		if (checkUniversalImages()) {
+			Universal->draw(p, emoji, _size, x, y);
+		}
 		return;
 	}
 	p.drawPixmap(
@@ -912,34 +927,100 @@ void Instance::draw(QPainter &p, EmojiPtr emoji, int x, int y) {
 		QRect(emoji->column() * _size, emoji->row() * _size, _size, _size));
 }
 
-void Instance::readCache() {
+bool Instance::ensureSpriteLoaded(int index) {
+	Expects(index >= 0 && index < int(_sprites.size()));
+
+	if (!_sprites[index].isNull()) {
+		return true;
+	} else if (_stored[index]) {
+		auto image = LoadFromFile(_id, _size, index);
+		if (!image.isNull()) {
+			setSprite(index, std::move(image));
+			return true;
+		}
+		_stored[index] = false;
+	}
+	if (!_wanted[index]) {
+		_wanted[index] = true;
+		if (_generatingIndex < 0) {
+			generateCache();
+		}
+	}
+	return false;
+}
+
+int Instance::chooseSpriteToCache() const {
+	// First the sprites that were already asked to be drawn.
 	for (auto i = 0; i != SpritesCount; ++i) {
-		auto image = LoadFromFile(_id, _size, i);
-		if (image.isNull()) {
-			return;
+		if (_wanted[i] && !_stored[i]) {
+			return i;
 		}
-		pushSprite(std::move(image));
 	}
+	const auto i = ranges::find(_stored, false);
+	return (i != _stored.end()) ? int(i - _stored.begin()) : -1;
 }
 
-void Instance::checkUniversalImages() {
+void Instance::checkUniversalId() {
 	Expects(Universal != nullptr);
 
 	if (_id != Universal->id()) {
 		_id = Universal->id();
+		_generatingIndex = -1;
 		_generating = nullptr;
-		_sprites.clear();
+		ranges::fill(_sprites, QPixmap());
+		ranges::fill(_stored, false);
 	}
+}
+
+bool Instance::checkUniversalImages() {
+	Expects(Universal != nullptr);
+
 	if (!Universal->ensureLoaded() && Universal->id() != 0) {
 		ClearCurrentSetIdSync();
 	}
+	return Universal->ensureLoaded();
 }
 
 void Instance::generateCache() {
-	checkUniversalImages();
+	checkUniversalId();
+
+	const auto index = chooseSpriteToCache();
+	_generatingIndex = index;
+	if (index < 0) {
+		_generating = nullptr;
+		ClearUniversalChecked();
+		return;
+	}
+	const auto id = _id;
+	const auto size = _size;
+	auto [left, right] = base::make_binary_guard();
+	_generating = std::move(left);
+	crl::async([=, guard = std::move(right)]() mutable {
+		crl::on_main([
+			=,
+			image = LoadFromFile(id, size, index),
+			guard = std::move(guard)
+		]() mutable {
+			if (!guard) {
+				return;
+			} else if (image.isNull()) {
+				generateSprite(index);
+			} else {
+				spriteReady(index, std::move(image));
+			}
+		});
+	});
+}
+
+void Instance::generateSprite(int index) {
+	if (!checkUniversalImages()) {
+		_generatingIndex = -1;
+		_generating = nullptr;
+		return;
+	}
+	checkUniversalId();
 
 	const auto size = _size;
-	const auto index = _sprites.size();
 	auto [left, right] = base::make_binary_guard();
 	_generating = std::move(left);
 	crl::async([
@@ -955,19 +1036,22 @@ void Instance::generateCache() {
 			if (!guard || universal != Universal) {
 				return;
 			}
-			pushSprite(std::move(image));
-			if (cached()) {
-				ClearUniversalChecked();
-			} else {
-				generateCache();
-			}
+			spriteReady(index, std::move(image));
 		});
 	});
 }
 
-void Instance::pushSprite(QImage &&data) {
-	_sprites.push_back(App::pixmapFromImageInPlace(std::move(data)));
-	_sprites.back().setDevicePixelRatio(cRetinaFactor());
+void Instance::spriteReady(int index, QImage &&data) {
+	_stored[index] = true;
+	if (_wanted[index] && _sprites[index].isNull()) {
+		setSprite(index, std::move(data));
+	}
+	generateCache();
+}
+
+void Instance::setSprite(int index, QImage &&data) {
+	_sprites[index] = App::pixmapFromImageInPlace(std::move(data));
+	_sprites[index].setDevicePixelRatio(cRetinaFactor());
 }
 
 } // namespace Emoji
@@ -9,9 +9,101 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "data/data_peer.h"
 #include "ui/emoji_config.h"
+#include "base/last_used_cache.h"
 #include "styles/style_history.h"
 
 namespace Ui {
+namespace {
+
+// Placeholders are the same for all peers with the same color and
+// initials, so they are rendered once and shared between all of them.
+constexpr auto kMemoryForCache = 8 * 1024 * 1024;
+
+struct CacheKey {
+	QRgb bg = 0;
+	QRgb fg = 0;
+	QString string;
+	int size = 0;
+	int shape = 0;
+};
+
+inline bool operator==(const CacheKey &a, const CacheKey &b) {
+	return (a.bg == b.bg)
+		&& (a.fg == b.fg)
+		&& (a.size == b.size)
+		&& (a.shape == b.shape)
+		&& (a.string == b.string);
+}
+
+} // namespace
+} // namespace Ui
+
+namespace std {
+
+template <>
+struct hash<Ui::CacheKey> {
+	size_t operator()(const Ui::CacheKey &key) const {
+		return qHash(key.string)
+			^ hash<QRgb>()(key.bg)
+			^ (hash<int>()(key.size) << 1)
+			^ (hash<int>()(key.shape) << 2);
+	}
+};
+
+} // namespace std
+
+namespace Ui {
+namespace {
+
+class PixmapsCache {
+public:
+	template <typename Callback>
+	const QPixmap &get(const CacheKey &key, Callback paint);
+
+private:
+	std::unordered_map<CacheKey, QPixmap> _pixmaps;
+	base::last_used_cache<CacheKey> _lastUsed;
+	int64 _usage = 0;
+
+};
+
+template <typename Callback>
+const QPixmap &PixmapsCache::get(const CacheKey &key, Callback paint) {
+	const auto i = _pixmaps.find(key);
+	if (i != end(_pixmaps)) {
+		_lastUsed.up(key);
+		return i->second;
+	}
+	auto image = QImage(
+		QSize(key.size, key.size) * cIntRetinaFactor(),
+		QImage::Format_ARGB32_Premultiplied);
+	image.setDevicePixelRatio(cRetinaFactor());
+	image.fill(Qt::transparent);
+	{
+		Painter p(&image);
+		paint(p);
+	}
+	_usage += int64(image.width()) * image.height() * 4;
+	const auto &result = _pixmaps.emplace(
+		key,
+		App::pixmapFromImageInPlace(std::move(image))).first->second;
+	_lastUsed.up(key);
+
+	while (_usage > kMemoryForCache && _pixmaps.size() > 1) {
+		const auto j = _pixmaps.find(_lastUsed.take_lowest());
+		Assert(j != end(_pixmaps));
+		_usage -= int64(j->second.width()) * j->second.height() * 4;
+		_pixmaps.erase(j);
+	}
+	return result;
+}
+
+PixmapsCache &Cache() {
+	static auto Instance = PixmapsCache();
+	return Instance;
+}
+
+} // namespace
 
 EmptyUserpic::EmptyUserpic(const style::color &color, const QString &name)
 : _color(color) {
@@ -49,23 +141,61 @@ void EmptyUserpic::paint(
 		int y,
 		int outerWidth,
 		int size) const {
-	paint(p, x, y, outerWidth, size, [&p, x, y, size] {
-		p.drawEllipse(x, y, size, size);
-	});
+	paintCached(p, x, y, outerWidth, size, Shape::Circle);
 }
 
 void EmptyUserpic::paintRounded(Painter &p, int x, int y, int outerWidth, int size) const {
-	paint(p, x, y, outerWidth, size, [&p, x, y, size] {
-		p.drawRoundedRect(x, y, size, size, st::buttonRadius, st::buttonRadius);
-	});
+	paintCached(p, x, y, outerWidth, size, Shape::Rounded);
 }
 
 void EmptyUserpic::paintSquare(Painter &p, int x, int y, int outerWidth, int size) const {
-	paint(p, x, y, outerWidth, size, [&p, x, y, size] {
-		p.fillRect(x, y, size, size, p.brush());
+	paintCached(p, x, y, outerWidth, size, Shape::Square);
+}
+
+void EmptyUserpic::paintCached(
+		Painter &p,
+		int x,
+		int y,
+		int outerWidth,
+		int size,
+		Shape shape) const {
+	x = rtl() ? (outerWidth - x - size) : x;
+	p.drawPixmap(x, y, cached(size, shape));
+}
+
+const QPixmap &EmptyUserpic::cached(int size, Shape shape) const {
+	const auto key = CacheKey{
+		_color->c.rgba(),
+		st::historyPeerUserpicFg->c.rgba(),
+		_string,
+		size,
+		int(shape)
+	};
+	return Cache().get(key, [&](Painter &p) {
+		paintUncached(p, size, shape);
 	});
 }
 
+void EmptyUserpic::paintUncached(Painter &p, int size, Shape shape) const {
+	switch (shape) {
+	case Shape::Circle:
+		paint(p, 0, 0, size, size, [&] {
+			p.drawEllipse(0, 0, size, size);
+		});
+		break;
+	case Shape::Rounded:
+		paint(p, 0, 0, size, size, [&] {
+			p.drawRoundedRect(0, 0, size, size, st::buttonRadius, st::buttonRadius);
+		});
+		break;
+	case Shape::Square:
+		paint(p, 0, 0, size, size, [&] {
+			p.fillRect(0, 0, size, size, p.brush());
+		});
+		break;
+	}
+}
+
 void EmptyUserpic::PaintSavedMessages(
 		Painter &p,
 		int x,
@@ -168,14 +298,7 @@ StorageKey EmptyUserpic::uniqueKey() const {
 }
 
 QPixmap EmptyUserpic::generate(int size) {
-	auto result = QImage(QSize(size, size) * cIntRetinaFactor(), QImage::Format_ARGB32_Premultiplied);
-	result.setDevicePixelRatio(cRetinaFactor());
-	result.fill(Qt::transparent);
-	{
-		Painter p(&result);
-		paint(p, 0, 0, size, size);
-	}
-	return App::pixmapFromImageInPlace(std::move(result));
+	return cached(size, Shape::Circle);
 }
 
 void EmptyUserpic::fillString(const QString &name) {
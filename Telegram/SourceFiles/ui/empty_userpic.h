@@ -52,6 +52,22 @@ public:
 	~EmptyUserpic();
 
 private:
+	enum class Shape {
+		Circle,
+		Rounded,
+		Square,
+	};
+
+	void paintCached(
+		Painter &p,
+		int x,
+		int y,
+		int outerWidth,
+		int size,
+		Shape shape) const;
+	void paintUncached(Painter &p, int size, Shape shape) const;
+	const QPixmap &cached(int size, Shape shape) const;
+
 	template <typename Callback>
 	void paint(
 		Painter &p,
@@ -10,6 +10,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Ui {
 namespace {
 
+// Albums are laid out again every time their views are created, after
+// the history is reloaded or the style is changed, with the same sizes.
+// Layouts are computed only on the main thread.
+constexpr auto kLayoutCacheLimit = 256;
+
 int Round(float64 value) {
 	return int(std::round(value));
 }
@@ -572,7 +577,29 @@ std::vector<GroupMediaLayout> LayoutMediaGroup(
 		int maxWidth,
 		int minWidth,
 		int spacing) {
-	return Layouter(sizes, maxWidth, minWidth, spacing).layout();
+	static auto Cache = std::map<
+		std::vector<int>,
+		std::vector<GroupMediaLayout>>();
+
+	auto key = std::vector<int>();
+	key.reserve(3 + 2 * sizes.size());
+	key.push_back(maxWidth);
+	key.push_back(minWidth);
+	key.push_back(spacing);
+	for (const auto &size : sizes) {
+		key.push_back(size.width());
+		key.push_back(size.height());
+	}
+	const auto i = Cache.find(key);
+	if (i != end(Cache)) {
+		return i->second;
+	}
+	auto result = Layouter(sizes, maxWidth, minWidth, spacing).layout();
+	if (Cache.size() >= kLayoutCacheLimit) {
+		Cache.clear();
+	}
+	Cache.emplace(std::move(key), result);
+	return result;
 }
 
 RectParts GetCornersFromSides(RectParts sides) {
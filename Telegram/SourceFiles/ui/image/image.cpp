@@ -22,6 +22,38 @@ namespace {
 // After 128 MB of unpacked images we try to clear some memory.
 constexpr auto kMemoryForCache = 128 * 1024 * 1024;
 
+// Scaled, rounded and blurred pixmaps are limited separately and are
+// cleared one by one, so that a large original is not reloaded only
+// because of many small thumbnails prepared from other images.
+constexpr auto kMemoryForVariants = 64 * 1024 * 1024;
+
+struct VariantKey {
+	const Image *image = nullptr;
+	uint64 key = 0;
+	int64 usage = 0;
+};
+
+inline bool operator==(const VariantKey &a, const VariantKey &b) {
+	return (a.image == b.image) && (a.key == b.key);
+}
+
+} // namespace
+} // namespace Images
+
+namespace std {
+
+template <>
+struct hash<Images::VariantKey> {
+	size_t operator()(const Images::VariantKey &key) const {
+		return hash<const Image*>()(key.image) ^ hash<uint64>()(key.key);
+	}
+};
+
+} // namespace std
+
+namespace Images {
+namespace {
+
 QMap<QString, Image*> LocalFileImages;
 QMap<QString, Image*> WebUrlImages;
 QMap<StorageKey, Image*> StorageImages;
@@ -47,6 +79,73 @@ Core::MediaActiveCache<const Image> &ActiveCache() {
 	return Instance;
 }
 
+class VariantsCache {
+public:
+	VariantsCache();
+
+	void up(const Image *image, uint64 key);
+	void add(const Image *image, uint64 key, int64 usage);
+	void remove(const Image *image, uint64 key, int64 usage);
+	void clear();
+
+private:
+	void check();
+
+	base::last_used_cache<VariantKey> _cache;
+	SingleQueuedInvokation _delayed;
+	int64 _usage = 0;
+	int64 _cleared = 0;
+
+};
+
+VariantsCache::VariantsCache() : _delayed([=] { check(); }) {
+}
+
+void VariantsCache::up(const Image *image, uint64 key) {
+	_cache.up({ image, key });
+}
+
+void VariantsCache::add(const Image *image, uint64 key, int64 usage) {
+	_cache.up({ image, key, usage });
+	_usage += usage;
+	_delayed.call();
+}
+
+void VariantsCache::remove(const Image *image, uint64 key, int64 usage) {
+	_cache.remove({ image, key });
+	_usage -= usage;
+}
+
+void VariantsCache::clear() {
+	_cache.clear();
+}
+
+void VariantsCache::check() {
+	auto cleared = 0;
+	while (_usage > kMemoryForVariants) {
+		const auto entry = _cache.take_lowest();
+		if (!entry.image) {
+			break;
+		}
+		_usage -= entry.usage;
+		_cleared += entry.usage;
+		entry.image->forgetPix(entry.key);
+		++cleared;
+	}
+	if (cleared) {
+		DEBUG_LOG(("Images Info: cleared %1 pixmaps, %2 bytes kept, "
+			"%3 bytes cleared in total."
+			).arg(cleared
+			).arg(_usage
+			).arg(_cleared));
+	}
+}
+
+VariantsCache &Variants() {
+	static auto Instance = VariantsCache();
+	return Instance;
+}
+
 uint64 PixKey(int width, int height, Options options) {
 	return static_cast<uint64>(width)
 		| (static_cast<uint64>(height) << 24)
@@ -57,6 +156,20 @@ uint64 SinglePixKey(Options options) {
 	return PixKey(0, 0, options);
 }
 
+// Maps of points closer than half of a map pixel look the same, so
+// near-identical locations (like live location updates) share one map.
+GeoPointLocation QuantizeGeoPoint(GeoPointLocation location) {
+	// At zoom Z the whole world is 256 * 2^Z map pixels wide.
+	const auto zoom = std::clamp(location.zoom, 0, 22);
+	const auto step = 180. / (256. * (1 << zoom));
+	const auto quantize = [&](float64 value) {
+		return std::round(value / step) * step;
+	};
+	location.lat = quantize(location.lat);
+	location.lon = quantize(location.lon);
+	return location;
+}
+
 } // namespace
 
 void ClearRemote() {
@@ -76,6 +189,7 @@ void ClearRemote() {
 
 void ClearAll() {
 	ActiveCache().clear();
+	Variants().clear();
 	for (auto image : base::take(LocalFileImages)) {
 		delete image;
 	}
@@ -317,12 +431,13 @@ ImagePtr Create(
 }
 
 ImagePtr Create(const GeoPointLocation &location) {
-	const auto key = storageKey(location);
+	const auto quantized = QuantizeGeoPoint(location);
+	const auto key = storageKey(quantized);
 	auto i = GeoPointImages.constFind(key);
 	if (i == GeoPointImages.cend()) {
 		i = GeoPointImages.insert(
 			key,
-			new Image(std::make_unique<GeoPointSource>(location)));
+			new Image(std::make_unique<GeoPointSource>(quantized)));
 	}
 	return ImagePtr(i.value());
 }
@@ -376,7 +491,9 @@ const QPixmap &Image::pix(
 		auto p = pixNoCache(origin, w, h, options);
         p.setDevicePixelRatio(cRetinaFactor());
 		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		Variants().add(this, k, ComputeUsage(*i));
+	} else {
+		Variants().up(this, k);
 	}
 	return i.value();
 }
@@ -415,7 +532,9 @@ const QPixmap &Image::pixRounded(
 		auto p = pixNoCache(origin, w, h, options);
 		p.setDevicePixelRatio(cRetinaFactor());
 		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		Variants().add(this, k, ComputeUsage(*i));
+	} else {
+		Variants().up(this, k);
 	}
 	return i.value();
 }
@@ -439,7 +558,9 @@ const QPixmap &Image::pixCircled(
 		auto p = pixNoCache(origin, w, h, options);
 		p.setDevicePixelRatio(cRetinaFactor());
 		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		Variants().add(this, k, ComputeUsage(*i));
+	} else {
+		Variants().up(this, k);
 	}
 	return i.value();
 }
@@ -463,7 +584,9 @@ const QPixmap &Image::pixBlurredCircled(
 		auto p = pixNoCache(origin, w, h, options);
 		p.setDevicePixelRatio(cRetinaFactor());
 		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		Variants().add(this, k, ComputeUsage(*i));
+	} else {
+		Variants().up(this, k);
 	}
 	return i.value();
 }
@@ -487,7 +610,9 @@ const QPixmap &Image::pixBlurred(
 		auto p = pixNoCache(origin, w, h, options);
 		p.setDevicePixelRatio(cRetinaFactor());
 		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		Variants().add(this, k, ComputeUsage(*i));
+	} else {
+		Variants().up(this, k);
 	}
 	return i.value();
 }
@@ -512,7 +637,9 @@ const QPixmap &Image::pixColored(
 		auto p = pixColoredNoCache(origin, add, w, h, true);
 		p.setDevicePixelRatio(cRetinaFactor());
 		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		Variants().add(this, k, ComputeUsage(*i));
+	} else {
+		Variants().up(this, k);
 	}
 	return i.value();
 }
@@ -537,7 +664,9 @@ const QPixmap &Image::pixBlurredColored(
 		auto p = pixBlurredColoredNoCache(origin, add, w, h);
 		p.setDevicePixelRatio(cRetinaFactor());
 		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		Variants().add(this, k, ComputeUsage(*i));
+	} else {
+		Variants().up(this, k);
 	}
 	return i.value();
 }
@@ -582,12 +711,14 @@ const QPixmap &Image::pixSingle(
 	auto i = _sizesCache.constFind(k);
 	if (i == _sizesCache.cend() || i->width() != (outerw * cIntRetinaFactor()) || i->height() != (outerh * cIntRetinaFactor())) {
 		if (i != _sizesCache.cend()) {
-			ActiveCache().decrement(ComputeUsage(*i));
+			Variants().remove(this, k, ComputeUsage(*i));
 		}
 		auto p = pixNoCache(origin, w, h, options, outerw, outerh, colored);
 		p.setDevicePixelRatio(cRetinaFactor());
 		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		Variants().add(this, k, ComputeUsage(*i));
+	} else {
+		Variants().up(this, k);
 	}
 	return i.value();
 }
@@ -628,16 +759,62 @@ const QPixmap &Image::pixBlurredSingle(
 	auto i = _sizesCache.constFind(k);
 	if (i == _sizesCache.cend() || i->width() != (outerw * cIntRetinaFactor()) || i->height() != (outerh * cIntRetinaFactor())) {
 		if (i != _sizesCache.cend()) {
-			ActiveCache().decrement(ComputeUsage(*i));
+			Variants().remove(this, k, ComputeUsage(*i));
 		}
 		auto p = pixNoCache(origin, w, h, options, outerw, outerh);
 		p.setDevicePixelRatio(cRetinaFactor());
 		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+		Variants().add(this, k, ComputeUsage(*i));
+	} else {
+		Variants().up(this, k);
 	}
 	return i.value();
 }
 
+QPixmap Image::pixProgressiveSingle(
+		int32 w,
+		int32 h,
+		int32 outerw,
+		int32 outerh,
+		ImageRoundRadius radius,
+		RectParts corners) const {
+	checkSource();
+
+	if (_progressive.isNull()) {
+		return QPixmap();
+	} else if (w <= 0) {
+		w = _progressive.width();
+		h = _progressive.height();
+	} else {
+		w *= cIntRetinaFactor();
+		h *= cIntRetinaFactor();
+	}
+	if (_progressiveCache.width() == (outerw * cIntRetinaFactor())
+		&& _progressiveCache.height() == (outerh * cIntRetinaFactor())) {
+		return _progressiveCache;
+	}
+
+	auto options = Option::Smooth | Option::None;
+	auto cornerOptions = [](RectParts corners) {
+		return (corners & RectPart::TopLeft ? Option::RoundedTopLeft : Option::None)
+			| (corners & RectPart::TopRight ? Option::RoundedTopRight : Option::None)
+			| (corners & RectPart::BottomLeft ? Option::RoundedBottomLeft : Option::None)
+			| (corners & RectPart::BottomRight ? Option::RoundedBottomRight : Option::None);
+	};
+	if (radius == ImageRoundRadius::Large) {
+		options |= Option::RoundedLarge | cornerOptions(corners);
+	} else if (radius == ImageRoundRadius::Small) {
+		options |= Option::RoundedSmall | cornerOptions(corners);
+	} else if (radius == ImageRoundRadius::Ellipse) {
+		options |= Option::Circled | cornerOptions(corners);
+	}
+
+	_progressiveCache = App::pixmapFromImageInPlace(
+		prepare(_progressive, w, h, options, outerw, outerh));
+	_progressiveCache.setDevicePixelRatio(cRetinaFactor());
+	return _progressiveCache;
+}
+
 QPixmap Image::pixNoCache(
 		Data::FileOrigin origin,
 		int w,
@@ -763,6 +940,12 @@ void Image::automaticLoad(
 	}
 }
 
+void Image::prefetch(Data::FileOrigin origin, const HistoryItem *item) {
+	if (!loaded()) {
+		_source->prefetch(origin, item);
+	}
+}
+
 void Image::load(Data::FileOrigin origin, bool loadFirst, bool prior) {
 	if (!loaded()) {
 		_source->load(origin, loadFirst, prior);
@@ -793,6 +976,14 @@ void Image::checkSource() const {
 		invalidateSizeCache();
 		_data = std::move(data);
 		ActiveCache().increment(ComputeUsage(_data));
+		_progressive = QImage();
+		_progressiveCache = QPixmap();
+	} else if (_data.isNull()) {
+		auto progressive = _source->takeProgressive();
+		if (!progressive.isNull()) {
+			_progressive = std::move(progressive);
+			_progressiveCache = QPixmap();
+		}
 	}
 
 	ActiveCache().up(this);
@@ -803,6 +994,8 @@ void Image::unload() const {
 	invalidateSizeCache();
 	ActiveCache().decrement(ComputeUsage(_data));
 	_data = QImage();
+	_progressive = QImage();
+	_progressiveCache = QPixmap();
 }
 
 void Image::setDelayedStorageLocation(
@@ -819,10 +1012,14 @@ void Image::setImageBytes(const QByteArray &bytes) {
 	checkSource();
 }
 
+void Image::forgetPix(uint64 key) const {
+	_sizesCache.remove(key);
+}
+
 void Image::invalidateSizeCache() const {
-	auto &cache = ActiveCache();
-	for (const auto &image : std::as_const(_sizesCache)) {
-		cache.decrement(ComputeUsage(image));
+	auto &cache = Variants();
+	for (auto i = _sizesCache.cbegin(); i != _sizesCache.cend(); ++i) {
+		cache.remove(this, i.key(), ComputeUsage(i.value()));
 	}
 	_sizesCache.clear();
 }
@@ -61,6 +61,9 @@ public:
 		bool loadFirst,
 		bool prior) = 0;
 	virtual QImage takeLoaded() = 0;
+
+	// Partially loaded image that can be shown until takeLoaded() works.
+	virtual QImage takeProgressive() = 0;
 	virtual void unload() = 0;
 
 	virtual void automaticLoad(
@@ -68,6 +71,13 @@ public:
 		const HistoryItem *item) = 0;
 	virtual void automaticLoadSettingsChanged() = 0;
 
+	// Low priority load of something the user may scroll to soon.
+	// Only a load started by prefetch() is stopped by cancelPrefetch().
+	virtual void prefetch(
+		Data::FileOrigin origin,
+		const HistoryItem *item) = 0;
+	virtual void cancelPrefetch() = 0;
+
 	virtual bool loading() = 0;
 	virtual bool displayLoading() = 0;
 	virtual void cancel() = 0;
@@ -145,6 +155,16 @@ public:
 		int32 outerh,
 		ImageRoundRadius radius,
 		RectParts corners = RectPart::AllCorners) const;
+
+	// Newest partially loaded progressive image, if there is one.
+	QPixmap pixProgressiveSingle(
+		int32 w,
+		int32 h,
+		int32 outerw,
+		int32 outerh,
+		ImageRoundRadius radius,
+		RectParts corners = RectPart::AllCorners) const;
+
 	const QPixmap &pixCircled(
 		Data::FileOrigin origin,
 		int32 w = 0,
@@ -177,6 +197,10 @@ public:
 	void automaticLoadSettingsChanged() {
 		_source->automaticLoadSettingsChanged();
 	}
+	void prefetch(Data::FileOrigin origin, const HistoryItem *item);
+	void cancelPrefetch() {
+		_source->cancelPrefetch();
+	}
 	bool loading() const {
 		return _source->loading();
 	}
@@ -232,6 +256,7 @@ public:
 	bool loaded() const;
 	bool isNull() const;
 	void unload() const;
+	void forgetPix(uint64 key) const;
 	void setDelayedStorageLocation(
 		Data::FileOrigin origin,
 		const StorageImageLocation &location);
@@ -246,5 +271,7 @@ private:
 	std::unique_ptr<Images::Source> _source;
 	mutable QMap<uint64, QPixmap> _sizesCache;
 	mutable QImage _data;
+	mutable QImage _progressive;
+	mutable QPixmap _progressiveCache;
 
 };
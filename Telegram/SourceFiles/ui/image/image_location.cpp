@@ -10,6 +10,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/image/image.h"
 #include "platform/platform_specific.h"
 
+namespace {
+
+constexpr auto kCheckResultTimeout = TimeMs(1000);
+
+} // namespace
+
 ImagePtr::ImagePtr() : _data(Image::Blank().get()) {
 }
 
@@ -102,6 +108,25 @@ FileLocation::FileLocation(const QString &name) : fname(name) {
 bool FileLocation::check() const {
 	if (fname.isEmpty()) return false;
 
+	const auto now = getms(true);
+	if (_lastCheck.valid
+		&& _lastCheck.fname == fname
+		&& _lastCheck.size == size
+		&& _lastCheck.modified == modified
+		&& now >= _lastCheck.when
+		&& now < _lastCheck.when + kCheckResultTimeout) {
+		return _lastCheck.result;
+	}
+	_lastCheck.result = checkNow();
+	_lastCheck.fname = fname;
+	_lastCheck.size = size;
+	_lastCheck.modified = modified;
+	_lastCheck.when = now;
+	_lastCheck.valid = true;
+	return _lastCheck.result;
+}
+
+bool FileLocation::checkNow() const {
 	ReadAccessEnabler enabler(_bookmark);
 	if (enabler.failed()) {
 		const_cast<FileLocation*>(this)->_bookmark = nullptr;
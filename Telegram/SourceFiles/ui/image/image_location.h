@@ -307,8 +307,23 @@ public:
 	qint32 size;
 
 private:
+	struct CheckResult {
+		QString fname;
+		QDateTime modified;
+		qint32 size = 0;
+		TimeMs when = 0;
+		bool result = false;
+		bool valid = false;
+	};
+
+	bool checkNow() const;
+
 	std::shared_ptr<PsFileBookmark> _bookmark;
 
+	// Several checks of one file usually come together, for example
+	// when a context menu or the media viewer is opened.
+	mutable CheckResult _lastCheck;
+
 };
 inline bool operator==(const FileLocation &a, const FileLocation &b) {
 	return (a.name() == b.name()) && (a.modified == b.modified) && (a.size == b.size);
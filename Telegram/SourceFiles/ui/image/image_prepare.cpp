@@ -14,6 +14,62 @@ TG_FORCE_INLINE uint64 blurGetColors(const uchar *p) {
 	return (uint64)p[0] + ((uint64)p[1] << 16) + ((uint64)p[2] << 32) + ((uint64)p[3] << 48);
 }
 
+// Averages each 2x2 square, four channels at once in a packed uint64.
+QImage DownscaleHalf(const QImage &image) {
+	Expects(image.format() == QImage::Format_RGB32
+		|| image.format() == QImage::Format_ARGB32_Premultiplied);
+
+	const auto width = image.width() / 2;
+	const auto height = image.height() / 2;
+	auto result = QImage(width, height, image.format());
+	result.setDevicePixelRatio(image.devicePixelRatio());
+
+	const auto fromPerLine = image.bytesPerLine();
+	const auto toPerLine = result.bytesPerLine();
+	const auto from = image.constBits();
+	const auto to = result.bits();
+	for (auto y = 0; y != height; ++y) {
+		auto top = from + 2 * y * fromPerLine;
+		auto bottom = top + fromPerLine;
+		auto pixel = to + y * toPerLine;
+		for (auto x = 0; x != width; ++x) {
+			const auto sum = blurGetColors(top)
+				+ blurGetColors(top + 4)
+				+ blurGetColors(bottom)
+				+ blurGetColors(bottom + 4)
+				+ 0x0002000200020002ULL;
+			const auto colors = (sum >> 2) & 0x00FF00FF00FF00FFULL;
+			pixel[0] = uchar(colors & 0xFF);
+			pixel[1] = uchar((colors >> 16) & 0xFF);
+			pixel[2] = uchar((colors >> 32) & 0xFF);
+			pixel[3] = uchar((colors >> 48) & 0xFF);
+			top += 8;
+			bottom += 8;
+			pixel += 4;
+		}
+	}
+	return result;
+}
+
+// Smooth scaling of large photos to small thumbnails is slow in QImage,
+// so we halve the image first while it stays twice the target or larger.
+QImage DownscaleBeforeSmooth(QImage image, int w, int h) {
+	const auto format = image.format();
+	if (format != QImage::Format_RGB32
+		&& format != QImage::Format_ARGB32_Premultiplied) {
+		return image;
+	}
+	if (h <= 0) {
+		h = (image.width() > 0)
+			? std::max(int(int64(image.height()) * w / image.width()), 1)
+			: 0;
+	}
+	while (image.width() >= 4 * w && image.height() >= 4 * h) {
+		image = DownscaleHalf(image);
+	}
+	return image;
+}
+
 const QPixmap &circleMask(int width, int height) {
 	Assert(Global::started());
 
@@ -520,11 +576,19 @@ QImage prepare(QImage img, int w, int h, Images::Options options, int outerw, in
 		Assert(!img.isNull());
 	}
 	if (w <= 0 || (w == img.width() && (h <= 0 || h == img.height()))) {
-	} else if (h <= 0) {
-		img = img.scaledToWidth(w, (options & Images::Option::Smooth) ? Qt::SmoothTransformation : Qt::FastTransformation);
-		Assert(!img.isNull());
 	} else {
-		img = img.scaled(w, h, Qt::IgnoreAspectRatio, (options & Images::Option::Smooth) ? Qt::SmoothTransformation : Qt::FastTransformation);
+		const auto smooth = (options & Images::Option::Smooth);
+		if (smooth) {
+			img = DownscaleBeforeSmooth(std::move(img), w, h);
+		}
+		const auto mode = smooth
+			? Qt::SmoothTransformation
+			: Qt::FastTransformation;
+		if (h <= 0) {
+			img = img.scaledToWidth(w, mode);
+		} else {
+			img = img.scaled(w, h, Qt::IgnoreAspectRatio, mode);
+		}
 		Assert(!img.isNull());
 	}
 	if (outerw > 0 && outerh > 0) {
@@ -45,6 +45,10 @@ QImage ImageSource::takeLoaded() {
 	return _data;
 }
 
+QImage ImageSource::takeProgressive() {
+	return QImage();
+}
+
 void ImageSource::unload() {
 	if (_bytes.isEmpty() && !_data.isNull()) {
 		if (_format != "JPG") {
@@ -67,6 +71,14 @@ void ImageSource::automaticLoad(
 void ImageSource::automaticLoadSettingsChanged() {
 }
 
+void ImageSource::prefetch(
+	Data::FileOrigin origin,
+	const HistoryItem *item) {
+}
+
+void ImageSource::cancelPrefetch() {
+}
+
 bool ImageSource::loading() {
 	return false;
 }
@@ -190,6 +202,10 @@ QImage LocalFileSource::takeLoaded() {
 	return std::move(_data);
 }
 
+QImage LocalFileSource::takeProgressive() {
+	return QImage();
+}
+
 void LocalFileSource::unload() {
 	_data = QImage();
 }
@@ -202,6 +218,14 @@ void LocalFileSource::automaticLoad(
 void LocalFileSource::automaticLoadSettingsChanged() {
 }
 
+void LocalFileSource::prefetch(
+	Data::FileOrigin origin,
+	const HistoryItem *item) {
+}
+
+void LocalFileSource::cancelPrefetch() {
+}
+
 bool LocalFileSource::loading() {
 	return false;
 }
@@ -283,7 +307,9 @@ QByteArray LocalFileSource::bytesForCache() {
 }
 
 QImage RemoteSource::takeLoaded() {
-	if (!loaderValid() || !_loader->finished()) {
+	if (!loaderValid()
+		|| !_loader->finished()
+		|| !_loader->prepareImageData(shrinkBox())) {
 		return QImage();
 	}
 
@@ -300,6 +326,12 @@ QImage RemoteSource::takeLoaded() {
 	return data;
 }
 
+QImage RemoteSource::takeProgressive() {
+	return (loaderValid() && !_loader->finished())
+		? _loader->takeProgressiveImage()
+		: QImage();
+}
+
 bool RemoteSource::loaderValid() const {
 	return _loader && !cancelled();
 }
@@ -333,6 +365,9 @@ void RemoteSource::setImageBytes(const QByteArray &bytes) {
 	_loader = createLoader({}, LoadFromLocalOnly, true);
 	_loader->finishWithBytes(bytes);
 
+	// The bytes are given to us to display them right away.
+	_loader->imageData(shrinkBox());
+
 	const auto location = this->location();
 	if (!location.isNull()
 		&& !bytes.isEmpty()
@@ -371,6 +406,7 @@ void RemoteSource::automaticLoad(
 			true);
 	}
 	if (loaderValid()) {
+		promotePrefetch();
 		_loader->start();
 	}
 }
@@ -381,6 +417,41 @@ void RemoteSource::automaticLoadSettingsChanged() {
 	}
 }
 
+void RemoteSource::prefetch(
+		Data::FileOrigin origin,
+		const HistoryItem *item) {
+	if (_loader || !item) {
+		return;
+	}
+	const auto loadFromCloud = Data::AutoDownload::Should(
+		Auth().settings().autoDownload(),
+		item->history()->peer,
+		this);
+	_loader = createLoader(
+		origin,
+		loadFromCloud ? LoadFromCloudOrLocal : LoadFromLocalOnly,
+		true);
+	if (_loader) {
+		_loader->setLoadPriority(Storage::LoadPriority::Prefetch);
+		_loader->start();
+	}
+}
+
+void RemoteSource::cancelPrefetch() {
+	if (loaderValid()
+		&& _loader->loadPriority() == Storage::LoadPriority::Prefetch) {
+		destroyLoader();
+	}
+}
+
+void RemoteSource::promotePrefetch() {
+	Expects(loaderValid());
+
+	if (_loader->loadPriority() == Storage::LoadPriority::Prefetch) {
+		_loader->setLoadPriority(Storage::LoadPriority::Visible);
+	}
+}
+
 void RemoteSource::load(
 		Data::FileOrigin origin,
 		bool loadFirst,
@@ -389,6 +460,7 @@ void RemoteSource::load(
 		_loader = createLoader(origin, LoadFromCloudOrLocal, false);
 	}
 	if (loaderValid()) {
+		promotePrefetch();
 		_loader->start(loadFirst, prior);
 	}
 }
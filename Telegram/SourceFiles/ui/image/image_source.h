@@ -24,6 +24,7 @@ public:
 		bool loadFirst,
 		bool prior) override;
 	QImage takeLoaded() override;
+	QImage takeProgressive() override;
 	void unload() override;
 
 	void automaticLoad(
@@ -31,6 +32,11 @@ public:
 		const HistoryItem *item) override;
 	void automaticLoadSettingsChanged() override;
 
+	void prefetch(
+		Data::FileOrigin origin,
+		const HistoryItem *item) override;
+	void cancelPrefetch() override;
+
 	bool loading() override;
 	bool displayLoading() override;
 	void cancel() override;
@@ -79,6 +85,7 @@ public:
 		bool loadFirst,
 		bool prior) override;
 	QImage takeLoaded() override;
+	QImage takeProgressive() override;
 	void unload() override;
 
 	void automaticLoad(
@@ -86,6 +93,11 @@ public:
 		const HistoryItem *item) override;
 	void automaticLoadSettingsChanged() override;
 
+	void prefetch(
+		Data::FileOrigin origin,
+		const HistoryItem *item) override;
+	void cancelPrefetch() override;
+
 	bool loading() override;
 	bool displayLoading() override;
 	void cancel() override;
@@ -131,6 +143,7 @@ public:
 		bool loadFirst,
 		bool prior) override;
 	QImage takeLoaded() override;
+	QImage takeProgressive() override;
 	void unload() override;
 
 	void automaticLoad(
@@ -138,6 +151,11 @@ public:
 		const HistoryItem *item) override;
 	void automaticLoadSettingsChanged() override;
 
+	void prefetch(
+		Data::FileOrigin origin,
+		const HistoryItem *item) override;
+	void cancelPrefetch() override;
+
 	bool loading() override;
 	bool displayLoading() override;
 	void cancel() override;
@@ -171,6 +189,7 @@ private:
 	bool loaderValid() const;
 	bool cancelled() const;
 	void destroyLoader(FileLoader *newValue = nullptr);
+	void promotePrefetch();
 
 	FileLoader *_loader = nullptr;
 
@@ -11,6 +11,9 @@ namespace style {
 namespace internal {
 namespace {
 
+// Building the colorize table costs about as much as 256 pixels.
+constexpr auto kColorizeTableMinPixels = 1024;
+
 using ModulesList = QList<internal::ModuleBase*>;
 NeverFreedPointer<ModulesList> styleModules;
 
@@ -92,7 +95,24 @@ void colorizeImage(const QImage &src, QColor c, QImage *outResult, QRect srcRect
 	auto maskBytes = src.constBits() + srcRect.y() * maskBytesPerLine + srcRect.x() * maskBytesPerPixel;
 	Assert(maskBytesAdded >= 0);
 	Assert(src.depth() == (maskBytesPerPixel << 3));
-	for (int y = 0; y != height; ++y) {
+	if (width * height > kColorizeTableMinPixels) {
+		// The mask has only 256 possible values, so for large images
+		// it is cheaper to colorize each of them once and then copy.
+		auto table = std::array<uint32, 256>();
+		for (auto i = 0; i != 256; ++i) {
+			const auto maskOpacity = static_cast<anim::ShiftedMultiplier>(i) + 1;
+			table[i] = anim::unshifted(pattern * maskOpacity);
+		}
+		for (int y = 0; y != height; ++y) {
+			for (int x = 0; x != width; ++x) {
+				*resultInts = table[*maskBytes];
+				maskBytes += maskBytesPerPixel;
+				resultInts += resultIntsPerPixel;
+			}
+			maskBytes += maskBytesAdded;
+			resultInts += resultIntsAdded;
+		}
+	} else for (int y = 0; y != height; ++y) {
 		for (int x = 0; x != width; ++x) {
 			auto maskOpacity = static_cast<anim::ShiftedMultiplier>(*maskBytes) + 1;
 			*resultInts = anim::unshifted(pattern * maskOpacity);
@@ -55,6 +55,7 @@ FontData::FontData(int size, uint32 flags, int family, Font *other)
 		memset(modified, 0, sizeof(modified));
 	}
 	modified[_flags] = Font(this);
+	_asciiWidths.fill(-1);
 
 	f.setPixelSize(size);
 	if (_flags & FontBold) {
@@ -74,6 +75,21 @@ FontData::FontData(int size, uint32 flags, int family, Font *other)
 	elidew = width(qsl("..."));
 }
 
+int32 FontData::width(const QString &str, int32 from, int32 to) const {
+	// Same bounds as str.mid(from, to), but without a copy of the part.
+	const auto size = str.size();
+	if (from < 0) {
+		to = (to < 0) ? to : std::max(to + from, 0);
+		from = 0;
+	}
+	if (from >= size) {
+		return 0;
+	} else if (to < 0 || to > size - from) {
+		to = size - from;
+	}
+	return m.width(QString::fromRawData(str.constData() + from, to));
+}
+
 Font FontData::bold(bool set) const {
 	return otherFlagsFont(FontBold, set);
 }
@@ -66,11 +66,17 @@ public:
 	int32 width(const QString &str) const {
 		return m.width(str);
 	}
-	int32 width(const QString &str, int32 from, int32 to) const {
-		return width(str.mid(from, to));
-	}
+	int32 width(const QString &str, int32 from, int32 to) const;
 	int32 width(QChar ch) const {
-		return m.width(ch);
+		const auto code = ch.unicode();
+		if (code >= _asciiWidths.size()) {
+			return m.width(ch);
+		}
+		auto &result = _asciiWidths[code];
+		if (result < 0) {
+			result = m.width(ch);
+		}
+		return result;
 	}
 	QString elided(const QString &str, int32 width, Qt::TextElideMode mode = Qt::ElideRight) const {
 		return m.elidedText(str, mode, width);
@@ -99,6 +105,9 @@ private:
 	uint32 _flags;
 	int _family;
 
+	// Single character advances, filled lazily, -1 if not yet known.
+	mutable std::array<int32, 128> _asciiWidths;
+
 };
 
 inline bool operator==(const Font &a, const Font &b) {
@@ -52,6 +52,16 @@ QImage createIconMask(const IconMask *mask, int scale) {
 		Qt::SmoothTransformation);
 }
 
+// Masks for the current interface scale are decoded once and shared.
+const QImage &cachedIconMask(const IconMask *mask) {
+	iconMasks.createIfNull();
+	auto i = iconMasks->constFind(mask);
+	if (i == iconMasks->cend()) {
+		i = iconMasks->insert(mask, createIconMask(mask, cScale()));
+	}
+	return i.value();
+}
+
 QSize readGeneratedSize(const IconMask *mask, int scale) {
 	auto data = mask->data();
 	auto size = mask->size();
@@ -91,8 +101,8 @@ MonoIcon::MonoIcon(const IconMask *mask, Color color, QPoint offset)
 }
 
 void MonoIcon::reset() const {
-	_pixmap = QPixmap();
-	_size = QSize();
+	// Keep the pixmap, it will be reused if our color was not changed.
+	_pixmapOutdated = !_pixmap.isNull();
 }
 
 int MonoIcon::width() const {
@@ -170,7 +180,7 @@ void MonoIcon::paint(
 	auto size = readGeneratedSize(_mask, cScale());
 	auto maskImage = QImage();
 	if (size.isEmpty()) {
-		maskImage = createIconMask(_mask, cScale());
+		maskImage = cachedIconMask(_mask);
 		size = maskImage.size() / cIntRetinaFactor();
 	}
 
@@ -198,7 +208,7 @@ void MonoIcon::fill(
 	auto size = readGeneratedSize(_mask, cScale());
 	auto maskImage = QImage();
 	if (size.isEmpty()) {
-		maskImage = createIconMask(_mask, cScale());
+		maskImage = cachedIconMask(_mask);
 		size = maskImage.size() / cIntRetinaFactor();
 	}
 	if (!maskImage.isNull()) {
@@ -240,21 +250,15 @@ QImage MonoIcon::instance(QColor colorOverride, int scale) const {
 
 void MonoIcon::ensureLoaded() const {
 	if (_size.isValid()) {
-		return;
-	}
-	if (!_maskImage.isNull()) {
-		createCachedPixmap();
+		if (_pixmapOutdated) {
+			createCachedPixmap();
+		}
 		return;
 	}
 
 	_size = readGeneratedSize(_mask, cScale());
 	if (_size.isEmpty()) {
-		iconMasks.createIfNull();
-		auto i = iconMasks->constFind(_mask);
-		if (i == iconMasks->cend()) {
-			i = iconMasks->insert(_mask, createIconMask(_mask, cScale()));
-		}
-		_maskImage = i.value();
+		_maskImage = cachedIconMask(_mask);
 
 		createCachedPixmap();
 	}
@@ -267,13 +271,20 @@ void MonoIcon::ensureColorizedImage(QColor color) const {
 
 void MonoIcon::createCachedPixmap() const {
 	iconPixmaps.createIfNull();
-	auto key = qMakePair(_mask, colorKey(_color->c));
+	const auto color = colorKey(_color->c);
+	auto key = qMakePair(_mask, color);
 	auto j = iconPixmaps->constFind(key);
 	if (j == iconPixmaps->cend()) {
-		auto image = colorizeImage(_maskImage, _color);
-		j = iconPixmaps->insert(key, App::pixmapFromImageInPlace(std::move(image)));
+		if (_pixmapOutdated && _pixmapColorKey == color) {
+			j = iconPixmaps->insert(key, _pixmap);
+		} else {
+			auto image = colorizeImage(_maskImage, _color);
+			j = iconPixmaps->insert(key, App::pixmapFromImageInPlace(std::move(image)));
+		}
 	}
 	_pixmap = j.value();
+	_pixmapColorKey = color;
+	_pixmapOutdated = false;
 	_size = _pixmap.size() / cIntRetinaFactor();
 }
 
@@ -74,6 +74,8 @@ private:
 	mutable QImage _maskImage, _colorizedImage;
 	mutable QPixmap _pixmap; // for pixmaps
 	mutable QSize _size; // for rects
+	mutable uint32 _pixmapColorKey = 0;
+	mutable bool _pixmapOutdated = false;
 
 };
 
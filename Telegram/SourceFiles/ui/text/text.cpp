@@ -17,13 +17,119 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "platform/platform_specific.h"
 #include "boxes/confirm_box.h"
 #include "mainwindow.h"
+#include "base/last_used_cache.h"
 
 namespace {
 
+constexpr auto kLayoutCacheTextLengthMax = 256;
+constexpr auto kLayoutCacheSizeLimit = 4096;
+
 inline int32 countBlockHeight(const ITextBlock *b, const style::TextStyle *st) {
 	return (b->type() == TextBlockTSkip) ? static_cast<const SkipBlock*>(b)->height() : (st->lineHeight > st->font->height) ? st->lineHeight : st->font->height;
 }
 
+// Short plain texts (names, service messages, headers) are laid out
+// with the same style again and again, so we keep the parsed blocks
+// of the recently used ones and copy them instead of parsing again.
+class LayoutCache {
+public:
+	static bool Allowed(const QString &text);
+
+	const Text *find(
+		const style::TextStyle &st,
+		const QString &text,
+		const TextParseOptions &options);
+	void store(
+		const QString &text,
+		const TextParseOptions &options,
+		const Text &layout);
+
+private:
+	struct Entry {
+		QString text;
+		TextParseOptions options;
+		Text layout;
+	};
+
+	static uint64 ComputeKey(
+		const style::TextStyle &st,
+		const QString &text,
+		const TextParseOptions &options);
+	static bool Same(
+		const Entry &entry,
+		const style::TextStyle &st,
+		const QString &text,
+		const TextParseOptions &options);
+
+	std::unordered_map<uint64, Entry> _entries;
+	base::last_used_cache<uint64> _lastUsed;
+
+};
+
+bool LayoutCache::Allowed(const QString &text) {
+	// The cache is not synchronized, use it only on the main thread.
+	return !text.isEmpty()
+		&& (text.size() <= kLayoutCacheTextLengthMax)
+		&& (QThread::currentThread() == QCoreApplication::instance()->thread());
+}
+
+uint64 LayoutCache::ComputeKey(
+		const style::TextStyle &st,
+		const QString &text,
+		const TextParseOptions &options) {
+	const auto styleHash = uint64(reinterpret_cast<quintptr>(&st));
+	const auto optionsHash = uint64(qHash(options.flags))
+		^ (uint64(qHash(options.maxw)) << 8)
+		^ (uint64(qHash(options.maxh)) << 16)
+		^ (uint64(options.dir) << 24);
+	return (uint64(qHash(text)) << 32) ^ styleHash ^ optionsHash;
+}
+
+bool LayoutCache::Same(
+		const Entry &entry,
+		const style::TextStyle &st,
+		const QString &text,
+		const TextParseOptions &options) {
+	return (entry.layout.style() == &st)
+		&& (entry.options.flags == options.flags)
+		&& (entry.options.maxw == options.maxw)
+		&& (entry.options.maxh == options.maxh)
+		&& (entry.options.dir == options.dir)
+		&& (entry.text == text);
+}
+
+const Text *LayoutCache::find(
+		const style::TextStyle &st,
+		const QString &text,
+		const TextParseOptions &options) {
+	const auto key = ComputeKey(st, text, options);
+	const auto i = _entries.find(key);
+	if (i == end(_entries) || !Same(i->second, st, text, options)) {
+		return nullptr;
+	}
+	_lastUsed.up(key);
+	return &i->second.layout;
+}
+
+void LayoutCache::store(
+		const QString &text,
+		const TextParseOptions &options,
+		const Text &layout) {
+	Expects(layout.style() != nullptr);
+
+	const auto key = ComputeKey(*layout.style(), text, options);
+	_entries[key] = Entry{ text, options, layout };
+	_lastUsed.up(key);
+	while (_entries.size() > kLayoutCacheSizeLimit) {
+		_entries.erase(_lastUsed.take_lowest());
+	}
+}
+
+LayoutCache &GlobalLayoutCache() {
+	static auto result = LayoutCache();
+	return result;
+}
+
 } // namespace
 
 bool chIsBad(QChar ch) {
@@ -189,13 +295,13 @@ public:
 			}
 			lastSkipped = false;
 			if (emoji) {
-				_t->_blocks.push_back(std::make_unique<EmojiBlock>(_t->_st->font, _t->_text, blockStart, len, flags, lnkIndex, emoji));
+				_t->_blocks.push_back(Block::Emoji(_t->_st->font, _t->_text, blockStart, len, flags, lnkIndex, emoji));
 				emoji = 0;
 				lastSkipped = true;
 			} else if (newline) {
-				_t->_blocks.push_back(std::make_unique<NewlineBlock>(_t->_st->font, _t->_text, blockStart, len, flags, lnkIndex));
+				_t->_blocks.push_back(Block::Newline(_t->_st->font, _t->_text, blockStart, len, flags, lnkIndex));
 			} else {
-				_t->_blocks.push_back(std::make_unique<TextBlock>(_t->_st->font, _t->_text, _t->_minResizeWidth, blockStart, len, flags, lnkIndex));
+				_t->_blocks.push_back(Block::Text(_t->_st->font, _t->_text, _t->_minResizeWidth, blockStart, len, flags, lnkIndex));
 			}
 			blockStart += len;
 			blockCreated();
@@ -205,7 +311,7 @@ public:
 	void createSkipBlock(int32 w, int32 h) {
 		createBlock();
 		_t->_text.push_back('_');
-		_t->_blocks.push_back(std::make_unique<SkipBlock>(_t->_st->font, _t->_text, blockStart++, w, h, lnkIndex));
+		_t->_blocks.push_back(Block::Skip(_t->_st->font, _t->_text, blockStart++, w, h, lnkIndex));
 		blockCreated();
 	}
 
@@ -1625,7 +1731,7 @@ private:
 		_elideSavedIndex = blockIndex;
 		auto mutableText = const_cast<Text*>(_t);
 		_elideSavedBlock = std::move(mutableText->_blocks[blockIndex]);
-		mutableText->_blocks[blockIndex] = std::make_unique<TextBlock>(_t->_st->font, _t->_text, QFIXED_MAX, elideStart, 0, _elideSavedBlock->flags(), _elideSavedBlock->lnkIndex());
+		mutableText->_blocks[blockIndex] = Block::Text(_t->_st->font, _t->_text, QFIXED_MAX, elideStart, 0, (*_elideSavedBlock)->flags(), (*_elideSavedBlock)->lnkIndex());
 		_blocksSize = blockIndex + 1;
 		_endBlock = (blockIndex + 1 < _t->_blocks.size() ? _t->_blocks[blockIndex + 1].get() : nullptr);
 	}
@@ -1750,7 +1856,7 @@ private:
 
 	void restoreAfterElided() {
 		if (_elideSavedBlock) {
-			const_cast<Text*>(_t)->_blocks[_elideSavedIndex] = std::move(_elideSavedBlock);
+			const_cast<Text*>(_t)->_blocks[_elideSavedIndex] = std::move(*base::take(_elideSavedBlock));
 		}
 	}
 
@@ -2439,7 +2545,7 @@ private:
 	// elided hack support
 	int _blocksSize = 0;
 	int _elideSavedIndex = 0;
-	std::unique_ptr<ITextBlock> _elideSavedBlock;
+	std::optional<Block> _elideSavedBlock;
 
 	int _lineStart = 0;
 	int _localFrom = 0;
@@ -2486,12 +2592,9 @@ Text::Text(const Text &other)
 , _minHeight(other._minHeight)
 , _text(other._text)
 , _st(other._st)
+, _blocks(other._blocks)
 , _links(other._links)
 , _startDir(other._startDir) {
-	_blocks.reserve(other._blocks.size());
-	for (auto &block : other._blocks) {
-		_blocks.push_back(block->clone());
-	}
 }
 
 Text::Text(Text &&other)
@@ -2512,12 +2615,9 @@ Text &Text::operator=(const Text &other) {
 	_minHeight = other._minHeight;
 	_text = other._text;
 	_st = other._st;
-	_blocks = TextBlocks(other._blocks.size());
+	_blocks = other._blocks;
 	_links = other._links;
 	_startDir = other._startDir;
-	for (int32 i = 0, l = _blocks.size(); i < l; ++i) {
-		_blocks[i] = other._blocks.at(i)->clone();
-	}
 	return *this;
 }
 
@@ -2535,12 +2635,26 @@ Text &Text::operator=(Text &&other) {
 }
 
 void Text::setText(const style::TextStyle &st, const QString &text, const TextParseOptions &options) {
+	const auto cacheAllowed = LayoutCache::Allowed(text);
+	if (cacheAllowed) {
+		if (const auto cached = GlobalLayoutCache().find(st, text, options)) {
+			const auto minResizeWidth = _minResizeWidth;
+			*this = *cached;
+			_minResizeWidth = minResizeWidth;
+			return;
+		}
+	}
 	_st = &st;
 	clear();
 	{
 		TextParser parser(this, text, options);
 	}
 	recountNaturalSize(true, options.dir);
+
+	// Click handlers are owned by each Text, so we don't share them.
+	if (cacheAllowed && _links.isEmpty()) {
+		GlobalLayoutCache().store(text, options, *this);
+	}
 }
 
 void Text::recountNaturalSize(bool initial, Qt::LayoutDirection optionsDir) {
@@ -2752,7 +2866,7 @@ bool Text::updateSkipBlock(int width, int height) {
 		_blocks.pop_back();
 	}
 	_text.push_back('_');
-	_blocks.push_back(std::make_unique<SkipBlock>(
+	_blocks.push_back(Block::Skip(
 		_st->font,
 		_text,
 		_text.size() - 1,
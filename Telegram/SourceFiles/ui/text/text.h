@@ -68,6 +68,7 @@ typedef QPair<QString, QString> TextCustomTag; // open str and close str
 typedef QMap<QChar, TextCustomTag> TextCustomTagsMap;
 
 class ITextBlock;
+class Block;
 class Text {
 public:
 	Text(int32 minResizeWidth = QFIXED_MAX);
@@ -195,7 +196,7 @@ public:
 	~Text();
 
 private:
-	using TextBlocks = std::vector<std::unique_ptr<ITextBlock>>;
+	using TextBlocks = std::vector<Block>;
 	using TextLinks = QVector<ClickHandlerPtr>;
 
 	uint16 countBlockEnd(const TextBlocks::const_iterator &i, const TextBlocks::const_iterator &e) const;
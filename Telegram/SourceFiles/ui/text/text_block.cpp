@@ -357,3 +357,96 @@ SkipBlock::SkipBlock(const style::font &font, const QString &str, uint16 from, i
 	_flags |= ((TextBlockTSkip & 0x0F) << 8);
 	_width = w;
 }
+
+template <typename BlockType, typename ...Args>
+Block Block::New(Args &&...args) {
+	auto result = Block();
+	new (&result._data) BlockType(std::forward<Args>(args)...);
+	return result;
+}
+
+Block Block::Newline(const style::font &font, const QString &str, uint16 from, uint16 length, uchar flags, uint16 lnkIndex) {
+	return New<NewlineBlock>(font, str, from, length, flags, lnkIndex);
+}
+
+Block Block::Text(const style::font &font, const QString &str, QFixed minResizeWidth, uint16 from, uint16 length, uchar flags, uint16 lnkIndex) {
+	return New<TextBlock>(font, str, minResizeWidth, from, length, flags, lnkIndex);
+}
+
+Block Block::Emoji(const style::font &font, const QString &str, uint16 from, uint16 length, uchar flags, uint16 lnkIndex, EmojiPtr emoji) {
+	return New<EmojiBlock>(font, str, from, length, flags, lnkIndex, emoji);
+}
+
+Block Block::Skip(const style::font &font, const QString &str, uint16 from, int32 w, int32 h, uint16 lnkIndex) {
+	return New<SkipBlock>(font, str, from, w, h, lnkIndex);
+}
+
+Block::Block(Block &&other) {
+	moveFrom(std::move(other));
+}
+
+Block::Block(const Block &other) {
+	copyFrom(other);
+}
+
+Block &Block::operator=(Block &&other) {
+	if (&other != this) {
+		destroy();
+		moveFrom(std::move(other));
+	}
+	return *this;
+}
+
+Block &Block::operator=(const Block &other) {
+	if (&other != this) {
+		destroy();
+		copyFrom(other);
+	}
+	return *this;
+}
+
+Block::~Block() {
+	destroy();
+}
+
+void Block::copyFrom(const Block &other) {
+	switch (other->type()) {
+	case TextBlockTNewline:
+		new (&_data) NewlineBlock(other.unsafe<NewlineBlock>());
+		break;
+	case TextBlockTText:
+		new (&_data) TextBlock(other.unsafe<TextBlock>());
+		break;
+	case TextBlockTEmoji:
+		new (&_data) EmojiBlock(other.unsafe<EmojiBlock>());
+		break;
+	case TextBlockTSkip:
+		new (&_data) SkipBlock(other.unsafe<SkipBlock>());
+		break;
+	default:
+		Unexpected("Type in Block::copyFrom.");
+	}
+}
+
+void Block::moveFrom(Block &&other) {
+	switch (other->type()) {
+	case TextBlockTNewline:
+		new (&_data) NewlineBlock(std::move(other.unsafe<NewlineBlock>()));
+		break;
+	case TextBlockTText:
+		new (&_data) TextBlock(std::move(other.unsafe<TextBlock>()));
+		break;
+	case TextBlockTEmoji:
+		new (&_data) EmojiBlock(std::move(other.unsafe<EmojiBlock>()));
+		break;
+	case TextBlockTSkip:
+		new (&_data) SkipBlock(std::move(other.unsafe<SkipBlock>()));
+		break;
+	default:
+		Unexpected("Type in Block::moveFrom.");
+	}
+}
+
+void Block::destroy() {
+	get()->~ITextBlock();
+}
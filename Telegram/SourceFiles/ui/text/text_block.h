@@ -64,7 +64,6 @@ public:
 		return (_flags & 0xFF);
 	}
 
-	virtual std::unique_ptr<ITextBlock> clone() const = 0;
 	virtual ~ITextBlock() {
 	}
 
@@ -94,10 +93,6 @@ public:
 		return _nextDir;
 	}
 
-	std::unique_ptr<ITextBlock> clone() const override {
-		return std::make_unique<NewlineBlock>(*this);
-	}
-
 private:
 	Qt::LayoutDirection _nextDir;
 
@@ -144,10 +139,6 @@ class TextBlock : public ITextBlock {
 public:
 	TextBlock(const style::font &font, const QString &str, QFixed minResizeWidth, uint16 from, uint16 length, uchar flags, uint16 lnkIndex);
 
-	std::unique_ptr<ITextBlock> clone() const override {
-		return std::make_unique<TextBlock>(*this);
-	}
-
 private:
 	friend class ITextBlock;
 	QFixed real_f_rbearing() const {
@@ -169,10 +160,6 @@ class EmojiBlock : public ITextBlock {
 public:
 	EmojiBlock(const style::font &font, const QString &str, uint16 from, uint16 length, uchar flags, uint16 lnkIndex, EmojiPtr emoji);
 
-	std::unique_ptr<ITextBlock> clone() const {
-		return std::make_unique<EmojiBlock>(*this);
-	}
-
 private:
 	EmojiPtr emoji = nullptr;
 
@@ -191,10 +178,6 @@ public:
 		return _height;
 	}
 
-	std::unique_ptr<ITextBlock> clone() const override {
-		return std::make_unique<SkipBlock>(*this);
-	}
-
 private:
 	int32 _height;
 
@@ -204,3 +187,65 @@ private:
 	friend class TextPainter;
 
 };
+
+// Holds any of the blocks above in place, so that a Text keeps all its
+// blocks in one contiguous array without a heap allocation per block.
+class Block final {
+public:
+	Block(Block &&other);
+	Block(const Block &other);
+	Block &operator=(Block &&other);
+	Block &operator=(const Block &other);
+	~Block();
+
+	[[nodiscard]] static Block Newline(const style::font &font, const QString &str, uint16 from, uint16 length, uchar flags, uint16 lnkIndex);
+	[[nodiscard]] static Block Text(const style::font &font, const QString &str, QFixed minResizeWidth, uint16 from, uint16 length, uchar flags, uint16 lnkIndex);
+	[[nodiscard]] static Block Emoji(const style::font &font, const QString &str, uint16 from, uint16 length, uchar flags, uint16 lnkIndex, EmojiPtr emoji);
+	[[nodiscard]] static Block Skip(const style::font &font, const QString &str, uint16 from, int32 w, int32 h, uint16 lnkIndex);
+
+	ITextBlock *get() {
+		return reinterpret_cast<ITextBlock*>(&_data);
+	}
+	const ITextBlock *get() const {
+		return reinterpret_cast<const ITextBlock*>(&_data);
+	}
+	ITextBlock *operator->() {
+		return get();
+	}
+	const ITextBlock *operator->() const {
+		return get();
+	}
+	ITextBlock &operator*() {
+		return *get();
+	}
+	const ITextBlock &operator*() const {
+		return *get();
+	}
+
+private:
+	Block() = default;
+
+	template <typename BlockType, typename ...Args>
+	static Block New(Args &&...args);
+
+	template <typename BlockType>
+	BlockType &unsafe() {
+		return *reinterpret_cast<BlockType*>(&_data);
+	}
+	template <typename BlockType>
+	const BlockType &unsafe() const {
+		return *reinterpret_cast<const BlockType*>(&_data);
+	}
+
+	void copyFrom(const Block &other);
+	void moveFrom(Block &&other);
+	void destroy();
+
+	std::aligned_union_t<
+		1,
+		NewlineBlock,
+		TextBlock,
+		EmojiBlock,
+		SkipBlock> _data;
+
+};
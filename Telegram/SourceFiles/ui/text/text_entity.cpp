@@ -1563,6 +1563,66 @@ TextWithEntities ParseEntities(const QString &text, int32 flags) {
 	return result;
 }
 
+namespace {
+
+enum class EntityTrigger {
+	Hashtag = (1 << 0),
+	Mention = (1 << 1),
+	BotCommand = (1 << 2),
+	Domain = (1 << 3),
+	ExplicitDomain = (1 << 4),
+};
+using EntityTriggers = base::flags<EntityTrigger>;
+inline constexpr auto is_flag_type(EntityTrigger) { return true; };
+
+// Each of the entity expressions requires some ASCII character to
+// be present in the text, so we find them all in one pass first.
+EntityTriggers CollectEntityTriggers(const QChar *start, int length) {
+	auto result = EntityTriggers();
+	for (const auto ch : gsl::make_span(start, length)) {
+		switch (ch.unicode()) {
+		case '#': result |= EntityTrigger::Hashtag; break;
+		case '@': result |= EntityTrigger::Mention; break;
+		case '/': result |= EntityTrigger::BotCommand; break;
+		case '.': result |= EntityTrigger::Domain; break;
+		case ':': result |= EntityTrigger::ExplicitDomain; break;
+		}
+	}
+	return result;
+}
+
+// The leftmost match found from some offset is the leftmost one for
+// any greater offset as well, if it doesn't start before that offset.
+// So we don't run the expression again for each found entity.
+class CachedMatch {
+public:
+	CachedMatch(const QRegularExpression &expression, bool enabled)
+	: _expression(expression)
+	, _enabled(enabled) {
+	}
+
+	QRegularExpressionMatch find(const QString &text, int offset) {
+		if (!_enabled) {
+			return QRegularExpressionMatch();
+		} else if (_searchedFrom < 0
+			|| _searchedFrom > offset
+			|| (_match.hasMatch() && _match.capturedStart() < offset)) {
+			_match = _expression.match(text, offset);
+			_searchedFrom = offset;
+		}
+		return _match;
+	}
+
+private:
+	const QRegularExpression &_expression;
+	const bool _enabled = false;
+	int _searchedFrom = -1;
+	QRegularExpressionMatch _match;
+
+};
+
+} // namespace
+
 // Some code is duplicated in message_field.cpp!
 void ParseEntities(TextWithEntities &result, int32 flags, bool rich) {
 	constexpr auto kNotFound = std::numeric_limits<int>::max();
@@ -1572,6 +1632,25 @@ void ParseEntities(TextWithEntities &result, int32 flags, bool rich) {
 	bool withMentions = (flags & TextParseMentions);
 	bool withBotCommands = (flags & TextParseBotCommands);
 
+	const auto triggers = CollectEntityTriggers(
+		result.text.constData(),
+		result.text.size());
+	auto domains = CachedMatch(
+		qthelp::RegExpDomain(),
+		(triggers & EntityTrigger::Domain));
+	auto explicitDomains = CachedMatch(
+		qthelp::RegExpDomainExplicit(),
+		(triggers & EntityTrigger::ExplicitDomain));
+	auto hashtags = CachedMatch(
+		RegExpHashtag(),
+		withHashtags && (triggers & EntityTrigger::Hashtag));
+	auto mentions = CachedMatch(
+		RegExpMention(),
+		withMentions && (triggers & EntityTrigger::Mention));
+	auto botCommands = CachedMatch(
+		RegExpBotCommand(),
+		withBotCommands && (triggers & EntityTrigger::BotCommand));
+
 	int existingEntityIndex = 0, existingEntitiesCount = result.entities.size();
 	int existingEntityEnd = 0;
 
@@ -1588,11 +1667,11 @@ void ParseEntities(TextWithEntities &result, int32 flags, bool rich) {
 				}
 			}
 		}
-		auto mDomain = qthelp::RegExpDomain().match(result.text, matchOffset);
-		auto mExplicitDomain = qthelp::RegExpDomainExplicit().match(result.text, matchOffset);
-		auto mHashtag = withHashtags ? RegExpHashtag().match(result.text, matchOffset) : QRegularExpressionMatch();
-		auto mMention = withMentions ? RegExpMention().match(result.text, qMax(mentionSkip, matchOffset)) : QRegularExpressionMatch();
-		auto mBotCommand = withBotCommands ? RegExpBotCommand().match(result.text, matchOffset) : QRegularExpressionMatch();
+		auto mDomain = domains.find(result.text, matchOffset);
+		auto mExplicitDomain = explicitDomains.find(result.text, matchOffset);
+		auto mHashtag = hashtags.find(result.text, matchOffset);
+		auto mMention = mentions.find(result.text, qMax(mentionSkip, matchOffset));
+		auto mBotCommand = botCommands.find(result.text, matchOffset);
 
 		EntityInTextType lnkType = EntityInTextUrl;
 		int32 lnkStart = 0, lnkLength = 0;
@@ -1632,7 +1711,7 @@ void ParseEntities(TextWithEntities &result, int32 flags, bool rich) {
 			}
 			if (!(start + mentionStart + 1)->isLetter() || !(start + mentionEnd - 1)->isLetterOrNumber()) {
 				mentionSkip = mentionEnd;
-				mMention = RegExpMention().match(result.text, qMax(mentionSkip, matchOffset));
+				mMention = mentions.find(result.text, qMax(mentionSkip, matchOffset));
 				if (mMention.hasMatch()) {
 					mentionStart = mMention.capturedStart();
 					mentionEnd = mMention.capturedEnd();
@@ -2187,8 +2187,8 @@ void InputField::handleContentsChanged() {
 		0,
 		-1,
 		_lastTextWithTags.tags,
-		tagsChanged,
-		_markdownEnabled ? &_lastMarkdownTags : nullptr);
+		tagsChanged);
+	_lastMarkdownTagsValid = false;
 
 	//highlightMarkdown();
 
@@ -2218,7 +2218,7 @@ void InputField::highlightMarkdown() {
 		cursor.mergeCharFormat(format);
 		from = b;
 	};
-	for (const auto &tag : _lastMarkdownTags) {
+	for (const auto &tag : getMarkdownTags()) {
 		if (tag.internalStart > from) {
 			applyColor(from, tag.internalStart, QColor(0, 0, 0));
 		} else if (tag.internalStart < from) {
@@ -2387,8 +2387,19 @@ TextWithTags InputField::getTextWithTagsPart(int start, int end) const {
 	return result;
 }
 
+const std::vector<InputField::MarkdownTag> &InputField::getMarkdownTags(
+) const {
+	if (_markdownEnabled && !_lastMarkdownTagsValid) {
+		auto tags = TagList();
+		auto tagsChanged = false;
+		getTextPart(0, -1, tags, tagsChanged, &_lastMarkdownTags);
+		_lastMarkdownTagsValid = true;
+	}
+	return _lastMarkdownTags;
+}
+
 TextWithTags InputField::getTextWithAppliedMarkdown() const {
-	if (!_markdownEnabled || _lastMarkdownTags.empty()) {
+	if (!_markdownEnabled || getMarkdownTags().empty()) {
 		return getTextWithTags();
 	}
 	const auto &originalText = _lastTextWithTags.text;
@@ -2857,7 +2868,7 @@ void InputField::processInstantReplaces(const QString &appended) {
 		return;
 	}
 	const auto position = textCursor().position();
-	for (const auto &tag : _lastMarkdownTags) {
+	for (const auto &tag : getMarkdownTags()) {
 		if (tag.internalStart < position
 			&& tag.internalStart + tag.internalLength >= position
 			&& (tag.tag == kTagCode || tag.tag == kTagPre)) {
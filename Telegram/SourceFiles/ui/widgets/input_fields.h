@@ -176,9 +176,7 @@ public:
 	const TextWithTags &getTextWithTags() const {
 		return _lastTextWithTags;
 	}
-	const std::vector<MarkdownTag> &getMarkdownTags() const {
-		return _lastMarkdownTags;
-	}
+	const std::vector<MarkdownTag> &getMarkdownTags() const;
 	TextWithTags getTextWithTagsPart(int start, int end = -1) const;
 	TextWithTags getTextWithAppliedMarkdown() const;
 	void insertTag(const QString &text, QString tagId = QString());
@@ -427,7 +425,11 @@ private:
 	const std::unique_ptr<Inner> _inner;
 
 	TextWithTags _lastTextWithTags;
-	std::vector<MarkdownTag> _lastMarkdownTags;
+
+	// Parsing markdown is the most expensive part of reading the text,
+	// so it is done only when the tags are asked for.
+	mutable std::vector<MarkdownTag> _lastMarkdownTags;
+	mutable bool _lastMarkdownTagsValid = false;
 	QString _lastPreEditText;
 	Fn<bool(
 		EditLinkSelection selection,
@@ -8,6 +8,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/widgets/scroll_area.h"
 
 namespace Ui {
+namespace {
+
+constexpr auto kMouseAfterScrollDelay = TimeMs(16);
+
+} // namespace
 
 // flick scroll taken from http://qt-project.org/doc/qt-4.8/demos-embedded-anomaly-src-flickcharm-cpp.html
 
@@ -313,7 +318,8 @@ ScrollArea::ScrollArea(QWidget *parent, const style::ScrollArea &st, bool handle
 , _verticalBar(this, true, &_st)
 , _topShadow(this, &_st)
 , _bottomShadow(this, &_st)
-, _touchEnabled(handleTouch) {
+, _touchEnabled(handleTouch)
+, _mouseAfterScrollTimer([=] { mouseAfterScrollTimeout(); }) {
 	setLayoutDirection(cLangDir());
 	setFocusPolicy(Qt::NoFocus);
 
@@ -379,11 +385,27 @@ void ScrollArea::onScrolled() {
 	if (em) {
 		emit scrolled();
 		if (!_movingByScrollBar) {
-			sendSynteticMouseEvent(this, QEvent::MouseMove, Qt::NoButton);
+			updateMouseAfterScroll();
 		}
 	}
 }
 
+void ScrollArea::updateMouseAfterScroll() {
+	if (_mouseAfterScrollTimer.isActive()) {
+		_mouseAfterScrollPending = true;
+		return;
+	}
+	sendSynteticMouseEvent(this, QEvent::MouseMove, Qt::NoButton);
+	_mouseAfterScrollTimer.callOnce(kMouseAfterScrollDelay);
+}
+
+void ScrollArea::mouseAfterScrollTimeout() {
+	if (base::take(_mouseAfterScrollPending)) {
+		sendSynteticMouseEvent(this, QEvent::MouseMove, Qt::NoButton);
+		_mouseAfterScrollTimer.callOnce(kMouseAfterScrollDelay);
+	}
+}
+
 void ScrollArea::onInnerResized() {
 	emit innerResized();
 }
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <rpl/event_stream.h>
 #include "ui/rp_widget.h"
+#include "base/timer.h"
 #include "styles/style_widgets.h"
 
 namespace Ui {
@@ -260,6 +261,9 @@ private:
 	void touchUpdateSpeed();
 	void touchDeaccelerate(int32 elapsed);
 
+	void updateMouseAfterScroll();
+	void mouseAfterScrollTimeout();
+
 	bool _disabled = false;
 	bool _movingByScrollBar = false;
 
@@ -286,6 +290,12 @@ private:
 
 	bool _widgetAcceptsTouch = false;
 
+	// Hover is updated at most once a frame while scrolling, trackpads
+	// send hundreds of scroll events a second and each synthetic mouse
+	// move does a full hit test of the inner widget.
+	base::Timer _mouseAfterScrollTimer;
+	bool _mouseAfterScrollPending = false;
+
 	friend class SplittedWidgetOther;
 	object_ptr<SplittedWidgetOther> _other = { nullptr };
 
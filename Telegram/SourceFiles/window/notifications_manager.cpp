@@ -31,6 +31,11 @@ namespace {
 // not more than one sound in 500ms from one peer - grouping
 constexpr auto kMinimalAlertDelay = TimeMs(500);
 
+// not more than kRateLimitCount notifications in kRateLimitWindow ms,
+// the rest wait and are collapsed to the newest one in each history
+constexpr auto kRateLimitWindow = TimeMs(1000);
+constexpr auto kRateLimitCount = 5;
+
 } // namespace
 
 System::System(AuthSession *session)
@@ -306,7 +311,18 @@ void System::showNext() {
 				}
 				_waitTimer.callOnce(next - ms);
 				break;
+			} else if (!checkRateLimit(ms)) {
+				next = _rateWindowStart + kRateLimitWindow;
+				if (nextAlert && nextAlert < next) {
+					next = nextAlert;
+					nextAlert = 0;
+				}
+				_waitTimer.callOnce(next - ms);
+				break;
 			} else {
+				if (_rateLimited) {
+					notifyItem = skipDueBacklog(notifyHistory, ms);
+				}
 				auto forwardedItem = notifyItem->Has<HistoryMessageForwarded>() ? notifyItem : nullptr; // forwarded notify grouping
 				auto forwardedCount = 1;
 
@@ -360,6 +376,7 @@ void System::showNext() {
 				}
 			}
 		} else {
+			_rateLimited = false;
 			break;
 		}
 	}
@@ -368,6 +385,40 @@ void System::showNext() {
 	}
 }
 
+bool System::checkRateLimit(TimeMs ms) {
+	if (ms >= _rateWindowStart + kRateLimitWindow) {
+		_rateWindowStart = ms;
+		_rateWindowShown = 0;
+	}
+	if (_rateWindowShown >= kRateLimitCount) {
+		_rateLimited = true;
+		return false;
+	}
+	++_rateWindowShown;
+	return true;
+}
+
+HistoryItem *System::skipDueBacklog(not_null<History*> history, TimeMs ms) {
+	const auto j = _whenMaps.find(history);
+	if (j == _whenMaps.end()) {
+		return history->currentNotification();
+	}
+	auto &whenMap = j.value();
+	const auto due = [&](not_null<HistoryItem*> item) {
+		const auto k = whenMap.constFind(item->id);
+		return (k != whenMap.cend()) && (k.value() <= ms);
+	};
+
+	// The messages stay unread in the chat, show only the newest of them.
+	while (history->notifies.size() > 1
+		&& due(history->notifies[0])
+		&& due(history->notifies[1])) {
+		whenMap.remove(history->currentNotification()->id);
+		history->skipNotification();
+	}
+	return history->currentNotification();
+}
+
 void System::ensureSoundCreated() {
 	if (_soundTrack) {
 		return;
@@ -79,6 +79,8 @@ public:
 
 private:
 	void showNext();
+	bool checkRateLimit(TimeMs ms);
+	HistoryItem *skipDueBacklog(not_null<History*> history, TimeMs ms);
 	void ensureSoundCreated();
 
 	AuthSession *_authSession = nullptr;
@@ -102,6 +104,10 @@ private:
 
 	QMap<History*, QMap<TimeMs, PeerData*>> _whenAlerts;
 
+	TimeMs _rateWindowStart = 0;
+	int _rateWindowShown = 0;
+	bool _rateLimited = false;
+
 	std::unique_ptr<Manager> _manager;
 
 	base::Observable<ChangeType> _settingsChanged;
@@ -121,7 +121,9 @@ void PasscodeLockWidget::paintContent(Painter &p) {
 }
 
 void PasscodeLockWidget::submit() {
-	if (_passcode->text().isEmpty()) {
+	if (_checking) {
+		return;
+	} else if (_passcode->text().isEmpty()) {
 		_passcode->showError();
 		return;
 	}
@@ -133,6 +135,14 @@ void PasscodeLockWidget::submit() {
 	}
 
 	const auto passcode = _passcode->text().toUtf8();
+	_checking = true;
+	Local::preparePasscode(passcode, crl::guard(this, [=] {
+		_checking = false;
+		checkPrepared(passcode);
+	}));
+}
+
+void PasscodeLockWidget::checkPrepared(const QByteArray &passcode) {
 	const auto correct = App::main()
 		? Local::checkPasscode(passcode)
 		: (Local::readMap(passcode) != Local::ReadMapPassNeeded);
@@ -53,6 +53,7 @@
       '<(src_loc)/base/concurrent_timer.h',
       '<(src_loc)/base/flags.h',
       '<(src_loc)/base/enum_mask.h',
+      '<(src_loc)/base/flat_hash_map.h',
       '<(src_loc)/base/flat_map.h',
       '<(src_loc)/base/flat_set.h',
       '<(src_loc)/base/functors.h',
@@ -67,13 +68,19 @@
       '<(src_loc)/base/overload.h',
       '<(src_loc)/base/parse_helper.cpp',
       '<(src_loc)/base/parse_helper.h',
+      '<(src_loc)/base/perf_counters.cpp',
+      '<(src_loc)/base/perf_counters.h',
       '<(src_loc)/base/qthelp_regex.h',
       '<(src_loc)/base/qthelp_url.cpp',
       '<(src_loc)/base/qthelp_url.h',
       '<(src_loc)/base/runtime_composer.cpp',
       '<(src_loc)/base/runtime_composer.h',
+      '<(src_loc)/base/slab_allocator.cpp',
+      '<(src_loc)/base/slab_allocator.h',
       '<(src_loc)/base/timer.cpp',
       '<(src_loc)/base/timer.h',
+      '<(src_loc)/base/timer_wheel.cpp',
+      '<(src_loc)/base/timer_wheel.h',
       '<(src_loc)/base/type_traits.h',
       '<(src_loc)/base/unique_any.h',
       '<(src_loc)/base/unique_function.h',
@@ -61,6 +61,15 @@
       '<(src_loc)/base/flags.h',
       '<(src_loc)/base/flags_tests.cpp',
     ],
+  }, {
+    'target_name': 'tests_flat_hash_map',
+    'includes': [
+      'common_test.gypi',
+    ],
+    'sources': [
+      '<(src_loc)/base/flat_hash_map.h',
+      '<(src_loc)/base/flat_hash_map_tests.cpp',
+    ],
   }, {
     'target_name': 'tests_flat_map',
     'includes': [
@@ -79,6 +88,36 @@
       '<(src_loc)/base/flat_set.h',
       '<(src_loc)/base/flat_set_tests.cpp',
     ],
+  }, {
+    'target_name': 'tests_perf_counters',
+    'includes': [
+      'common_test.gypi',
+    ],
+    'sources': [
+      '<(src_loc)/base/perf_counters.cpp',
+      '<(src_loc)/base/perf_counters.h',
+      '<(src_loc)/base/perf_counters_tests.cpp',
+    ],
+  }, {
+    'target_name': 'tests_slab_allocator',
+    'includes': [
+      'common_test.gypi',
+    ],
+    'sources': [
+      '<(src_loc)/base/slab_allocator.cpp',
+      '<(src_loc)/base/slab_allocator.h',
+      '<(src_loc)/base/slab_allocator_tests.cpp',
+    ],
+  }, {
+    'target_name': 'tests_timer_wheel',
+    'includes': [
+      'common_test.gypi',
+    ],
+    'sources': [
+      '<(src_loc)/base/timer_wheel.cpp',
+      '<(src_loc)/base/timer_wheel.h',
+      '<(src_loc)/base/timer_wheel_tests.cpp',
+    ],
   }, {
     'target_name': 'tests_rpl',
     'includes': [
@@ -128,6 +167,7 @@
     ],
     'sources': [
       '<(src_loc)/storage/storage_encrypted_file_tests.cpp',
+      '<(src_loc)/storage/storage_encryption_tests.cpp',
       '<(src_loc)/storage/cache/storage_cache_database_tests.cpp',
       '<(src_loc)/platform/win/windows_dlls.cpp',
       '<(src_loc)/platform/win/windows_dlls.h',
@@ -138,5 +178,32 @@
         '<(src_loc)/platform/win/windows_dlls.h',
       ],
     }]],
+  }, {
+    # Not a part of 'tests', run it manually:
+    # benchmarks [--filter <substring>] [--output <results.json>]
+    'target_name': 'benchmarks',
+    'includes': [
+      'common_benchmark.gypi',
+      '../openssl.gypi',
+    ],
+    'dependencies': [
+      '../lib_storage.gyp:lib_storage',
+    ],
+    'sources': [
+      '<(src_loc)/base/flat_hash_map_benchmarks.cpp',
+      '<(src_loc)/base/flat_map_benchmarks.cpp',
+      '<(src_loc)/base/flat_set_benchmarks.cpp',
+      '<(src_loc)/base/timer_wheel_benchmarks.cpp',
+      '<(src_loc)/rpl/event_stream_benchmarks.cpp',
+      '<(src_loc)/storage/cache/storage_cache_database_benchmarks.cpp',
+      '<(src_loc)/platform/win/windows_dlls.cpp',
+      '<(src_loc)/platform/win/windows_dlls.h',
+    ],
+    'conditions': [[ 'not build_win', {
+      'sources!': [
+        '<(src_loc)/platform/win/windows_dlls.cpp',
+        '<(src_loc)/platform/win/windows_dlls.h',
+      ],
+    }]],
   }],
 }